@@ -418,6 +418,7 @@ typedef struct {
 	NmCli *nmc;
 	int index;
 	const char* active_bssid;
+	NMAccessPoint *active_ap;
 	const char* device;
 } APInfo;
 
@@ -438,7 +439,9 @@ detail_access_point (gpointer data, gpointer user_data)
 	GString *security_str;
 	char *ap_name;
 
-	if (info->active_bssid) {
+	if (info->active_ap)
+		active = (ap == info->active_ap);
+	else if (info->active_bssid) {
 		const char *current_bssid = nm_access_point_get_bssid (ap);
 		if (current_bssid && !strcmp (current_bssid, info->active_bssid))
 			active = TRUE;
@@ -1255,28 +1258,154 @@ error:
 	return nmc->return_value;
 }
 
+/* 'dev wifi list' loads the properties of all devices and access points in
+ * parallel instead of fetching them one by one.  Rows of each device are
+ * printed, in device order, as soon as its access points are loaded; in
+ * terse mode every row is printed as soon as its access point is loaded.
+ */
+typedef struct {
+	NmCli *nmc;
+	GSList *devices;       /* WifiListDevice, in device order */
+	GSList *next_print;    /* first device not printed yet */
+	guint pending;         /* devices still loading */
+	gboolean stream;
+} WifiList;
+
+typedef struct {
+	WifiList *list;
+	NMDevice *device;
+	APInfo info;
+	gboolean loaded;       /* device properties are loaded */
+	guint pending;         /* device and access points still loading */
+	GSList *ready;         /* streamed APs waiting for the device */
+} WifiListDevice;
+
 static void
-show_acces_point_info (NMDevice *device, NmCli *nmc)
+wifi_list_print_device (WifiListDevice *wdev)
 {
-	NMAccessPoint *active_ap = NULL;
-	const char *active_bssid = NULL;
 	const GPtrArray *aps;
-	APInfo *info;
 
-	if (nm_device_get_state (device) == NM_DEVICE_STATE_ACTIVATED) {
-		active_ap = nm_device_wifi_get_active_access_point (NM_DEVICE_WIFI (device));
-		active_bssid = active_ap ? nm_access_point_get_bssid (active_ap) : NULL;
+	aps = nm_device_wifi_get_access_points (NM_DEVICE_WIFI (wdev->device));
+	if (aps && aps->len)
+		g_ptr_array_foreach ((GPtrArray *) aps, detail_access_point, (gpointer) &wdev->info);
+}
+
+static void
+wifi_list_free (WifiList *list)
+{
+	GSList *iter;
+
+	for (iter = list->devices; iter; iter = g_slist_next (iter)) {
+		WifiListDevice *wdev = iter->data;
+
+		g_slist_free (wdev->ready);
+		g_slice_free (WifiListDevice, wdev);
 	}
+	g_slist_free (list->devices);
+	g_slice_free (WifiList, list);
+}
 
-	info = g_malloc0 (sizeof (APInfo));
-	info->nmc = nmc;
-	info->index = 1;
-	info->active_bssid = active_bssid;
-	info->device = nm_device_get_iface (device);
-	aps = nm_device_wifi_get_access_points (NM_DEVICE_WIFI (device));
-	if (aps && aps->len)
-		g_ptr_array_foreach ((GPtrArray *) aps, detail_access_point, (gpointer) info);
-	g_free (info);
+static void
+wifi_list_device_done (WifiListDevice *wdev)
+{
+	WifiList *list = wdev->list;
+
+	if (--wdev->pending)
+		return;
+
+	if (!list->stream) {
+		while (list->next_print) {
+			WifiListDevice *next = list->next_print->data;
+
+			if (next->pending)
+				break;
+			wifi_list_print_device (next);
+			list->next_print = g_slist_next (list->next_print);
+		}
+	}
+
+	if (--list->pending == 0) {
+		wifi_list_free (list);
+		quit ();
+	}
+}
+
+static void
+wifi_list_device_loaded_cb (NMObject *object, GError *error, gpointer user_data)
+{
+	WifiListDevice *wdev = user_data;
+	GSList *iter;
+
+	wdev->loaded = TRUE;
+	if (nm_device_get_state (wdev->device) == NM_DEVICE_STATE_ACTIVATED)
+		wdev->info.active_ap = nm_device_wifi_get_active_access_point (NM_DEVICE_WIFI (wdev->device));
+
+	if (wdev->list->stream) {
+		wdev->ready = g_slist_reverse (wdev->ready);
+		for (iter = wdev->ready; iter; iter = g_slist_next (iter))
+			detail_access_point (iter->data, &wdev->info);
+		g_slist_free (wdev->ready);
+		wdev->ready = NULL;
+	}
+
+	wifi_list_device_done (wdev);
+}
+
+static void
+wifi_list_ap_loaded_cb (NMObject *object, GError *error, gpointer user_data)
+{
+	WifiListDevice *wdev = user_data;
+
+	/* On error the getters just fall back to fetching the values */
+	if (wdev->list->stream) {
+		if (wdev->loaded)
+			detail_access_point (object, &wdev->info);
+		else
+			wdev->ready = g_slist_prepend (wdev->ready, object);
+	}
+
+	wifi_list_device_done (wdev);
+}
+
+static void
+wifi_list_start (NmCli *nmc, GSList *devices)
+{
+	WifiList *list;
+	GSList *iter;
+	int i;
+
+	list = g_slice_new0 (WifiList);
+	list->nmc = nmc;
+	list->stream = (nmc->print_output == NMC_PRINT_TERSE);
+	list->pending = 1;  /* until all loads have been started */
+
+	for (iter = devices; iter; iter = g_slist_next (iter)) {
+		NMDevice *device = iter->data;
+		WifiListDevice *wdev;
+		const GPtrArray *aps;
+
+		wdev = g_slice_new0 (WifiListDevice);
+		wdev->list = list;
+		wdev->device = device;
+		wdev->info.nmc = nmc;
+		wdev->info.index = 1;
+		wdev->info.device = nm_device_get_iface (device);
+		list->devices = g_slist_append (list->devices, wdev);
+		list->pending++;
+
+		aps = nm_device_wifi_get_access_points (NM_DEVICE_WIFI (device));
+		wdev->pending = 1 + (aps ? aps->len : 0);
+		nm_object_load_properties (NM_OBJECT (device), wifi_list_device_loaded_cb, wdev);
+		for (i = 0; aps && i < aps->len; i++)
+			nm_object_load_properties (g_ptr_array_index (aps, i), wifi_list_ap_loaded_cb, wdev);
+	}
+	list->next_print = list->devices;
+
+	nmc->should_wait = TRUE;
+	if (--list->pending == 0) {
+		wifi_list_free (list);
+		quit ();
+	}
 }
 
 static NMCResultCode
@@ -1410,8 +1539,11 @@ do_device_wifi_list (NmCli *nmc, int argc, char **argv)
 				detail_access_point (ap, info);
 				g_free (info);
 			} else {
+				GSList *list = g_slist_prepend (NULL, device);
+
 				print_fields (nmc->print_fields, nmc->allowed_fields); /* Print header */
-				show_acces_point_info (device, nmc);
+				wifi_list_start (nmc, list);
+				g_slist_free (list);
 			}
 		} else {
 		 	g_string_printf (nmc->return_text, _("Error: Device '%s' is not a WiFi device."), iface);
@@ -1456,11 +1588,15 @@ do_device_wifi_list (NmCli *nmc, int argc, char **argv)
 				goto error;
 			}
 		} else {
+			GSList *list = NULL;
+
 			for (i = 0; devices && (i < devices->len); i++) {
 				NMDevice *dev = g_ptr_array_index (devices, i);
 				if (NM_IS_DEVICE_WIFI (dev))
-					show_acces_point_info (dev, nmc);
+					list = g_slist_append (list, dev);
 			}
+			wifi_list_start (nmc, list);
+			g_slist_free (list);
 		}
 	}
 
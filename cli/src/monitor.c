@@ -0,0 +1,288 @@
+/* nmcli - command-line tool to control NetworkManager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * (C) Copyright 2011 Red Hat, Inc.
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include <glib.h>
+#include <glib/gi18n.h>
+#include <nm-client.h>
+#include <nm-event-monitor.h>
+
+#include "utils.h"
+#include "monitor.h"
+
+
+/* Available fields for 'monitor' */
+static NmcOutputField nmc_fields_monitor[] = {
+	{"SEQ",        N_("SEQ"),          8, NULL, 0},  /* 0 */
+	{"TYPE",       N_("TYPE"),        19, NULL, 0},  /* 1 */
+	{"PATH",       N_("PATH"),        52, NULL, 0},  /* 2 */
+	{"EVENT",      N_("EVENT"),       22, NULL, 0},  /* 3 */
+	{"VALUE",      N_("VALUE"),       20, NULL, 0},  /* 4 */
+	{"REASON",     N_("REASON"),       8, NULL, 0},  /* 5 */
+	{NULL,         NULL,               0, NULL, 0}
+};
+#define NMC_FIELDS_MONITOR_ALL     "SEQ,TYPE,PATH,EVENT,VALUE,REASON"
+#define NMC_FIELDS_MONITOR_COMMON  "SEQ,TYPE,PATH,EVENT,VALUE"
+
+/* glib main loop variable - defined in nmcli.c */
+extern GMainLoop *loop;
+
+static void
+usage (void)
+{
+	fprintf (stderr,
+	         _("Usage: nmcli monitor { OPTIONS | help }\n\n"
+	         "  OPTIONS := [events <type>[,<type>...]] [iface <iface>] [coalesce <ms>]\n\n"
+	         "  <type> := { manager | device | connection | active | ap }\n\n"));
+}
+
+/* quit main loop */
+static void
+quit (void)
+{
+	g_main_loop_quit (loop);  /* quit main loop */
+}
+
+static const struct {
+	const char *name;
+	NMEventType type;
+} event_types[] = {
+	{ "manager",    NM_EVENT_TYPE_MANAGER },
+	{ "device",     NM_EVENT_TYPE_DEVICE },
+	{ "connection", NM_EVENT_TYPE_CONNECTION },
+	{ "active",     NM_EVENT_TYPE_ACTIVE_CONNECTION },
+	{ "ap",         NM_EVENT_TYPE_ACCESS_POINT },
+	{ NULL,         0 }
+};
+
+static const char *
+event_type_to_string (NMEventType type)
+{
+	int i;
+
+	for (i = 0; event_types[i].name; i++) {
+		if (event_types[i].type == type)
+			return event_types[i].name;
+	}
+	return _("unknown");
+}
+
+static gboolean
+parse_event_types (const char *str, guint32 *types, GError **error)
+{
+	char **names, **iter;
+	gboolean success = TRUE;
+
+	*types = 0;
+	names = g_strsplit (str, ",", -1);
+	for (iter = names; *iter && success; iter++) {
+		int i;
+
+		for (i = 0; event_types[i].name; i++) {
+			if (!strcmp (*iter, event_types[i].name)) {
+				*types |= event_types[i].type;
+				break;
+			}
+		}
+		if (!event_types[i].name) {
+			g_set_error (error, 0, 0, _("'%s' is not a valid event type"), *iter);
+			success = FALSE;
+		}
+	}
+	g_strfreev (names);
+	return success;
+}
+
+static char *
+event_value_to_string (const NMEvent *event)
+{
+	if (!G_IS_VALUE (&event->value))
+		return g_strdup ("");
+	if (G_VALUE_HOLDS_STRING (&event->value))
+		return g_value_dup_string (&event->value);
+	if (G_VALUE_HOLDS (&event->value, G_TYPE_STRV)) {
+		char **strv = g_value_get_boxed (&event->value);
+
+		return strv ? g_strjoinv (",", strv) : g_strdup ("");
+	}
+	if (G_VALUE_HOLDS_BOOLEAN (&event->value))
+		return g_strdup (g_value_get_boolean (&event->value) ? _("yes") : _("no"));
+	return g_strdup_value_contents (&event->value);
+}
+
+static void
+event_cb (NMEventMonitor *monitor, const NMEvent *event, gpointer user_data)
+{
+	NmCli *nmc = (NmCli *) user_data;
+	char *seq_str, *value_str, *reason_str;
+
+	seq_str = g_strdup_printf ("%" G_GUINT64_FORMAT, event->seq);
+	value_str = event_value_to_string (event);
+	reason_str = g_strdup_printf ("%u", event->reason);
+
+	nmc->allowed_fields[0].value = seq_str;
+	nmc->allowed_fields[1].value = event_type_to_string (event->type);
+	nmc->allowed_fields[2].value = event->path;
+	nmc->allowed_fields[3].value = event->name;
+	nmc->allowed_fields[4].value = value_str;
+	nmc->allowed_fields[5].value = reason_str;
+	print_fields (nmc->print_fields, nmc->allowed_fields);
+	fflush (stdout);
+
+	g_free (seq_str);
+	g_free (value_str);
+	g_free (reason_str);
+}
+
+/* entry point function for 'nmcli monitor' */
+NMCResultCode
+do_monitor (NmCli *nmc, int argc, char **argv)
+{
+	GError *error = NULL;
+	guint32 types = NM_EVENT_TYPE_ALL;
+	const char *iface = NULL;
+	const char *path = NULL;
+	guint coalesce = 0;
+	const char *fields_str;
+	guint32 mode_flag = (nmc->print_output == NMC_PRINT_PRETTY) ? NMC_PF_FLAG_PRETTY : (nmc->print_output == NMC_PRINT_TERSE) ? NMC_PF_FLAG_TERSE : 0;
+	guint32 multiline_flag = nmc->multiline_output ? NMC_PF_FLAG_MULTILINE : 0;
+	guint32 escape_flag = nmc->escape_values ? NMC_PF_FLAG_ESCAPE : 0;
+
+	while (argc > 0) {
+		if (strcmp (*argv, "help") == 0) {
+			usage ();
+			goto end;
+		} else if (strcmp (*argv, "events") == 0) {
+			if (next_arg (&argc, &argv) != 0) {
+				g_string_printf (nmc->return_text, _("Error: %s argument is missing."), *(argv-1));
+				nmc->return_value = NMC_RESULT_ERROR_USER_INPUT;
+				goto end;
+			}
+			if (!parse_event_types (*argv, &types, &error)) {
+				g_string_printf (nmc->return_text, _("Error: %s."), error->message);
+				g_clear_error (&error);
+				nmc->return_value = NMC_RESULT_ERROR_USER_INPUT;
+				goto end;
+			}
+		} else if (strcmp (*argv, "iface") == 0) {
+			if (next_arg (&argc, &argv) != 0) {
+				g_string_printf (nmc->return_text, _("Error: %s argument is missing."), *(argv-1));
+				nmc->return_value = NMC_RESULT_ERROR_USER_INPUT;
+				goto end;
+			}
+			iface = *argv;
+		} else if (strcmp (*argv, "coalesce") == 0) {
+			char *end;
+			long ms;
+
+			if (next_arg (&argc, &argv) != 0) {
+				g_string_printf (nmc->return_text, _("Error: %s argument is missing."), *(argv-1));
+				nmc->return_value = NMC_RESULT_ERROR_USER_INPUT;
+				goto end;
+			}
+			ms = strtol (*argv, &end, 10);
+			if (*end || ms < 0 || ms > G_MAXINT) {
+				g_string_printf (nmc->return_text, _("Error: '%s' is not a valid coalesce interval."), *argv);
+				nmc->return_value = NMC_RESULT_ERROR_USER_INPUT;
+				goto end;
+			}
+			coalesce = (guint) ms;
+		} else {
+			fprintf (stderr, _("Unknown parameter: %s\n"), *argv);
+		}
+
+		argc--;
+		argv++;
+	}
+
+	if (!nmc_terse_option_check (nmc->print_output, nmc->required_fields, &error)) {
+		g_string_printf (nmc->return_text, _("Error: %s."), error->message);
+		g_error_free (error);
+		nmc->return_value = NMC_RESULT_ERROR_USER_INPUT;
+		goto end;
+	}
+
+	if (!nmc->required_fields || strcasecmp (nmc->required_fields, "common") == 0)
+		fields_str = NMC_FIELDS_MONITOR_COMMON;
+	else if (strcasecmp (nmc->required_fields, "all") == 0)
+		fields_str = NMC_FIELDS_MONITOR_ALL;
+	else
+		fields_str = nmc->required_fields;
+
+	nmc->allowed_fields = nmc_fields_monitor;
+	nmc->print_fields.indices = parse_output_fields (fields_str, nmc->allowed_fields, &error);
+	if (error) {
+		if (error->code == 0)
+			g_string_printf (nmc->return_text, _("Error: 'monitor': %s"), error->message);
+		else
+			g_string_printf (nmc->return_text, _("Error: 'monitor': %s; allowed fields: %s"), error->message, NMC_FIELDS_MONITOR_ALL);
+		g_error_free (error);
+		nmc->return_value = NMC_RESULT_ERROR_USER_INPUT;
+		goto end;
+	}
+
+	if (iface) {
+		NMDevice *device;
+
+		if (!nmc_is_nm_running (nmc, &error)) {
+			if (error) {
+				g_string_printf (nmc->return_text, _("Error: Can't find out if NetworkManager is running: %s."), error->message);
+				nmc->return_value = NMC_RESULT_ERROR_UNKNOWN;
+				g_error_free (error);
+			} else {
+				g_string_printf (nmc->return_text, _("Error: NetworkManager is not running."));
+				nmc->return_value = NMC_RESULT_ERROR_NM_NOT_RUNNING;
+			}
+			goto end;
+		}
+
+		nmc->get_client (nmc); /* create NMClient */
+		device = nm_client_get_device_by_iface (nmc->client, iface);
+		if (!device) {
+			g_string_printf (nmc->return_text, _("Error: Device '%s' not found."), iface);
+			nmc->return_value = NMC_RESULT_ERROR_UNKNOWN;
+			goto end;
+		}
+		path = nm_object_get_path (NM_OBJECT (device));
+	}
+
+	nmc->print_fields.flags = multiline_flag | mode_flag | escape_flag | NMC_PF_FLAG_MAIN_HEADER_ADD | NMC_PF_FLAG_FIELD_NAMES;
+	nmc->print_fields.header_name = _("NetworkManager events");
+	print_fields (nmc->print_fields, nmc->allowed_fields); /* Print header */
+	nmc->print_fields.flags = multiline_flag | mode_flag | escape_flag;
+	fflush (stdout);
+
+	/* Runs until interrupted; nmc_cleanup() frees the monitor */
+	nmc->event_monitor = nm_event_monitor_new (NULL);
+	nm_event_monitor_set_filter (nmc->event_monitor, types, path);
+	nm_event_monitor_set_coalesce_interval (nmc->event_monitor, coalesce);
+	g_signal_connect (nmc->event_monitor, NM_EVENT_MONITOR_EVENT, G_CALLBACK (event_cb), nmc);
+
+	nmc->should_wait = TRUE;
+	return nmc->return_value;
+
+end:
+	quit ();
+	return nmc->return_value;
+}
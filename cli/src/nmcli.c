@@ -39,6 +39,7 @@
 #include "connections.h"
 #include "devices.h"
 #include "network-manager.h"
+#include "monitor.h"
 
 #if defined(NM_DIST_VERSION)
 # define NMCLI_VERSION NM_DIST_VERSION
@@ -74,7 +75,8 @@ usage (const char *prog_name)
 	         "OBJECT\n"
 	         "  nm          NetworkManager status\n"
 	         "  con         NetworkManager connections\n"
-	         "  dev         devices managed by NetworkManager\n\n"),
+	         "  dev         devices managed by NetworkManager\n"
+	         "  monitor     watch NetworkManager events\n\n"),
 	          prog_name);
 }
 
@@ -92,6 +94,7 @@ static const struct cmd {
 	{ "nm",         do_network_manager },
 	{ "con",        do_connections },
 	{ "dev",        do_devices },
+	{ "monitor",    do_monitor },
 	{ "help",       do_help },
 	{ 0 }
 };
@@ -278,6 +281,8 @@ nmc_init (NmCli *nmc)
 	nmc->system_settings_running = FALSE;
 	nmc->system_connections = NULL;
 
+	nmc->event_monitor = NULL;
+
 	nmc->should_wait = FALSE;
 	nmc->nowait_flag = TRUE;
 	nmc->print_output = NMC_PRINT_NORMAL;
@@ -300,6 +305,8 @@ nmc_cleanup (NmCli *nmc)
 	if (nmc->system_settings) g_object_unref (nmc->system_settings);
 	g_slist_free (nmc->system_connections);
 
+	if (nmc->event_monitor) g_object_unref (nmc->event_monitor);
+
 	g_free (nmc->required_fields);
 	if (nmc->print_fields.indices)
 		g_array_free (nmc->print_fields.indices, TRUE);
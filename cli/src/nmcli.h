@@ -24,6 +24,7 @@
 
 #include <nm-client.h>
 #include <nm-remote-settings.h>
+#include <nm-event-monitor.h>
 
 /* nmcli exit codes */
 typedef enum {
@@ -101,6 +102,8 @@ typedef struct _NmCli {
 	gboolean system_settings_running;                 /* Is system settings service running? */
 	GSList *system_connections;                       /* List of system connections */
 
+	NMEventMonitor *event_monitor;                    /* Event monitor of 'nmcli monitor' */
+
 	gboolean should_wait;                             /* Indication that nmcli should not end yet */
 	gboolean nowait_flag;                             /* '--nowait' option; used for passing to callbacks */
 	NMCPrintOutput print_output;                      /* Output mode */
@@ -43,9 +43,6 @@ G_DEFINE_TYPE (NMAccessPoint, nm_access_point, NM_TYPE_OBJECT)
 #define NM_ACCESS_POINT_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), NM_TYPE_ACCESS_POINT, NMAccessPointPrivate))
 
 typedef struct {
-	gboolean disposed;
-	DBusGProxy *proxy;
-
 	NM80211ApFlags flags;
 	NM80211ApSecurityFlags wpa_flags;
 	NM80211ApSecurityFlags rsn_flags;
@@ -120,7 +117,7 @@ nm_access_point_get_flags (NMAccessPoint *ap)
 	g_return_val_if_fail (NM_IS_ACCESS_POINT (ap), NM_802_11_AP_FLAGS_NONE);
 
 	priv = NM_ACCESS_POINT_GET_PRIVATE (ap);
-	if (!priv->flags) {
+	if (!priv->flags && !_nm_object_properties_loaded (NM_OBJECT (ap))) {
 		priv->flags = _nm_object_get_uint_property (NM_OBJECT (ap),
 		                                           NM_DBUS_INTERFACE_ACCESS_POINT,
 		                                           DBUS_PROP_FLAGS,
@@ -146,7 +143,7 @@ nm_access_point_get_wpa_flags (NMAccessPoint *ap)
 	g_return_val_if_fail (NM_IS_ACCESS_POINT (ap), NM_802_11_AP_SEC_NONE);
 
 	priv = NM_ACCESS_POINT_GET_PRIVATE (ap);
-	if (!priv->wpa_flags) {
+	if (!priv->wpa_flags && !_nm_object_properties_loaded (NM_OBJECT (ap))) {
 		priv->wpa_flags = _nm_object_get_uint_property (NM_OBJECT (ap),
 		                                               NM_DBUS_INTERFACE_ACCESS_POINT,
 		                                               DBUS_PROP_WPA_FLAGS,
@@ -173,7 +170,7 @@ nm_access_point_get_rsn_flags (NMAccessPoint *ap)
 	g_return_val_if_fail (NM_IS_ACCESS_POINT (ap), NM_802_11_AP_SEC_NONE);
 
 	priv = NM_ACCESS_POINT_GET_PRIVATE (ap);
-	if (!priv->rsn_flags) {
+	if (!priv->rsn_flags && !_nm_object_properties_loaded (NM_OBJECT (ap))) {
 		priv->rsn_flags = _nm_object_get_uint_property (NM_OBJECT (ap),
 		                                               NM_DBUS_INTERFACE_ACCESS_POINT,
 		                                               DBUS_PROP_RSN_FLAGS,
@@ -226,7 +223,7 @@ nm_access_point_get_frequency (NMAccessPoint *ap)
 	g_return_val_if_fail (NM_IS_ACCESS_POINT (ap), 0);
 
 	priv = NM_ACCESS_POINT_GET_PRIVATE (ap);
-	if (!priv->frequency) {
+	if (!priv->frequency && !_nm_object_properties_loaded (NM_OBJECT (ap))) {
 		priv->frequency = _nm_object_get_uint_property (NM_OBJECT (ap),
 		                                               NM_DBUS_INTERFACE_ACCESS_POINT,
 		                                               DBUS_PROP_FREQUENCY,
@@ -296,7 +293,7 @@ nm_access_point_get_mode (NMAccessPoint *ap)
 	g_return_val_if_fail (NM_IS_ACCESS_POINT (ap), 0);
 
 	priv = NM_ACCESS_POINT_GET_PRIVATE (ap);
-	if (!priv->mode) {
+	if (!priv->mode && !_nm_object_properties_loaded (NM_OBJECT (ap))) {
 		priv->mode = _nm_object_get_uint_property (NM_OBJECT (ap),
 		                                          NM_DBUS_INTERFACE_ACCESS_POINT,
 		                                          DBUS_PROP_MODE,
@@ -322,7 +319,7 @@ nm_access_point_get_max_bitrate (NMAccessPoint *ap)
 	g_return_val_if_fail (NM_IS_ACCESS_POINT (ap), 0);
 
 	priv = NM_ACCESS_POINT_GET_PRIVATE (ap);
-	if (!priv->max_bitrate) {
+	if (!priv->max_bitrate && !_nm_object_properties_loaded (NM_OBJECT (ap))) {
 		priv->max_bitrate = _nm_object_get_uint_property (NM_OBJECT (ap),
 		                                              NM_DBUS_INTERFACE_ACCESS_POINT,
 		                                              DBUS_PROP_MAX_BITRATE,
@@ -348,7 +345,7 @@ nm_access_point_get_strength (NMAccessPoint *ap)
 	g_return_val_if_fail (NM_IS_ACCESS_POINT (ap), 0);
 
 	priv = NM_ACCESS_POINT_GET_PRIVATE (ap);
-	if (!priv->strength) {
+	if (!priv->strength && !_nm_object_properties_loaded (NM_OBJECT (ap))) {
 		priv->strength = _nm_object_get_byte_property (NM_OBJECT (ap),
 		                                              NM_DBUS_INTERFACE_ACCESS_POINT,
 		                                              DBUS_PROP_STRENGTH,
@@ -504,23 +501,6 @@ nm_access_point_init (NMAccessPoint *ap)
 {
 }
 
-static void
-dispose (GObject *object)
-{
-	NMAccessPointPrivate *priv = NM_ACCESS_POINT_GET_PRIVATE (object);
-
-	if (priv->disposed) {
-		G_OBJECT_CLASS (nm_access_point_parent_class)->dispose (object);
-		return;
-	}
-
-	priv->disposed = TRUE;
-
-	g_object_unref (priv->proxy);
-
-	G_OBJECT_CLASS (nm_access_point_parent_class)->dispose (object);
-}
-
 static void
 finalize (GObject *object)
 {
@@ -606,9 +586,9 @@ register_for_property_changed (NMAccessPoint *ap)
 		{ NULL },
 	};
 
-	_nm_object_handle_properties_changed (NM_OBJECT (ap),
-	                                     priv->proxy,
-	                                     property_changed_info);
+	_nm_object_register_properties (NM_OBJECT (ap),
+	                                NM_DBUS_INTERFACE_ACCESS_POINT,
+	                                property_changed_info);
 }
 
 static GObject*
@@ -617,7 +597,6 @@ constructor (GType type,
 			 GObjectConstructParam *construct_params)
 {
 	NMObject *object;
-	NMAccessPointPrivate *priv;
 
 	object = (NMObject *) G_OBJECT_CLASS (nm_access_point_parent_class)->constructor (type,
 																	  n_construct_params,
@@ -625,13 +604,6 @@ constructor (GType type,
 	if (!object)
 		return NULL;
 
-	priv = NM_ACCESS_POINT_GET_PRIVATE (object);
-
-	priv->proxy = dbus_g_proxy_new_for_name (nm_object_get_connection (object),
-									    NM_DBUS_SERVICE,
-									    nm_object_get_path (object),
-									    NM_DBUS_INTERFACE_ACCESS_POINT);
-
 	register_for_property_changed (NM_ACCESS_POINT (object));
 
 	return G_OBJECT (object);
@@ -648,7 +620,6 @@ nm_access_point_class_init (NMAccessPointClass *ap_class)
 	/* virtual methods */
 	object_class->constructor = constructor;
 	object_class->get_property = get_property;
-	object_class->dispose = dispose;
 	object_class->finalize = finalize;
 
 	/* properties */
@@ -111,7 +111,7 @@ nm_active_connection_get_connection (NMActiveConnection *connection)
 	g_return_val_if_fail (NM_IS_ACTIVE_CONNECTION (connection), NULL);
 
 	priv = NM_ACTIVE_CONNECTION_GET_PRIVATE (connection);
-	if (!priv->connection) {
+	if (!priv->connection && !_nm_object_properties_loaded (NM_OBJECT (connection))) {
 		priv->connection = _nm_object_get_string_property (NM_OBJECT (connection),
 		                                                  NM_DBUS_INTERFACE_ACTIVE_CONNECTION,
 		                                                  DBUS_PROP_CONNECTION,
@@ -165,7 +165,7 @@ nm_active_connection_get_specific_object (NMActiveConnection *connection)
 	g_return_val_if_fail (NM_IS_ACTIVE_CONNECTION (connection), NULL);
 
 	priv = NM_ACTIVE_CONNECTION_GET_PRIVATE (connection);
-	if (!priv->specific_object) {
+	if (!priv->specific_object && !_nm_object_properties_loaded (NM_OBJECT (connection))) {
 		priv->specific_object = _nm_object_get_string_property (NM_OBJECT (connection),
 		                                                       NM_DBUS_INTERFACE_ACTIVE_CONNECTION,
 		                                                       DBUS_PROP_SPECIFIC_OBJECT,
@@ -226,7 +226,7 @@ nm_active_connection_get_state (NMActiveConnection *connection)
 	g_return_val_if_fail (NM_IS_ACTIVE_CONNECTION (connection), NM_ACTIVE_CONNECTION_STATE_UNKNOWN);
 
 	priv = NM_ACTIVE_CONNECTION_GET_PRIVATE (connection);
-	if (!priv->state) {
+	if (!priv->state && !_nm_object_properties_loaded (NM_OBJECT (connection))) {
 		priv->state = _nm_object_get_uint_property (NM_OBJECT (connection),
 		                                           NM_DBUS_INTERFACE_ACTIVE_CONNECTION,
 		                                           DBUS_PROP_STATE,
@@ -253,7 +253,7 @@ nm_active_connection_get_default (NMActiveConnection *connection)
 	g_return_val_if_fail (NM_IS_ACTIVE_CONNECTION (connection), FALSE);
 
 	priv = NM_ACTIVE_CONNECTION_GET_PRIVATE (connection);
-	if (!priv->is_default) {
+	if (!priv->is_default && !_nm_object_properties_loaded (NM_OBJECT (connection))) {
 		priv->is_default = _nm_object_get_boolean_property (NM_OBJECT (connection),
 		                                                    NM_DBUS_INTERFACE_ACTIVE_CONNECTION,
 		                                                    DBUS_PROP_DEFAULT,
@@ -280,7 +280,7 @@ nm_active_connection_get_default6 (NMActiveConnection *connection)
 	g_return_val_if_fail (NM_IS_ACTIVE_CONNECTION (connection), FALSE);
 
 	priv = NM_ACTIVE_CONNECTION_GET_PRIVATE (connection);
-	if (!priv->is_default6) {
+	if (!priv->is_default6 && !_nm_object_properties_loaded (NM_OBJECT (connection))) {
 		priv->is_default6 = _nm_object_get_boolean_property (NM_OBJECT (connection),
 		                                                     NM_DBUS_INTERFACE_ACTIVE_CONNECTION,
 		                                                     DBUS_PROP_DEFAULT6,
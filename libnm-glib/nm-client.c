@@ -74,6 +74,9 @@ typedef struct {
 
 	gboolean wimax_enabled;
 	gboolean wimax_hw_enabled;
+
+	/* nm_client_new_async() loads the initial state itself */
+	gboolean load_async;
 } NMClientPrivate;
 
 enum {
@@ -89,10 +92,14 @@ enum {
 	PROP_WIMAX_ENABLED,
 	PROP_WIMAX_HARDWARE_ENABLED,
 	PROP_ACTIVE_CONNECTIONS,
+	PROP_LOAD_ASYNC,
 
 	LAST_PROP
 };
 
+/* Private, construct-only */
+#define NM_CLIENT_LOAD_ASYNC "load-async"
+
 enum {
 	DEVICE_ADDED,
 	DEVICE_REMOVED,
@@ -299,6 +306,72 @@ new_active_connection (DBusGConnection *connection, const char *path)
 	return object;
 }
 
+typedef struct {
+	DBusGConnection *connection;
+	char *path;
+	NMObjectCreatedFunc callback;
+	gpointer user_data;
+} NewActiveInfo;
+
+static void
+new_active_got_vpn (DBusGProxy *proxy, DBusGProxyCall *call, gpointer user_data)
+{
+	NewActiveInfo *info = user_data;
+	GError *error = NULL;
+	GValue value = {0,};
+	GObject *object = NULL;
+
+	if (dbus_g_proxy_end_call (proxy, call, &error,
+	                           G_TYPE_VALUE, &value, G_TYPE_INVALID)) {
+		/* Someone else may have created it while we were waiting */
+		object = (GObject *) _nm_object_cache_get (info->path);
+		if (!object && g_value_get_boolean (&value))
+			object = nm_vpn_connection_new (info->connection, info->path);
+		else if (!object)
+			object = nm_active_connection_new (info->connection, info->path);
+		g_value_unset (&value);
+	} else {
+		g_warning ("Error in getting active connection 'Vpn' property: (%d) %s",
+		           error->code, error->message);
+		g_error_free (error);
+	}
+
+	info->callback (object, info->user_data);
+
+	dbus_g_connection_unref (info->connection);
+	g_free (info->path);
+	g_slice_free (NewActiveInfo, info);
+	g_object_unref (proxy);
+}
+
+/* Non-blocking new_active_connection() */
+static void
+new_active_connection_async (DBusGConnection *connection,
+                             const char *path,
+                             NMObjectCreatedFunc callback,
+                             gpointer user_data)
+{
+	DBusGProxy *proxy;
+	NewActiveInfo *info;
+
+	proxy = dbus_g_proxy_new_for_name (connection,
+	                                   NM_DBUS_SERVICE,
+	                                   path,
+	                                   "org.freedesktop.DBus.Properties");
+
+	info = g_slice_new0 (NewActiveInfo);
+	info->connection = dbus_g_connection_ref (connection);
+	info->path = g_strdup (path);
+	info->callback = callback;
+	info->user_data = user_data;
+
+	dbus_g_proxy_begin_call (proxy, "Get",
+	                         new_active_got_vpn, info, NULL,
+	                         G_TYPE_STRING, NM_DBUS_INTERFACE_ACTIVE_CONNECTION,
+	                         G_TYPE_STRING, "Vpn",
+	                         G_TYPE_INVALID);
+}
+
 static gboolean
 demarshal_active_connections (NMObject *object,
                               GParamSpec *pspec,
@@ -1069,7 +1142,7 @@ nm_client_get_version (NMClient *client)
 	if (!priv->manager_running)
 		return NULL;
 
-	if (!priv->version)
+	if (!priv->version && !_nm_object_properties_loaded (NM_OBJECT (client)))
 		priv->version = _nm_object_get_string_property (NM_OBJECT (client), NM_DBUS_INTERFACE, "Version", &err);
 
 	/* TODO: we don't pass the error to the caller yet, maybe later */
@@ -1099,7 +1172,7 @@ nm_client_get_state (NMClient *client)
 	if (!priv->manager_running)
 		return NM_STATE_UNKNOWN;
 
-	if (priv->state == NM_STATE_UNKNOWN)
+	if (priv->state == NM_STATE_UNKNOWN && !_nm_object_properties_loaded (NM_OBJECT (client)))
 		priv->state = _nm_object_get_uint_property (NM_OBJECT (client), NM_DBUS_INTERFACE, "State", NULL);
 
 	return priv->state;
@@ -1248,6 +1321,8 @@ proxy_name_owner_changed (DBusGProxy *proxy,
 
 	priv->manager_running = new_running;
 	if (!priv->manager_running) {
+		/* Whatever the next daemon reports must be fetched again */
+		_nm_object_set_properties_loaded (NM_OBJECT (client), FALSE);
 		priv->state = NM_STATE_UNKNOWN;
 		_nm_object_queue_notify (NM_OBJECT (client), NM_CLIENT_MANAGER_RUNNING);
 		poke_wireless_devices_with_rf_status (client);
@@ -1309,6 +1384,16 @@ client_device_removed_proxy (DBusGProxy *proxy, char *path, gpointer user_data)
 
 /****************************************************************/
 
+static DBusGConnection *
+get_bus (GError **error)
+{
+#ifdef LIBNM_GLIB_TEST
+	return dbus_g_bus_get (DBUS_BUS_SESSION, error);
+#else
+	return dbus_g_bus_get (DBUS_BUS_SYSTEM, error);
+#endif
+}
+
 /**
  * nm_client_new:
  *
@@ -1322,11 +1407,7 @@ nm_client_new (void)
 	DBusGConnection *connection;
 	GError *err = NULL;
 
-#ifdef LIBNM_GLIB_TEST
-	connection = dbus_g_bus_get (DBUS_BUS_SESSION, &err);
-#else
-	connection = dbus_g_bus_get (DBUS_BUS_SYSTEM, &err);
-#endif
+	connection = get_bus (&err);
 	if (!connection) {
 		g_warning ("Couldn't connect to system bus: %s", err->message);
 		g_error_free (err);
@@ -1339,6 +1420,323 @@ nm_client_new (void)
 									  NULL);
 }
 
+typedef struct {
+	NMClient *client;
+	NMClientNewFn callback;
+	gpointer user_data;
+	GError *error;
+
+	DBusGProxy *props_proxy;
+	guint pending;
+	gboolean loading;     /* children created, now loading their properties */
+	GValue devices;       /* device paths from GetDevices */
+	GValue active;        /* the manager's ActiveConnections property */
+	GSList *children;     /* newly created devices and active connections */
+} NewInfo;
+
+static void new_step_done (NewInfo *info);
+
+static void
+new_set_error (NewInfo *info, GError *error)
+{
+	if (!info->error)
+		info->error = error;
+	else
+		g_error_free (error);
+}
+
+static gboolean
+new_done (gpointer user_data)
+{
+	NewInfo *info = user_data;
+
+	if (info->client) {
+		NMClientPrivate *priv = NM_CLIENT_GET_PRIVATE (info->client);
+
+		if (priv->manager_running) {
+			/* As update_*_status() do, report radios with their hardware
+			 * switch off as disabled.
+			 */
+			priv->wireless_enabled = priv->wireless_enabled && priv->wireless_hw_enabled;
+			priv->wwan_enabled = priv->wwan_enabled && priv->wwan_hw_enabled;
+			priv->wimax_enabled = priv->wimax_enabled && priv->wimax_hw_enabled;
+			poke_wireless_devices_with_rf_status (info->client);
+		} else {
+			/* Failures are expected if NM isn't running; the client picks
+			 * up the state once it starts.
+			 */
+			g_clear_error (&info->error);
+		}
+	}
+
+	if (info->callback)
+		info->callback (info->client, info->error, info->user_data);
+	else if (info->client)
+		g_object_unref (info->client);
+
+	g_clear_error (&info->error);
+	if (info->props_proxy)
+		g_object_unref (info->props_proxy);
+	if (G_IS_VALUE (&info->devices))
+		g_value_unset (&info->devices);
+	if (G_IS_VALUE (&info->active))
+		g_value_unset (&info->active);
+	g_slice_free (NewInfo, info);
+	return FALSE;
+}
+
+static void
+new_child_loaded (NMObject *object, GError *error, gpointer user_data)
+{
+	/* Objects may go away while loading; not an error for the client */
+	new_step_done ((NewInfo *) user_data);
+}
+
+/* All devices and active connections exist now, so filling the arrays
+ * only finds them in the object cache and doesn't block.
+ */
+static void
+new_objects_created (NewInfo *info)
+{
+	NMClientPrivate *priv = NM_CLIENT_GET_PRIVATE (info->client);
+	DBusGConnection *connection = nm_object_get_connection (NM_OBJECT (info->client));
+	GSList *iter;
+
+	info->loading = TRUE;
+
+	if (priv->manager_running) {
+		if (G_IS_VALUE (&info->devices))
+			_nm_object_array_demarshal (&info->devices, &priv->devices, connection, nm_device_new);
+		if (G_IS_VALUE (&info->active))
+			demarshal_active_connections (NM_OBJECT (info->client), NULL, &info->active, &priv->active_connections);
+
+		for (iter = info->children; iter; iter = g_slist_next (iter)) {
+			info->pending++;
+			nm_object_load_properties (NM_OBJECT (iter->data), new_child_loaded, info);
+		}
+	}
+
+	g_slist_foreach (info->children, (GFunc) g_object_unref, NULL);
+	g_slist_free (info->children);
+	info->children = NULL;
+
+	if (info->pending == 0)
+		new_done (info);
+}
+
+static void
+new_step_done (NewInfo *info)
+{
+	if (--info->pending > 0)
+		return;
+
+	if (!info->loading)
+		new_objects_created (info);
+	else
+		new_done (info);
+}
+
+static void
+new_child_created (GObject *object, gpointer user_data)
+{
+	NewInfo *info = user_data;
+
+	if (object)
+		info->children = g_slist_prepend (info->children, object);
+	new_step_done (info);
+}
+
+static void
+new_name_has_owner_cb (DBusGProxy *proxy, DBusGProxyCall *call, gpointer user_data)
+{
+	NewInfo *info = user_data;
+	NMClientPrivate *priv = NM_CLIENT_GET_PRIVATE (info->client);
+	GError *error = NULL;
+
+	if (!dbus_g_proxy_end_call (proxy, call, &error,
+	                            G_TYPE_BOOLEAN, &priv->manager_running,
+	                            G_TYPE_INVALID)) {
+		g_warning ("Error on NameHasOwner DBUS call: %s", error->message);
+		new_set_error (info, error);
+	}
+	new_step_done (info);
+}
+
+static void
+new_get_all_cb (DBusGProxy *proxy, DBusGProxyCall *call, gpointer user_data)
+{
+	NewInfo *info = user_data;
+	NMClientPrivate *priv = NM_CLIENT_GET_PRIVATE (info->client);
+	GHashTable *props = NULL;
+	GError *error = NULL;
+	GValue *active;
+
+	if (!dbus_g_proxy_end_call (proxy, call, &error,
+	                            DBUS_TYPE_G_MAP_OF_VARIANT, &props,
+	                            G_TYPE_INVALID)) {
+		new_set_error (info, error);
+		new_step_done (info);
+		return;
+	}
+
+	/* Active connections are set once their objects have been created */
+	active = g_hash_table_lookup (props, "ActiveConnections");
+	if (active && G_VALUE_HOLDS (active, DBUS_TYPE_G_ARRAY_OF_OBJECT_PATH)) {
+		GPtrArray *paths = g_value_get_boxed (active);
+		int i;
+
+		g_value_init (&info->active, G_VALUE_TYPE (active));
+		g_value_copy (active, &info->active);
+		g_hash_table_remove (props, "ActiveConnections");
+
+		for (i = 0; paths && i < paths->len; i++) {
+			const char *path = g_ptr_array_index (paths, i);
+
+			if (_nm_object_cache_peek (path))
+				continue;
+			info->pending++;
+			new_active_connection_async (nm_object_get_connection (NM_OBJECT (info->client)),
+			                             path, new_child_created, info);
+		}
+	}
+
+	_nm_object_process_properties (NM_OBJECT (info->client), props);
+	g_hash_table_destroy (props);
+	priv->have_networking_enabled = TRUE;
+	_nm_object_set_properties_loaded (NM_OBJECT (info->client), TRUE);
+
+	new_step_done (info);
+}
+
+static void
+new_get_devices_cb (DBusGProxy *proxy, GPtrArray *devices, GError *error, gpointer user_data)
+{
+	NewInfo *info = user_data;
+	int i;
+
+	if (error) {
+		new_set_error (info, error);
+		new_step_done (info);
+		return;
+	}
+
+	g_value_init (&info->devices, DBUS_TYPE_G_ARRAY_OF_OBJECT_PATH);
+	g_value_take_boxed (&info->devices, devices);
+
+	for (i = 0; devices && i < devices->len; i++) {
+		const char *path = g_ptr_array_index (devices, i);
+
+		if (_nm_object_cache_peek (path))
+			continue;
+		info->pending++;
+		_nm_device_new_async (nm_object_get_connection (NM_OBJECT (info->client)),
+		                      path, new_child_created, info);
+	}
+
+	new_step_done (info);
+}
+
+static void
+new_get_permissions_cb (DBusGProxy *proxy, GHashTable *permissions, GError *error, gpointer user_data)
+{
+	NewInfo *info = user_data;
+
+	NM_CLIENT_GET_PRIVATE (info->client)->perm_call = NULL;
+	if (error) {
+		update_permissions (info->client, NULL);
+		new_set_error (info, error);
+	} else {
+		update_permissions (info->client, permissions);
+		g_hash_table_destroy (permissions);
+	}
+	new_step_done (info);
+}
+
+/**
+ * nm_client_new_async:
+ * @callback: (scope async): called when the client is ready
+ * @user_data: user data for @callback
+ *
+ * Creates a new #NMClient without blocking.  Whether NetworkManager is
+ * running, its state, permissions, devices and active connections are all
+ * requested at once, followed by the properties of every device and active
+ * connection, also in parallel.  @callback gets the new client, which it
+ * owns; after that the getters return the loaded values without calling
+ * NetworkManager.  The error passed to @callback, if any, only tells which
+ * part of the state couldn't be loaded; the client is usable regardless.
+ **/
+void
+nm_client_new_async (NMClientNewFn callback, gpointer user_data)
+{
+	DBusGConnection *connection;
+	NMClientPrivate *priv;
+	NewInfo *info;
+
+	info = g_slice_new0 (NewInfo);
+	info->callback = callback;
+	info->user_data = user_data;
+
+	connection = get_bus (&info->error);
+	if (!connection) {
+		g_idle_add (new_done, info);
+		return;
+	}
+
+	info->client = (NMClient *) g_object_new (NM_TYPE_CLIENT,
+	                                          NM_OBJECT_DBUS_CONNECTION, connection,
+	                                          NM_OBJECT_DBUS_PATH, NM_DBUS_PATH,
+	                                          NM_CLIENT_LOAD_ASYNC, TRUE,
+	                                          NULL);
+	priv = NM_CLIENT_GET_PRIVATE (info->client);
+
+	info->props_proxy = dbus_g_proxy_new_for_name (connection,
+	                                               NM_DBUS_SERVICE,
+	                                               NM_DBUS_PATH,
+	                                               "org.freedesktop.DBus.Properties");
+
+	info->pending = 4;
+	dbus_g_proxy_begin_call (priv->bus_proxy, "NameHasOwner",
+	                         new_name_has_owner_cb, info, NULL,
+	                         G_TYPE_STRING, NM_DBUS_SERVICE,
+	                         G_TYPE_INVALID);
+	dbus_g_proxy_begin_call (info->props_proxy, "GetAll",
+	                         new_get_all_cb, info, NULL,
+	                         G_TYPE_STRING, NM_DBUS_INTERFACE,
+	                         G_TYPE_INVALID);
+	org_freedesktop_NetworkManager_get_devices_async (priv->client_proxy,
+	                                                  new_get_devices_cb,
+	                                                  info);
+	priv->perm_call = org_freedesktop_NetworkManager_get_permissions_async (priv->client_proxy,
+	                                                                        new_get_permissions_cb,
+	                                                                        info);
+}
+
+static void
+init_sync (NMClient *client)
+{
+	NMClientPrivate *priv = NM_CLIENT_GET_PRIVATE (client);
+	GError *err = NULL;
+
+	get_permissions_sync (client);
+
+	if (!dbus_g_proxy_call (priv->bus_proxy,
+					    "NameHasOwner", &err,
+					    G_TYPE_STRING, NM_DBUS_SERVICE,
+					    G_TYPE_INVALID,
+					    G_TYPE_BOOLEAN, &priv->manager_running,
+					    G_TYPE_INVALID)) {
+		g_warning ("Error on NameHasOwner DBUS call: %s", err->message);
+		g_error_free (err);
+	}
+
+	if (priv->manager_running) {
+		update_wireless_status (client, FALSE);
+		update_wwan_status (client, FALSE);
+		update_wimax_status (client, FALSE);
+		nm_client_get_state (client);
+	}
+}
+
 static GObject*
 constructor (GType type,
 		   guint n_construct_params,
@@ -1347,7 +1745,6 @@ constructor (GType type,
 	NMObject *object;
 	DBusGConnection *connection;
 	NMClientPrivate *priv;
-	GError *err = NULL;
 
 	object = (NMObject *) G_OBJECT_CLASS (nm_client_parent_class)->constructor (type,
 																 n_construct_params,
@@ -1386,7 +1783,6 @@ constructor (GType type,
 	                             G_CALLBACK (client_recheck_permissions),
 	                             object,
 	                             NULL);
-	get_permissions_sync (NM_CLIENT (object));
 
 	priv->bus_proxy = dbus_g_proxy_new_for_name (connection,
 	                                             DBUS_SERVICE_DBUS,
@@ -1401,22 +1797,8 @@ constructor (GType type,
 						    G_CALLBACK (proxy_name_owner_changed),
 						    object, NULL);
 
-	if (!dbus_g_proxy_call (priv->bus_proxy,
-					    "NameHasOwner", &err,
-					    G_TYPE_STRING, NM_DBUS_SERVICE,
-					    G_TYPE_INVALID,
-					    G_TYPE_BOOLEAN, &priv->manager_running,
-					    G_TYPE_INVALID)) {
-		g_warning ("Error on NameHasOwner DBUS call: %s", err->message);
-		g_error_free (err);
-	}
-
-	if (priv->manager_running) {
-		update_wireless_status (NM_CLIENT (object), FALSE);
-		update_wwan_status (NM_CLIENT (object), FALSE);
-		update_wimax_status (NM_CLIENT (object), FALSE);
-		nm_client_get_state (NM_CLIENT (object));
-	}
+	if (!priv->load_async)
+		init_sync (NM_CLIENT (object));
 
 	g_signal_connect (G_OBJECT (object), "notify::" NM_CLIENT_WIRELESS_ENABLED,
 	                  G_CALLBACK (wireless_enabled_cb), NULL);
@@ -1500,6 +1882,9 @@ set_property (GObject *object, guint prop_id,
 			/* Let the property value flip when we get the change signal from NM */
 		}
 		break;
+	case PROP_LOAD_ASYNC:
+		priv->load_async = g_value_get_boolean (value);
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -1714,6 +2099,15 @@ nm_client_class_init (NMClientClass *client_class)
 						   NM_TYPE_OBJECT_ARRAY,
 						   G_PARAM_READABLE));
 
+	/* Lets nm_client_new_async() skip the blocking state load; not public */
+	g_object_class_install_property
+		(object_class, PROP_LOAD_ASYNC,
+		 g_param_spec_boolean (NM_CLIENT_LOAD_ASYNC,
+		                       "Load asynchronously",
+		                       "Whether the initial state is loaded by the caller",
+		                       FALSE,
+		                       G_PARAM_WRITABLE | G_PARAM_CONSTRUCT_ONLY));
+
 	/* signals */
 
 	/**
@@ -106,6 +106,12 @@ GType nm_client_get_type (void);
 
 NMClient *nm_client_new (void);
 
+typedef void (*NMClientNewFn) (NMClient *client,
+                               GError *error,
+                               gpointer user_data);
+
+void nm_client_new_async (NMClientNewFn callback, gpointer user_data);
+
 const GPtrArray *nm_client_get_devices    (NMClient *client);
 NMDevice *nm_client_get_device_by_path    (NMClient *client, const char *object_path);
 NMDevice *nm_client_get_device_by_iface   (NMClient *client, const char *iface);
@@ -100,7 +100,7 @@ nm_device_bt_get_hw_address (NMDeviceBt *device)
 	g_return_val_if_fail (NM_IS_DEVICE_BT (device), NULL);
 
 	priv = NM_DEVICE_BT_GET_PRIVATE (device);
-	if (!priv->hw_address) {
+	if (!priv->hw_address && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->hw_address = _nm_object_get_string_property (NM_OBJECT (device),
 		                                                   NM_DBUS_INTERFACE_DEVICE_BLUETOOTH,
 		                                                   DBUS_PROP_HW_ADDRESS,
@@ -126,7 +126,7 @@ nm_device_bt_get_name (NMDeviceBt *device)
 	g_return_val_if_fail (NM_IS_DEVICE_BT (device), NULL);
 
 	priv = NM_DEVICE_BT_GET_PRIVATE (device);
-	if (!priv->name) {
+	if (!priv->name && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->name = _nm_object_get_string_property (NM_OBJECT (device),
 		                                             NM_DBUS_INTERFACE_DEVICE_BLUETOOTH,
 		                                             DBUS_PROP_NAME,
@@ -152,7 +152,7 @@ nm_device_bt_get_capabilities (NMDeviceBt *device)
 	g_return_val_if_fail (NM_IS_DEVICE_BT (device), NM_BT_CAPABILITY_NONE);
 
 	priv = NM_DEVICE_BT_GET_PRIVATE (device);
-	if (!priv->bt_capabilities_valid) {
+	if (!priv->bt_capabilities_valid && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->bt_capabilities = _nm_object_get_uint_property (NM_OBJECT (device),
 		                                                      NM_DBUS_INTERFACE_DEVICE_BLUETOOTH,
 		                                                      DBUS_PROP_BT_CAPABILITIES,
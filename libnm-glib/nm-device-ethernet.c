@@ -104,7 +104,7 @@ nm_device_ethernet_get_hw_address (NMDeviceEthernet *device)
 	g_return_val_if_fail (NM_IS_DEVICE_ETHERNET (device), NULL);
 
 	priv = NM_DEVICE_ETHERNET_GET_PRIVATE (device);
-	if (!priv->hw_address) {
+	if (!priv->hw_address && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->hw_address = _nm_object_get_string_property (NM_OBJECT (device),
 		                                                  NM_DBUS_INTERFACE_DEVICE_WIRED,
 		                                                  DBUS_PROP_HW_ADDRESS,
@@ -131,7 +131,7 @@ nm_device_ethernet_get_permanent_hw_address (NMDeviceEthernet *device)
 	g_return_val_if_fail (NM_IS_DEVICE_ETHERNET (device), NULL);
 
 	priv = NM_DEVICE_ETHERNET_GET_PRIVATE (device);
-	if (!priv->perm_hw_address) {
+	if (!priv->perm_hw_address && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->perm_hw_address = _nm_object_get_string_property (NM_OBJECT (device),
 		                                                        NM_DBUS_INTERFACE_DEVICE_WIRED,
 		                                                        DBUS_PROP_PERM_HW_ADDRESS,
@@ -157,7 +157,7 @@ nm_device_ethernet_get_speed (NMDeviceEthernet *device)
 	g_return_val_if_fail (NM_IS_DEVICE_ETHERNET (device), 0);
 
 	priv = NM_DEVICE_ETHERNET_GET_PRIVATE (device);
-	if (!priv->speed) {
+	if (!priv->speed && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->speed = _nm_object_get_uint_property (NM_OBJECT (device),
 		                                           NM_DBUS_INTERFACE_DEVICE_WIRED,
 		                                           DBUS_PROP_SPEED,
@@ -183,7 +183,7 @@ nm_device_ethernet_get_carrier (NMDeviceEthernet *device)
 	g_return_val_if_fail (NM_IS_DEVICE_ETHERNET (device), FALSE);
 
 	priv = NM_DEVICE_ETHERNET_GET_PRIVATE (device);
-	if (!priv->carrier_valid) {
+	if (!priv->carrier_valid && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->carrier = _nm_object_get_boolean_property (NM_OBJECT (device),
 		                                                NM_DBUS_INTERFACE_DEVICE_WIRED,
 		                                                DBUS_PROP_CARRIER,
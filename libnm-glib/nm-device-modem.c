@@ -77,7 +77,7 @@ nm_device_modem_get_modem_capabilities (NMDeviceModem *self)
 	g_return_val_if_fail (NM_IS_DEVICE_MODEM (self), NM_DEVICE_MODEM_CAPABILITY_NONE);
 
 	priv = NM_DEVICE_MODEM_GET_PRIVATE (self);
-	if (!priv->caps) {
+	if (!priv->caps && !_nm_object_properties_loaded (NM_OBJECT (self))) {
 		priv->caps = _nm_object_get_uint_property (NM_OBJECT (self),
 		                                           NM_DBUS_INTERFACE_DEVICE_MODEM,
 		                                           DBUS_PROP_MODEM_CAPS,
@@ -107,7 +107,7 @@ nm_device_modem_get_current_capabilities (NMDeviceModem *self)
 	g_return_val_if_fail (NM_IS_DEVICE_MODEM (self), NM_DEVICE_MODEM_CAPABILITY_NONE);
 
 	priv = NM_DEVICE_MODEM_GET_PRIVATE (self);
-	if (!priv->current_caps) {
+	if (!priv->current_caps && !_nm_object_properties_loaded (NM_OBJECT (self))) {
 		priv->current_caps = _nm_object_get_uint_property (NM_OBJECT (self),
 		                                                   NM_DBUS_INTERFACE_DEVICE_MODEM,
 		                                                   DBUS_PROP_CURRENT_CAPS,
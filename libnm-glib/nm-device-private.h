@@ -24,6 +24,7 @@
 #define NM_DEVICE_PRIVATE_H
 
 #include <dbus/dbus-glib.h>
+#include "nm-object-private.h"
 
 DBusGConnection *nm_device_get_connection       (NMDevice *device);
 const char      *nm_device_get_path             (NMDevice *device);
@@ -33,4 +34,9 @@ DBusGProxy      *nm_device_get_properties_proxy (NMDevice *device);
 NMDeviceType     nm_device_type_for_path (DBusGConnection *connection,
 										  const char *path);
 
+void _nm_device_new_async (DBusGConnection *connection,
+                           const char *path,
+                           NMObjectCreatedFunc callback,
+                           gpointer user_data);
+
 #endif /* NM_DEVICE_PRIVATE_H */
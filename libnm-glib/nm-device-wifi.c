@@ -128,7 +128,7 @@ nm_device_wifi_get_hw_address (NMDeviceWifi *device)
 	g_return_val_if_fail (NM_IS_DEVICE_WIFI (device), NULL);
 
 	priv = NM_DEVICE_WIFI_GET_PRIVATE (device);
-	if (!priv->hw_address) {
+	if (!priv->hw_address && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->hw_address = _nm_object_get_string_property (NM_OBJECT (device),
 		                                                  NM_DBUS_INTERFACE_DEVICE_WIRELESS,
 		                                                  DBUS_PROP_HW_ADDRESS,
@@ -155,7 +155,7 @@ nm_device_wifi_get_permanent_hw_address (NMDeviceWifi *device)
 	g_return_val_if_fail (NM_IS_DEVICE_WIFI (device), NULL);
 
 	priv = NM_DEVICE_WIFI_GET_PRIVATE (device);
-	if (!priv->perm_hw_address) {
+	if (!priv->perm_hw_address && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->perm_hw_address = _nm_object_get_string_property (NM_OBJECT (device),
 		                                                        NM_DBUS_INTERFACE_DEVICE_WIRELESS,
 		                                                        DBUS_PROP_PERM_HW_ADDRESS,
@@ -181,7 +181,7 @@ nm_device_wifi_get_mode (NMDeviceWifi *device)
 	g_return_val_if_fail (NM_IS_DEVICE_WIFI (device), 0);
 
 	priv = NM_DEVICE_WIFI_GET_PRIVATE (device);
-	if (!priv->mode) {
+	if (!priv->mode && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->mode = _nm_object_get_uint_property (NM_OBJECT (device),
 		                                          NM_DBUS_INTERFACE_DEVICE_WIRELESS,
 		                                          DBUS_PROP_MODE,
@@ -220,7 +220,7 @@ nm_device_wifi_get_bitrate (NMDeviceWifi *device)
 	}
 
 	priv = NM_DEVICE_WIFI_GET_PRIVATE (device);
-	if (!priv->rate) {
+	if (!priv->rate && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->rate = _nm_object_get_uint_property (NM_OBJECT (device),
 		                                         NM_DBUS_INTERFACE_DEVICE_WIRELESS,
 		                                         DBUS_PROP_BITRATE,
@@ -246,7 +246,7 @@ nm_device_wifi_get_capabilities (NMDeviceWifi *device)
 	g_return_val_if_fail (NM_IS_DEVICE_WIFI (device), 0);
 
 	priv = NM_DEVICE_WIFI_GET_PRIVATE (device);
-	if (!priv->wireless_caps) {
+	if (!priv->wireless_caps && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->wireless_caps = _nm_object_get_uint_property (NM_OBJECT (device),
 		                                                   NM_DBUS_INTERFACE_DEVICE_WIRELESS,
 		                                                   DBUS_PROP_WIRELESS_CAPABILITIES,
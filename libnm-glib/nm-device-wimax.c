@@ -128,7 +128,7 @@ nm_device_wimax_get_hw_address (NMDeviceWimax *wimax)
 	g_return_val_if_fail (NM_IS_DEVICE_WIMAX (wimax), NULL);
 
 	priv = NM_DEVICE_WIMAX_GET_PRIVATE (wimax);
-	if (!priv->hw_address) {
+	if (!priv->hw_address && !_nm_object_properties_loaded (NM_OBJECT (wimax))) {
 		priv->hw_address = _nm_object_get_string_property (NM_OBJECT (wimax),
 		                                                   NM_DBUS_INTERFACE_DEVICE_WIMAX,
 		                                                   DBUS_PROP_HW_ADDRESS,
@@ -364,7 +364,7 @@ nm_device_wimax_get_center_frequency (NMDeviceWimax *self)
 	g_return_val_if_fail (NM_IS_DEVICE_WIMAX (self), 0);
 
 	priv = NM_DEVICE_WIMAX_GET_PRIVATE (self);
-	if (!priv->center_freq) {
+	if (!priv->center_freq && !_nm_object_properties_loaded (NM_OBJECT (self))) {
 		priv->center_freq = _nm_object_get_uint_property (NM_OBJECT (self),
 		                                                  NM_DBUS_INTERFACE_DEVICE_WIMAX,
 		                                                  DBUS_PROP_CENTER_FREQUENCY,
@@ -392,7 +392,7 @@ nm_device_wimax_get_rssi (NMDeviceWimax *self)
 	g_return_val_if_fail (NM_IS_DEVICE_WIMAX (self), 0);
 
 	priv = NM_DEVICE_WIMAX_GET_PRIVATE (self);
-	if (!priv->rssi) {
+	if (!priv->rssi && !_nm_object_properties_loaded (NM_OBJECT (self))) {
 		priv->rssi = _nm_object_get_int_property (NM_OBJECT (self),
 		                                          NM_DBUS_INTERFACE_DEVICE_WIMAX,
 		                                          DBUS_PROP_RSSI,
@@ -419,7 +419,7 @@ nm_device_wimax_get_cinr (NMDeviceWimax *self)
 	g_return_val_if_fail (NM_IS_DEVICE_WIMAX (self), 0);
 
 	priv = NM_DEVICE_WIMAX_GET_PRIVATE (self);
-	if (!priv->cinr) {
+	if (!priv->cinr && !_nm_object_properties_loaded (NM_OBJECT (self))) {
 		priv->cinr = _nm_object_get_int_property (NM_OBJECT (self),
 		                                          NM_DBUS_INTERFACE_DEVICE_WIMAX,
 		                                          DBUS_PROP_CINR,
@@ -446,7 +446,7 @@ nm_device_wimax_get_tx_power (NMDeviceWimax *self)
 	g_return_val_if_fail (NM_IS_DEVICE_WIMAX (self), 0);
 
 	priv = NM_DEVICE_WIMAX_GET_PRIVATE (self);
-	if (!priv->tx_power) {
+	if (!priv->tx_power && !_nm_object_properties_loaded (NM_OBJECT (self))) {
 		priv->tx_power = _nm_object_get_int_property (NM_OBJECT (self),
 		                                              NM_DBUS_INTERFACE_DEVICE_WIMAX,
 		                                              DBUS_PROP_TX_POWER,
@@ -471,7 +471,7 @@ nm_device_wimax_get_bsid (NMDeviceWimax *self)
 	g_return_val_if_fail (NM_IS_DEVICE_WIMAX (self), NULL);
 
 	priv = NM_DEVICE_WIMAX_GET_PRIVATE (self);
-	if (!priv->bsid) {
+	if (!priv->bsid && !_nm_object_properties_loaded (NM_OBJECT (self))) {
 		priv->bsid = _nm_object_get_string_property (NM_OBJECT (self),
 		                                             NM_DBUS_INTERFACE_DEVICE_WIMAX,
 		                                             DBUS_PROP_BSID,
@@ -309,6 +309,8 @@ register_for_property_changed (NMDevice *device)
 		{ NM_DEVICE_IP6_CONFIG,       demarshal_ip6_config,         &priv->ip6_config },
 		{ NM_DEVICE_DHCP6_CONFIG,     demarshal_dhcp6_config,       &priv->dhcp6_config },
 		{ NM_DEVICE_ACTIVE_CONNECTION,demarshal_active_connection,  &priv->active_connection },
+		/* Changes arrive as StateChanged; this is for the initial load */
+		{ NM_DEVICE_STATE,            _nm_object_demarshal_generic, &priv->state },
 		{ NULL },
 	};
 
@@ -752,6 +754,42 @@ nm_device_class_init (NMDeviceClass *device_class)
 				    G_TYPE_UINT, G_TYPE_UINT, G_TYPE_UINT);
 }
 
+static GType
+device_gtype_for_type (NMDeviceType dtype)
+{
+	switch (dtype) {
+	case NM_DEVICE_TYPE_ETHERNET:
+		return NM_TYPE_DEVICE_ETHERNET;
+	case NM_DEVICE_TYPE_WIFI:
+		return NM_TYPE_DEVICE_WIFI;
+	case NM_DEVICE_TYPE_MODEM:
+		return NM_TYPE_DEVICE_MODEM;
+	case NM_DEVICE_TYPE_BT:
+		return NM_TYPE_DEVICE_BT;
+	case NM_DEVICE_TYPE_WIMAX:
+		return NM_TYPE_DEVICE_WIMAX;
+	default:
+		g_warning ("Unknown device type %d", dtype);
+		return G_TYPE_INVALID;
+	}
+}
+
+static GObject *
+device_new_for_type (DBusGConnection *connection, const char *path, NMDeviceType dtype)
+{
+	GType gtype;
+
+	gtype = device_gtype_for_type (dtype);
+	if (gtype == G_TYPE_INVALID)
+		return NULL;
+
+	return g_object_new (gtype,
+	                     NM_OBJECT_DBUS_CONNECTION, connection,
+	                     NM_OBJECT_DBUS_PATH, path,
+	                     NM_DEVICE_DEVICE_TYPE, dtype,
+	                     NULL);
+}
+
 /**
  * nm_device_new:
  * @connection: the #DBusGConnection
@@ -767,9 +805,7 @@ nm_device_new (DBusGConnection *connection, const char *path)
 	DBusGProxy *proxy;
 	GError *err = NULL;
 	GValue value = {0,};
-	GType dtype = 0;
-	NMDevice *device = NULL;
-	NMDeviceType nm_dtype;
+	GObject *device = NULL;
 
 	g_return_val_if_fail (connection != NULL, NULL);
 	g_return_val_if_fail (path != NULL, NULL);
@@ -794,39 +830,82 @@ nm_device_new (DBusGConnection *connection, const char *path)
 		goto out;
 	}
 
-	nm_dtype = g_value_get_uint (&value);
-	switch (nm_dtype) {
-	case NM_DEVICE_TYPE_ETHERNET:
-		dtype = NM_TYPE_DEVICE_ETHERNET;
-		break;
-	case NM_DEVICE_TYPE_WIFI:
-		dtype = NM_TYPE_DEVICE_WIFI;
-		break;
-	case NM_DEVICE_TYPE_MODEM:
-		dtype = NM_TYPE_DEVICE_MODEM;
-		break;
-	case NM_DEVICE_TYPE_BT:
-		dtype = NM_TYPE_DEVICE_BT;
-		break;
-	case NM_DEVICE_TYPE_WIMAX:
-		dtype = NM_TYPE_DEVICE_WIMAX;
-		break;
-	default:
-		g_warning ("Unknown device type %d", g_value_get_uint (&value));
-		break;
-	}
+	device = device_new_for_type (connection, path, g_value_get_uint (&value));
+	g_value_unset (&value);
 
-	if (dtype) {
-		device = (NMDevice *) g_object_new (dtype,
-											NM_OBJECT_DBUS_CONNECTION, connection,
-											NM_OBJECT_DBUS_PATH, path,
-											NM_DEVICE_DEVICE_TYPE, nm_dtype,
-											NULL);
+out:
+	g_object_unref (proxy);
+	return device;
+}
+
+typedef struct {
+	DBusGConnection *connection;
+	char *path;
+	NMObjectCreatedFunc callback;
+	gpointer user_data;
+} NewAsyncInfo;
+
+static void
+new_async_got_type (DBusGProxy *proxy, DBusGProxyCall *call, gpointer user_data)
+{
+	NewAsyncInfo *info = user_data;
+	GError *error = NULL;
+	GValue value = {0,};
+	GObject *device = NULL;
+
+	if (dbus_g_proxy_end_call (proxy, call, &error,
+	                           G_TYPE_VALUE, &value, G_TYPE_INVALID)) {
+		/* Someone else may have created it while we were waiting */
+		device = (GObject *) _nm_object_cache_get (info->path);
+		if (!device)
+			device = device_new_for_type (info->connection, info->path, g_value_get_uint (&value));
+		g_value_unset (&value);
+	} else {
+		g_warning ("Error in get_property: %s\n", error->message);
+		g_error_free (error);
 	}
 
-out:
+	info->callback (device, info->user_data);
+
+	dbus_g_connection_unref (info->connection);
+	g_free (info->path);
+	g_slice_free (NewAsyncInfo, info);
 	g_object_unref (proxy);
-	return G_OBJECT (device);
+}
+
+/* Like nm_device_new(), but asks for the device type without blocking, so
+ * that many devices can be created at once.  @callback gets the new device,
+ * which it owns, or %NULL on failure.
+ */
+void
+_nm_device_new_async (DBusGConnection *connection,
+                      const char *path,
+                      NMObjectCreatedFunc callback,
+                      gpointer user_data)
+{
+	DBusGProxy *proxy;
+	NewAsyncInfo *info;
+
+	g_return_if_fail (connection != NULL);
+	g_return_if_fail (path != NULL);
+	g_return_if_fail (callback != NULL);
+
+	proxy = dbus_g_proxy_new_for_name (connection,
+	                                   NM_DBUS_SERVICE,
+	                                   path,
+	                                   "org.freedesktop.DBus.Properties");
+
+	info = g_slice_new0 (NewAsyncInfo);
+	info->connection = dbus_g_connection_ref (connection);
+	info->path = g_strdup (path);
+	info->callback = callback;
+	info->user_data = user_data;
+
+	dbus_g_proxy_begin_call (proxy, "Get",
+	                         new_async_got_type, info, NULL,
+	                         G_TYPE_STRING, NM_DBUS_INTERFACE_DEVICE,
+	                         G_TYPE_STRING, "DeviceType",
+	                         G_TYPE_INVALID);
 }
 
 /**
@@ -846,7 +925,7 @@ nm_device_get_iface (NMDevice *device)
 	g_return_val_if_fail (NM_IS_DEVICE (device), NULL);
 
 	priv = NM_DEVICE_GET_PRIVATE (device);
-	if (!priv->iface) {
+	if (!priv->iface && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->iface = _nm_object_get_string_property (NM_OBJECT (device),
 		                                             NM_DBUS_INTERFACE_DEVICE,
 		                                             "Interface",
@@ -874,7 +953,7 @@ nm_device_get_ip_iface (NMDevice *device)
 	g_return_val_if_fail (NM_IS_DEVICE (device), NULL);
 
 	priv = NM_DEVICE_GET_PRIVATE (device);
-	if (!priv->ip_iface) {
+	if (!priv->ip_iface && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->ip_iface = _nm_object_get_string_property (NM_OBJECT (device),
 		                                                 NM_DBUS_INTERFACE_DEVICE,
 		                                                 "IpInterface",
@@ -918,7 +997,7 @@ nm_device_get_udi (NMDevice *device)
 	g_return_val_if_fail (NM_IS_DEVICE (device), NULL);
 
 	priv = NM_DEVICE_GET_PRIVATE (device);
-	if (!priv->udi) {
+	if (!priv->udi && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->udi = _nm_object_get_string_property (NM_OBJECT (device),
 		                                           NM_DBUS_INTERFACE_DEVICE,
 		                                           "Udi",
@@ -945,7 +1024,7 @@ nm_device_get_driver (NMDevice *device)
 	g_return_val_if_fail (NM_IS_DEVICE (device), NULL);
 
 	priv = NM_DEVICE_GET_PRIVATE (device);
-	if (!priv->driver) {
+	if (!priv->driver && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->driver = _nm_object_get_string_property (NM_OBJECT (device),
 		                                              NM_DBUS_INTERFACE_DEVICE,
 		                                              "Driver",
@@ -971,7 +1050,7 @@ nm_device_get_capabilities (NMDevice *device)
 	g_return_val_if_fail (NM_IS_DEVICE (device), 0);
 
 	priv = NM_DEVICE_GET_PRIVATE (device);
-	if (!priv->capabilities) {
+	if (!priv->capabilities && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->capabilities = _nm_object_get_uint_property (NM_OBJECT (device),
 		                                                  NM_DBUS_INTERFACE_DEVICE,
 		                                                  "Capabilities",
@@ -997,7 +1076,7 @@ nm_device_get_managed (NMDevice *device)
 	g_return_val_if_fail (NM_IS_DEVICE (device), 0);
 
 	priv = NM_DEVICE_GET_PRIVATE (device);
-	if (!priv->managed) {
+	if (!priv->managed && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->managed = _nm_object_get_boolean_property (NM_OBJECT (device),
 		                                                NM_DBUS_INTERFACE_DEVICE,
 		                                                "Managed",
@@ -1025,7 +1104,7 @@ nm_device_get_firmware_missing (NMDevice *device)
 	g_return_val_if_fail (NM_IS_DEVICE (device), 0);
 
 	priv = NM_DEVICE_GET_PRIVATE (device);
-	if (!priv->firmware_missing) {
+	if (!priv->firmware_missing && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->firmware_missing = _nm_object_get_boolean_property (NM_OBJECT (device),
 		                                                          NM_DBUS_INTERFACE_DEVICE,
 		                                                          "FirmwareMissing",
@@ -1201,7 +1280,7 @@ nm_device_get_state (NMDevice *device)
 	g_return_val_if_fail (NM_IS_DEVICE (device), NM_DEVICE_STATE_UNKNOWN);
 
 	priv = NM_DEVICE_GET_PRIVATE (device);
-	if (priv->state == NM_DEVICE_STATE_UNKNOWN) {
+	if (priv->state == NM_DEVICE_STATE_UNKNOWN && !_nm_object_properties_loaded (NM_OBJECT (device))) {
 		priv->state = _nm_object_get_uint_property (NM_OBJECT (device), 
 		                                           NM_DBUS_INTERFACE_DEVICE,
 		                                           "State",
@@ -34,8 +34,6 @@ G_DEFINE_TYPE (NMDHCP4Config, nm_dhcp4_config, NM_TYPE_OBJECT)
 #define NM_DHCP4_CONFIG_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), NM_TYPE_DHCP4_CONFIG, NMDHCP4ConfigPrivate))
 
 typedef struct {
-	DBusGProxy *proxy;
-
 	GHashTable *options;
 } NMDHCP4ConfigPrivate;
 
@@ -85,9 +83,9 @@ register_for_property_changed (NMDHCP4Config *config)
 		{ NULL },
 	};
 
-	_nm_object_handle_properties_changed (NM_OBJECT (config),
-	                                     priv->proxy,
-	                                     property_changed_info);
+	_nm_object_register_properties (NM_OBJECT (config),
+	                                NM_DBUS_INTERFACE_DHCP4_CONFIG,
+	                                property_changed_info);
 }
 
 static GObject*
@@ -96,7 +94,6 @@ constructor (GType type,
 		   GObjectConstructParam *construct_params)
 {
 	NMObject *object;
-	DBusGConnection *connection;
 	NMDHCP4ConfigPrivate *priv;
 
 	object = (NMObject *) G_OBJECT_CLASS (nm_dhcp4_config_parent_class)->constructor (type,
@@ -108,13 +105,6 @@ constructor (GType type,
 	priv = NM_DHCP4_CONFIG_GET_PRIVATE (object);
 	priv->options = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 
-	connection = nm_object_get_connection (object);
-
-	priv->proxy = dbus_g_proxy_new_for_name (connection,
-										   NM_DBUS_SERVICE,
-										   nm_object_get_path (object),
-										   NM_DBUS_INTERFACE_DHCP4_CONFIG);
-
 	register_for_property_changed (NM_DHCP4_CONFIG (object));
 
 	return G_OBJECT (object);
@@ -128,8 +118,6 @@ finalize (GObject *object)
 	if (priv->options)
 		g_hash_table_destroy (priv->options);
 
-	g_object_unref (priv->proxy);
-
 	G_OBJECT_CLASS (nm_dhcp4_config_parent_class)->finalize (object);
 }
 
@@ -0,0 +1,835 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * libnm_glib -- Access network status & information from glib applications
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ */
+
+#include <string.h>
+#include <dbus/dbus.h>
+#include <dbus/dbus-glib-lowlevel.h>
+#include <NetworkManager.h>
+#include <NetworkManagerVPN.h>
+
+#include "nm-event-monitor.h"
+#include "nm-dbus-glib-types.h"
+
+/* The monitor receives every signal NetworkManager sends through a single
+ * match rule and a connection filter, instead of one DBusGProxy and match
+ * rule per object.  Signals are turned into NMEvents and queued; property
+ * changes of the same object that are still queued are coalesced, state
+ * change signals never are, so short transitions are not lost.  The queue
+ * is flushed from an idle handler, or after the coalesce interval.
+ */
+
+#define MATCH_RULE "type='signal',sender='" NM_DBUS_SERVICE "'"
+
+/* Number of delivered events kept for nm_event_monitor_replay() */
+#define HISTORY_LEN 256
+
+G_DEFINE_TYPE (NMEventMonitor, nm_event_monitor, G_TYPE_OBJECT)
+
+#define NM_EVENT_MONITOR_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), NM_TYPE_EVENT_MONITOR, NMEventMonitorPrivate))
+
+typedef struct {
+	DBusGConnection *bus;
+	gboolean filter_added;
+
+	guint32 types;
+	char *path;
+	guint coalesce_ms;
+
+	/* Access points and active connections of the object at 'path':
+	 * object path -> NMEventType
+	 */
+	GHashTable *related;
+	DBusGProxy *device_proxy;
+	DBusGProxy *props_proxy;
+
+	GQueue *queue;        /* NMEvents not delivered yet */
+	GHashTable *queued;   /* "path\nproperty" -> link in queue */
+	guint flush_id;
+
+	guint64 seq;
+	GQueue *history;      /* last HISTORY_LEN delivered NMEvents */
+
+	gboolean disposed;
+} NMEventMonitorPrivate;
+
+enum {
+	PROP_0,
+	PROP_BUS,
+
+	LAST_PROP
+};
+
+enum {
+	EVENT,
+
+	LAST_SIGNAL
+};
+static guint signals[LAST_SIGNAL] = { 0 };
+
+/**********************************************************************/
+
+static void
+event_free (NMEvent *event)
+{
+	g_free (event->path);
+	g_free (event->name);
+	if (G_IS_VALUE (&event->value))
+		g_value_unset (&event->value);
+	g_slice_free (NMEvent, event);
+}
+
+static NMEvent *
+event_new (NMEventType type, const char *path, const char *name, gboolean is_property)
+{
+	NMEvent *event;
+
+	event = g_slice_new0 (NMEvent);
+	event->type = type;
+	event->path = g_strdup (path);
+	event->name = g_strdup (name);
+	event->is_property = is_property;
+	return event;
+}
+
+static NMEventType
+event_type_for_interface (const char *iface)
+{
+	if (!strcmp (iface, NM_DBUS_INTERFACE))
+		return NM_EVENT_TYPE_MANAGER;
+	if (!strcmp (iface, NM_DBUS_INTERFACE_ACCESS_POINT))
+		return NM_EVENT_TYPE_ACCESS_POINT;
+	if (g_str_has_prefix (iface, NM_DBUS_INTERFACE_DEVICE))
+		return NM_EVENT_TYPE_DEVICE;
+	if (g_str_has_prefix (iface, NM_DBUS_IFACE_SETTINGS))
+		return NM_EVENT_TYPE_CONNECTION;
+	if (   !strcmp (iface, NM_DBUS_INTERFACE_ACTIVE_CONNECTION)
+	    || !strcmp (iface, NM_DBUS_INTERFACE_VPN_CONNECTION))
+		return NM_EVENT_TYPE_ACTIVE_CONNECTION;
+	return 0;
+}
+
+/* Converts basic D-Bus values, and arrays of strings or object paths, to
+ * a GValue; object paths become plain strings.
+ */
+static gboolean
+value_from_iter (DBusMessageIter *iter, GValue *value)
+{
+	DBusMessageIter sub;
+
+	switch (dbus_message_iter_get_arg_type (iter)) {
+	case DBUS_TYPE_VARIANT:
+		dbus_message_iter_recurse (iter, &sub);
+		return value_from_iter (&sub, value);
+	case DBUS_TYPE_BOOLEAN: {
+		dbus_bool_t b;
+
+		dbus_message_iter_get_basic (iter, &b);
+		g_value_init (value, G_TYPE_BOOLEAN);
+		g_value_set_boolean (value, b);
+		return TRUE;
+	}
+	case DBUS_TYPE_BYTE: {
+		guchar y;
+
+		dbus_message_iter_get_basic (iter, &y);
+		g_value_init (value, G_TYPE_UCHAR);
+		g_value_set_uchar (value, y);
+		return TRUE;
+	}
+	case DBUS_TYPE_INT16: {
+		gint16 n;
+
+		dbus_message_iter_get_basic (iter, &n);
+		g_value_init (value, G_TYPE_INT);
+		g_value_set_int (value, n);
+		return TRUE;
+	}
+	case DBUS_TYPE_UINT16: {
+		guint16 q;
+
+		dbus_message_iter_get_basic (iter, &q);
+		g_value_init (value, G_TYPE_UINT);
+		g_value_set_uint (value, q);
+		return TRUE;
+	}
+	case DBUS_TYPE_INT32: {
+		gint32 i;
+
+		dbus_message_iter_get_basic (iter, &i);
+		g_value_init (value, G_TYPE_INT);
+		g_value_set_int (value, i);
+		return TRUE;
+	}
+	case DBUS_TYPE_UINT32: {
+		guint32 u;
+
+		dbus_message_iter_get_basic (iter, &u);
+		g_value_init (value, G_TYPE_UINT);
+		g_value_set_uint (value, u);
+		return TRUE;
+	}
+	case DBUS_TYPE_INT64: {
+		gint64 x;
+
+		dbus_message_iter_get_basic (iter, &x);
+		g_value_init (value, G_TYPE_INT64);
+		g_value_set_int64 (value, x);
+		return TRUE;
+	}
+	case DBUS_TYPE_UINT64: {
+		guint64 t;
+
+		dbus_message_iter_get_basic (iter, &t);
+		g_value_init (value, G_TYPE_UINT64);
+		g_value_set_uint64 (value, t);
+		return TRUE;
+	}
+	case DBUS_TYPE_DOUBLE: {
+		double d;
+
+		dbus_message_iter_get_basic (iter, &d);
+		g_value_init (value, G_TYPE_DOUBLE);
+		g_value_set_double (value, d);
+		return TRUE;
+	}
+	case DBUS_TYPE_STRING:
+	case DBUS_TYPE_OBJECT_PATH: {
+		const char *s;
+
+		dbus_message_iter_get_basic (iter, &s);
+		g_value_init (value, G_TYPE_STRING);
+		g_value_set_string (value, s);
+		return TRUE;
+	}
+	case DBUS_TYPE_ARRAY: {
+		GPtrArray *strv;
+		int elem = dbus_message_iter_get_element_type (iter);
+
+		if (elem != DBUS_TYPE_STRING && elem != DBUS_TYPE_OBJECT_PATH)
+			return FALSE;
+
+		strv = g_ptr_array_new ();
+		dbus_message_iter_recurse (iter, &sub);
+		while (dbus_message_iter_get_arg_type (&sub) != DBUS_TYPE_INVALID) {
+			const char *s;
+
+			dbus_message_iter_get_basic (&sub, &s);
+			g_ptr_array_add (strv, g_strdup (s));
+			dbus_message_iter_next (&sub);
+		}
+		g_ptr_array_add (strv, NULL);
+
+		g_value_init (value, G_TYPE_STRV);
+		g_value_take_boxed (value, g_ptr_array_free (strv, FALSE));
+		return TRUE;
+	}
+	default:
+		return FALSE;
+	}
+}
+
+static void
+add_related (NMEventMonitorPrivate *priv, const char *path, NMEventType type)
+{
+	if (path && strcmp (path, "/"))
+		g_hash_table_insert (priv->related, g_strdup (path), GUINT_TO_POINTER (type));
+}
+
+static gboolean
+strv_contains (char **strv, const char *str)
+{
+	for (; strv && *strv; strv++) {
+		if (!strcmp (*strv, str))
+			return TRUE;
+	}
+	return FALSE;
+}
+
+/* Keeps track of the access points and active connections of the
+ * filtered object, as reported by the signals about them.
+ */
+static void
+track_related (NMEventMonitorPrivate *priv, NMEvent *event)
+{
+	const char *value = NULL;
+	char **strv = NULL;
+
+	if (!priv->path)
+		return;
+
+	if (G_VALUE_HOLDS_STRING (&event->value))
+		value = g_value_get_string (&event->value);
+	else if (G_VALUE_HOLDS (&event->value, G_TYPE_STRV))
+		strv = g_value_get_boxed (&event->value);
+
+	if (!strcmp (event->path, priv->path)) {
+		if (!strcmp (event->name, "AccessPointAdded") || !strcmp (event->name, "ActiveAccessPoint"))
+			add_related (priv, value, NM_EVENT_TYPE_ACCESS_POINT);
+		else if (!strcmp (event->name, "AccessPointRemoved") && value)
+			g_hash_table_remove (priv->related, value);
+		else if (!strcmp (event->name, "ActiveConnection"))
+			add_related (priv, value, NM_EVENT_TYPE_ACTIVE_CONNECTION);
+	} else if (event->is_property && !strcmp (event->name, "Devices")) {
+		/* Active connections list the devices they use */
+		if (strv_contains (strv, priv->path))
+			add_related (priv, event->path, NM_EVENT_TYPE_ACTIVE_CONNECTION);
+		else
+			g_hash_table_remove (priv->related, event->path);
+	} else if (event->is_property && !strcmp (event->name, "ActiveConnections")) {
+		GHashTableIter iter;
+		gpointer key, type;
+
+		/* Forget active connections that are gone */
+		g_hash_table_iter_init (&iter, priv->related);
+		while (g_hash_table_iter_next (&iter, &key, &type)) {
+			if (   GPOINTER_TO_UINT (type) == NM_EVENT_TYPE_ACTIVE_CONNECTION
+			    && !strv_contains (strv, key))
+				g_hash_table_iter_remove (&iter);
+		}
+	}
+}
+
+static gboolean
+event_matches (NMEventMonitorPrivate *priv, NMEvent *event)
+{
+	if (!(priv->types & event->type))
+		return FALSE;
+
+	if (priv->path) {
+		if (!strcmp (event->path, priv->path))
+			return TRUE;
+		if (g_hash_table_lookup (priv->related, event->path))
+			return TRUE;
+		/* Also match signals that are about the object, like DeviceRemoved */
+		if (   !event->is_property
+		    && G_VALUE_HOLDS_STRING (&event->value)
+		    && !g_strcmp0 (g_value_get_string (&event->value), priv->path))
+			return TRUE;
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static gboolean
+flush_cb (gpointer user_data)
+{
+	NMEventMonitor *self = NM_EVENT_MONITOR (user_data);
+	NMEventMonitorPrivate *priv = NM_EVENT_MONITOR_GET_PRIVATE (self);
+	NMEvent *event;
+
+	priv->flush_id = 0;
+	g_hash_table_remove_all (priv->queued);
+
+	g_object_ref (self);
+	while (!priv->disposed && (event = g_queue_pop_head (priv->queue))) {
+		event->seq = ++priv->seq;
+
+		g_queue_push_tail (priv->history, event);
+		if (g_queue_get_length (priv->history) > HISTORY_LEN)
+			event_free (g_queue_pop_head (priv->history));
+
+		g_signal_emit (self, signals[EVENT], 0, event);
+	}
+	g_object_unref (self);
+
+	return FALSE;
+}
+
+static void
+queue_event (NMEventMonitor *self, NMEvent *event)
+{
+	NMEventMonitorPrivate *priv = NM_EVENT_MONITOR_GET_PRIVATE (self);
+
+	track_related (priv, event);
+	if (!event_matches (priv, event)) {
+		event_free (event);
+		return;
+	}
+
+	if (event->is_property) {
+		char *key = g_strdup_printf ("%s\n%s", event->path, event->name);
+		GList *old;
+
+		/* Only the latest value is delivered, at the position of the
+		 * latest change so the stream stays ordered.
+		 */
+		old = g_hash_table_lookup (priv->queued, key);
+		if (old) {
+			event_free (old->data);
+			g_queue_delete_link (priv->queue, old);
+		}
+		g_queue_push_tail (priv->queue, event);
+		g_hash_table_insert (priv->queued, key, g_queue_peek_tail_link (priv->queue));
+	} else
+		g_queue_push_tail (priv->queue, event);
+
+	if (!priv->flush_id) {
+		if (priv->coalesce_ms)
+			priv->flush_id = g_timeout_add (priv->coalesce_ms, flush_cb, self);
+		else
+			priv->flush_id = g_idle_add (flush_cb, self);
+	}
+}
+
+static void
+handle_properties_changed (NMEventMonitor *self,
+                           NMEventType type,
+                           const char *path,
+                           DBusMessageIter *iter)
+{
+	DBusMessageIter array, entry;
+
+	if (dbus_message_iter_get_arg_type (iter) != DBUS_TYPE_ARRAY)
+		return;
+
+	dbus_message_iter_recurse (iter, &array);
+	while (dbus_message_iter_get_arg_type (&array) == DBUS_TYPE_DICT_ENTRY) {
+		const char *name;
+		NMEvent *event;
+
+		dbus_message_iter_recurse (&array, &entry);
+		dbus_message_iter_get_basic (&entry, &name);
+		dbus_message_iter_next (&entry);
+
+		event = event_new (type, path, name, TRUE);
+		value_from_iter (&entry, &event->value);
+		queue_event (self, event);
+
+		dbus_message_iter_next (&array);
+	}
+}
+
+static void
+handle_signal (NMEventMonitor *self,
+               NMEventType type,
+               const char *path,
+               const char *member,
+               DBusMessageIter *iter)
+{
+	NMEvent *event;
+	int nargs = 0;
+
+	/* Wireless devices report their access points */
+	if (   type == NM_EVENT_TYPE_DEVICE
+	    && (!strcmp (member, "AccessPointAdded") || !strcmp (member, "AccessPointRemoved")))
+		type = NM_EVENT_TYPE_ACCESS_POINT;
+
+	event = event_new (type, path, member, FALSE);
+
+	if (value_from_iter (iter, &event->value))
+		nargs++;
+
+	/* State changes end with the reason: StateChanged (new, old, reason) on
+	 * devices and VpnStateChanged (state, reason) on VPN connections.
+	 */
+	if (G_VALUE_HOLDS_UINT (&event->value)) {
+		while (dbus_message_iter_next (iter)) {
+			if (dbus_message_iter_get_arg_type (iter) != DBUS_TYPE_UINT32)
+				break;
+			dbus_message_iter_get_basic (iter, &event->reason);
+			nargs++;
+		}
+		if (nargs < 2)
+			event->reason = 0;
+	}
+
+	queue_event (self, event);
+}
+
+static DBusHandlerResult
+message_filter (DBusConnection *connection, DBusMessage *message, void *user_data)
+{
+	NMEventMonitor *self = NM_EVENT_MONITOR (user_data);
+	const char *iface, *path, *member;
+	NMEventType type;
+	DBusMessageIter iter;
+
+	if (dbus_message_get_type (message) != DBUS_MESSAGE_TYPE_SIGNAL)
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+	iface = dbus_message_get_interface (message);
+	path = dbus_message_get_path (message);
+	member = dbus_message_get_member (message);
+	if (!iface || !path || !member || !g_str_has_prefix (path, NM_DBUS_PATH))
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+	type = event_type_for_interface (iface);
+	if (!type)
+		return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+
+	dbus_message_iter_init (message, &iter);
+	if (!strcmp (member, "PropertiesChanged"))
+		handle_properties_changed (self, type, path, &iter);
+	else
+		handle_signal (self, type, path, member, &iter);
+
+	/* Other proxies on this connection may want the signal too */
+	return DBUS_HANDLER_RESULT_NOT_YET_HANDLED;
+}
+
+/**********************************************************************/
+
+/**
+ * nm_event_monitor_new:
+ * @bus: (allow-none): a valid and connected D-Bus connection, or %NULL
+ *   for the system bus
+ *
+ * Creates a monitor that reports the state, device, connection and access
+ * point changes of NetworkManager through its #NMEventMonitor::event signal.
+ *
+ * Returns: the new event monitor
+ **/
+NMEventMonitor *
+nm_event_monitor_new (DBusGConnection *bus)
+{
+	return (NMEventMonitor *) g_object_new (NM_TYPE_EVENT_MONITOR,
+	                                        NM_EVENT_MONITOR_BUS, bus,
+	                                        NULL);
+}
+
+static void
+get_access_points_cb (DBusGProxy *proxy, DBusGProxyCall *call, gpointer user_data)
+{
+	NMEventMonitorPrivate *priv = NM_EVENT_MONITOR_GET_PRIVATE (user_data);
+	GPtrArray *aps = NULL;
+	int i;
+
+	/* Fails for devices that are not wireless */
+	if (!dbus_g_proxy_end_call (proxy, call, NULL,
+	                            DBUS_TYPE_G_ARRAY_OF_OBJECT_PATH, &aps,
+	                            G_TYPE_INVALID))
+		return;
+
+	for (i = 0; i < aps->len; i++) {
+		add_related (priv, g_ptr_array_index (aps, i), NM_EVENT_TYPE_ACCESS_POINT);
+		g_free (g_ptr_array_index (aps, i));
+	}
+	g_ptr_array_free (aps, TRUE);
+}
+
+static void
+get_active_connection_cb (DBusGProxy *proxy, DBusGProxyCall *call, gpointer user_data)
+{
+	NMEventMonitorPrivate *priv = NM_EVENT_MONITOR_GET_PRIVATE (user_data);
+	GValue value = { 0, };
+
+	if (!dbus_g_proxy_end_call (proxy, call, NULL,
+	                            G_TYPE_VALUE, &value,
+	                            G_TYPE_INVALID))
+		return;
+
+	if (G_VALUE_HOLDS (&value, DBUS_TYPE_G_OBJECT_PATH))
+		add_related (priv, g_value_get_boxed (&value), NM_EVENT_TYPE_ACTIVE_CONNECTION);
+	g_value_unset (&value);
+}
+
+/* Asks for the access points and active connection the filtered object
+ * already has; later ones are picked up from the signals.
+ */
+static void
+load_related (NMEventMonitor *self)
+{
+	NMEventMonitorPrivate *priv = NM_EVENT_MONITOR_GET_PRIVATE (self);
+
+	/* Pending calls of the old filter are cancelled with their proxies */
+	if (priv->device_proxy) {
+		g_object_unref (priv->device_proxy);
+		priv->device_proxy = NULL;
+	}
+	if (priv->props_proxy) {
+		g_object_unref (priv->props_proxy);
+		priv->props_proxy = NULL;
+	}
+	g_hash_table_remove_all (priv->related);
+
+	if (!priv->path)
+		return;
+
+	priv->device_proxy = dbus_g_proxy_new_for_name (priv->bus,
+	                                                NM_DBUS_SERVICE,
+	                                                priv->path,
+	                                                NM_DBUS_INTERFACE_DEVICE_WIRELESS);
+	dbus_g_proxy_begin_call (priv->device_proxy, "GetAccessPoints",
+	                         get_access_points_cb, self, NULL,
+	                         G_TYPE_INVALID);
+
+	priv->props_proxy = dbus_g_proxy_new_for_name (priv->bus,
+	                                               NM_DBUS_SERVICE,
+	                                               priv->path,
+	                                               "org.freedesktop.DBus.Properties");
+	dbus_g_proxy_begin_call (priv->props_proxy, "Get",
+	                         get_active_connection_cb, self, NULL,
+	                         G_TYPE_STRING, NM_DBUS_INTERFACE_DEVICE,
+	                         G_TYPE_STRING, "ActiveConnection",
+	                         G_TYPE_INVALID);
+}
+
+/**
+ * nm_event_monitor_set_filter:
+ * @monitor: a #NMEventMonitor
+ * @types: mask of #NMEventType values to report
+ * @path: (allow-none): report only events about the object with this
+ *   D-Bus path, or %NULL for all objects
+ *
+ * Restricts which events are reported from now on.  Events that do not
+ * match are dropped and don't get a sequence number.  For a device @path,
+ * events about its access points and active connection are reported too.
+ **/
+void
+nm_event_monitor_set_filter (NMEventMonitor *monitor,
+                             guint32 types,
+                             const char *path)
+{
+	NMEventMonitorPrivate *priv;
+
+	g_return_if_fail (NM_IS_EVENT_MONITOR (monitor));
+
+	priv = NM_EVENT_MONITOR_GET_PRIVATE (monitor);
+	priv->types = types;
+	g_free (priv->path);
+	priv->path = g_strdup (path);
+	load_related (monitor);
+}
+
+/**
+ * nm_event_monitor_set_coalesce_interval:
+ * @monitor: a #NMEventMonitor
+ * @msec: how long to collect events before delivering them
+ *
+ * Property changes of an object that arrive within @msec of each other
+ * are delivered once, with the latest value.  With 0, the default, events
+ * are delivered as soon as the main loop is idle.
+ **/
+void
+nm_event_monitor_set_coalesce_interval (NMEventMonitor *monitor, guint msec)
+{
+	g_return_if_fail (NM_IS_EVENT_MONITOR (monitor));
+
+	NM_EVENT_MONITOR_GET_PRIVATE (monitor)->coalesce_ms = msec;
+}
+
+/**
+ * nm_event_monitor_get_last_seq:
+ * @monitor: a #NMEventMonitor
+ *
+ * Returns: the sequence number of the last event delivered, or 0
+ **/
+guint64
+nm_event_monitor_get_last_seq (NMEventMonitor *monitor)
+{
+	g_return_val_if_fail (NM_IS_EVENT_MONITOR (monitor), 0);
+
+	return NM_EVENT_MONITOR_GET_PRIVATE (monitor)->seq;
+}
+
+/**
+ * nm_event_monitor_replay:
+ * @monitor: a #NMEventMonitor
+ * @since: sequence number of the last event the caller has seen
+ *
+ * Emits #NMEventMonitor::event again for the events after @since that are
+ * still remembered, so a consumer can resume where it left off.
+ *
+ * Returns: %TRUE if all events after @since were replayed, %FALSE if some
+ * of them were already forgotten
+ **/
+gboolean
+nm_event_monitor_replay (NMEventMonitor *monitor, guint64 since)
+{
+	NMEventMonitorPrivate *priv;
+	NMEvent *oldest;
+	GList *iter;
+
+	g_return_val_if_fail (NM_IS_EVENT_MONITOR (monitor), FALSE);
+
+	priv = NM_EVENT_MONITOR_GET_PRIVATE (monitor);
+	if (since >= priv->seq)
+		return TRUE;
+
+	oldest = g_queue_peek_head (priv->history);
+	for (iter = priv->history->head; iter; iter = g_list_next (iter)) {
+		NMEvent *event = iter->data;
+
+		if (event->seq > since)
+			g_signal_emit (monitor, signals[EVENT], 0, event);
+	}
+
+	return oldest && oldest->seq <= since + 1;
+}
+
+static void
+nm_event_monitor_init (NMEventMonitor *self)
+{
+	NMEventMonitorPrivate *priv = NM_EVENT_MONITOR_GET_PRIVATE (self);
+
+	priv->types = NM_EVENT_TYPE_ALL;
+	priv->queue = g_queue_new ();
+	priv->queued = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	priv->history = g_queue_new ();
+	priv->related = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+}
+
+static GObject *
+constructor (GType type,
+             guint n_construct_params,
+             GObjectConstructParam *construct_params)
+{
+	GObject *object;
+	NMEventMonitorPrivate *priv;
+	DBusConnection *connection;
+
+	object = G_OBJECT_CLASS (nm_event_monitor_parent_class)->constructor (type, n_construct_params, construct_params);
+	if (!object)
+		return NULL;
+
+	priv = NM_EVENT_MONITOR_GET_PRIVATE (object);
+
+	connection = dbus_g_connection_get_connection (priv->bus);
+	if (!dbus_connection_add_filter (connection, message_filter, object, NULL)) {
+		g_warning ("%s: could not add D-Bus message filter", __func__);
+		return object;
+	}
+	priv->filter_added = TRUE;
+
+	/* No error argument, so the rule is added without blocking */
+	dbus_bus_add_match (connection, MATCH_RULE, NULL);
+
+	return object;
+}
+
+static void
+dispose (GObject *object)
+{
+	NMEventMonitorPrivate *priv = NM_EVENT_MONITOR_GET_PRIVATE (object);
+
+	if (priv->disposed) {
+		G_OBJECT_CLASS (nm_event_monitor_parent_class)->dispose (object);
+		return;
+	}
+	priv->disposed = TRUE;
+
+	if (priv->filter_added) {
+		DBusConnection *connection = dbus_g_connection_get_connection (priv->bus);
+
+		dbus_bus_remove_match (connection, MATCH_RULE, NULL);
+		dbus_connection_remove_filter (connection, message_filter, object);
+	}
+
+	if (priv->flush_id)
+		g_source_remove (priv->flush_id);
+
+	g_queue_foreach (priv->queue, (GFunc) event_free, NULL);
+	g_queue_free (priv->queue);
+	g_hash_table_destroy (priv->queued);
+	g_queue_foreach (priv->history, (GFunc) event_free, NULL);
+	g_queue_free (priv->history);
+	g_free (priv->path);
+	if (priv->device_proxy)
+		g_object_unref (priv->device_proxy);
+	if (priv->props_proxy)
+		g_object_unref (priv->props_proxy);
+	g_hash_table_destroy (priv->related);
+
+	dbus_g_connection_unref (priv->bus);
+
+	G_OBJECT_CLASS (nm_event_monitor_parent_class)->dispose (object);
+}
+
+static void
+set_property (GObject *object, guint prop_id,
+              const GValue *value, GParamSpec *pspec)
+{
+	NMEventMonitorPrivate *priv = NM_EVENT_MONITOR_GET_PRIVATE (object);
+	DBusGConnection *connection;
+
+	switch (prop_id) {
+	case PROP_BUS:
+		/* Construct only */
+		connection = (DBusGConnection *) g_value_get_boxed (value);
+		if (connection)
+			priv->bus = dbus_g_connection_ref (connection);
+		else {
+			/* Already a new reference */
+			priv->bus = dbus_g_bus_get (DBUS_BUS_SYSTEM, NULL);
+		}
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+		break;
+	}
+}
+
+static void
+get_property (GObject *object, guint prop_id,
+              GValue *value, GParamSpec *pspec)
+{
+	NMEventMonitorPrivate *priv = NM_EVENT_MONITOR_GET_PRIVATE (object);
+
+	switch (prop_id) {
+	case PROP_BUS:
+		g_value_set_boxed (value, priv->bus);
+		break;
+	default:
+		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+		break;
+	}
+}
+
+static void
+nm_event_monitor_class_init (NMEventMonitorClass *class)
+{
+	GObjectClass *object_class = G_OBJECT_CLASS (class);
+
+	g_type_class_add_private (class, sizeof (NMEventMonitorPrivate));
+
+	/* Virtual methods */
+	object_class->constructor = constructor;
+	object_class->set_property = set_property;
+	object_class->get_property = get_property;
+	object_class->dispose = dispose;
+
+	/* Properties */
+	g_object_class_install_property
+		(object_class, PROP_BUS,
+		 g_param_spec_boxed (NM_EVENT_MONITOR_BUS,
+		                     "DBusGConnection",
+		                     "DBusGConnection",
+		                     DBUS_TYPE_G_CONNECTION,
+		                     G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY));
+
+	/* Signals */
+	/**
+	 * NMEventMonitor::event:
+	 * @monitor: the event monitor
+	 * @event: (type gpointer): the #NMEvent; it is owned by the monitor
+	 *
+	 * Emitted for every event, in the order NetworkManager sent them.
+	 **/
+	signals[EVENT] =
+	                g_signal_new (NM_EVENT_MONITOR_EVENT,
+	                              G_OBJECT_CLASS_TYPE (object_class),
+	                              G_SIGNAL_RUN_FIRST,
+	                              G_STRUCT_OFFSET (NMEventMonitorClass, event),
+	                              NULL, NULL,
+	                              g_cclosure_marshal_VOID__POINTER,
+	                              G_TYPE_NONE, 1, G_TYPE_POINTER);
+}
@@ -0,0 +1,120 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * libnm_glib -- Access network status & information from glib applications
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ */
+
+#ifndef NM_EVENT_MONITOR_H
+#define NM_EVENT_MONITOR_H
+
+#include <glib.h>
+#include <glib-object.h>
+#include <dbus/dbus-glib.h>
+
+G_BEGIN_DECLS
+
+#define NM_TYPE_EVENT_MONITOR            (nm_event_monitor_get_type ())
+#define NM_EVENT_MONITOR(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), NM_TYPE_EVENT_MONITOR, NMEventMonitor))
+#define NM_EVENT_MONITOR_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), NM_TYPE_EVENT_MONITOR, NMEventMonitorClass))
+#define NM_IS_EVENT_MONITOR(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), NM_TYPE_EVENT_MONITOR))
+#define NM_IS_EVENT_MONITOR_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), NM_TYPE_EVENT_MONITOR))
+#define NM_EVENT_MONITOR_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), NM_TYPE_EVENT_MONITOR, NMEventMonitorClass))
+
+/**
+ * NMEventType:
+ * @NM_EVENT_TYPE_MANAGER: NetworkManager state and global properties
+ * @NM_EVENT_TYPE_DEVICE: devices added, removed or changed
+ * @NM_EVENT_TYPE_CONNECTION: saved connections added, updated or removed
+ * @NM_EVENT_TYPE_ACTIVE_CONNECTION: active and VPN connection changes
+ * @NM_EVENT_TYPE_ACCESS_POINT: access points added, removed or changed
+ * @NM_EVENT_TYPE_ALL: all of the above
+ *
+ * The kinds of events an #NMEventMonitor reports; used as a filter mask.
+ **/
+typedef enum {
+	NM_EVENT_TYPE_MANAGER           = 0x01,
+	NM_EVENT_TYPE_DEVICE            = 0x02,
+	NM_EVENT_TYPE_CONNECTION        = 0x04,
+	NM_EVENT_TYPE_ACTIVE_CONNECTION = 0x08,
+	NM_EVENT_TYPE_ACCESS_POINT      = 0x10,
+	NM_EVENT_TYPE_ALL               = 0x1F
+} NMEventType;
+
+/**
+ * NMEvent:
+ * @seq: sequence number; increases by one for every event the monitor
+ *   delivers
+ * @type: the kind of event
+ * @path: D-Bus object path of the object the event is about
+ * @name: the D-Bus signal name, or the property name for property changes
+ * @is_property: %TRUE if @name is a property and @value its new value
+ * @value: the new state or property value, or an unset #GValue if the
+ *   signal carries none or its type is not supported
+ * @reason: the state change reason for device state changes, otherwise 0
+ **/
+typedef struct {
+	guint64 seq;
+	NMEventType type;
+	char *path;
+	char *name;
+	gboolean is_property;
+	GValue value;
+	guint32 reason;
+} NMEvent;
+
+#define NM_EVENT_MONITOR_BUS "bus"
+
+#define NM_EVENT_MONITOR_EVENT "event"
+
+typedef struct {
+	GObject parent;
+} NMEventMonitor;
+
+typedef struct {
+	GObjectClass parent;
+
+	/* Signals */
+	void (*event) (NMEventMonitor *monitor, const NMEvent *event);
+
+	/* Padding for future expansion */
+	void (*_reserved1) (void);
+	void (*_reserved2) (void);
+	void (*_reserved3) (void);
+	void (*_reserved4) (void);
+} NMEventMonitorClass;
+
+GType nm_event_monitor_get_type (void);
+
+NMEventMonitor *nm_event_monitor_new (DBusGConnection *bus);
+
+void     nm_event_monitor_set_filter            (NMEventMonitor *monitor,
+                                                 guint32 types,
+                                                 const char *path);
+
+void     nm_event_monitor_set_coalesce_interval (NMEventMonitor *monitor,
+                                                 guint msec);
+
+guint64  nm_event_monitor_get_last_seq          (NMEventMonitor *monitor);
+
+gboolean nm_event_monitor_replay                (NMEventMonitor *monitor,
+                                                 guint64 since);
+
+G_END_DECLS
+
+#endif /* NM_EVENT_MONITOR_H */
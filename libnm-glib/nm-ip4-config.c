@@ -35,8 +35,6 @@ G_DEFINE_TYPE (NMIP4Config, nm_ip4_config, NM_TYPE_OBJECT)
 #define NM_IP4_CONFIG_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), NM_TYPE_IP4_CONFIG, NMIP4ConfigPrivate))
 
 typedef struct {
-	DBusGProxy *proxy;
-
 	GSList *addresses;
 	GArray *nameservers;
 	GPtrArray *domains;
@@ -127,9 +125,9 @@ register_for_property_changed (NMIP4Config *config)
 		{ NULL },
 	};
 
-	_nm_object_handle_properties_changed (NM_OBJECT (config),
-	                                     priv->proxy,
-	                                     property_changed_info);
+	_nm_object_register_properties (NM_OBJECT (config),
+	                                NM_DBUS_INTERFACE_IP4_CONFIG,
+	                                property_changed_info);
 }
 
 static GObject*
@@ -138,8 +136,6 @@ constructor (GType type,
 		   GObjectConstructParam *construct_params)
 {
 	NMObject *object;
-	DBusGConnection *connection;
-	NMIP4ConfigPrivate *priv;
 
 	object = (NMObject *) G_OBJECT_CLASS (nm_ip4_config_parent_class)->constructor (type,
 																 n_construct_params,
@@ -147,14 +143,6 @@ constructor (GType type,
 	if (!object)
 		return NULL;
 
-	priv = NM_IP4_CONFIG_GET_PRIVATE (object);
-	connection = nm_object_get_connection (object);
-
-	priv->proxy = dbus_g_proxy_new_for_name (connection,
-										   NM_DBUS_SERVICE,
-										   nm_object_get_path (object),
-										   NM_DBUS_INTERFACE_IP4_CONFIG);
-
 	register_for_property_changed (NM_IP4_CONFIG (object));
 
 	return G_OBJECT (object);
@@ -182,8 +170,6 @@ finalize (GObject *object)
 		g_ptr_array_free (priv->domains, TRUE);
 	}
 
-	g_object_unref (priv->proxy);
-
 	G_OBJECT_CLASS (nm_ip4_config_parent_class)->finalize (object);
 }
 
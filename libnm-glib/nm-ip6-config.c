@@ -35,8 +35,6 @@ G_DEFINE_TYPE (NMIP6Config, nm_ip6_config, NM_TYPE_OBJECT)
 #define NM_IP6_CONFIG_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), NM_TYPE_IP6_CONFIG, NMIP6ConfigPrivate))
 
 typedef struct {
-	DBusGProxy *proxy;
-
 	GSList *addresses;
 	GSList *nameservers;
 	GPtrArray *domains;
@@ -135,9 +133,9 @@ register_for_property_changed (NMIP6Config *config)
 		{ NULL },
 	};
 
-	_nm_object_handle_properties_changed (NM_OBJECT (config),
-	                                      priv->proxy,
-	                                      property_changed_info);
+	_nm_object_register_properties (NM_OBJECT (config),
+	                                NM_DBUS_INTERFACE_IP6_CONFIG,
+	                                property_changed_info);
 }
 
 /**
@@ -292,8 +290,6 @@ constructor (GType type,
              GObjectConstructParam *construct_params)
 {
 	GObject *object;
-	DBusGConnection *connection;
-	NMIP6ConfigPrivate *priv;
 
 	object = G_OBJECT_CLASS (nm_ip6_config_parent_class)->constructor (type,
 	                                                                   n_construct_params,
@@ -301,14 +297,6 @@ constructor (GType type,
 	if (!object)
 		return NULL;
 
-	priv = NM_IP6_CONFIG_GET_PRIVATE (object);
-	connection = nm_object_get_connection (NM_OBJECT (object));
-
-	priv->proxy = dbus_g_proxy_new_for_name (connection,
-	                                         NM_DBUS_SERVICE,
-	                                         nm_object_get_path (NM_OBJECT (object)),
-	                                         NM_DBUS_INTERFACE_IP6_CONFIG);
-
 	register_for_property_changed (NM_IP6_CONFIG (object));
 
 	return object;
@@ -333,8 +321,6 @@ finalize (GObject *object)
 		g_ptr_array_free (priv->domains, TRUE);
 	}
 
-	g_object_unref (priv->proxy);
-
 	G_OBJECT_CLASS (nm_ip6_config_parent_class)->finalize (object);
 }
 
@@ -17,7 +17,7 @@
  * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
  * Boston, MA 02110-1301 USA.
  *
- * Copyright (C) 2008 Red Hat, Inc.
+ * Copyright (C) 2008 - 2011 Red Hat, Inc.
  */
 
 #include <string.h>
@@ -25,13 +25,29 @@
 #include "nm-object-cache.h"
 #include "nm-object.h"
 
+/* Each entry carries a generation tag, used by _nm_object_array_demarshal()
+ * to tell which objects of an array are still listed without building a
+ * lookup table for every update.
+ */
+typedef struct {
+	NMObject *object;
+	guint32 generation;
+} CacheEntry;
+
 static GHashTable *cache = NULL;
+static guint32 last_generation = 0;
+
+static void
+cache_entry_free (CacheEntry *entry)
+{
+	g_slice_free (CacheEntry, entry);
+}
 
 static void
 _init_cache (void)
 {
 	if (G_UNLIKELY (cache == NULL))
-		cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+		cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) cache_entry_free);
 }
 
 void
@@ -51,11 +67,14 @@ _nm_object_cache_remove_by_object (NMObject *object)
 void
 _nm_object_cache_add (NMObject *object)
 {
+	CacheEntry *entry;
 	char *path;
 
 	_init_cache ();
 	path = g_strdup (nm_object_get_path (object));
-	g_hash_table_insert (cache, path, object);
+	entry = g_slice_new0 (CacheEntry);
+	entry->object = object;
+	g_hash_table_insert (cache, path, entry);
 	g_object_set_data_full (G_OBJECT (object), "nm-object-cache-tag",
 	                        path, (GDestroyNotify) _nm_object_cache_remove_by_path);
 }
@@ -63,10 +82,50 @@ _nm_object_cache_add (NMObject *object)
 NMObject *
 _nm_object_cache_get (const char *path)
 {
-	NMObject *object;
+	CacheEntry *entry;
+
+	_init_cache ();
+	entry = g_hash_table_lookup (cache, path);
+	return entry ? g_object_ref (entry->object) : NULL;
+}
+
+/* Returns the cached object without adding a reference */
+NMObject *
+_nm_object_cache_peek (const char *path)
+{
+	CacheEntry *entry;
 
 	_init_cache ();
-	object = g_hash_table_lookup (cache, path);
-	return object ? g_object_ref (object) : NULL;
+	entry = g_hash_table_lookup (cache, path);
+	return entry ? entry->object : NULL;
 }
 
+/* Returns a generation tag no object has been tagged with yet */
+guint32
+_nm_object_cache_new_generation (void)
+{
+	if (G_UNLIKELY (++last_generation == 0))
+		last_generation++;
+	return last_generation;
+}
+
+void
+_nm_object_cache_set_generation (NMObject *object, guint32 generation)
+{
+	CacheEntry *entry;
+
+	_init_cache ();
+	entry = g_hash_table_lookup (cache, nm_object_get_path (object));
+	if (entry && entry->object == object)
+		entry->generation = generation;
+}
+
+guint32
+_nm_object_cache_get_generation (NMObject *object)
+{
+	CacheEntry *entry;
+
+	_init_cache ();
+	entry = g_hash_table_lookup (cache, nm_object_get_path (object));
+	return (entry && entry->object == object) ? entry->generation : 0;
+}
@@ -17,7 +17,7 @@
  * Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
  * Boston, MA 02110-1301 USA.
  *
- * Copyright (C) 2008 Red Hat, Inc.
+ * Copyright (C) 2008 - 2011 Red Hat, Inc.
  */
 
 #ifndef NM_OBJECT_CACHE_H
@@ -35,6 +35,13 @@ void _nm_object_cache_add (NMObject *object);
 void _nm_object_cache_remove_by_object (NMObject *object);
 void _nm_object_cache_remove_by_path (const char *path);
 
+/* Returns the object from the cache without a reference */
+NMObject *_nm_object_cache_peek (const char *path);
+
+guint32 _nm_object_cache_new_generation (void);
+void _nm_object_cache_set_generation (NMObject *object, guint32 generation);
+guint32 _nm_object_cache_get_generation (NMObject *object);
+
 G_END_DECLS
 
 #endif /* NM_OBJECT_CACHE_H */
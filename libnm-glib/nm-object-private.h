@@ -29,6 +29,7 @@
 
 typedef gboolean (*PropChangedMarshalFunc) (NMObject *, GParamSpec *, GValue *, gpointer);
 typedef GObject * (*NMObjectCreatorFunc) (DBusGConnection *, const char *);
+typedef void (*NMObjectCreatedFunc) (GObject *object, gpointer user_data);
 
 typedef struct {
 	const char *name;
@@ -41,12 +42,24 @@ void _nm_object_handle_properties_changed (NMObject *object,
                                            DBusGProxy *proxy,
                                            const NMPropertiesChangedInfo *info);
 
+void _nm_object_register_properties (NMObject *object,
+                                     const char *interface,
+                                     const NMPropertiesChangedInfo *info);
+
+void _nm_object_ensure_inited (NMObject *object);
+
 void _nm_object_process_properties_changed (NMObject *self, GHashTable *properties);
 
+void _nm_object_process_properties (NMObject *self, GHashTable *properties);
+
 gboolean _nm_object_demarshal_generic (NMObject *object, GParamSpec *pspec, GValue *value, gpointer field);
 
 void _nm_object_queue_notify (NMObject *object, const char *property);
 
+gboolean _nm_object_properties_loaded (NMObject *object);
+
+void _nm_object_set_properties_loaded (NMObject *object, gboolean loaded);
+
 /* DBus property accessors */
 
 gboolean _nm_object_get_property (NMObject *object,
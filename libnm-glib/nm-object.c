@@ -45,6 +45,11 @@ typedef struct {
 	char *path;
 	DBusGProxy *properties_proxy;
 	GSList *pcs;
+	GSList *interfaces;   /* D-Bus interfaces with registered properties */
+	GSList *lazy_interfaces;  /* ... of which these have no proxy until inited */
+	GSList *lazy_proxies;
+	gboolean inited;
+	gboolean properties_loaded;
 	NMObject *parent;
 
 	GSList *notify_props;
@@ -87,11 +92,6 @@ constructor (GType type,
 		return NULL;
 	}
 
-	priv->properties_proxy = dbus_g_proxy_new_for_name (priv->connection,
-														NM_DBUS_SERVICE,
-														priv->path,
-														"org.freedesktop.DBus.Properties");
-
 	_nm_object_cache_add (NM_OBJECT (object));
 
 	return object;
@@ -117,7 +117,11 @@ dispose (GObject *object)
 	g_slist_foreach (priv->notify_props, (GFunc) g_free, NULL);
 	g_slist_free (priv->notify_props);
 
-	g_object_unref (priv->properties_proxy);
+	if (priv->properties_proxy)
+		g_object_unref (priv->properties_proxy);
+	g_slist_foreach (priv->lazy_proxies, (GFunc) g_object_unref, NULL);
+	g_slist_free (priv->lazy_proxies);
+	priv->lazy_proxies = NULL;
 	dbus_g_connection_unref (priv->connection);
 
 	G_OBJECT_CLASS (nm_object_parent_class)->dispose (object);
@@ -130,6 +134,10 @@ finalize (GObject *object)
 
 	g_slist_foreach (priv->pcs, (GFunc) g_hash_table_destroy, NULL);
 	g_slist_free (priv->pcs);
+	g_slist_foreach (priv->interfaces, (GFunc) g_free, NULL);
+	g_slist_free (priv->interfaces);
+	g_slist_foreach (priv->lazy_interfaces, (GFunc) g_free, NULL);
+	g_slist_free (priv->lazy_interfaces);
 	g_free (priv->path);
 
 	G_OBJECT_CLASS (nm_object_parent_class)->finalize (object);
@@ -396,28 +404,29 @@ properties_changed_proxy (DBusGProxy *proxy,
 	_nm_object_process_properties_changed (NM_OBJECT (user_data), properties);
 }
 
-void
-_nm_object_handle_properties_changed (NMObject *object,
-                                     DBusGProxy *proxy,
-                                     const NMPropertiesChangedInfo *info)
+static void
+connect_properties_changed (NMObject *object, DBusGProxy *proxy)
 {
-	NMObjectPrivate *priv = NM_OBJECT_GET_PRIVATE (object);
-	NMPropertiesChangedInfo *tmp;
-	GHashTable *instance;
-
-	g_return_if_fail (NM_IS_OBJECT (object));
-	g_return_if_fail (proxy != NULL);
-	g_return_if_fail (info != NULL);
-
 	dbus_g_proxy_add_signal (proxy, "PropertiesChanged", DBUS_TYPE_G_MAP_OF_VARIANT, G_TYPE_INVALID);
 	dbus_g_proxy_connect_signal (proxy,
 						    "PropertiesChanged",
 						    G_CALLBACK (properties_changed_proxy),
 						    object,
 						    NULL);
+}
+
+static void
+register_properties (NMObject *object,
+                     const char *interface,
+                     const NMPropertiesChangedInfo *info)
+{
+	NMObjectPrivate *priv = NM_OBJECT_GET_PRIVATE (object);
+	NMPropertiesChangedInfo *tmp;
+	GHashTable *instance;
 
 	instance = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
 	priv->pcs = g_slist_prepend (priv->pcs, instance);
+	priv->interfaces = g_slist_prepend (priv->interfaces, g_strdup (interface));
 
 	for (tmp = (NMPropertiesChangedInfo *) info; tmp->name; tmp++) {
 		PropChangedInfo *pci;
@@ -438,6 +447,242 @@ _nm_object_handle_properties_changed (NMObject *object,
 	}
 }
 
+void
+_nm_object_handle_properties_changed (NMObject *object,
+                                     DBusGProxy *proxy,
+                                     const NMPropertiesChangedInfo *info)
+{
+	g_return_if_fail (NM_IS_OBJECT (object));
+	g_return_if_fail (proxy != NULL);
+	g_return_if_fail (info != NULL);
+
+	connect_properties_changed (object, proxy);
+	register_properties (object, dbus_g_proxy_get_interface (proxy), info);
+}
+
+/* Like _nm_object_handle_properties_changed(), but for objects that are
+ * only watched: the proxy for @interface and its PropertiesChanged match
+ * are not created until the object is first used, see
+ * _nm_object_ensure_inited().  Objects that are only listed in some array
+ * property, like the access points of a device, never pay for them.
+ */
+void
+_nm_object_register_properties (NMObject *object,
+                                const char *interface,
+                                const NMPropertiesChangedInfo *info)
+{
+	NMObjectPrivate *priv;
+
+	g_return_if_fail (NM_IS_OBJECT (object));
+	g_return_if_fail (interface != NULL);
+	g_return_if_fail (info != NULL);
+
+	priv = NM_OBJECT_GET_PRIVATE (object);
+	register_properties (object, interface, info);
+	priv->lazy_interfaces = g_slist_prepend (priv->lazy_interfaces, g_strdup (interface));
+
+	if (priv->inited) {
+		priv->inited = FALSE;
+		_nm_object_ensure_inited (object);
+	}
+}
+
+static DBusGProxy *
+get_properties_proxy (NMObject *object)
+{
+	NMObjectPrivate *priv = NM_OBJECT_GET_PRIVATE (object);
+
+	if (!priv->properties_proxy) {
+		priv->properties_proxy = dbus_g_proxy_new_for_name (priv->connection,
+		                                                    NM_DBUS_SERVICE,
+		                                                    priv->path,
+		                                                    "org.freedesktop.DBus.Properties");
+	}
+	return priv->properties_proxy;
+}
+
+/* Creates the proxies of interfaces registered with
+ * _nm_object_register_properties(), so that property values read from now
+ * on are kept up-to-date.  Called before any property is read over D-Bus.
+ */
+void
+_nm_object_ensure_inited (NMObject *object)
+{
+	NMObjectPrivate *priv;
+	GSList *iter;
+
+	g_return_if_fail (NM_IS_OBJECT (object));
+
+	priv = NM_OBJECT_GET_PRIVATE (object);
+	if (priv->inited || priv->disposed)
+		return;
+	priv->inited = TRUE;
+
+	for (iter = priv->lazy_interfaces; iter; iter = g_slist_next (iter)) {
+		const char *interface = iter->data;
+		GSList *piter;
+		DBusGProxy *proxy;
+		gboolean found = FALSE;
+
+		/* Don't connect twice when more interfaces are registered later */
+		for (piter = priv->lazy_proxies; piter; piter = g_slist_next (piter)) {
+			if (!strcmp (dbus_g_proxy_get_interface (piter->data), interface)) {
+				found = TRUE;
+				break;
+			}
+		}
+		if (found)
+			continue;
+
+		proxy = dbus_g_proxy_new_for_name (priv->connection,
+		                                   NM_DBUS_SERVICE,
+		                                   priv->path,
+		                                   interface);
+		connect_properties_changed (object, proxy);
+		priv->lazy_proxies = g_slist_prepend (priv->lazy_proxies, proxy);
+	}
+}
+
+typedef struct {
+	NMObject *object;
+	NMObjectLoadFunc callback;
+	gpointer user_data;
+	guint pending;
+	GError *error;
+} LoadInfo;
+
+static gboolean
+load_done (gpointer user_data)
+{
+	LoadInfo *info = user_data;
+
+	if (!info->error)
+		NM_OBJECT_GET_PRIVATE (info->object)->properties_loaded = TRUE;
+
+	if (info->callback)
+		info->callback (info->object, info->error, info->user_data);
+
+	g_clear_error (&info->error);
+	g_object_unref (info->object);
+	g_slice_free (LoadInfo, info);
+	return FALSE;
+}
+
+static void
+load_property (gpointer key, gpointer data, gpointer user_data)
+{
+	NMObject *self = NM_OBJECT (user_data);
+	char *prop_name;
+
+	/* GetAll returns everything the daemon knows; quietly skip properties
+	 * this object type doesn't implement.
+	 */
+	prop_name = wincaps_to_dash ((char *) key);
+	if (g_object_class_find_property (G_OBJECT_GET_CLASS (self), prop_name))
+		handle_property_changed (key, data, self);
+	g_free (prop_name);
+}
+
+/* Applies the result of a GetAll call made outside of
+ * nm_object_load_properties().
+ */
+void
+_nm_object_process_properties (NMObject *self, GHashTable *properties)
+{
+	g_hash_table_foreach (properties, load_property, self);
+}
+
+static void
+load_get_all_cb (DBusGProxy *proxy,
+                 DBusGProxyCall *call,
+                 gpointer user_data)
+{
+	LoadInfo *info = user_data;
+	GHashTable *props = NULL;
+	GError *error = NULL;
+
+	if (dbus_g_proxy_end_call (proxy, call, &error,
+	                           DBUS_TYPE_G_MAP_OF_VARIANT, &props,
+	                           G_TYPE_INVALID)) {
+		_nm_object_process_properties (info->object, props);
+		g_hash_table_destroy (props);
+	} else if (!info->error)
+		info->error = error;
+	else
+		g_error_free (error);
+
+	if (--info->pending == 0)
+		load_done (info);
+}
+
+/**
+ * nm_object_load_properties:
+ * @object: a #NMObject
+ * @callback: (allow-none): called when all properties have been loaded
+ * @user_data: user data for @callback
+ *
+ * Asynchronously fetches all properties of @object with a single D-Bus call
+ * per interface.  Calls for many objects can be in flight at once; once an
+ * object's properties are loaded its getters don't block on D-Bus anymore.
+ **/
+void
+nm_object_load_properties (NMObject *object,
+                           NMObjectLoadFunc callback,
+                           gpointer user_data)
+{
+	NMObjectPrivate *priv;
+	LoadInfo *info;
+	GSList *iter;
+
+	g_return_if_fail (NM_IS_OBJECT (object));
+
+	priv = NM_OBJECT_GET_PRIVATE (object);
+	_nm_object_ensure_inited (object);
+
+	info = g_slice_new0 (LoadInfo);
+	info->object = g_object_ref (object);
+	info->callback = callback;
+	info->user_data = user_data;
+
+	if (!priv->interfaces) {
+		g_idle_add (load_done, info);
+		return;
+	}
+
+	for (iter = priv->interfaces; iter; iter = g_slist_next (iter)) {
+		info->pending++;
+		dbus_g_proxy_begin_call (get_properties_proxy (object), "GetAll",
+		                         load_get_all_cb,
+		                         info,
+		                         NULL,
+		                         G_TYPE_STRING, iter->data,
+		                         G_TYPE_INVALID);
+	}
+}
+
+/* Returns TRUE once nm_object_load_properties() has fetched all properties;
+ * after that they are kept up-to-date by PropertiesChanged signals, so a
+ * zero value is real and need not be fetched again.
+ */
+gboolean
+_nm_object_properties_loaded (NMObject *object)
+{
+	g_return_val_if_fail (NM_IS_OBJECT (object), FALSE);
+
+	return NM_OBJECT_GET_PRIVATE (object)->properties_loaded;
+}
+
+/* For objects whose properties were loaded by a GetAll call made outside
+ * of nm_object_load_properties(), or that have to be fetched again.
+ */
+void
+_nm_object_set_properties_loaded (NMObject *object, gboolean loaded)
+{
+	g_return_if_fail (NM_IS_OBJECT (object));
+
+	NM_OBJECT_GET_PRIVATE (object)->properties_loaded = loaded;
+}
+
 #define HANDLE_TYPE(ucase, lcase) \
 	} else if (pspec->value_type == G_TYPE_##ucase) { \
 		if (G_VALUE_HOLDS_##ucase (value)) { \
@@ -517,7 +762,9 @@ _nm_object_get_property (NMObject *object,
 	g_return_val_if_fail (value != NULL, FALSE);
 	g_return_val_if_fail (error == NULL || *error == NULL, FALSE);
 
-	if (!dbus_g_proxy_call_with_timeout (NM_OBJECT_GET_PRIVATE (object)->properties_proxy,
+	_nm_object_ensure_inited (object);
+
+	if (!dbus_g_proxy_call_with_timeout (get_properties_proxy (object),
 							"Get", 15000, &err,
 							G_TYPE_STRING, interface,
 							G_TYPE_STRING, prop_name,
@@ -555,7 +802,7 @@ _nm_object_set_property (NMObject *object,
 	g_return_if_fail (prop_name != NULL);
 	g_return_if_fail (G_IS_VALUE (value));
 
-	if (!dbus_g_proxy_call_with_timeout (NM_OBJECT_GET_PRIVATE (object)->properties_proxy,
+	if (!dbus_g_proxy_call_with_timeout (get_properties_proxy (object),
 	                                     "Set", 2000, NULL,
 	                                     G_TYPE_STRING, interface,
 	                                     G_TYPE_STRING, prop_name,
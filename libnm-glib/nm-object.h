@@ -61,6 +61,12 @@ GType nm_object_get_type (void);
 DBusGConnection *nm_object_get_connection (NMObject *object);
 const char      *nm_object_get_path       (NMObject *object);
 
+typedef void (*NMObjectLoadFunc) (NMObject *object, GError *error, gpointer user_data);
+
+void nm_object_load_properties (NMObject *object,
+                                NMObjectLoadFunc callback,
+                                gpointer user_data);
+
 G_END_DECLS
 
 #endif /* NM_OBJECT_H */
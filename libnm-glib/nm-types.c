@@ -230,48 +230,73 @@ nm_object_array_get_type (void)
 	return our_type;
 }
 
+/* Updates *dest in place: objects no longer listed are dropped and newly
+ * listed ones appended, while the objects that stay keep their position.
+ * Membership is tracked with the object cache's generation tags.  New
+ * objects are cheap to create, since objects like access points don't set
+ * up their D-Bus proxies until first used.
+ */
 gboolean
 _nm_object_array_demarshal (GValue *value,
                            GPtrArray **dest,
                            DBusGConnection *connection,
                            NMObjectCreatorFunc func)
 {
-	GPtrArray *temp = NULL;
 	GPtrArray *array;
+	GSList *missing = NULL, *iter;
+	guint32 old_gen, new_gen;
+	int i;
 
 	if (!G_VALUE_HOLDS (value, DBUS_TYPE_G_ARRAY_OF_OBJECT_PATH))
 		return FALSE;
 
+	if (!*dest)
+		*dest = g_ptr_array_new ();
+
+	old_gen = _nm_object_cache_new_generation ();
+	new_gen = _nm_object_cache_new_generation ();
+
+	for (i = 0; i < (*dest)->len; i++)
+		_nm_object_cache_set_generation (g_ptr_array_index (*dest, i), old_gen);
+
+	/* Tag the objects that stay; remember the paths that are new */
 	array = (GPtrArray *) g_value_get_boxed (value);
-	if (array && array->len) {
-		int i;
+	for (i = 0; array && i < array->len; i++) {
+		const char *path = g_ptr_array_index (array, i);
+		NMObject *object;
+
+		object = _nm_object_cache_peek (path);
+		if (object && _nm_object_cache_get_generation (object) == old_gen)
+			_nm_object_cache_set_generation (object, new_gen);
+		else if (!object || _nm_object_cache_get_generation (object) != new_gen)
+			missing = g_slist_prepend (missing, (gpointer) path);
+	}
 
-		temp = g_ptr_array_sized_new (array->len);
-		for (i = 0; i < array->len; i++) {
-			const char *path;
-			GObject *object;
-
-			path = g_ptr_array_index (array, i);
-			object = G_OBJECT (_nm_object_cache_get (path));
-			if (object)
-				g_ptr_array_add (temp, object);
-			else {
-				object = (*func) (connection, path);
-				if (object)
-					g_ptr_array_add (temp, object);
-				else
-					g_warning ("%s: couldn't create object for %s", __func__, path);
-			}
+	/* Drop the objects that weren't tagged */
+	for (i = (int) (*dest)->len - 1; i >= 0; i--) {
+		NMObject *object = g_ptr_array_index (*dest, i);
+
+		if (_nm_object_cache_get_generation (object) != new_gen) {
+			g_ptr_array_remove_index (*dest, i);
+			g_object_unref (object);
 		}
-	} else
-		temp = g_ptr_array_new ();
-
-	/* Deallocate after to ensure that an object that might already
-	 * be in the array doesn't get destroyed due to refcounting.
-	 */
-	if (*dest)
-		g_boxed_free (NM_TYPE_OBJECT_ARRAY, *dest);
-	*dest = temp;
+	}
+
+	/* Objects are created only now; creating one may update other arrays */
+	missing = g_slist_reverse (missing);
+	for (iter = missing; iter; iter = g_slist_next (iter)) {
+		const char *path = iter->data;
+		GObject *object;
+
+		object = G_OBJECT (_nm_object_cache_get (path));
+		if (!object)
+			object = (*func) (connection, path);
+		if (object)
+			g_ptr_array_add (*dest, object);
+		else
+			g_warning ("%s: couldn't create object for %s", __func__, path);
+	}
+	g_slist_free (missing);
 
 	return TRUE;
 }
@@ -37,9 +37,6 @@ G_DEFINE_TYPE (NMWimaxNsp, nm_wimax_nsp, NM_TYPE_OBJECT)
 #define NM_WIMAX_NSP_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), NM_TYPE_WIMAX_NSP, NMWimaxNspPrivate))
 
 typedef struct {
-	gboolean disposed;
-	DBusGProxy *proxy;
-
 	char *name;
 	guint32 signal_quality;
 	NMWimaxNspNetworkType network_type;
@@ -238,23 +235,6 @@ nm_wimax_nsp_init (NMWimaxNsp *nsp)
 {
 }
 
-static void
-dispose (GObject *object)
-{
-	NMWimaxNspPrivate *priv = NM_WIMAX_NSP_GET_PRIVATE (object);
-
-	if (priv->disposed) {
-		G_OBJECT_CLASS (nm_wimax_nsp_parent_class)->dispose (object);
-		return;
-	}
-
-	priv->disposed = TRUE;
-
-	g_object_unref (priv->proxy);
-
-	G_OBJECT_CLASS (nm_wimax_nsp_parent_class)->dispose (object);
-}
-
 static void
 finalize (GObject *object)
 {
@@ -298,9 +278,9 @@ register_for_property_changed (NMWimaxNsp *nsp)
 		{ NULL },
 	};
 
-	_nm_object_handle_properties_changed (NM_OBJECT (nsp),
-										  priv->proxy,
-										  property_changed_info);
+	_nm_object_register_properties (NM_OBJECT (nsp),
+	                                NM_DBUS_INTERFACE_WIMAX_NSP,
+	                                property_changed_info);
 }
 
 static GObject*
@@ -309,7 +289,6 @@ constructor (GType type,
 			 GObjectConstructParam *construct_params)
 {
 	NMObject *object;
-	NMWimaxNspPrivate *priv;
 
 	object = (NMObject *) G_OBJECT_CLASS (nm_wimax_nsp_parent_class)->constructor (type,
 																				   n_construct_params,
@@ -317,13 +296,6 @@ constructor (GType type,
 	if (!object)
 		return NULL;
 
-	priv = NM_WIMAX_NSP_GET_PRIVATE (object);
-
-	priv->proxy = dbus_g_proxy_new_for_name (nm_object_get_connection (object),
-											 NM_DBUS_SERVICE,
-											 nm_object_get_path (object),
-											 NM_DBUS_INTERFACE_WIMAX_NSP);
-
 	register_for_property_changed (NM_WIMAX_NSP (object));
 
 	return G_OBJECT (object);
@@ -340,7 +312,6 @@ nm_wimax_nsp_class_init (NMWimaxNspClass *nsp_class)
 	/* virtual methods */
 	object_class->constructor = constructor;
 	object_class->get_property = get_property;
-	object_class->dispose = dispose;
 	object_class->finalize = finalize;
 
 	/* properties */
@@ -71,6 +71,8 @@ gboolean crypto_init (GError **error);
 
 void crypto_deinit (void);
 
+void crypto_clear_caches (void);
+
 GByteArray *crypto_decrypt_private_key_data (const GByteArray *contents,
                                              const char *password,
                                              NMCryptoKeyType *out_key_type,
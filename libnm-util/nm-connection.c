@@ -108,8 +108,14 @@ nm_connection_error_get_type (void)
 	return etype;
 }
 
+#define DEFAULT_MAP_SIZE 17
+
 typedef struct {
-	GHashTable *settings;
+	/* Settings of the default types, indexed by their slot in default_map */
+	NMSetting *settings[DEFAULT_MAP_SIZE];
+
+	/* Any other NMSetting subclass; GType -> NMSetting, created on demand */
+	GHashTable *other_settings;
 
 	/* D-Bus path of the connection, if any */
 	char *path;
@@ -129,15 +135,15 @@ enum {
 enum {
 	SECRETS_UPDATED,
 	SECRETS_CLEARED,
+	CHANGED,
 	LAST_SIGNAL
 };
 
 static guint signals[LAST_SIGNAL] = { 0 };
 
+/* setting name -> GType */
 static GHashTable *registered_settings = NULL;
 
-#define DEFAULT_MAP_SIZE 17
-
 static struct SettingInfo {
 	const char *name;
 	GType type;
@@ -146,6 +152,11 @@ static struct SettingInfo {
 	GQuark error_quark;
 } default_map[DEFAULT_MAP_SIZE] = { { NULL } };
 
+/* Same order as default_map, kept separate so the slot lookup done by
+ * nm_connection_get_setting() only touches a few cache lines.
+ */
+static GType default_types[DEFAULT_MAP_SIZE] = { 0 };
+
 static void
 setting_register (const char *name, GType type)
 {
@@ -153,15 +164,15 @@ setting_register (const char *name, GType type)
 	g_return_if_fail (G_TYPE_IS_INSTANTIATABLE (type));
 
 	if (G_UNLIKELY (!registered_settings)) {
-		registered_settings = g_hash_table_new_full (g_str_hash, g_str_equal, 
+		registered_settings = g_hash_table_new_full (g_str_hash, g_str_equal,
 		                                             (GDestroyNotify) g_free,
-		                                             (GDestroyNotify) g_free);
+		                                             NULL);
 	}
 
 	if (g_hash_table_lookup (registered_settings, name))
 		g_warning ("Already have a creator function for '%s', overriding", name);
 
-	g_hash_table_insert (registered_settings, g_strdup (name), g_strdup (g_type_name (type)));
+	g_hash_table_insert (registered_settings, g_strdup (name), GSIZE_TO_POINTER (type));
 }
 
 #if 0
@@ -184,12 +195,15 @@ register_one_setting (const char *name,
 
 	g_return_if_fail (i < DEFAULT_MAP_SIZE);
 	g_return_if_fail (default_map[i].name == NULL);
+	/* nm_connection_need_secrets() walks the slots in priority order */
+	g_return_if_fail (i == 0 || default_map[i - 1].priority <= priority);
 
 	default_map[i].name = name;
 	default_map[i].type = type;
 	default_map[i].error_quark = error_quark;
 	default_map[i].priority = priority;
 	default_map[i].base_type = base_type;
+	default_types[i] = type;
 	i++;
 
 	setting_register (name, type);
@@ -291,29 +305,83 @@ register_default_settings (void)
 	/* Be sure to update DEFAULT_MAP_SIZE if you add another setting!! */
 }
 
-static guint32
-get_priority_for_setting_type (GType type)
+/* Returns the setting type's slot in default_map, or -1 */
+static inline int
+get_slot_for_setting_type (GType type)
 {
 	int i;
 
-	for (i = 0; default_map[i].name; i++) {
-		if (default_map[i].type == type)
-			return default_map[i].priority;
+	for (i = 0; i < DEFAULT_MAP_SIZE; i++) {
+		if (default_types[i] == type)
+			return i;
 	}
-
-	return G_MAXUINT32;
+	return -1;
 }
 
 static gboolean
 get_base_type_for_setting_type (GType type)
+{
+	int slot = get_slot_for_setting_type (type);
+
+	return slot >= 0 ? default_map[slot].base_type : FALSE;
+}
+
+/* Iterates a connection's settings: the default types in priority order,
+ * then any others in no particular order.
+ */
+typedef struct {
+	NMConnectionPrivate *priv;
+	int slot;
+	GHashTableIter other_iter;
+} SettingIter;
+
+static void
+setting_iter_init (SettingIter *iter, NMConnection *connection)
+{
+	iter->priv = NM_CONNECTION_GET_PRIVATE (connection);
+	iter->slot = 0;
+}
+
+static gboolean
+setting_iter_next (SettingIter *iter, NMSetting **out_setting)
+{
+	NMConnectionPrivate *priv = iter->priv;
+
+	while (iter->slot < DEFAULT_MAP_SIZE) {
+		NMSetting *setting = priv->settings[iter->slot++];
+
+		if (setting) {
+			*out_setting = setting;
+			return TRUE;
+		}
+	}
+
+	if (!priv->other_settings)
+		return FALSE;
+
+	if (iter->slot == DEFAULT_MAP_SIZE) {
+		g_hash_table_iter_init (&iter->other_iter, priv->other_settings);
+		iter->slot++;
+	}
+	return g_hash_table_iter_next (&iter->other_iter, NULL, (gpointer) out_setting);
+}
+
+static void
+clear_settings (NMConnectionPrivate *priv)
 {
 	int i;
 
-	for (i = 0; default_map[i].name; i++) {
-		if (default_map[i].type == type)
-			return default_map[i].base_type;
+	for (i = 0; i < DEFAULT_MAP_SIZE; i++) {
+		if (priv->settings[i]) {
+			g_object_unref (priv->settings[i]);
+			priv->settings[i] = NULL;
+		}
+	}
+
+	if (priv->other_settings) {
+		g_hash_table_destroy (priv->other_settings);
+		priv->other_settings = NULL;
 	}
-	return FALSE;
 }
 
 /**
@@ -327,7 +395,6 @@ get_base_type_for_setting_type (GType type)
 GType
 nm_connection_lookup_setting_type (const char *name)
 {
-	char *type_name;
 	GType type;
 
 	g_return_val_if_fail (name != NULL, G_TYPE_NONE);
@@ -335,15 +402,9 @@ nm_connection_lookup_setting_type (const char *name)
 	if (!registered_settings)
 		register_default_settings ();
 
-	type_name = (char *) g_hash_table_lookup (registered_settings, name);
-	if (type_name) {
-		type = g_type_from_name (type_name);
-		if (!type)
-			g_warning ("Can not get type for '%s'.", type_name);
-	} else {
-		type = 0;
+	type = (GType) GPOINTER_TO_SIZE (g_hash_table_lookup (registered_settings, name));
+	if (!type)
 		g_warning ("Unknown setting '%s'", name);
-	}
 
 	return type;
 }
@@ -420,11 +481,28 @@ parse_one_setting (gpointer key, gpointer value, gpointer user_data)
 void
 nm_connection_add_setting (NMConnection *connection, NMSetting *setting)
 {
+	NMConnectionPrivate *priv;
+	GType type;
+	int slot;
+
 	g_return_if_fail (NM_IS_CONNECTION (connection));
 	g_return_if_fail (NM_IS_SETTING (setting));
 
-	g_hash_table_insert (NM_CONNECTION_GET_PRIVATE (connection)->settings,
-					 g_strdup (G_OBJECT_TYPE_NAME (setting)), setting);
+	priv = NM_CONNECTION_GET_PRIVATE (connection);
+	type = G_OBJECT_TYPE (setting);
+
+	slot = get_slot_for_setting_type (type);
+	if (slot >= 0) {
+		if (priv->settings[slot])
+			g_object_unref (priv->settings[slot]);
+		priv->settings[slot] = setting;
+	} else {
+		if (!priv->other_settings)
+			priv->other_settings = g_hash_table_new_full (NULL, NULL, NULL, g_object_unref);
+		g_hash_table_insert (priv->other_settings, GSIZE_TO_POINTER (type), setting);
+	}
+
+	g_signal_emit (connection, signals[CHANGED], 0);
 }
 
 /**
@@ -438,10 +516,27 @@ nm_connection_add_setting (NMConnection *connection, NMSetting *setting)
 void
 nm_connection_remove_setting (NMConnection *connection, GType setting_type)
 {
+	NMConnectionPrivate *priv;
+	int slot;
+	gboolean removed = FALSE;
+
 	g_return_if_fail (NM_IS_CONNECTION (connection));
 	g_return_if_fail (g_type_is_a (setting_type, NM_TYPE_SETTING));
 
-	g_hash_table_remove (NM_CONNECTION_GET_PRIVATE (connection)->settings, g_type_name (setting_type));
+	priv = NM_CONNECTION_GET_PRIVATE (connection);
+
+	slot = get_slot_for_setting_type (setting_type);
+	if (slot >= 0) {
+		if (priv->settings[slot]) {
+			g_object_unref (priv->settings[slot]);
+			priv->settings[slot] = NULL;
+			removed = TRUE;
+		}
+	} else if (priv->other_settings)
+		removed = g_hash_table_remove (priv->other_settings, GSIZE_TO_POINTER (setting_type));
+
+	if (removed)
+		g_signal_emit (connection, signals[CHANGED], 0);
 }
 
 /**
@@ -458,11 +553,21 @@ nm_connection_remove_setting (NMConnection *connection, GType setting_type)
 NMSetting *
 nm_connection_get_setting (NMConnection *connection, GType setting_type)
 {
+	NMConnectionPrivate *priv;
+	int slot;
+
 	g_return_val_if_fail (NM_IS_CONNECTION (connection), NULL);
 	g_return_val_if_fail (g_type_is_a (setting_type, NM_TYPE_SETTING), NULL);
 
-	return (NMSetting *) g_hash_table_lookup (NM_CONNECTION_GET_PRIVATE (connection)->settings,
-									  g_type_name (setting_type));
+	priv = NM_CONNECTION_GET_PRIVATE (connection);
+
+	slot = get_slot_for_setting_type (setting_type);
+	if (G_LIKELY (slot >= 0))
+		return priv->settings[slot];
+
+	if (priv->other_settings)
+		return g_hash_table_lookup (priv->other_settings, GSIZE_TO_POINTER (setting_type));
+	return NULL;
 }
 
 /**
@@ -539,7 +644,8 @@ nm_connection_replace_settings (NMConnection *connection,
 	if (!validate_permissions_type (new_settings, error))
 		return FALSE;
 
-	g_hash_table_remove_all (NM_CONNECTION_GET_PRIVATE (connection)->settings);
+	clear_settings (NM_CONNECTION_GET_PRIVATE (connection));
+	g_signal_emit (connection, signals[CHANGED], 0);
 	g_hash_table_foreach (new_settings, parse_one_setting, connection);
 
 	return nm_connection_verify (connection, error);
@@ -552,20 +658,21 @@ typedef struct {
 } CompareConnectionInfo;
 
 static void
-compare_one_setting (gpointer key, gpointer value, gpointer user_data)
+compare_settings (NMConnection *connection, CompareConnectionInfo *info)
 {
-	NMSetting *setting = (NMSetting *) value;
-	CompareConnectionInfo *info = (CompareConnectionInfo *) user_data;
-	NMSetting *other_setting;
+	SettingIter iter;
+	NMSetting *setting;
 
-	if (info->failed)
-		return;
+	setting_iter_init (&iter, connection);
+	while (!info->failed && setting_iter_next (&iter, &setting)) {
+		NMSetting *other_setting;
 
-	other_setting = nm_connection_get_setting (info->other, G_OBJECT_TYPE (setting));
-	if (other_setting)
-		info->failed = nm_setting_compare (setting, other_setting, info->flags) ? FALSE : TRUE;
-	else
-		info->failed = TRUE;
+		other_setting = nm_connection_get_setting (info->other, G_OBJECT_TYPE (setting));
+		if (other_setting)
+			info->failed = nm_setting_compare (setting, other_setting, info->flags) ? FALSE : TRUE;
+		else
+			info->failed = TRUE;
+	}
 }
 
 /**
@@ -585,7 +692,6 @@ nm_connection_compare (NMConnection *a,
                        NMConnection *b,
                        NMSettingCompareFlags flags)
 {
-	NMConnectionPrivate *priv;
 	CompareConnectionInfo info = { b, FALSE, flags };
 
 	if (!a && !b)
@@ -594,16 +700,14 @@ nm_connection_compare (NMConnection *a,
 	if (!a || !b)
 		return FALSE;
 
-	priv = NM_CONNECTION_GET_PRIVATE (a);
-	g_hash_table_foreach (priv->settings, compare_one_setting, &info);
+	compare_settings (a, &info);
 	if (info.failed == FALSE) {
 		/* compare A to B, then if that is the same compare B to A to ensure
 		 * that keys that are in B but not A will make the comparison fail.
 		 */
 		info.failed = FALSE;
 		info.other = a;
-		priv = NM_CONNECTION_GET_PRIVATE (b);
-		g_hash_table_foreach (priv->settings, compare_one_setting, &info);
+		compare_settings (b, &info);
 	}
 
 	return info.failed ? FALSE : TRUE;
@@ -617,12 +721,11 @@ diff_one_connection (NMConnection *a,
                      gboolean invert_results,
                      GHashTable *diffs)
 {
-	NMConnectionPrivate *priv = NM_CONNECTION_GET_PRIVATE (a);
-	GHashTableIter iter;
+	SettingIter iter;
 	NMSetting *a_setting = NULL;
 
-	g_hash_table_iter_init (&iter, priv->settings);
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &a_setting)) {
+	setting_iter_init (&iter, a);
+	while (setting_iter_next (&iter, &a_setting)) {
 		NMSetting *b_setting = NULL;
 		const char *setting_name = nm_setting_get_name (a_setting);
 		GHashTable *results;
@@ -714,10 +817,9 @@ nm_connection_diff (NMConnection *a,
 gboolean
 nm_connection_verify (NMConnection *connection, GError **error)
 {
-	NMConnectionPrivate *priv;
 	NMSetting *s_con;
-	GHashTableIter iter;
-	gpointer value;
+	SettingIter iter;
+	NMSetting *setting;
 	GSList *all_settings = NULL;
 	gboolean success = TRUE;
 	const char *ctype;
@@ -734,8 +836,6 @@ nm_connection_verify (NMConnection *connection, GError **error)
 		g_return_val_if_fail (NM_IS_CONNECTION (connection), FALSE);
 	}
 
-	priv = NM_CONNECTION_GET_PRIVATE (connection);
-
 	/* First, make sure there's at least 'connection' setting */
 	s_con = nm_connection_get_setting (connection, NM_TYPE_SETTING_CONNECTION);
 	if (!s_con) {
@@ -747,14 +847,15 @@ nm_connection_verify (NMConnection *connection, GError **error)
 	}
 
 	/* Build up the list of settings */
-	g_hash_table_iter_init (&iter, priv->settings);
-	while (g_hash_table_iter_next (&iter, NULL, &value))
-		all_settings = g_slist_append (all_settings, value);
+	setting_iter_init (&iter, connection);
+	while (setting_iter_next (&iter, &setting))
+		all_settings = g_slist_prepend (all_settings, setting);
+	all_settings = g_slist_reverse (all_settings);
 
 	/* Now, run the verify function of each setting */
-	g_hash_table_iter_init (&iter, priv->settings);
-	while (g_hash_table_iter_next (&iter, NULL, &value) && success)
-		success = nm_setting_verify (NM_SETTING (value), all_settings, error);
+	setting_iter_init (&iter, connection);
+	while (success && setting_iter_next (&iter, &setting))
+		success = nm_setting_verify (setting, all_settings, error);
 	g_slist_free (all_settings);
 
 	if (success == FALSE)
@@ -872,29 +973,6 @@ nm_connection_update_secrets (NMConnection *connection,
 	return success;
 }
 
-static gint
-setting_priority_compare (gconstpointer a, gconstpointer b)
-{
-	guint32 prio_a, prio_b;
-
-	prio_a = get_priority_for_setting_type (G_OBJECT_TYPE (NM_SETTING (a)));
-	prio_b = get_priority_for_setting_type (G_OBJECT_TYPE (NM_SETTING (b)));
-
-	if (prio_a < prio_b)
-		return -1;
-	else if (prio_a == prio_b)
-		return 0;
-	return 1;
-}
-
-static void
-add_setting_to_list (gpointer key, gpointer data, gpointer user_data)
-{
-	GSList **list = (GSList **) user_data;
-
-	*list = g_slist_insert_sorted (*list, NM_SETTING (data), setting_priority_compare);
-}
-
 /**
  * nm_connection_need_secrets:
  * @connection: the #NMConnection
@@ -918,9 +996,8 @@ const char *
 nm_connection_need_secrets (NMConnection *connection,
                             GPtrArray **hints)
 {
-	NMConnectionPrivate *priv;
-	GSList *settings = NULL;
-	GSList *iter;
+	SettingIter iter;
+	NMSetting *setting;
 	const char *name = NULL;
 
 	g_return_val_if_fail (connection != NULL, NULL);
@@ -928,13 +1005,9 @@ nm_connection_need_secrets (NMConnection *connection,
 	if (hints)
 		g_return_val_if_fail (*hints == NULL, NULL);
 
-	priv = NM_CONNECTION_GET_PRIVATE (connection);
-
-	/* Get list of settings in priority order */
-	g_hash_table_foreach (priv->settings, add_setting_to_list, &settings);
-
-	for (iter = settings; iter; iter = g_slist_next (iter)) {
-		NMSetting *setting = NM_SETTING (iter->data);
+	/* Settings come in priority order */
+	setting_iter_init (&iter, connection);
+	while (setting_iter_next (&iter, &setting)) {
 		GPtrArray *secrets;
 
 		// FIXME: do something with requested secrets rather than asking for
@@ -952,7 +1025,6 @@ nm_connection_need_secrets (NMConnection *connection,
 		}
 	}
 
-	g_slist_free (settings);
 	return name;
 }
 
@@ -966,13 +1038,13 @@ nm_connection_need_secrets (NMConnection *connection,
 void
 nm_connection_clear_secrets (NMConnection *connection)
 {
-	GHashTableIter iter;
+	SettingIter iter;
 	NMSetting *setting;
 
 	g_return_if_fail (NM_IS_CONNECTION (connection));
 
-	g_hash_table_iter_init (&iter, NM_CONNECTION_GET_PRIVATE (connection)->settings);
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &setting))
+	setting_iter_init (&iter, connection);
+	while (setting_iter_next (&iter, &setting))
 		nm_setting_clear_secrets (setting);
 
 	g_signal_emit (connection, signals[SECRETS_CLEARED], 0);
@@ -992,13 +1064,13 @@ nm_connection_clear_secrets_with_flags (NMConnection *connection,
                                         NMSettingClearSecretsWithFlagsFn func,
                                         gpointer user_data)
 {
-	GHashTableIter iter;
+	SettingIter iter;
 	NMSetting *setting;
 
 	g_return_if_fail (NM_IS_CONNECTION (connection));
 
-	g_hash_table_iter_init (&iter, NM_CONNECTION_GET_PRIVATE (connection)->settings);
-	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &setting))
+	setting_iter_init (&iter, connection);
+	while (setting_iter_next (&iter, &setting))
 		nm_setting_clear_secrets_with_flags (setting, func, user_data);
 
 	g_signal_emit (connection, signals[SECRETS_CLEARED], 0);
@@ -1024,9 +1096,8 @@ nm_connection_clear_secrets_with_flags (NMConnection *connection,
 GHashTable *
 nm_connection_to_hash (NMConnection *connection, NMSettingHashFlags flags)
 {
-	NMConnectionPrivate *priv;
-	GHashTableIter iter;
-	gpointer key, data;
+	SettingIter iter;
+	NMSetting *setting;
 	GHashTable *ret, *setting_hash;
 
 	g_return_val_if_fail (connection != NULL, NULL);
@@ -1035,13 +1106,9 @@ nm_connection_to_hash (NMConnection *connection, NMSettingHashFlags flags)
 	ret = g_hash_table_new_full (g_str_hash, g_str_equal,
 	                             g_free, (GDestroyNotify) g_hash_table_destroy);
 
-	priv = NM_CONNECTION_GET_PRIVATE (connection);
-
 	/* Add each setting's hash to the main hash */
-	g_hash_table_iter_init (&iter, priv->settings);
-	while (g_hash_table_iter_next (&iter, &key, &data)) {
-		NMSetting *setting = NM_SETTING (data);
-
+	setting_iter_init (&iter, connection);
+	while (setting_iter_next (&iter, &setting)) {
 		setting_hash = nm_setting_to_hash (setting, flags);
 		if (setting_hash)
 			g_hash_table_insert (ret, g_strdup (nm_setting_get_name (setting)), setting_hash);
@@ -1070,25 +1137,15 @@ nm_connection_for_each_setting_value (NMConnection *connection,
                                       NMSettingValueIterFn func,
                                       gpointer user_data)
 {
-	GHashTableIter iter;
-	gpointer value;
+	SettingIter iter;
+	NMSetting *setting;
 
 	g_return_if_fail (NM_IS_CONNECTION (connection));
 	g_return_if_fail (func != NULL);
 
-	g_hash_table_iter_init (&iter, NM_CONNECTION_GET_PRIVATE (connection)->settings);
-	while (g_hash_table_iter_next (&iter, NULL, &value))
-		nm_setting_enumerate_values (NM_SETTING (value), func, user_data);
-}
-
-static void
-dump_setting (gpointer key, gpointer value, gpointer user_data)
-{
-	char *str;
-
-	str = nm_setting_to_string (NM_SETTING (value));
-	g_print ("%s\n", str);
-	g_free (str);
+	setting_iter_init (&iter, connection);
+	while (setting_iter_next (&iter, &setting))
+		nm_setting_enumerate_values (setting, func, user_data);
 }
 
 /**
@@ -1102,9 +1159,19 @@ dump_setting (gpointer key, gpointer value, gpointer user_data)
 void
 nm_connection_dump (NMConnection *connection)
 {
+	SettingIter iter;
+	NMSetting *setting;
+
 	g_return_if_fail (NM_IS_CONNECTION (connection));
 
-	g_hash_table_foreach (NM_CONNECTION_GET_PRIVATE (connection)->settings, dump_setting, NULL);
+	setting_iter_init (&iter, connection);
+	while (setting_iter_next (&iter, &setting)) {
+		char *str;
+
+		str = nm_setting_to_string (setting);
+		g_print ("%s\n", str);
+		g_free (str);
+	}
 }
 
 /**
@@ -1204,12 +1271,6 @@ nm_connection_new_from_hash (GHashTable *hash, GError **error)
 	return connection;
 }
 
-static void
-duplicate_cb (gpointer key, gpointer value, gpointer user_data)
-{
-	nm_connection_add_setting (NM_CONNECTION (user_data), nm_setting_duplicate (NM_SETTING (value)));
-}
-
 /**
  * nm_connection_duplicate:
  * @connection: the #NMConnection to duplicate
@@ -1223,12 +1284,17 @@ NMConnection *
 nm_connection_duplicate (NMConnection *connection)
 {
 	NMConnection *dup;
+	SettingIter iter;
+	NMSetting *setting;
 
 	g_return_val_if_fail (NM_IS_CONNECTION (connection), NULL);
 
 	dup = nm_connection_new ();
 	nm_connection_set_path (dup, nm_connection_get_path (connection));
-	g_hash_table_foreach (NM_CONNECTION_GET_PRIVATE (connection)->settings, duplicate_cb, dup);
+
+	setting_iter_init (&iter, connection);
+	while (setting_iter_next (&iter, &setting))
+		nm_connection_add_setting (dup, nm_setting_duplicate (setting));
 
 	return dup;
 }
@@ -1539,9 +1605,6 @@ nm_connection_get_setting_wireless_security (NMConnection *connection)
 static void
 nm_connection_init (NMConnection *connection)
 {
-	NMConnectionPrivate *priv = NM_CONNECTION_GET_PRIVATE (connection);
-
-	priv->settings = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_object_unref);
 }
 
 static void
@@ -1550,8 +1613,7 @@ finalize (GObject *object)
 	NMConnection *connection = NM_CONNECTION (object);
 	NMConnectionPrivate *priv = NM_CONNECTION_GET_PRIVATE (connection);
 
-	g_hash_table_destroy (priv->settings);
-	priv->settings = NULL;
+	clear_settings (priv);
 
 	g_free (priv->path);
 	priv->path = NULL;
@@ -1598,6 +1660,13 @@ nm_connection_class_init (NMConnectionClass *klass)
 
 	g_type_class_add_private (klass, sizeof (NMConnectionPrivate));
 
+	/* Settings are stored by slot, so the slots must be known before any
+	 * connection is created, including subclasses not made through
+	 * nm_connection_new().
+	 */
+	if (!registered_settings)
+		register_default_settings ();
+
 	/* virtual methods */
 	object_class->set_property = set_property;
 	object_class->get_property = get_property;
@@ -1654,5 +1723,20 @@ nm_connection_class_init (NMConnectionClass *klass)
 		              0, NULL, NULL,
 		              g_cclosure_marshal_VOID__VOID,
 		              G_TYPE_NONE, 0);
+
+	/**
+	* NMConnection::changed:
+	* @connection: the object on which the signal is emitted
+	*
+	* The ::changed signal is emitted when a setting is added to or removed
+	* from the connection.
+	*/
+	signals[CHANGED] =
+		g_signal_new ("changed",
+		              G_OBJECT_CLASS_TYPE (object_class),
+		              G_SIGNAL_RUN_FIRST,
+		              0, NULL, NULL,
+		              g_cclosure_marshal_VOID__VOID,
+		              G_TYPE_NONE, 0);
 }
 
@@ -29,6 +29,7 @@
 #include "nm-dbus-glib-types.h"
 #include "nm-param-spec-specialized.h"
 #include "nm-setting-connection.h"
+#include "nm-utils-private.h"
 
 /**
  * SECTION:nm-setting-connection
@@ -94,9 +95,9 @@ typedef struct {
 } Permission;
 
 typedef struct {
-	char *id;
-	char *uuid;
-	char *type;
+	const char *id;
+	const char *uuid;
+	const char *type;
 	GSList *permissions; /* list of Permission structs */
 	gboolean autoconnect;
 	guint64 timestamp;
@@ -588,9 +589,9 @@ finalize (GObject *object)
 {
 	NMSettingConnectionPrivate *priv = NM_SETTING_CONNECTION_GET_PRIVATE (object);
 
-	g_free (priv->id);
-	g_free (priv->uuid);
-	g_free (priv->type);
+	_nm_utils_str_release (priv->id);
+	_nm_utils_str_release (priv->uuid);
+	_nm_utils_str_release (priv->type);
 	nm_utils_slist_free (priv->permissions, (GDestroyNotify) permission_free);
 
 	G_OBJECT_CLASS (nm_setting_connection_parent_class)->finalize (object);
@@ -620,16 +621,16 @@ set_property (GObject *object, guint prop_id,
 
 	switch (prop_id) {
 	case PROP_ID:
-		g_free (priv->id);
-		priv->id = g_value_dup_string (value);
+		_nm_utils_str_release (priv->id);
+		priv->id = _nm_utils_str_intern (g_value_get_string (value));
 		break;
 	case PROP_UUID:
-		g_free (priv->uuid);
-		priv->uuid = g_value_dup_string (value);
+		_nm_utils_str_release (priv->uuid);
+		priv->uuid = _nm_utils_str_intern (g_value_get_string (value));
 		break;
 	case PROP_TYPE:
-		g_free (priv->type);
-		priv->type = g_value_dup_string (value);
+		_nm_utils_str_release (priv->type);
+		priv->type = _nm_utils_str_intern (g_value_get_string (value));
 		break;
 	case PROP_PERMISSIONS:
 		nm_utils_slist_free (priv->permissions, (GDestroyNotify) permission_free);
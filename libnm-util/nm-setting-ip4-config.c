@@ -30,6 +30,7 @@
 #include "nm-param-spec-specialized.h"
 #include "nm-utils.h"
 #include "nm-dbus-glib-types.h"
+#include "nm-utils-private.h"
 
 /**
  * SECTION:nm-setting-ip4-config
@@ -312,7 +313,7 @@ nm_setting_ip4_config_add_dns_search (NMSettingIP4Config *setting,
 			return FALSE;
 	}
 
-	priv->dns_search = g_slist_append (priv->dns_search, g_strdup (dns_search));
+	priv->dns_search = g_slist_append (priv->dns_search, (gpointer) _nm_utils_str_intern (dns_search));
 	return TRUE;
 }
 
@@ -335,7 +336,7 @@ nm_setting_ip4_config_remove_dns_search (NMSettingIP4Config *setting, guint32 i)
 	elt = g_slist_nth (priv->dns_search, i);
 	g_return_if_fail (elt != NULL);
 
-	g_free (elt->data);
+	_nm_utils_str_release (elt->data);
 	priv->dns_search = g_slist_delete_link (priv->dns_search, elt);
 }
 
@@ -350,7 +351,7 @@ nm_setting_ip4_config_clear_dns_searches (NMSettingIP4Config *setting)
 {
 	g_return_if_fail (NM_IS_SETTING_IP4_CONFIG (setting));
 
-	nm_utils_slist_free (NM_SETTING_IP4_CONFIG_GET_PRIVATE (setting)->dns_search, g_free);
+	_nm_utils_str_slist_release (NM_SETTING_IP4_CONFIG_GET_PRIVATE (setting)->dns_search);
 	NM_SETTING_IP4_CONFIG_GET_PRIVATE (setting)->dns_search = NULL;
 }
 
@@ -840,7 +841,7 @@ finalize (GObject *object)
 
 	g_array_free (priv->dns, TRUE);
 
-	nm_utils_slist_free (priv->dns_search, g_free);
+	_nm_utils_str_slist_release (priv->dns_search);
 	nm_utils_slist_free (priv->addresses, (GDestroyNotify) nm_ip4_address_unref);
 	nm_utils_slist_free (priv->routes, (GDestroyNotify) nm_ip4_route_unref);
 
@@ -866,8 +867,8 @@ set_property (GObject *object, guint prop_id,
 			priv->dns = g_array_sized_new (FALSE, TRUE, sizeof (guint32), 3);			
 		break;
 	case PROP_DNS_SEARCH:
-		nm_utils_slist_free (priv->dns_search, g_free);
-		priv->dns_search = g_value_dup_boxed (value);
+		_nm_utils_str_slist_release (priv->dns_search);
+		priv->dns_search = _nm_utils_str_slist_intern (g_value_get_boxed (value));
 		break;
 	case PROP_ADDRESSES:
 		nm_utils_slist_free (priv->addresses, (GDestroyNotify) nm_ip4_address_unref);
@@ -29,6 +29,7 @@
 #include "nm-param-spec-specialized.h"
 #include "nm-utils.h"
 #include "nm-dbus-glib-types.h"
+#include "nm-utils-private.h"
 
 /**
  * SECTION:nm-setting-ip6-config
@@ -311,7 +312,7 @@ nm_setting_ip6_config_add_dns_search (NMSettingIP6Config *setting,
 			return FALSE;
 	}
 
-	priv->dns_search = g_slist_append (priv->dns_search, g_strdup (dns_search));
+	priv->dns_search = g_slist_append (priv->dns_search, (gpointer) _nm_utils_str_intern (dns_search));
 	return TRUE;
 }
 
@@ -334,7 +335,7 @@ nm_setting_ip6_config_remove_dns_search (NMSettingIP6Config *setting, guint32 i)
 	elt = g_slist_nth (priv->dns_search, i);
 	g_return_if_fail (elt != NULL);
 
-	g_free (elt->data);
+	_nm_utils_str_release (elt->data);
 	priv->dns_search = g_slist_delete_link (priv->dns_search, elt);
 }
 
@@ -349,7 +350,7 @@ nm_setting_ip6_config_clear_dns_searches (NMSettingIP6Config *setting)
 {
 	g_return_if_fail (NM_IS_SETTING_IP6_CONFIG (setting));
 
-	nm_utils_slist_free (NM_SETTING_IP6_CONFIG_GET_PRIVATE (setting)->dns_search, g_free);
+	_nm_utils_str_slist_release (NM_SETTING_IP6_CONFIG_GET_PRIVATE (setting)->dns_search);
 	NM_SETTING_IP6_CONFIG_GET_PRIVATE (setting)->dns_search = NULL;
 }
 
@@ -718,7 +719,7 @@ finalize (GObject *object)
 	g_free (priv->method);
 	g_slist_free (priv->dns);
 
-	nm_utils_slist_free (priv->dns_search, g_free);
+	_nm_utils_str_slist_release (priv->dns_search);
 	nm_utils_slist_free (priv->addresses, g_free);
 	nm_utils_slist_free (priv->routes, g_free);
 
@@ -741,8 +742,8 @@ set_property (GObject *object, guint prop_id,
 		priv->dns = nm_utils_ip6_dns_from_gvalue (value);
 		break;
 	case PROP_DNS_SEARCH:
-		nm_utils_slist_free (priv->dns_search, g_free);
-		priv->dns_search = g_value_dup_boxed (value);
+		_nm_utils_str_slist_release (priv->dns_search);
+		priv->dns_search = _nm_utils_str_slist_intern (g_value_get_boxed (value));
 		break;
 	case PROP_ADDRESSES:
 		nm_utils_slist_free (priv->addresses, g_free);
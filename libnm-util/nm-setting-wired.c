@@ -90,16 +90,16 @@ G_DEFINE_TYPE (NMSettingWired, nm_setting_wired, NM_TYPE_SETTING)
 #define NM_SETTING_WIRED_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), NM_TYPE_SETTING_WIRED, NMSettingWiredPrivate))
 
 typedef struct {
-	char *port;
+	const char *port;
 	guint32 speed;
-	char *duplex;
+	const char *duplex;
 	gboolean auto_negotiate;
 	GByteArray *device_mac_address;
 	GByteArray *cloned_mac_address;
 	GSList *mac_address_blacklist;
 	guint32 mtu;
 	GPtrArray *s390_subchannels;
-	char *s390_nettype;
+	const char *s390_nettype;
 	GHashTable *s390_options;
 } NMSettingWiredPrivate;
 
@@ -541,17 +541,14 @@ finalize (GObject *object)
 {
 	NMSettingWiredPrivate *priv = NM_SETTING_WIRED_GET_PRIVATE (object);
 
-	g_free (priv->port);
-	g_free (priv->duplex);
-	g_free (priv->s390_nettype);
+	_nm_utils_str_release (priv->port);
+	_nm_utils_str_release (priv->duplex);
+	_nm_utils_str_release (priv->s390_nettype);
 
 	g_hash_table_destroy (priv->s390_options);
 
-	if (priv->device_mac_address)
-		g_byte_array_free (priv->device_mac_address, TRUE);
-
-	if (priv->cloned_mac_address)
-		g_byte_array_free (priv->cloned_mac_address, TRUE);
+	_nm_utils_blob_release (priv->device_mac_address);
+	_nm_utils_blob_release (priv->cloned_mac_address);
 
 	nm_utils_slist_free (priv->mac_address_blacklist, g_free);
 
@@ -573,28 +570,26 @@ set_property (GObject *object, guint prop_id,
 
 	switch (prop_id) {
 	case PROP_PORT:
-		g_free (priv->port);
-		priv->port = g_value_dup_string (value);
+		_nm_utils_str_release (priv->port);
+		priv->port = _nm_utils_str_intern (g_value_get_string (value));
 		break;
 	case PROP_SPEED:
 		priv->speed = g_value_get_uint (value);
 		break;
 	case PROP_DUPLEX:
-		g_free (priv->duplex);
-		priv->duplex = g_value_dup_string (value);
+		_nm_utils_str_release (priv->duplex);
+		priv->duplex = _nm_utils_str_intern (g_value_get_string (value));
 		break;
 	case PROP_AUTO_NEGOTIATE:
 		priv->auto_negotiate = g_value_get_boolean (value);
 		break;
 	case PROP_MAC_ADDRESS:
-		if (priv->device_mac_address)
-			g_byte_array_free (priv->device_mac_address, TRUE);
-		priv->device_mac_address = g_value_dup_boxed (value);
+		_nm_utils_blob_release (priv->device_mac_address);
+		priv->device_mac_address = _nm_utils_blob_intern (g_value_get_boxed (value));
 		break;
 	case PROP_CLONED_MAC_ADDRESS:
-		if (priv->cloned_mac_address)
-			g_byte_array_free (priv->cloned_mac_address, TRUE);
-		priv->cloned_mac_address = g_value_dup_boxed (value);
+		_nm_utils_blob_release (priv->cloned_mac_address);
+		priv->cloned_mac_address = _nm_utils_blob_intern (g_value_get_boxed (value));
 		break;
 	case PROP_MAC_ADDRESS_BLACKLIST:
 		nm_utils_slist_free (priv->mac_address_blacklist, g_free);
@@ -611,8 +606,8 @@ set_property (GObject *object, guint prop_id,
 		priv->s390_subchannels = g_value_dup_boxed (value);
 		break;
 	case PROP_S390_NETTYPE:
-		g_free (priv->s390_nettype);
-		priv->s390_nettype = g_value_dup_string (value);
+		_nm_utils_str_release (priv->s390_nettype);
+		priv->s390_nettype = _nm_utils_str_intern (g_value_get_string (value));
 		break;
 	case PROP_S390_OPTIONS:
 		/* Must make a deep copy of the hash table here... */
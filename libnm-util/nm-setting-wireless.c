@@ -97,8 +97,8 @@ G_DEFINE_TYPE (NMSettingWireless, nm_setting_wireless, NM_TYPE_SETTING)
 
 typedef struct {
 	GByteArray *ssid;
-	char *mode;
-	char *band;
+	const char *mode;
+	const char *band;
 	guint32 channel;
 	GByteArray *bssid;
 	guint32 rate;
@@ -108,7 +108,7 @@ typedef struct {
 	GSList *mac_address_blacklist;
 	guint32 mtu;
 	GSList *seen_bssids;
-	char *security;
+	const char *security;
 } NMSettingWirelessPrivate;
 
 enum {
@@ -722,18 +722,14 @@ finalize (GObject *object)
 {
 	NMSettingWirelessPrivate *priv = NM_SETTING_WIRELESS_GET_PRIVATE (object);
 
-	g_free (priv->mode);
-	g_free (priv->band);
-	g_free (priv->security);
-
-	if (priv->ssid)
-		g_byte_array_free (priv->ssid, TRUE);
-	if (priv->bssid)
-		g_byte_array_free (priv->bssid, TRUE);
-	if (priv->device_mac_address)
-		g_byte_array_free (priv->device_mac_address, TRUE);
-	if (priv->cloned_mac_address)
-		g_byte_array_free (priv->cloned_mac_address, TRUE);
+	_nm_utils_str_release (priv->mode);
+	_nm_utils_str_release (priv->band);
+	_nm_utils_str_release (priv->security);
+
+	_nm_utils_blob_release (priv->ssid);
+	_nm_utils_blob_release (priv->bssid);
+	_nm_utils_blob_release (priv->device_mac_address);
+	_nm_utils_blob_release (priv->cloned_mac_address);
 	nm_utils_slist_free (priv->mac_address_blacklist, g_free);
 	nm_utils_slist_free (priv->seen_bssids, g_free);
 
@@ -748,25 +744,23 @@ set_property (GObject *object, guint prop_id,
 
 	switch (prop_id) {
 	case PROP_SSID:
-		if (priv->ssid)
-			g_byte_array_free (priv->ssid, TRUE);
-		priv->ssid = g_value_dup_boxed (value);
+		_nm_utils_blob_release (priv->ssid);
+		priv->ssid = _nm_utils_blob_intern (g_value_get_boxed (value));
 		break;
 	case PROP_MODE:
-		g_free (priv->mode);
-		priv->mode = g_value_dup_string (value);
+		_nm_utils_str_release (priv->mode);
+		priv->mode = _nm_utils_str_intern (g_value_get_string (value));
 		break;
 	case PROP_BAND:
-		g_free (priv->band);
-		priv->band = g_value_dup_string (value);
+		_nm_utils_str_release (priv->band);
+		priv->band = _nm_utils_str_intern (g_value_get_string (value));
 		break;
 	case PROP_CHANNEL:
 		priv->channel = g_value_get_uint (value);
 		break;
 	case PROP_BSSID:
-		if (priv->bssid)
-			g_byte_array_free (priv->bssid, TRUE);
-		priv->bssid = g_value_dup_boxed (value);
+		_nm_utils_blob_release (priv->bssid);
+		priv->bssid = _nm_utils_blob_intern (g_value_get_boxed (value));
 		break;
 	case PROP_RATE:
 		priv->rate = g_value_get_uint (value);
@@ -775,14 +769,12 @@ set_property (GObject *object, guint prop_id,
 		priv->tx_power = g_value_get_uint (value);
 		break;
 	case PROP_MAC_ADDRESS:
-		if (priv->device_mac_address)
-			g_byte_array_free (priv->device_mac_address, TRUE);
-		priv->device_mac_address = g_value_dup_boxed (value);
+		_nm_utils_blob_release (priv->device_mac_address);
+		priv->device_mac_address = _nm_utils_blob_intern (g_value_get_boxed (value));
 		break;
 	case PROP_CLONED_MAC_ADDRESS:
-		if (priv->cloned_mac_address)
-			g_byte_array_free (priv->cloned_mac_address, TRUE);
-		priv->cloned_mac_address = g_value_dup_boxed (value);
+		_nm_utils_blob_release (priv->cloned_mac_address);
+		priv->cloned_mac_address = _nm_utils_blob_intern (g_value_get_boxed (value));
 		break;
 	case PROP_MAC_ADDRESS_BLACKLIST:
 		nm_utils_slist_free (priv->mac_address_blacklist, g_free);
@@ -796,8 +788,8 @@ set_property (GObject *object, guint prop_id,
 		priv->seen_bssids = g_value_dup_boxed (value);
 		break;
 	case PROP_SEC:
-		g_free (priv->security);
-		priv->security = g_value_dup_string (value);
+		_nm_utils_str_release (priv->security);
+		priv->security = _nm_utils_str_intern (g_value_get_string (value));
 		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -105,6 +105,165 @@ destroy_gvalue (gpointer data)
 	g_slice_free (GValue, value);
 }
 
+/*****************************************************************************/
+
+/* Property descriptors, built once per setting type.  Going through the
+ * owning class' get_property() directly skips the name lookup and checks
+ * g_object_get_property() does on every call, and the comparators avoid
+ * the generic GParamSpec vfunc for the common fundamental types.
+ */
+
+typedef gint (*PropertyCmpFunc) (GParamSpec *pspec, const GValue *a, const GValue *b);
+
+typedef struct {
+	GParamSpec *pspec;
+	GObjectClass *owner_class;
+	PropertyCmpFunc cmp;
+} PropertyInfo;
+
+typedef struct {
+	guint n_properties;
+	PropertyInfo **properties;
+} SettingClassInfo;
+
+G_LOCK_DEFINE_STATIC (info_lock);
+
+static gint
+cmp_boolean (GParamSpec *pspec, const GValue *a, const GValue *b)
+{
+	gboolean va = g_value_get_boolean (a) ? TRUE : FALSE;
+	gboolean vb = g_value_get_boolean (b) ? TRUE : FALSE;
+
+	return va == vb ? 0 : (va < vb ? -1 : 1);
+}
+
+static gint
+cmp_int (GParamSpec *pspec, const GValue *a, const GValue *b)
+{
+	gint va = g_value_get_int (a), vb = g_value_get_int (b);
+
+	return va == vb ? 0 : (va < vb ? -1 : 1);
+}
+
+static gint
+cmp_uint (GParamSpec *pspec, const GValue *a, const GValue *b)
+{
+	guint va = g_value_get_uint (a), vb = g_value_get_uint (b);
+
+	return va == vb ? 0 : (va < vb ? -1 : 1);
+}
+
+static gint
+cmp_uint64 (GParamSpec *pspec, const GValue *a, const GValue *b)
+{
+	guint64 va = g_value_get_uint64 (a), vb = g_value_get_uint64 (b);
+
+	return va == vb ? 0 : (va < vb ? -1 : 1);
+}
+
+static gint
+cmp_string (GParamSpec *pspec, const GValue *a, const GValue *b)
+{
+	return g_strcmp0 (g_value_get_string (a), g_value_get_string (b));
+}
+
+static PropertyCmpFunc
+cmp_func_for_pspec (GParamSpec *pspec)
+{
+	/* Only plain fundamental pspecs; anything else (including specialized
+	 * collection types) keeps its own values_cmp.
+	 */
+	if (G_IS_PARAM_SPEC_BOOLEAN (pspec))
+		return cmp_boolean;
+	if (G_IS_PARAM_SPEC_INT (pspec))
+		return cmp_int;
+	if (G_IS_PARAM_SPEC_UINT (pspec))
+		return cmp_uint;
+	if (G_IS_PARAM_SPEC_UINT64 (pspec))
+		return cmp_uint64;
+	if (G_IS_PARAM_SPEC_STRING (pspec))
+		return cmp_string;
+	return (PropertyCmpFunc) g_param_values_cmp;
+}
+
+/* Called with info_lock held */
+static PropertyInfo *
+property_info_lookup (GParamSpec *pspec)
+{
+	static GQuark quark = 0;
+	PropertyInfo *prop;
+
+	if (G_UNLIKELY (!quark))
+		quark = g_quark_from_static_string ("nm-setting-property-info");
+
+	/* A pspec belongs to one class, so its info is shared by all subclasses */
+	prop = g_param_spec_get_qdata (pspec, quark);
+	if (G_UNLIKELY (!prop)) {
+		prop = g_new0 (PropertyInfo, 1);
+		prop->pspec = pspec;
+		prop->owner_class = g_type_class_peek (pspec->owner_type);
+		prop->cmp = cmp_func_for_pspec (pspec);
+		g_param_spec_set_qdata (pspec, quark, prop);
+	}
+	return prop;
+}
+
+static const SettingClassInfo *
+setting_class_info_get (NMSetting *setting)
+{
+	static GQuark quark = 0;
+	GType type = G_OBJECT_TYPE (setting);
+	SettingClassInfo *info;
+	GParamSpec **property_specs;
+	guint i;
+
+	G_LOCK (info_lock);
+
+	if (G_UNLIKELY (!quark))
+		quark = g_quark_from_static_string ("nm-setting-class-info");
+
+	info = g_type_get_qdata (type, quark);
+	if (G_UNLIKELY (!info)) {
+		info = g_new0 (SettingClassInfo, 1);
+
+		/* Same order as g_object_class_list_properties(), which callers
+		 * like the keyfile writer rely on.
+		 */
+		property_specs = g_object_class_list_properties (G_OBJECT_GET_CLASS (setting),
+		                                                 &info->n_properties);
+		info->properties = g_new0 (PropertyInfo *, info->n_properties);
+		for (i = 0; i < info->n_properties; i++)
+			info->properties[i] = property_info_lookup (property_specs[i]);
+		g_free (property_specs);
+
+		/* Setting types are static, so the info lives as long as the type */
+		g_type_set_qdata (type, quark, info);
+	}
+
+	G_UNLOCK (info_lock);
+	return info;
+}
+
+static const PropertyInfo *
+property_info_get (const GParamSpec *pspec)
+{
+	PropertyInfo *prop;
+
+	G_LOCK (info_lock);
+	prop = property_info_lookup ((GParamSpec *) pspec);
+	G_UNLOCK (info_lock);
+	return prop;
+}
+
+static inline void
+property_get_value (NMSetting *setting, const PropertyInfo *prop, GValue *value)
+{
+	g_value_init (value, prop->pspec->value_type);
+	prop->owner_class->get_property (G_OBJECT (setting), prop->pspec->param_id, value, prop->pspec);
+}
+
+/*****************************************************************************/
+
 /**
  * nm_setting_to_hash:
  * @setting: the #NMSetting
@@ -121,15 +280,14 @@ GHashTable *
 nm_setting_to_hash (NMSetting *setting, NMSettingHashFlags flags)
 {
 	GHashTable *hash;
-	GParamSpec **property_specs;
-	guint n_property_specs;
+	const SettingClassInfo *info;
 	guint i;
 
 	g_return_val_if_fail (setting != NULL, NULL);
 	g_return_val_if_fail (NM_IS_SETTING (setting), NULL);
 
-	property_specs = g_object_class_list_properties (G_OBJECT_GET_CLASS (setting), &n_property_specs);
-	if (!property_specs) {
+	info = setting_class_info_get (setting);
+	if (!info->n_properties) {
 		g_warning ("%s: couldn't find property specs for object of type '%s'",
 		           __func__, g_type_name (G_OBJECT_TYPE (setting)));
 		return NULL;
@@ -138,8 +296,9 @@ nm_setting_to_hash (NMSetting *setting, NMSettingHashFlags flags)
 	hash = g_hash_table_new_full (g_str_hash, g_str_equal,
 	                              (GDestroyNotify) g_free, destroy_gvalue);
 
-	for (i = 0; i < n_property_specs; i++) {
-		GParamSpec *prop_spec = property_specs[i];
+	for (i = 0; i < info->n_properties; i++) {
+		const PropertyInfo *prop = info->properties[i];
+		GParamSpec *prop_spec = prop->pspec;
 		GValue *value;
 
 		if (!(prop_spec->flags & NM_SETTING_PARAM_SERIALIZE))
@@ -154,8 +313,7 @@ nm_setting_to_hash (NMSetting *setting, NMSettingHashFlags flags)
 			continue;
 
 		value = g_slice_new0 (GValue);
-		g_value_init (value, prop_spec->value_type);
-		g_object_get_property (G_OBJECT (setting), prop_spec->name, value);
+		property_get_value (setting, prop, value);
 
 		/* Don't serialize values with default values */
 		if (!g_param_value_defaults (prop_spec, value))
@@ -163,7 +321,6 @@ nm_setting_to_hash (NMSetting *setting, NMSettingHashFlags flags)
 		else
 			destroy_gvalue (value);
 	}
-	g_free (property_specs);
 
 	/* Don't return empty hashes */
 	if (g_hash_table_size (hash) < 1) {
@@ -252,17 +409,6 @@ nm_setting_new_from_hash (GType setting_type, GHashTable *hash)
 	return setting;
 }
 
-static void
-duplicate_setting (NMSetting *setting,
-                   const char *name,
-                   const GValue *value,
-                   GParamFlags flags,
-                   gpointer user_data)
-{
-	if (flags & G_PARAM_WRITABLE)
-		g_object_set_property (G_OBJECT (user_data), name, value);
-}
-
 /**
  * nm_setting_duplicate:
  * @setting: the #NMSetting to duplicate
@@ -275,14 +421,27 @@ duplicate_setting (NMSetting *setting,
 NMSetting *
 nm_setting_duplicate (NMSetting *setting)
 {
+	const SettingClassInfo *info;
 	GObject *dup;
+	guint i;
 
 	g_return_val_if_fail (NM_IS_SETTING (setting), NULL);
 
+	info = setting_class_info_get (setting);
 	dup = g_object_new (G_OBJECT_TYPE (setting), NULL);
 
 	g_object_freeze_notify (dup);
-	nm_setting_enumerate_values (setting, duplicate_setting, dup);
+	for (i = 0; i < info->n_properties; i++) {
+		const PropertyInfo *prop = info->properties[i];
+		GValue value = { 0 };
+
+		if (!(prop->pspec->flags & G_PARAM_WRITABLE))
+			continue;
+
+		property_get_value (setting, prop, &value);
+		g_object_set_property (dup, prop->pspec->name, &value);
+		g_value_unset (&value);
+	}
 	g_object_thaw_notify (dup);
 
 	return NM_SETTING (dup);
@@ -338,6 +497,7 @@ compare_property (NMSetting *setting,
 	              const GParamSpec *prop_spec,
 	              NMSettingCompareFlags flags)
 {
+	const PropertyInfo *prop;
 	GValue value1 = { 0 };
 	GValue value2 = { 0 };
 	gboolean different;
@@ -366,13 +526,11 @@ compare_property (NMSetting *setting,
 			return TRUE;
 	}
 
-	g_value_init (&value1, prop_spec->value_type);
-	g_object_get_property (G_OBJECT (setting), prop_spec->name, &value1);
+	prop = property_info_get (prop_spec);
+	property_get_value (setting, prop, &value1);
+	property_get_value (other, prop, &value2);
 
-	g_value_init (&value2, prop_spec->value_type);
-	g_object_get_property (G_OBJECT (other), prop_spec->name, &value2);
-
-	different = g_param_values_cmp ((GParamSpec *) prop_spec, &value1, &value2);
+	different = prop->cmp ((GParamSpec *) prop_spec, &value1, &value2);
 
 	g_value_unset (&value1);
 	g_value_unset (&value2);
@@ -397,8 +555,7 @@ nm_setting_compare (NMSetting *a,
                     NMSetting *b,
                     NMSettingCompareFlags flags)
 {
-	GParamSpec **property_specs;
-	guint n_property_specs;
+	const SettingClassInfo *info;
 	gint same = TRUE;
 	guint i;
 
@@ -409,10 +566,13 @@ nm_setting_compare (NMSetting *a,
 	if (G_OBJECT_TYPE (a) != G_OBJECT_TYPE (b))
 		return FALSE;
 
+	if (a == b)
+		return TRUE;
+
 	/* And now all properties */
-	property_specs = g_object_class_list_properties (G_OBJECT_GET_CLASS (a), &n_property_specs);
-	for (i = 0; i < n_property_specs && same; i++) {
-		GParamSpec *prop_spec = property_specs[i];
+	info = setting_class_info_get (a);
+	for (i = 0; i < info->n_properties && same; i++) {
+		GParamSpec *prop_spec = info->properties[i]->pspec;
 
 		/* Fuzzy compare ignores secrets and properties defined with the FUZZY_IGNORE flag */
 		if (   (flags & NM_SETTING_COMPARE_FLAG_FUZZY)
@@ -425,7 +585,6 @@ nm_setting_compare (NMSetting *a,
 
 		same = NM_SETTING_GET_CLASS (a)->compare_property (a, b, prop_spec, flags);
 	}
-	g_free (property_specs);
 
 	return same;
 }
@@ -494,8 +653,7 @@ nm_setting_diff (NMSetting *a,
                  gboolean invert_results,
                  GHashTable **results)
 {
-	GParamSpec **property_specs;
-	guint n_property_specs;
+	const SettingClassInfo *info;
 	guint i;
 	NMSettingDiffResult a_result = NM_SETTING_DIFF_RESULT_IN_A;
 	NMSettingDiffResult b_result = NM_SETTING_DIFF_RESULT_IN_B;
@@ -529,10 +687,11 @@ nm_setting_diff (NMSetting *a,
 	}
 
 	/* And now all properties */
-	property_specs = g_object_class_list_properties (G_OBJECT_GET_CLASS (a), &n_property_specs);
+	info = setting_class_info_get (a);
 
-	for (i = 0; i < n_property_specs; i++) {
-		GParamSpec *prop_spec = property_specs[i];
+	for (i = 0; i < info->n_properties; i++) {
+		const PropertyInfo *prop = info->properties[i];
+		GParamSpec *prop_spec = prop->pspec;
 		GValue a_value = { 0 }, b_value = { 0 };
 		NMSettingDiffResult r = NM_SETTING_DIFF_RESULT_UNKNOWN, tmp;
 		gboolean different = TRUE;
@@ -544,13 +703,10 @@ nm_setting_diff (NMSetting *a,
 			continue;
 
 		if (b) {
-			g_value_init (&a_value, prop_spec->value_type);
-			g_object_get_property (G_OBJECT (a), prop_spec->name, &a_value);
+			property_get_value (a, prop, &a_value);
+			property_get_value (b, prop, &b_value);
 
-			g_value_init (&b_value, prop_spec->value_type);
-			g_object_get_property (G_OBJECT (b), prop_spec->name, &b_value);
-
-			different = !!g_param_values_cmp (prop_spec, &a_value, &b_value);
+			different = !!prop->cmp (prop_spec, &a_value, &b_value);
 			if (different) {
 				if (!g_param_value_defaults (prop_spec, &a_value))
 					r |= a_result;
@@ -568,7 +724,6 @@ nm_setting_diff (NMSetting *a,
 			g_hash_table_insert (*results, g_strdup (prop_spec->name), GUINT_TO_POINTER (tmp | r));
 		}
 	}
-	g_free (property_specs);
 
 	/* Don't return an empty hash table */
 	if (results_created && !g_hash_table_size (*results)) {
@@ -593,25 +748,21 @@ nm_setting_enumerate_values (NMSetting *setting,
 					    NMSettingValueIterFn func,
 					    gpointer user_data)
 {
-	GParamSpec **property_specs;
-	guint n_property_specs;
-	int i;
+	const SettingClassInfo *info;
+	guint i;
 
 	g_return_if_fail (NM_IS_SETTING (setting));
 	g_return_if_fail (func != NULL);
 
-	property_specs = g_object_class_list_properties (G_OBJECT_GET_CLASS (setting), &n_property_specs);
-	for (i = 0; i < n_property_specs; i++) {
-		GParamSpec *prop_spec = property_specs[i];
+	info = setting_class_info_get (setting);
+	for (i = 0; i < info->n_properties; i++) {
+		const PropertyInfo *prop = info->properties[i];
 		GValue value = { 0 };
 
-		g_value_init (&value, G_PARAM_SPEC_VALUE_TYPE (prop_spec));
-		g_object_get_property (G_OBJECT (setting), prop_spec->name, &value);
-		func (setting, prop_spec->name, &value, prop_spec->flags, user_data);
+		property_get_value (setting, prop, &value);
+		func (setting, prop->pspec->name, &value, prop->pspec->flags, user_data);
 		g_value_unset (&value);
 	}
-
-	g_free (property_specs);
 }
 
 /**
@@ -34,4 +34,13 @@ gboolean    _nm_utils_string_slist_validate (GSList *list,
 
 void        _nm_utils_register_value_transformations (void);
 
+const char *_nm_utils_str_intern   (const char *str);
+void        _nm_utils_str_release  (const char *str);
+
+GSList *    _nm_utils_str_slist_intern  (const GSList *list);
+void        _nm_utils_str_slist_release (GSList *list);
+
+GByteArray *_nm_utils_blob_intern  (const GByteArray *blob);
+void        _nm_utils_blob_release (GByteArray *blob);
+
 #endif
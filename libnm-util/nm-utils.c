@@ -256,6 +256,7 @@ void
 nm_utils_deinit (void)
 {
 	if (initialized) {
+		crypto_clear_caches ();
 		crypto_deinit ();
 		initialized = FALSE;
 	}
@@ -533,6 +534,177 @@ _nm_utils_string_slist_validate (GSList *list, const char **valid_values)
 	return TRUE;
 }
 
+/* Setting data is shared through two pools: equal strings and byte arrays
+ * held by any number of settings (and their duplicates) point at the same
+ * storage, refcounted by the pool.  Pooled data is immutable; replace it
+ * through the interning functions instead of modifying it in place.
+ */
+G_LOCK_DEFINE_STATIC (intern_lock);
+static GHashTable *intern_strings = NULL;  /* char * -> refcount */
+static GHashTable *intern_blobs = NULL;    /* GByteArray * -> refcount */
+
+static guint
+blob_hash (gconstpointer key)
+{
+	const GByteArray *blob = key;
+	guint h = 5381;
+	guint i;
+
+	for (i = 0; i < blob->len; i++)
+		h = (h << 5) + h + blob->data[i];
+	return h;
+}
+
+static gboolean
+blob_equal (gconstpointer a, gconstpointer b)
+{
+	const GByteArray *blob_a = a, *blob_b = b;
+
+	return    blob_a->len == blob_b->len
+	       && !memcmp (blob_a->data, blob_b->data, blob_a->len);
+}
+
+/**
+ * _nm_utils_str_intern:
+ * @str: (allow-none): string to intern
+ *
+ * Returns: the pooled copy of @str, with a reference the caller must give
+ * back with _nm_utils_str_release().  Equal strings always return the same
+ * pointer.
+ **/
+const char *
+_nm_utils_str_intern (const char *str)
+{
+	gpointer key = NULL, refcount = NULL;
+
+	if (!str)
+		return NULL;
+
+	G_LOCK (intern_lock);
+	if (G_UNLIKELY (!intern_strings))
+		intern_strings = g_hash_table_new (g_str_hash, g_str_equal);
+
+	if (g_hash_table_lookup_extended (intern_strings, str, &key, &refcount))
+		g_hash_table_insert (intern_strings, key, GUINT_TO_POINTER (GPOINTER_TO_UINT (refcount) + 1));
+	else {
+		key = g_strdup (str);
+		g_hash_table_insert (intern_strings, key, GUINT_TO_POINTER (1));
+	}
+	G_UNLOCK (intern_lock);
+
+	return key;
+}
+
+void
+_nm_utils_str_release (const char *str)
+{
+	gpointer key = NULL, refcount = NULL;
+	guint count;
+
+	if (!str)
+		return;
+
+	G_LOCK (intern_lock);
+	if (   !intern_strings
+	    || !g_hash_table_lookup_extended (intern_strings, str, &key, &refcount)
+	    || key != str) {
+		G_UNLOCK (intern_lock);
+		g_return_if_reached ();
+	}
+
+	count = GPOINTER_TO_UINT (refcount);
+	if (count > 1)
+		g_hash_table_insert (intern_strings, key, GUINT_TO_POINTER (count - 1));
+	else {
+		g_hash_table_remove (intern_strings, key);
+		g_free (key);
+	}
+	G_UNLOCK (intern_lock);
+}
+
+/* Interns every string in @list into a new list */
+GSList *
+_nm_utils_str_slist_intern (const GSList *list)
+{
+	GSList *interned = NULL;
+
+	for (; list; list = g_slist_next (list))
+		interned = g_slist_prepend (interned, (gpointer) _nm_utils_str_intern (list->data));
+	return g_slist_reverse (interned);
+}
+
+void
+_nm_utils_str_slist_release (GSList *list)
+{
+	GSList *iter;
+
+	for (iter = list; iter; iter = g_slist_next (iter))
+		_nm_utils_str_release (iter->data);
+	g_slist_free (list);
+}
+
+/**
+ * _nm_utils_blob_intern:
+ * @blob: (allow-none): byte array to intern
+ *
+ * Returns: the pooled copy of @blob, with a reference the caller must give
+ * back with _nm_utils_blob_release().  The returned array must not be
+ * modified.
+ **/
+GByteArray *
+_nm_utils_blob_intern (const GByteArray *blob)
+{
+	gpointer key = NULL, refcount = NULL;
+
+	if (!blob)
+		return NULL;
+
+	G_LOCK (intern_lock);
+	if (G_UNLIKELY (!intern_blobs))
+		intern_blobs = g_hash_table_new (blob_hash, blob_equal);
+
+	if (g_hash_table_lookup_extended (intern_blobs, blob, &key, &refcount))
+		g_hash_table_insert (intern_blobs, key, GUINT_TO_POINTER (GPOINTER_TO_UINT (refcount) + 1));
+	else {
+		GByteArray *copy;
+
+		copy = g_byte_array_sized_new (blob->len);
+		g_byte_array_append (copy, blob->data, blob->len);
+		key = copy;
+		g_hash_table_insert (intern_blobs, key, GUINT_TO_POINTER (1));
+	}
+	G_UNLOCK (intern_lock);
+
+	return key;
+}
+
+void
+_nm_utils_blob_release (GByteArray *blob)
+{
+	gpointer key = NULL, refcount = NULL;
+	guint count;
+
+	if (!blob)
+		return;
+
+	G_LOCK (intern_lock);
+	if (   !intern_blobs
+	    || !g_hash_table_lookup_extended (intern_blobs, blob, &key, &refcount)
+	    || key != blob) {
+		G_UNLOCK (intern_lock);
+		g_return_if_reached ();
+	}
+
+	count = GPOINTER_TO_UINT (refcount);
+	if (count > 1)
+		g_hash_table_insert (intern_blobs, key, GUINT_TO_POINTER (count - 1));
+	else {
+		g_hash_table_remove (intern_blobs, key);
+		g_byte_array_free (blob, TRUE);
+	}
+	G_UNLOCK (intern_lock);
+}
+
 static void
 _nm_utils_convert_strv_to_slist (const GValue *src_value, GValue *dest_value)
 {
@@ -0,0 +1,356 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ *
+ */
+
+/* Not run by "make check"; times the hot NMConnection/NMSetting paths
+ * over a large set of connections, and reports the resident memory a
+ * provisioning-sized profile set takes:
+ *
+ *   bench-settings [n-connections] [iterations] [memory-connections]
+ */
+
+#include <glib.h>
+#include <dbus/dbus-glib.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "nm-test-helpers.h"
+#include <nm-utils.h>
+
+#include "nm-connection.h"
+#include "nm-setting-connection.h"
+#include "nm-setting-wireless.h"
+#include "nm-setting-wireless-security.h"
+#include "nm-setting-ip4-config.h"
+#include "nm-setting-ip6-config.h"
+#include "nm-setting-8021x.h"
+
+static NMConnection *
+create_connection (guint i)
+{
+	NMConnection *connection;
+	NMSettingConnection *s_con;
+	NMSettingWireless *s_wifi;
+	NMSettingWirelessSecurity *s_wsec;
+	NMSettingIP4Config *s_ip4;
+	NMSettingIP6Config *s_ip6;
+	GByteArray *ssid;
+	char *id, *uuid;
+
+	connection = nm_connection_new ();
+
+	s_con = (NMSettingConnection *) nm_setting_connection_new ();
+	id = g_strdup_printf ("bench-%u", i);
+	uuid = nm_utils_uuid_generate ();
+	g_object_set (G_OBJECT (s_con),
+	              NM_SETTING_CONNECTION_ID, id,
+	              NM_SETTING_CONNECTION_UUID, uuid,
+	              NM_SETTING_CONNECTION_TYPE, NM_SETTING_WIRELESS_SETTING_NAME,
+	              NM_SETTING_CONNECTION_TIMESTAMP, (guint64) (1300000000 + i),
+	              NULL);
+	g_free (uuid);
+	nm_connection_add_setting (connection, NM_SETTING (s_con));
+
+	s_wifi = (NMSettingWireless *) nm_setting_wireless_new ();
+	ssid = g_byte_array_sized_new (32);
+	g_byte_array_append (ssid, (const guint8 *) id, strlen (id));
+	g_object_set (G_OBJECT (s_wifi),
+	              NM_SETTING_WIRELESS_SSID, ssid,
+	              NM_SETTING_WIRELESS_MODE, "infrastructure",
+	              NM_SETTING_WIRELESS_SEC, NM_SETTING_WIRELESS_SECURITY_SETTING_NAME,
+	              NULL);
+	g_byte_array_free (ssid, TRUE);
+	g_free (id);
+	nm_connection_add_setting (connection, NM_SETTING (s_wifi));
+
+	s_wsec = (NMSettingWirelessSecurity *) nm_setting_wireless_security_new ();
+	g_object_set (G_OBJECT (s_wsec),
+	              NM_SETTING_WIRELESS_SECURITY_KEY_MGMT, "wpa-psk",
+	              NM_SETTING_WIRELESS_SECURITY_PSK, "benchmark-passphrase",
+	              NULL);
+	nm_connection_add_setting (connection, NM_SETTING (s_wsec));
+
+	s_ip4 = (NMSettingIP4Config *) nm_setting_ip4_config_new ();
+	g_object_set (G_OBJECT (s_ip4),
+	              NM_SETTING_IP4_CONFIG_METHOD, NM_SETTING_IP4_CONFIG_METHOD_AUTO,
+	              NULL);
+	nm_connection_add_setting (connection, NM_SETTING (s_ip4));
+
+	s_ip6 = (NMSettingIP6Config *) nm_setting_ip6_config_new ();
+	g_object_set (G_OBJECT (s_ip6),
+	              NM_SETTING_IP6_CONFIG_METHOD, NM_SETTING_IP6_CONFIG_METHOD_AUTO,
+	              NULL);
+	nm_connection_add_setting (connection, NM_SETTING (s_ip6));
+
+	return connection;
+}
+
+static void
+report (const char *what, GTimer *timer, guint ops)
+{
+	double elapsed = g_timer_elapsed (timer, NULL);
+
+	fprintf (stdout, "%-24s %10u ops  %8.3f s  %8.3f us/op\n",
+	         what, ops, elapsed, ops ? (elapsed * 1000000.0) / ops : 0.0);
+}
+
+static void
+bench_compare_diff (GPtrArray *connections, GPtrArray *copies, guint iterations)
+{
+	GTimer *timer;
+	guint i, j, ops;
+
+	timer = g_timer_new ();
+
+	/* Identical connections: every property gets compared */
+	ops = 0;
+	g_timer_start (timer);
+	for (j = 0; j < iterations; j++) {
+		for (i = 0; i < connections->len; i++, ops++) {
+			if (!nm_connection_compare (g_ptr_array_index (connections, i),
+			                            g_ptr_array_index (copies, i),
+			                            NM_SETTING_COMPARE_FLAG_EXACT))
+				FAIL ("bench-compare", "duplicate connection %u differs", i);
+		}
+	}
+	g_timer_stop (timer);
+	report ("compare (same)", timer, ops);
+
+	/* Neighbours differ in id, uuid, ssid and timestamp */
+	ops = 0;
+	g_timer_start (timer);
+	for (j = 0; j < iterations; j++) {
+		for (i = 1; i < connections->len; i++, ops++) {
+			nm_connection_compare (g_ptr_array_index (connections, i - 1),
+			                       g_ptr_array_index (connections, i),
+			                       NM_SETTING_COMPARE_FLAG_EXACT);
+		}
+	}
+	g_timer_stop (timer);
+	report ("compare (different)", timer, ops);
+
+	ops = 0;
+	g_timer_start (timer);
+	for (j = 0; j < iterations; j++) {
+		for (i = 1; i < connections->len; i++, ops++) {
+			GHashTable *diffs = NULL;
+
+			if (nm_connection_diff (g_ptr_array_index (connections, i - 1),
+			                        g_ptr_array_index (connections, i),
+			                        NM_SETTING_COMPARE_FLAG_EXACT,
+			                        &diffs))
+				FAIL ("bench-diff", "connections %u and %u should differ", i - 1, i);
+			g_hash_table_destroy (diffs);
+		}
+	}
+	g_timer_stop (timer);
+	report ("diff", timer, ops);
+
+	ops = 0;
+	g_timer_start (timer);
+	for (j = 0; j < iterations; j++) {
+		for (i = 0; i < connections->len; i++, ops++) {
+			GHashTable *hash;
+
+			hash = nm_connection_to_hash (g_ptr_array_index (connections, i),
+			                              NM_SETTING_HASH_FLAG_ALL);
+			g_hash_table_destroy (hash);
+		}
+	}
+	g_timer_stop (timer);
+	report ("to_hash", timer, ops);
+
+	ops = 0;
+	g_timer_start (timer);
+	for (j = 0; j < iterations; j++) {
+		for (i = 0; i < connections->len; i++, ops++)
+			g_object_unref (nm_connection_duplicate (g_ptr_array_index (connections, i)));
+	}
+	g_timer_stop (timer);
+	report ("duplicate", timer, ops);
+
+	g_timer_destroy (timer);
+}
+
+/* The lookups policy and device matching do per candidate connection */
+static void
+bench_get_setting (GPtrArray *connections, guint iterations)
+{
+	GTimer *timer;
+	guint i, j, ops = 0, found = 0;
+
+	timer = g_timer_new ();
+
+	g_timer_start (timer);
+	for (j = 0; j < iterations * 10; j++) {
+		for (i = 0; i < connections->len; i++) {
+			NMConnection *connection = g_ptr_array_index (connections, i);
+
+			if (nm_connection_get_setting_connection (connection))
+				found++;
+			if (nm_connection_get_setting_wireless (connection))
+				found++;
+			if (nm_connection_get_setting (connection, NM_TYPE_SETTING_IP4_CONFIG))
+				found++;
+			/* Not present */
+			if (nm_connection_get_setting (connection, NM_TYPE_SETTING_802_1X))
+				found++;
+			ops += 4;
+		}
+	}
+	g_timer_stop (timer);
+	report ("get_setting", timer, ops);
+
+	if (found != (ops / 4) * 3)
+		FAIL ("bench-get-setting", "unexpected lookup results (%u of %u)", found, ops);
+
+	ops = 0;
+	g_timer_start (timer);
+	for (j = 0; j < iterations; j++) {
+		for (i = 0; i < connections->len; i++, ops++)
+			nm_connection_get_setting_by_name (g_ptr_array_index (connections, i),
+			                                   NM_SETTING_WIRELESS_SETTING_NAME);
+	}
+	g_timer_stop (timer);
+	report ("get_setting_by_name", timer, ops);
+
+	g_timer_destroy (timer);
+}
+
+static gulong
+get_rss_kib (void)
+{
+	char *contents = NULL;
+	gulong size = 0, resident = 0;
+
+	if (g_file_get_contents ("/proc/self/statm", &contents, NULL, NULL))
+		sscanf (contents, "%lu %lu", &size, &resident);
+	g_free (contents);
+	return resident * (sysconf (_SC_PAGESIZE) / 1024);
+}
+
+static void
+report_memory (const char *what, gulong before, gulong after, guint n)
+{
+	gulong used = after > before ? after - before : 0;
+
+	fprintf (stdout, "%-24s %10u conns %8lu KiB  %8lu B/conn\n",
+	         what, n, used, n ? (used * 1024) / n : 0);
+}
+
+/* Profiles as provisioning pushes them: unique id and uuid, but SSIDs,
+ * search domains and the rest drawn from a small shared set.
+ */
+static void
+bench_memory (guint n_connections)
+{
+	GPtrArray *connections, *copies;
+	gulong start, created, duplicated;
+	guint i;
+
+	connections = g_ptr_array_sized_new (n_connections);
+	copies = g_ptr_array_sized_new (n_connections);
+
+	start = get_rss_kib ();
+	for (i = 0; i < n_connections; i++) {
+		NMConnection *connection = create_connection (i);
+		NMSettingWireless *s_wifi;
+		NMSettingIP4Config *s_ip4;
+		GByteArray *ssid;
+		char *name;
+
+		s_wifi = nm_connection_get_setting_wireless (connection);
+		name = g_strdup_printf ("corp-site-%u", i % 100);
+		ssid = g_byte_array_sized_new (32);
+		g_byte_array_append (ssid, (const guint8 *) name, strlen (name));
+		g_object_set (G_OBJECT (s_wifi), NM_SETTING_WIRELESS_SSID, ssid, NULL);
+		g_byte_array_free (ssid, TRUE);
+		g_free (name);
+
+		s_ip4 = (NMSettingIP4Config *) nm_connection_get_setting (connection, NM_TYPE_SETTING_IP4_CONFIG);
+		nm_setting_ip4_config_add_dns_search (s_ip4, "corp.example.com");
+		nm_setting_ip4_config_add_dns_search (s_ip4, "example.com");
+
+		g_ptr_array_add (connections, connection);
+	}
+	created = get_rss_kib ();
+
+	/* What activation and agent requests do to each of them */
+	for (i = 0; i < n_connections; i++)
+		g_ptr_array_add (copies, nm_connection_duplicate (g_ptr_array_index (connections, i)));
+	duplicated = get_rss_kib ();
+
+	report_memory ("memory (create)", start, created, n_connections);
+	report_memory ("memory (duplicate)", created, duplicated, n_connections);
+
+	for (i = 0; i < n_connections; i++) {
+		g_object_unref (g_ptr_array_index (connections, i));
+		g_object_unref (g_ptr_array_index (copies, i));
+	}
+	g_ptr_array_free (connections, TRUE);
+	g_ptr_array_free (copies, TRUE);
+}
+
+int main (int argc, char **argv)
+{
+	GError *error = NULL;
+	GPtrArray *connections, *copies;
+	guint n_connections = 5000, iterations = 5, memory_connections = 50000;
+	guint i;
+
+	g_type_init ();
+
+	if (!nm_utils_init (&error))
+		FAIL ("nm-utils-init", "failed to initialize libnm-util: %s", error->message);
+
+	if (argc > 1)
+		n_connections = MAX (2, atoi (argv[1]));
+	if (argc > 2)
+		iterations = MAX (1, atoi (argv[2]));
+	if (argc > 3)
+		memory_connections = MAX (1, atoi (argv[3]));
+
+	/* First, before the timing runs leave freed memory in the heap */
+	bench_memory (memory_connections);
+
+	connections = g_ptr_array_sized_new (n_connections);
+	copies = g_ptr_array_sized_new (n_connections);
+	for (i = 0; i < n_connections; i++) {
+		NMConnection *connection = create_connection (i);
+
+		g_ptr_array_add (connections, connection);
+		g_ptr_array_add (copies, nm_connection_duplicate (connection));
+	}
+
+	fprintf (stdout, "%u connections, %u iterations\n", n_connections, iterations);
+	bench_compare_diff (connections, copies, iterations);
+	bench_get_setting (connections, iterations);
+
+	for (i = 0; i < n_connections; i++) {
+		g_object_unref (g_ptr_array_index (connections, i));
+		g_object_unref (g_ptr_array_index (copies, i));
+	}
+	g_ptr_array_free (connections, TRUE);
+	g_ptr_array_free (copies, TRUE);
+
+	return 0;
+}
+
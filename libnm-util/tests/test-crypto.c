@@ -113,6 +113,39 @@ test_load_cert (const char *path, const char *desc)
 	g_byte_array_free (array, TRUE);
 }
 
+/* A second load is served from the cache and must hand out its own copy */
+static void
+test_load_cert_cached (const char *path, const char *desc)
+{
+	GByteArray *first, *second;
+	NMCryptoFileFormat format = NM_CRYPTO_FILE_FORMAT_UNKNOWN;
+	GError *error = NULL;
+
+	first = crypto_load_and_verify_certificate (path, &format, &error);
+	ASSERT (first != NULL, desc,
+	        "couldn't read certificate file '%s': %d %s",
+	        path, error->code, error->message);
+
+	format = NM_CRYPTO_FILE_FORMAT_UNKNOWN;
+	second = crypto_load_and_verify_certificate (path, &format, &error);
+	ASSERT (second != NULL, desc,
+	        "couldn't re-read certificate file '%s': %d %s",
+	        path, error->code, error->message);
+	ASSERT (format == NM_CRYPTO_FILE_FORMAT_X509, desc,
+	        "%s: unexpected cached certificate format (expected %d, got %d)",
+	        path, NM_CRYPTO_FILE_FORMAT_X509, format);
+
+	ASSERT (first != second, desc, "%s: cached certificate data was not copied", path);
+	ASSERT (first->len == second->len && !memcmp (first->data, second->data, first->len), desc,
+	        "%s: cached certificate data differs", path);
+
+	memset (first->data, 0, first->len);
+	g_byte_array_free (first, TRUE);
+	g_byte_array_free (second, TRUE);
+
+	test_load_cert (path, desc);
+}
+
 static GByteArray *
 file_to_byte_array (const char *filename)
 {
@@ -321,9 +354,10 @@ int main (int argc, char **argv)
 	if (!crypto_init (&error))
 		FAIL ("crypto-init", "failed to initialize crypto: %s", error->message);
 
-	if (!strcmp (argv[1], "--cert"))
+	if (!strcmp (argv[1], "--cert")) {
 		test_load_cert (argv[2], "cert");
-	else if (!strcmp (argv[1], "--key")) {
+		test_load_cert_cached (argv[2], "cert-cached");
+	} else if (!strcmp (argv[1], "--key")) {
 		const char *decrypted_path = (argc == 5) ? argv[4] : NULL;
 
 		ASSERT (argc == 4 || argc == 5, "test-crypto",
@@ -336,6 +370,7 @@ int main (int argc, char **argv)
 		test_encrypt_private_key (argv[2], argv[3], "private-key-rencrypt");
 	} else if (!strcmp (argv[1], "--p12")) {
 		test_is_pkcs12 (argv[2], FALSE, "is-pkcs12");
+		test_is_pkcs12 (argv[2], FALSE, "is-pkcs12-cached");
 		test_load_pkcs12 (argv[2], argv[3], FALSE, "pkcs12-private-key");
 		test_load_pkcs12 (argv[2], "blahblahblah", TRUE, "pkcs12-private-key-bad-password");
 		test_load_pkcs12_no_password (argv[2], "pkcs12-private-key-no-password");
@@ -354,6 +389,7 @@ int main (int argc, char **argv)
 		ASSERT (argc > 2, "test-crypto", "unknown test type (not --cert, --key, or --p12)");
 	}
 
+	crypto_clear_caches ();
 	crypto_deinit ();
 
 	progname = g_path_get_basename (argv[0]);
@@ -22,6 +22,7 @@
 #include <glib.h>
 #include <dbus/dbus-glib.h>
 #include <string.h>
+#include <net/ethernet.h>
 
 #include "nm-test-helpers.h"
 #include <nm-utils.h>
@@ -1230,6 +1231,44 @@ test_setting_compare_id (void)
 	g_assert (success);
 }
 
+static void
+test_setting_duplicate_shares_data (void)
+{
+	NMSetting *old, *new;
+	GByteArray *mac;
+	const guint8 old_mac[ETH_ALEN] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x55 };
+	const guint8 new_mac[ETH_ALEN] = { 0x00, 0x11, 0x22, 0x33, 0x44, 0x66 };
+
+	old = nm_setting_wired_new ();
+	mac = g_byte_array_sized_new (ETH_ALEN);
+	g_byte_array_append (mac, old_mac, ETH_ALEN);
+	g_object_set (old,
+	              NM_SETTING_WIRED_PORT, "tp",
+	              NM_SETTING_WIRED_MAC_ADDRESS, mac,
+	              NULL);
+	g_byte_array_free (mac, TRUE);
+
+	/* Equal strings and blobs are stored once */
+	new = nm_setting_duplicate (old);
+	g_assert (nm_setting_wired_get_port (NM_SETTING_WIRED (old)) == nm_setting_wired_get_port (NM_SETTING_WIRED (new)));
+	g_assert (   nm_setting_wired_get_mac_address (NM_SETTING_WIRED (old))
+	          == nm_setting_wired_get_mac_address (NM_SETTING_WIRED (new)));
+
+	/* Changing one copy must leave the other alone */
+	mac = g_byte_array_sized_new (ETH_ALEN);
+	g_byte_array_append (mac, new_mac, ETH_ALEN);
+	g_object_set (new, NM_SETTING_WIRED_MAC_ADDRESS, mac, NULL);
+	g_byte_array_free (mac, TRUE);
+
+	g_assert (memcmp (nm_setting_wired_get_mac_address (NM_SETTING_WIRED (old))->data, old_mac, ETH_ALEN) == 0);
+	g_assert (memcmp (nm_setting_wired_get_mac_address (NM_SETTING_WIRED (new))->data, new_mac, ETH_ALEN) == 0);
+	g_assert (nm_setting_compare (old, new, NM_SETTING_COMPARE_FLAG_EXACT) == FALSE);
+
+	g_object_unref (new);
+	g_assert_cmpstr (nm_setting_wired_get_port (NM_SETTING_WIRED (old)), ==, "tp");
+	g_object_unref (old);
+}
+
 static void
 test_setting_compare_secrets (NMSettingSecretFlags secret_flags,
                               NMSettingCompareFlags comp_flags,
@@ -1317,6 +1356,7 @@ int main (int argc, char **argv)
 	test_setting_to_hash_no_secrets ();
 	test_setting_to_hash_only_secrets ();
 	test_setting_compare_id ();
+	test_setting_duplicate_shares_data ();
 	test_setting_compare_secrets (NM_SETTING_SECRET_FLAG_AGENT_OWNED, NM_SETTING_COMPARE_FLAG_IGNORE_AGENT_OWNED_SECRETS, TRUE);
 	test_setting_compare_secrets (NM_SETTING_SECRET_FLAG_NOT_SAVED, NM_SETTING_COMPARE_FLAG_IGNORE_NOT_SAVED_SECRETS, TRUE);
 	test_setting_compare_secrets (NM_SETTING_SECRET_FLAG_NONE, NM_SETTING_COMPARE_FLAG_IGNORE_SECRETS, TRUE);
@@ -60,6 +60,7 @@
 #include "nm-properties-changed-signal.h"
 #include "nm-dhcp-manager.h"
 #include "nm-netlink-utils.h"
+#include "nm-hw-control.h"
 
 #include "nm-device-ethernet-glue.h"
 
@@ -139,8 +140,6 @@ enum {
 };
 
 
-static gboolean supports_mii_carrier_detect (NMDeviceEthernet *dev);
-static gboolean supports_ethtool_carrier_detect (NMDeviceEthernet *dev);
 
 static GQuark
 nm_ethernet_error_quark (void)
@@ -603,40 +602,13 @@ nm_device_ethernet_get_address (NMDeviceEthernet *self, struct ether_addr *addr)
 static guint32
 nm_device_ethernet_get_speed (NMDeviceEthernet *self)
 {
-	int fd;
-	struct ifreq ifr;
-	struct ethtool_cmd edata = {
-		.cmd = ETHTOOL_GSET,
-	};
-	guint32 speed = 0;
+	NMHwState state;
 
 	g_return_val_if_fail (self != NULL, 0);
 
-	fd = socket (PF_INET, SOCK_DGRAM, 0);
-	if (fd < 0) {
-		nm_log_warn (LOGD_HW, "couldn't open control socket.");
-		return 0;
-	}
-
-	memset (&ifr, 0, sizeof (struct ifreq));
-	strncpy (ifr.ifr_name, nm_device_get_iface (NM_DEVICE (self)), IFNAMSIZ);
-	ifr.ifr_data = (char *) &edata;
-
-	if (ioctl (fd, SIOCETHTOOL, &ifr) < 0)
-		goto out;
-
-#if LINUX_VERSION_CODE < KERNEL_VERSION(2,6,27)
-	speed = edata.speed;
-#else
-	speed = ethtool_cmd_speed (&edata);
-#endif
-
-	if (speed == G_MAXUINT16 || speed == G_MAXUINT32)
-		speed = 0;
-
-out:
-	close (fd);
-	return speed;
+	nm_hw_control_refresh (nm_device_get_iface (NM_DEVICE (self)),
+	                       NM_HW_STATE_SPEED, NULL, &state);
+	return state.speed;
 }
 
 static void
@@ -701,11 +673,9 @@ real_update_hw_address (NMDevice *dev)
 	struct ifreq req;
 	int fd;
 
-	fd = socket (PF_INET, SOCK_DGRAM, 0);
-	if (fd < 0) {
-		nm_log_warn (LOGD_HW, "couldn't open control socket.");
+	fd = nm_hw_control_get_socket ();
+	if (fd < 0)
 		return;
-	}
 
 	memset (&req, 0, sizeof (struct ifreq));
 	strncpy (req.ifr_name, nm_device_get_iface (dev), IFNAMSIZ);
@@ -717,8 +687,6 @@ real_update_hw_address (NMDevice *dev)
 		            nm_device_get_iface (dev), errno);
 	} else
 		_update_hw_addr (self, (const guint8 *) &req.ifr_hwaddr.sa_data);
-
-	close (fd);
 }
 
 static void
@@ -726,40 +694,23 @@ real_update_permanent_hw_address (NMDevice *dev)
 {
 	NMDeviceEthernet *self = NM_DEVICE_ETHERNET (dev);
 	NMDeviceEthernetPrivate *priv = NM_DEVICE_ETHERNET_GET_PRIVATE (self);
-	struct ifreq req;
-	struct ethtool_perm_addr *epaddr = NULL;
-	int fd, ret;
-
-	fd = socket (PF_INET, SOCK_DGRAM, 0);
-	if (fd < 0) {
-		nm_log_warn (LOGD_HW, "couldn't open control socket.");
-		return;
-	}
+	struct ether_addr addr;
 
 	/* Get permanent MAC address */
-	memset (&req, 0, sizeof (struct ifreq));
-	strncpy (req.ifr_name, nm_device_get_iface (dev), IFNAMSIZ);
-
-	epaddr = g_malloc0 (sizeof (struct ethtool_perm_addr) + ETH_ALEN);
-	epaddr->cmd = ETHTOOL_GPERMADDR;
-	epaddr->size = ETH_ALEN;
-	req.ifr_data = (void *) epaddr;
-
-	errno = 0;
-	ret = ioctl (fd, SIOCETHTOOL, &req);
-	if ((ret < 0) || !nm_ethernet_address_is_valid ((struct ether_addr *) epaddr->data)) {
+	if (   !nm_hw_control_get_permanent_address (nm_device_get_ifindex (dev),
+	                                             nm_device_get_iface (dev),
+	                                             &addr)
+	    || !nm_ethernet_address_is_valid (&addr)) {
 		nm_log_err (LOGD_HW | LOGD_ETHER, "(%s): unable to read permanent MAC address (error %d)",
 		            nm_device_get_iface (dev), errno);
 		/* Fall back to current address */
-		memcpy (epaddr->data, &priv->hw_addr, ETH_ALEN);
+		memcpy (&addr, &priv->hw_addr, ETH_ALEN);
 	}
 
-	if (memcmp (&priv->perm_hw_addr, epaddr->data, ETH_ALEN)) {
-		memcpy (&priv->perm_hw_addr, epaddr->data, ETH_ALEN);
+	if (memcmp (&priv->perm_hw_addr, &addr, ETH_ALEN)) {
+		memcpy (&priv->perm_hw_addr, &addr, ETH_ALEN);
 		g_object_notify (G_OBJECT (dev), NM_DEVICE_ETHERNET_PERMANENT_HW_ADDRESS);
 	}
-
-	close (fd);
 }
 
 static void
@@ -792,14 +743,15 @@ real_update_initial_hw_address (NMDevice *dev)
 static guint32
 real_get_generic_capabilities (NMDevice *dev)
 {
-	NMDeviceEthernet *self = NM_DEVICE_ETHERNET (dev);
 	guint32	caps = NM_DEVICE_CAP_NONE;
 
 	/* cipsec devices are also explicitly unsupported at this time */
 	if (strstr (nm_device_get_iface (dev), "cipsec"))
 		return NM_DEVICE_CAP_NONE;
 
-	if (supports_ethtool_carrier_detect (self) || supports_mii_carrier_detect (self))
+	if (nm_hw_control_get_capabilities (nm_device_get_ifindex (dev),
+	                                    nm_device_get_iface (dev),
+	                                    NM_HW_CAP_ETHTOOL_LINK | NM_HW_CAP_MII))
 		caps |= NM_DEVICE_CAP_CARRIER_DETECT;
 
 	caps |= NM_DEVICE_CAP_NM_SUPPORTED;
@@ -2059,111 +2011,3 @@ nm_device_ethernet_class_init (NMDeviceEthernetClass *klass)
 
 	dbus_g_error_domain_register (NM_ETHERNET_ERROR, NULL, NM_TYPE_ETHERNET_ERROR);
 }
-
-
-/**************************************/
-/*    Ethtool capability detection    */
-/**************************************/
-
-static gboolean
-supports_ethtool_carrier_detect (NMDeviceEthernet *self)
-{
-	int fd;
-	struct ifreq ifr;
-	gboolean supports_ethtool = FALSE;
-	struct ethtool_cmd edata;
-
-	g_return_val_if_fail (self != NULL, FALSE);
-
-	fd = socket (PF_INET, SOCK_DGRAM, 0);
-	if (fd < 0) {
-		nm_log_err (LOGD_HW, "couldn't open control socket.");
-		return FALSE;
-	}
-
-	memset (&ifr, 0, sizeof (struct ifreq));
-	strncpy (ifr.ifr_name, nm_device_get_iface (NM_DEVICE (self)), IFNAMSIZ);
-
-	edata.cmd = ETHTOOL_GLINK;
-	ifr.ifr_data = (char *) &edata;
-
-	errno = 0;
-	if (ioctl (fd, SIOCETHTOOL, &ifr) < 0) {
-		nm_log_dbg (LOGD_HW | LOGD_ETHER, "SIOCETHTOOL failed: %d", errno);
-		goto out;
-	}
-
-	supports_ethtool = TRUE;
-
-out:
-	close (fd);
-	nm_log_dbg (LOGD_HW | LOGD_ETHER, "ethtool %s supported",
-	            supports_ethtool ? "is" : "not");
-	return supports_ethtool;
-}
-
-
-/**************************************/
-/*    MII capability detection        */
-/**************************************/
-#define _LINUX_IF_H
-#include <linux/mii.h>
-#undef _LINUX_IF_H
-
-static int
-mdio_read (NMDeviceEthernet *self, int fd, struct ifreq *ifr, int location)
-{
-	struct mii_ioctl_data *mii;
-	int val = -1;
-
-	g_return_val_if_fail (fd >= 0, -1);
-	g_return_val_if_fail (ifr != NULL, -1);
-
-	mii = (struct mii_ioctl_data *) &ifr->ifr_ifru;
-	mii->reg_num = location;
-
-	errno = 0;
-	if (ioctl (fd, SIOCGMIIREG, ifr) == 0) {
-		nm_log_dbg (LOGD_HW | LOGD_ETHER, "SIOCGMIIREG result 0x%X", mii->val_out);
-		val = mii->val_out;
-	} else {
-		nm_log_dbg (LOGD_HW | LOGD_ETHER, "SIOCGMIIREG failed: %d", errno);
-	}
-
-	return val;
-}
-
-static gboolean
-supports_mii_carrier_detect (NMDeviceEthernet *self)
-{
-	int fd, bmsr;
-	struct ifreq ifr;
-	gboolean supports_mii = FALSE;
-
-	g_return_val_if_fail (self != NULL, FALSE);
-
-	fd = socket (PF_INET, SOCK_DGRAM, 0);
-	if (fd < 0) {
-		nm_log_err (LOGD_HW, "couldn't open control socket.");
-		return FALSE;
-	}
-
-	memset (&ifr, 0, sizeof (struct ifreq));
-	strncpy (ifr.ifr_name, nm_device_get_iface (NM_DEVICE (self)), IFNAMSIZ);
-
-	errno = 0;
-	if (ioctl (fd, SIOCGMIIPHY, &ifr) < 0) {
-		nm_log_dbg (LOGD_HW | LOGD_ETHER, "SIOCGMIIPHY failed: %d", errno);
-		goto out;
-	}
-
-	/* If we can read the BMSR register, we assume that the card supports MII link detection */
-	bmsr = mdio_read (self, fd, &ifr, MII_BMSR);
-	supports_mii = (bmsr != -1) ? TRUE : FALSE;
-	nm_log_dbg (LOGD_HW | LOGD_ETHER, "MII %s supported",
-	            supports_mii ? "is" : "not");
-
-out:
-	close (fd);
-	return supports_mii;	
-}
@@ -57,6 +57,12 @@
 #include "nm-setting-ip6-config.h"
 #include "nm-system.h"
 #include "nm-settings-connection.h"
+#include "nm-hw-control.h"
+#include "nm-wifi-nl80211.h"
+#include "nm-wifi-scan-scheduler.h"
+#include "nm-wifi-bss-cache.h"
+#include "nm-wifi-candidate-index.h"
+#include "nm-wifi-ap-utils.h"
 
 static gboolean impl_device_get_access_points (NMDeviceWifi *device,
                                                GPtrArray **aps,
@@ -70,6 +76,16 @@ static gboolean impl_device_get_access_points (NMDeviceWifi *device,
 #define SCAN_INTERVAL_STEP 20
 #define SCAN_INTERVAL_MAX 120
 
+/* Link state polling interval; when nl80211 reports link changes and signal
+ * threshold crossings, only every PERIODIC_UPDATE_EVENTS_SKIP'th tick polls,
+ * which keeps the bitrate current.
+ */
+#define PERIODIC_UPDATE_INTERVAL    6
+#define PERIODIC_UPDATE_EVENTS_SKIP 5
+
+/* How long a BSS restored from the cache survives if scans don't see it */
+#define BSS_CACHE_RESTORE_GRACE 30
+
 #define WIRELESS_SECRETS_TRIES "wireless-secrets-tries"
 
 static void device_interface_init (NMDeviceInterface *iface_class);
@@ -147,11 +163,16 @@ struct _NMDeviceWifiPrivate {
 	glong             scheduled_scan_time;
 	guint8            scan_interval; /* seconds */
 	guint             pending_scan_id;
+	NMWifiScanScheduler *scan_sched;
+	NMWifiBssCache *  bss_cache;
+	NMWifiCandidateIndex *candidates;
 
 	Supplicant        supplicant;
 
 	guint32           failed_link_count;
 	guint             periodic_source_id;
+	guint             periodic_ticks;
+	NMWifiNl80211 *   nl80211;
 	guint             link_timeout_id;
 
 	/* Static options from driver */
@@ -161,6 +182,10 @@ struct _NMDeviceWifiPrivate {
 
 static guint32 nm_device_wifi_get_frequency (NMDeviceWifi *self);
 
+static NM80211Mode hw_state_get_mode (const NMHwState *hw);
+
+static void update_ssid_from_hw_state (NMDeviceWifi *self, const NMHwState *hw);
+
 static gboolean request_wireless_scan (gpointer user_data);
 
 static void schedule_scan (NMDeviceWifi *self, gboolean backoff);
@@ -193,6 +218,11 @@ static guint32 nm_device_wifi_get_bitrate (NMDeviceWifi *self);
 
 static void cull_scan_list (NMDeviceWifi *self);
 
+static void nl80211_event_cb (NMWifiNl80211 *nl,
+                              NMWifiNl80211Event event,
+                              int signal_dbm,
+                              gpointer user_data);
+
 /*****************************************************************/
 
 typedef enum {
@@ -301,107 +331,6 @@ ipw_rfkill_state_work (gpointer user_data)
 
 /*****************************************************************/
 
-/*
- * wireless_qual_to_percent
- *
- * Convert an iw_quality structure from SIOCGIWSTATS into a magical signal
- * strength percentage.
- *
- */
-static int
-wireless_qual_to_percent (const struct iw_quality *qual,
-                          const struct iw_quality *max_qual)
-{
-	int percent = -1;
-	int level_percent = -1;
-
-	g_return_val_if_fail (qual != NULL, -1);
-	g_return_val_if_fail (max_qual != NULL, -1);
-
-	nm_log_dbg (LOGD_WIFI,
-	            "QL: qual %d/%u/0x%X, level %d/%u/0x%X, noise %d/%u/0x%X, updated: 0x%X  ** MAX: qual %d/%u/0x%X, level %d/%u/0x%X, noise %d/%u/0x%X, updated: 0x%X",
-	            (__s8) qual->qual, qual->qual, qual->qual,
-	            (__s8) qual->level, qual->level, qual->level,
-	            (__s8) qual->noise, qual->noise, qual->noise,
-	            qual->updated,
-	            (__s8) max_qual->qual, max_qual->qual, max_qual->qual,
-	            (__s8) max_qual->level, max_qual->level, max_qual->level,
-	            (__s8) max_qual->noise, max_qual->noise, max_qual->noise,
-	            max_qual->updated);
-
-	/* Try using the card's idea of the signal quality first as long as it tells us what the max quality is.
-	 * Drivers that fill in quality values MUST treat them as percentages, ie the "Link Quality" MUST be 
-	 * bounded by 0 and max_qual->qual, and MUST change in a linear fashion.  Within those bounds, drivers
-	 * are free to use whatever they want to calculate "Link Quality".
-	 */
-	if ((max_qual->qual != 0) && !(max_qual->updated & IW_QUAL_QUAL_INVALID) && !(qual->updated & IW_QUAL_QUAL_INVALID))
-		percent = (int)(100 * ((double)qual->qual / (double)max_qual->qual));
-
-	/* If the driver doesn't specify a complete and valid quality, we have two options:
-	 *
-	 * 1) dBm: driver must specify max_qual->level = 0, and have valid values for
-	 *        qual->level and (qual->noise OR max_qual->noise)
-	 * 2) raw RSSI: driver must specify max_qual->level > 0, and have valid values for
-	 *        qual->level and max_qual->level
-	 *
-	 * This is the WEXT spec.  If this interpretation is wrong, I'll fix it.  Otherwise,
-	 * If drivers don't conform to it, they are wrong and need to be fixed.
-	 */
-
-	if (    (max_qual->level == 0) && !(max_qual->updated & IW_QUAL_LEVEL_INVALID)          /* Valid max_qual->level == 0 */
-		&& !(qual->updated & IW_QUAL_LEVEL_INVALID)                                     /* Must have valid qual->level */
-		&& (    ((max_qual->noise > 0) && !(max_qual->updated & IW_QUAL_NOISE_INVALID)) /* Must have valid max_qual->noise */
-			|| ((qual->noise > 0) && !(qual->updated & IW_QUAL_NOISE_INVALID)))     /*    OR valid qual->noise */
-	   ) {
-		/* Absolute power values (dBm) */
-
-		/* Reasonable fallbacks for dumb drivers that don't specify either level. */
-		#define FALLBACK_NOISE_FLOOR_DBM  -90
-		#define FALLBACK_SIGNAL_MAX_DBM   -20
-		int max_level = FALLBACK_SIGNAL_MAX_DBM;
-		int noise = FALLBACK_NOISE_FLOOR_DBM;
-		int level = qual->level - 0x100;
-
-		level = CLAMP (level, FALLBACK_NOISE_FLOOR_DBM, FALLBACK_SIGNAL_MAX_DBM);
-
-		if ((qual->noise > 0) && !(qual->updated & IW_QUAL_NOISE_INVALID))
-			noise = qual->noise - 0x100;
-		else if ((max_qual->noise > 0) && !(max_qual->updated & IW_QUAL_NOISE_INVALID))
-			noise = max_qual->noise - 0x100;
-		noise = CLAMP (noise, FALLBACK_NOISE_FLOOR_DBM, FALLBACK_SIGNAL_MAX_DBM);
-
-		/* A sort of signal-to-noise ratio calculation */
-		level_percent = (int)(100 - 70 *(
-		                                ((double)max_level - (double)level) /
-		                                ((double)max_level - (double)noise)));
-		nm_log_dbg (LOGD_WIFI, "QL1: level_percent is %d.  max_level %d, level %d, noise_floor %d.",
-		            level_percent, max_level, level, noise);
-	} else if (   (max_qual->level != 0)
-	           && !(max_qual->updated & IW_QUAL_LEVEL_INVALID) /* Valid max_qual->level as upper bound */
-	           && !(qual->updated & IW_QUAL_LEVEL_INVALID)) {
-		/* Relative power values (RSSI) */
-
-		int level = qual->level;
-
-		/* Signal level is relavtive (0 -> max_qual->level) */
-		level = CLAMP (level, 0, max_qual->level);
-		level_percent = (int)(100 * ((double)level / (double)max_qual->level));
-		nm_log_dbg (LOGD_WIFI, "QL2: level_percent is %d.  max_level %d, level %d.",
-		            level_percent, max_qual->level, level);
-	} else if (percent == -1) {
-		nm_log_dbg (LOGD_WIFI, "QL: Could not get quality %% value from driver.  Driver is probably buggy.");
-	}
-
-	/* If the quality percent was 0 or doesn't exist, then try to use signal levels instead */
-	if ((percent < 1) && (level_percent >= 0))
-		percent = level_percent;
-
-	nm_log_dbg (LOGD_WIFI, "QL: Final quality percent is %d (%d).",
-	            percent, CLAMP (percent, 0, 100));
-	return (CLAMP (percent, 0, 100));
-}
-
-
 /*
  * nm_device_wifi_update_signal_strength
  *
@@ -411,28 +340,14 @@ wireless_qual_to_percent (const struct iw_quality *qual,
  */
 static void
 nm_device_wifi_update_signal_strength (NMDeviceWifi *self,
-                                       NMAccessPoint *ap)
+                                       NMAccessPoint *ap,
+                                       const NMHwState *hw)
 {
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
-	const char *iface = nm_device_get_iface (NM_DEVICE (self));
-	int fd, percent = -1;
-
-	fd = socket (PF_INET, SOCK_DGRAM, 0);
-	if (fd >= 0) {
-		struct iwreq wrq;
-		struct iw_statistics stats;
-
-		memset (&stats, 0, sizeof (stats));
-
-		wrq.u.data.pointer = &stats;
-		wrq.u.data.length = sizeof (stats);
-		wrq.u.data.flags = 1;  /* Clear updated flag */
-		strncpy (wrq.ifr_name, iface, IFNAMSIZ);
+	int percent = -1;
 
-		if (ioctl (fd, SIOCGIWSTATS, &wrq) == 0)
-			percent = wireless_qual_to_percent (&stats.qual, &priv->max_qual);
-		close (fd);
-	}
+	if (hw->valid & NM_HW_STATE_STRENGTH)
+		percent = hw->strength;
 
 	/* Try to smooth out the strength.  Atmel cards, for example, will give no strength
 	 * one second and normal strength the next.
@@ -449,82 +364,25 @@ wireless_get_range (NMDeviceWifi *self,
                     struct iw_range *range,
                     guint32 *response_len)
 {
-	int fd, i = 26;
-	gboolean success = FALSE;
-	const char *iface;
-	struct iwreq wrq;
-
 	g_return_val_if_fail (NM_IS_DEVICE_WIFI (self), FALSE);
 	g_return_val_if_fail (range != NULL, FALSE);
 
-	iface = nm_device_get_iface (NM_DEVICE (self));
-
-	fd = socket (PF_INET, SOCK_DGRAM, 0);
-	if (fd < 0) {
-		nm_log_err (LOGD_HW, "(%s): couldn't open control socket.", iface);
-		return FALSE;
-	}
-
-	memset (&wrq, 0, sizeof (struct iwreq));
-	strncpy (wrq.ifr_name, iface, IFNAMSIZ);
-	wrq.u.data.pointer = (caddr_t) range;
-	wrq.u.data.length = sizeof (struct iw_range);
-
-	/* Need to give some drivers time to recover after suspend/resume
-	 * (ex ipw3945 takes a few seconds to talk to its regulatory daemon;
-	 * see rh bz#362421)
-	 */
-	while (i-- > 0) {
-		if (ioctl (fd, SIOCGIWRANGE, &wrq) == 0) {
-			if (response_len)
-				*response_len = wrq.u.data.length;
-			success = TRUE;
-			break;
-		} else if (errno != EAGAIN) {
-			nm_log_err (LOGD_HW | LOGD_WIFI,
-			            "(%s): couldn't get driver range information (%d).",
-			            iface, errno);
-			break;
-		}
-
-		g_usleep (G_USEC_PER_SEC / 4);
-	}
-
-	if (i <= 0) {
-		nm_log_warn (LOGD_HW | LOGD_WIFI,
-		             "(%s): driver took too long to respond to IWRANGE query.",
-		             iface);
-	}
-
-	close (fd);
-	return success;
+	return nm_hw_control_get_range (nm_device_get_ifindex (NM_DEVICE (self)),
+	                                nm_device_get_iface (NM_DEVICE (self)),
+	                                range,
+	                                response_len);
 }
 
 static guint32
 real_get_generic_capabilities (NMDevice *dev)
 {
-	int fd, err;
-	guint32 caps = NM_DEVICE_CAP_NONE;
-	struct iwreq wrq;
-	const char *iface = nm_device_get_iface (dev);
-
-	fd = socket (PF_INET, SOCK_DGRAM, 0);
-	if (fd < 0) {
-		nm_log_err (LOGD_HW, "(%s): couldn't open control socket.", iface);
-		return NM_DEVICE_CAP_NONE;
-	}
-
 	/* Cards that don't scan aren't supported */
-	memset (&wrq, 0, sizeof (struct iwreq));
-	strncpy (wrq.ifr_name, iface, IFNAMSIZ);
-	err = ioctl (fd, SIOCSIWSCAN, &wrq);
-	close (fd);
-	if ((err < 0) && (errno == EOPNOTSUPP))
-		caps = NM_DEVICE_CAP_NONE;
-	else
-		caps |= NM_DEVICE_CAP_NM_SUPPORTED;
+	if (nm_hw_control_get_capabilities (nm_device_get_ifindex (dev),
+	                                    nm_device_get_iface (dev),
+	                                    NM_HW_CAP_WEXT_SCAN))
+		return NM_DEVICE_CAP_NM_SUPPORTED;
 
-	return caps;
+	return NM_DEVICE_CAP_NONE;
 }
 
 #define WPA_CAPS (NM_WIFI_DEVICE_CAP_CIPHER_TKIP | \
@@ -578,22 +436,6 @@ get_wireless_capabilities (NMDeviceWifi *self, iwrange *range)
 }
 
 
-static guint32 iw_freq_to_uint32 (struct iw_freq *freq)
-{
-	if (freq->e == 0) {
-		/* Some drivers report channel not frequency.  Convert to a
-		 * frequency; but this assumes that the device is in b/g mode.
-		 */
-		if ((freq->m >= 1) && (freq->m <= 13))
-			return 2407 + (5 * freq->m);
-		else if (freq->m == 14)
-			return 2484;
-	}
-
-	return (guint32) (((double) freq->m) * pow (10, freq->e) / 1000000);
-}
-
-
 /* Until a new wireless-tools comes out that has the defs and the structure,
  * need to copy them here.
  */
@@ -664,7 +506,7 @@ constructor (GType type,
 
 	priv->num_freqs = MIN (range.num_frequency, IW_MAX_FREQUENCIES);
 	for (i = 0; i < priv->num_freqs; i++)
-		priv->freqs[i] = iw_freq_to_uint32 (&range.freq[i]);
+		priv->freqs[i] = nm_hw_control_freq_to_mhz (&range.freq[i]);
 
 	/* Check for the ability to scan specific SSIDs.  Until the scan_capa
 	 * field gets added to wireless-tools, need to work around that by casting
@@ -687,6 +529,16 @@ constructor (GType type,
 	/* 802.11 wireless-specific capabilities */
 	priv->capabilities = get_wireless_capabilities (self, &range);
 
+	priv->scan_sched = nm_wifi_scan_scheduler_new ();
+	priv->bss_cache = nm_wifi_bss_cache_get ();
+	priv->candidates = nm_wifi_candidate_index_new ();
+
+	/* Prefer nl80211 link events over polling WEXT when the driver has them */
+	priv->nl80211 = nm_wifi_nl80211_new (nm_device_get_iface (NM_DEVICE (self)),
+	                                     nm_device_get_ifindex (NM_DEVICE (self)),
+	                                     nl80211_event_cb,
+	                                     self);
+
 	/* Connect to the supplicant manager */
 	priv->supplicant.mgr = nm_supplicant_manager_get ();
 	g_assert (priv->supplicant.mgr);
@@ -834,10 +686,12 @@ get_ap_by_path (NMDeviceWifi *self, const char *path)
 static NMAccessPoint *
 get_active_ap (NMDeviceWifi *self,
                NMAccessPoint *ignore_ap,
-               gboolean match_hidden)
+               gboolean match_hidden,
+               const NMHwState *hw)
 {
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 	const char *iface = nm_device_get_iface (NM_DEVICE (self));
+	NMHwState local_hw;
 	struct ether_addr bssid;
 	const GByteArray *ssid;
 	GSList *iter;
@@ -848,7 +702,16 @@ get_active_ap (NMDeviceWifi *self,
 	NM80211Mode devmode;
 	guint32 devfreq;
 
-	nm_device_wifi_get_bssid (self, &bssid);
+	/* Read everything needed for matching from the card in one go */
+	if (!hw) {
+		nm_hw_control_refresh (iface,
+		                       NM_HW_STATE_BSSID | NM_HW_STATE_SSID | NM_HW_STATE_MODE | NM_HW_STATE_FREQ,
+		                       NULL,
+		                       &local_hw);
+		hw = &local_hw;
+	}
+
+	memcpy (&bssid, &hw->bssid, sizeof (bssid));
 	nm_log_dbg (LOGD_WIFI, "(%s): active BSSID: %02x:%02x:%02x:%02x:%02x:%02x",
 	            iface,
 	            bssid.ether_addr_octet[0], bssid.ether_addr_octet[1],
@@ -858,15 +721,16 @@ get_active_ap (NMDeviceWifi *self,
 	if (!nm_ethernet_address_is_valid (&bssid))
 		return NULL;
 
-	ssid = nm_device_wifi_get_ssid (self);
+	update_ssid_from_hw_state (self, hw);
+	ssid = priv->ssid;
 	nm_log_dbg (LOGD_WIFI, "(%s): active SSID: %s%s%s",
 	            iface,
 	            ssid ? "'" : "",
 	            ssid ? nm_utils_escape_ssid (ssid->data, ssid->len) : "(none)",
 	            ssid ? "'" : "");
 
-	devmode = nm_device_wifi_get_mode (self);
-	devfreq = nm_device_wifi_get_frequency (self);
+	devmode = hw_state_get_mode (hw);
+	devfreq = hw->freq;
 
 	/* When matching hidden APs, do a second pass that ignores the SSID check,
 	 * because NM might not yet know the SSID of the hidden AP in the scan list
@@ -985,6 +849,8 @@ update_seen_bssids_cache (NMDeviceWifi *self, NMAccessPoint *ap)
 			connection = nm_act_request_get_connection (req);
 			nm_settings_connection_add_seen_bssid (NM_SETTINGS_CONNECTION (connection),
 			                                       nm_ap_get_address (ap));
+			nm_wifi_scan_scheduler_add_known_bssid (NM_DEVICE_WIFI_GET_PRIVATE (self)->scan_sched,
+			                                        nm_ap_get_address (ap));
 		}
 	}
 }
@@ -1020,6 +886,13 @@ set_current_ap (NMDeviceWifi *self, NMAccessPoint *new_ap)
 		update_seen_bssids_cache (self, priv->current_ap);
 	}
 
+	/* Scans target the channels of the ESS we're in, if any */
+	if (priv->scan_sched && (new_ap != old_ap)) {
+		nm_wifi_scan_scheduler_set_link (priv->scan_sched,
+		                                 new_ap ? nm_ap_get_ssid (new_ap) : NULL,
+		                                 new_ap ? nm_ap_get_freq (new_ap) : 0);
+	}
+
 	/* Unref old AP here to ensure object lives if new_ap == old_ap */
 	if (old_ap)
 		g_object_unref (old_ap);
@@ -1033,12 +906,35 @@ set_current_ap (NMDeviceWifi *self, NMAccessPoint *new_ap)
 	g_free (old_path);
 }
 
+static void
+start_roaming_scans (NMDeviceWifi *self)
+{
+	nm_log_info (LOGD_WIFI_SCAN, "(%s): link quality low, starting background roaming scans",
+	             nm_device_get_iface (NM_DEVICE (self)));
+
+	/* Pulls the next scan in to the short roaming interval */
+	schedule_scan (self, FALSE);
+}
+
 static void
 periodic_update (NMDeviceWifi *self)
 {
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 	NMAccessPoint *new_ap;
-	guint32 new_rate;
+	NMHwState hw;
+
+	/* Grab all link parameters at once, from nl80211 if possible */
+	if (!priv->nl80211 || !nm_wifi_nl80211_get_link (priv->nl80211, &hw)) {
+		nm_hw_control_refresh (nm_device_get_iface (NM_DEVICE (self)),
+		                         NM_HW_STATE_BSSID
+		                       | NM_HW_STATE_SSID
+		                       | NM_HW_STATE_MODE
+		                       | NM_HW_STATE_FREQ
+		                       | NM_HW_STATE_BITRATE
+		                       | NM_HW_STATE_STRENGTH,
+		                       &priv->max_qual,
+		                       &hw);
+	}
 
 	/* In IBSS mode, most newer firmware/drivers do "BSS coalescing" where
 	 * multiple IBSS stations using the same SSID will eventually switch to
@@ -1049,20 +945,17 @@ periodic_update (NMDeviceWifi *self)
 	 * current AP with it, if the current AP is adhoc.
 	 */
 	if (priv->current_ap && (nm_ap_get_mode (priv->current_ap) == NM_802_11_MODE_ADHOC)) {
-		struct ether_addr bssid = { {0x0, 0x0, 0x0, 0x0, 0x0, 0x0} };
-
-		nm_device_wifi_get_bssid (self, &bssid);
 		/* 0x02 means "locally administered" and should be OR-ed into
 		 * the first byte of IBSS BSSIDs.
 		 */
-		if (   (bssid.ether_addr_octet[0] & 0x02)
-		    && nm_ethernet_address_is_valid (&bssid))
-			nm_ap_set_address (priv->current_ap, &bssid);
+		if (   (hw.bssid.ether_addr_octet[0] & 0x02)
+		    && nm_ethernet_address_is_valid (&hw.bssid))
+			nm_ap_set_address (priv->current_ap, &hw.bssid);
 	}
 
-	new_ap = get_active_ap (self, NULL, FALSE);
+	new_ap = get_active_ap (self, NULL, FALSE, &hw);
 	if (new_ap)
-		nm_device_wifi_update_signal_strength (self, new_ap);
+		nm_device_wifi_update_signal_strength (self, new_ap, &hw);
 
 	if ((new_ap || priv->current_ap) && (new_ap != priv->current_ap)) {
 		const struct ether_addr *new_bssid = NULL;
@@ -1095,13 +988,32 @@ periodic_update (NMDeviceWifi *self)
 		set_current_ap (self, new_ap);
 	}
 
-	new_rate = nm_device_wifi_get_bitrate (self);
-	if (new_rate != priv->rate) {
-		priv->rate = new_rate;
+	if (   priv->current_ap
+	    && nm_wifi_scan_scheduler_update_strength (priv->scan_sched, nm_ap_get_strength (priv->current_ap)))
+		start_roaming_scans (self);
+
+	if (hw.bitrate != priv->rate) {
+		priv->rate = hw.bitrate;
 		g_object_notify (G_OBJECT (self), NM_DEVICE_WIFI_BITRATE);
 	}
 }
 
+static void
+link_update (NMDeviceWifi *self)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+
+	/* BSSID and signal strength have meaningful values only if the device
+	   is activated and not scanning */
+	if (nm_device_get_state (NM_DEVICE (self)) != NM_DEVICE_STATE_ACTIVATED)
+		return;
+
+	if (nm_supplicant_interface_get_scanning (priv->supplicant.iface))
+		return;
+
+	periodic_update (self);
+}
+
 /*
  * nm_device_wifi_periodic_update
  *
@@ -1113,21 +1025,39 @@ nm_device_wifi_periodic_update (gpointer data)
 {
 	NMDeviceWifi *self = NM_DEVICE_WIFI (data);
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
-	NMDeviceState state;
 
-	/* BSSID and signal strength have meaningful values only if the device
-	   is activated and not scanning */
-	state = nm_device_get_state (NM_DEVICE (self));
-	if (state != NM_DEVICE_STATE_ACTIVATED)
-		goto out;
+	/* nl80211 link and signal events drive the updates; the bitrate still
+	 * needs the occasional poll.
+	 */
+	if (   priv->nl80211
+	    && nm_wifi_nl80211_has_signal_events (priv->nl80211)
+	    && (++priv->periodic_ticks % PERIODIC_UPDATE_EVENTS_SKIP))
+		return TRUE;
 
-	if (nm_supplicant_interface_get_scanning (priv->supplicant.iface))
-		goto out;
+	link_update (self);
+	return TRUE;
+}
 
-	periodic_update (self);
+static void
+nl80211_event_cb (NMWifiNl80211 *nl,
+                  NMWifiNl80211Event event,
+                  int signal_dbm,
+                  gpointer user_data)
+{
+	NMDeviceWifi *self = NM_DEVICE_WIFI (user_data);
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 
-out:
-	return TRUE;
+	/* Signal dropping below the CQM threshold kicks off roaming scans
+	 * without waiting for the polled strength to catch up.
+	 */
+	if (   (event & NM_WIFI_NL80211_EVENT_SIGNAL)
+	    && nm_device_get_state (NM_DEVICE (self)) == NM_DEVICE_STATE_ACTIVATED
+	    && nm_wifi_scan_scheduler_update_strength (priv->scan_sched,
+	                                               nm_ap_utils_level_to_quality (signal_dbm)))
+		start_roaming_scans (self);
+
+	/* Refresh link state right away instead of waiting for the next poll */
+	link_update (self);
 }
 
 static gboolean
@@ -1166,7 +1096,9 @@ real_bring_up (NMDevice *dev)
 	NMDeviceWifi *self = NM_DEVICE_WIFI (dev);
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 
-	priv->periodic_source_id = g_timeout_add_seconds (6, nm_device_wifi_periodic_update, self);
+	priv->periodic_source_id = g_timeout_add_seconds (PERIODIC_UPDATE_INTERVAL,
+	                                                  nm_device_wifi_periodic_update,
+	                                                  self);
 	return TRUE;
 }
 
@@ -1261,6 +1193,9 @@ real_take_down (NMDevice *dev)
 
 	cleanup_association_attempt (self, TRUE);
 	set_current_ap (self, NULL);
+
+	/* Make sure what we've seen survives suspend or shutdown */
+	nm_wifi_bss_cache_flush (priv->bss_cache);
 	remove_all_aps (self);
 }
 
@@ -1595,79 +1530,65 @@ real_is_available (NMDevice *dev)
 	return TRUE;
 }
 
-static NMConnection *
-real_get_best_auto_connection (NMDevice *dev,
-                               GSList *connections,
-                               char **specific_object)
+static void
+add_known_network (const GByteArray *ssid,
+                   const struct ether_addr *bssids,
+                   guint num_bssids,
+                   gpointer user_data)
 {
-	NMDeviceWifi *self = NM_DEVICE_WIFI (dev);
-	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
-	GSList *iter, *ap_iter;
-
-	for (iter = connections; iter; iter = g_slist_next (iter)) {
-		NMConnection *connection = NM_CONNECTION (iter->data);
-		NMSettingConnection *s_con;
-		NMSettingWireless *s_wireless;
-		const GByteArray *mac;
-		const GSList *mac_blacklist, *mac_blacklist_iter;
-		gboolean mac_blacklist_found = FALSE;
-		NMSettingIP4Config *s_ip4;
-		const char *method = NULL;
-
-		s_con = (NMSettingConnection *) nm_connection_get_setting (connection, NM_TYPE_SETTING_CONNECTION);
-		if (s_con == NULL)
-			continue;
-		if (strcmp (nm_setting_connection_get_connection_type (s_con), NM_SETTING_WIRELESS_SETTING_NAME))
-			continue;
-		if (!nm_setting_connection_get_autoconnect (s_con))
-			continue;
-
-		s_wireless = (NMSettingWireless *) nm_connection_get_setting (connection, NM_TYPE_SETTING_WIRELESS);
-		if (!s_wireless)
-			continue;
-
-		mac = nm_setting_wireless_get_mac_address (s_wireless);
-		if (mac && memcmp (mac->data, &priv->perm_hw_addr, ETH_ALEN))
-			continue;
-
-		/* Check for MAC address blacklist */
-		mac_blacklist = nm_setting_wireless_get_mac_address_blacklist (s_wireless);
-		for (mac_blacklist_iter = mac_blacklist; mac_blacklist_iter;
-		     mac_blacklist_iter = g_slist_next (mac_blacklist_iter)) {
-			struct ether_addr addr;
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (user_data);
+	guint i;
 
-			if (!ether_aton_r (mac_blacklist_iter->data, &addr)) {
-				g_warn_if_reached ();
-				continue;
-			}
-			if (memcmp (&addr, &priv->perm_hw_addr, ETH_ALEN) == 0) {
-				mac_blacklist_found = TRUE;
-				break;
-			}
-		}
-		/* Found device MAC address in the blacklist - do not use this connection */
-		if (mac_blacklist_found)
-			continue;
+	nm_wifi_scan_scheduler_add_known_ssid (priv->scan_sched, ssid);
+	for (i = 0; i < num_bssids; i++)
+		nm_wifi_scan_scheduler_add_known_bssid (priv->scan_sched, &bssids[i]);
+}
 
-		/* Use the connection if it's a shared connection */
-		s_ip4 = (NMSettingIP4Config *) nm_connection_get_setting (connection, NM_TYPE_SETTING_IP4_CONFIG);
-		if (s_ip4)
-			method = nm_setting_ip4_config_get_method (s_ip4);
+static void
+real_auto_candidate_changed (NMDevice *dev,
+                             NMConnection *connection,
+                             gboolean eligible)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (dev);
 
-		if (s_ip4 && !strcmp (method, NM_SETTING_IP4_CONFIG_METHOD_SHARED))
-			return connection;
+	if (eligible)
+		nm_wifi_candidate_index_add (priv->candidates, connection);
+	else
+		nm_wifi_candidate_index_remove (priv->candidates, connection);
+}
 
-		for (ap_iter = priv->ap_list; ap_iter; ap_iter = g_slist_next (ap_iter)) {
-			NMAccessPoint *ap = NM_AP (ap_iter->data);
+static NMConnection *
+real_find_auto_candidate (NMDevice *dev,
+                          NMDeviceCandidateFunc filter,
+                          gpointer filter_data,
+                          char **specific_object)
+{
+	NMDeviceWifi *self = NM_DEVICE_WIFI (dev);
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	NMConnection *connection;
+	NMAccessPoint *ap = NULL;
 
-			if (nm_ap_check_compatible (ap, connection)) {
-				/* All good; connection is usable */
-				*specific_object = (char *) nm_ap_get_dbus_path (ap);
-				return connection;
-			}
-		}
+	/* Shared connections are usable right away; anything else needs a
+	 * compatible AP in the scan list.
+	 */
+	connection = nm_wifi_candidate_index_find (priv->candidates,
+	                                           priv->perm_hw_addr,
+	                                           priv->ap_list,
+	                                           filter,
+	                                           filter_data,
+	                                           &ap);
+	if (connection && ap)
+		*specific_object = (char *) nm_ap_get_dbus_path (ap);
+
+	/* Remember which networks we know so scans can target their
+	 * channels; only redone when the eligible connections changed.
+	 */
+	if (nm_wifi_candidate_index_known_changed (priv->candidates)) {
+		nm_wifi_scan_scheduler_clear_known (priv->scan_sched);
+		nm_wifi_candidate_index_foreach_known (priv->candidates, add_known_network, self);
 	}
-	return NULL;
+
+	return connection;
 }
 
 /*
@@ -1725,6 +1646,14 @@ impl_device_get_access_points (NMDeviceWifi *self,
 	return TRUE;
 }
 
+static NM80211Mode
+hw_state_get_mode (const NMHwState *hw)
+{
+	if (hw->valid & NM_HW_STATE_MODE)
+		return hw->mode;
+	return NM_802_11_MODE_UNKNOWN;
+}
+
 /*
  * nm_device_get_mode
  *
@@ -1734,40 +1663,13 @@ impl_device_get_access_points (NMDeviceWifi *self,
 NM80211Mode
 nm_device_wifi_get_mode (NMDeviceWifi *self)
 {
-	int fd;
-	NM80211Mode mode = NM_802_11_MODE_UNKNOWN;
-	const char *iface;
-	struct iwreq wrq;
+	NMHwState hw;
 
 	g_return_val_if_fail (self != NULL, NM_802_11_MODE_UNKNOWN);
 
-	fd = socket (PF_INET, SOCK_DGRAM, 0);
-	if (fd < 0)
-		goto out;
-
-	memset (&wrq, 0, sizeof (struct iwreq));
-	iface = nm_device_get_iface (NM_DEVICE (self));
-	strncpy (wrq.ifr_name, iface, IFNAMSIZ);
-
-	if (ioctl (fd, SIOCGIWMODE, &wrq) == 0) {
-		switch (wrq.u.mode) {
-		case IW_MODE_ADHOC:
-			mode = NM_802_11_MODE_ADHOC;
-			break;
-		case IW_MODE_INFRA:
-			mode = NM_802_11_MODE_INFRA;
-			break;
-		default:
-			break;
-		}
-	} else {
-		if (errno != ENODEV)
-			nm_log_warn (LOGD_HW | LOGD_WIFI, "(%s): error %d getting card mode", iface, errno);
-	}
-	close (fd);
-
-out:
-	return mode;
+	nm_hw_control_refresh (nm_device_get_iface (NM_DEVICE (self)),
+	                       NM_HW_STATE_MODE, NULL, &hw);
+	return hw_state_get_mode (&hw);
 }
 
 
@@ -1791,7 +1693,7 @@ nm_device_wifi_set_mode (NMDeviceWifi *self, const NM80211Mode mode)
 	if (nm_device_wifi_get_mode (self) == mode)
 		return TRUE;
 
-	fd = socket (PF_INET, SOCK_DGRAM, 0);
+	fd = nm_hw_control_get_socket ();
 	if (fd < 0)
 		goto out;
 
@@ -1815,7 +1717,6 @@ nm_device_wifi_set_mode (NMDeviceWifi *self, const NM80211Mode mode)
 			nm_log_err (LOGD_HW | LOGD_WIFI, "(%s): error setting mode %d", iface, mode);
 	} else
 		success = TRUE;
-	close (fd);
 
 out:
 	return success;
@@ -1831,30 +1732,32 @@ out:
 static guint32
 nm_device_wifi_get_frequency (NMDeviceWifi *self)
 {
-	int fd;
-	guint32 freq = 0;
-	const char *iface;
-	struct iwreq wrq;
+	NMHwState hw;
 
 	g_return_val_if_fail (self != NULL, 0);
 
-	fd = socket (PF_INET, SOCK_DGRAM, 0);
-	if (fd < 0)
-		return 0;
+	nm_hw_control_refresh (nm_device_get_iface (NM_DEVICE (self)),
+	                       NM_HW_STATE_FREQ, NULL, &hw);
+	return hw.freq;
+}
 
-	memset (&wrq, 0, sizeof (struct iwreq));
-	iface = nm_device_get_iface (NM_DEVICE (self));
-	strncpy (wrq.ifr_name, iface, IFNAMSIZ);
+static void
+update_ssid_from_hw_state (NMDeviceWifi *self, const NMHwState *hw)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 
-	if (ioctl (fd, SIOCGIWFREQ, &wrq) < 0) {
-		nm_log_warn (LOGD_HW | LOGD_WIFI,
-		             "(%s): error getting frequency: %s",
-		             iface, strerror (errno));
-	} else
-		freq = iw_freq_to_uint32 (&wrq.u.freq);
+	if (!(hw->valid & NM_HW_STATE_SSID))
+		return;
 
-	close (fd);
-	return freq;
+	if (priv->ssid) {
+		g_byte_array_free (priv->ssid, TRUE);
+		priv->ssid = NULL;
+	}
+
+	if (!nm_utils_is_empty_ssid (hw->ssid, hw->ssid_len)) {
+		priv->ssid = g_byte_array_sized_new (hw->ssid_len);
+		g_byte_array_append (priv->ssid, hw->ssid, hw->ssid_len);
+	}
 }
 
 /*
@@ -1866,47 +1769,14 @@ nm_device_wifi_get_frequency (NMDeviceWifi *self)
 const GByteArray *
 nm_device_wifi_get_ssid (NMDeviceWifi *self)
 {
-	NMDeviceWifiPrivate *priv;
-	int sk;
-	struct iwreq wrq;
-	char ssid[IW_ESSID_MAX_SIZE + 2];
-	guint32 len;
+	NMHwState hw;
 
 	g_return_val_if_fail (self != NULL, NULL);
-	priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
-
-	sk = socket (AF_INET, SOCK_DGRAM, 0);
-	if (sk == -1) {
-		nm_log_err (LOGD_HW, "couldn't create socket: %d.", errno);
-		return NULL;
-	}
-
-	memset (ssid, 0, sizeof (ssid));
-	wrq.u.essid.pointer = (caddr_t) &ssid;
-	wrq.u.essid.length = sizeof (ssid);
-	wrq.u.essid.flags = 0;
-	strncpy (wrq.ifr_name, nm_device_get_iface (NM_DEVICE (self)), IFNAMSIZ);
-
-	if (ioctl (sk, SIOCGIWESSID, &wrq) < 0) {
-		nm_log_err (LOGD_HW | LOGD_WIFI, "(%s): couldn't get SSID: %d",
-		            nm_device_get_iface (NM_DEVICE (self)), errno);
-		goto out;
-	}
-
-	if (priv->ssid) {
-		g_byte_array_free (priv->ssid, TRUE);
-		priv->ssid = NULL;
-	}
-
-	len = wrq.u.essid.length;
-	if (!nm_utils_is_empty_ssid ((guint8 *) ssid, len)) {
-		priv->ssid = g_byte_array_sized_new (len);
-		g_byte_array_append (priv->ssid, (const guint8 *) ssid, len);
-	}
 
-out:
-	close (sk);
-	return priv->ssid;
+	nm_hw_control_refresh (nm_device_get_iface (NM_DEVICE (self)),
+	                       NM_HW_STATE_SSID, NULL, &hw);
+	update_ssid_from_hw_state (self, &hw);
+	return NM_DEVICE_WIFI_GET_PRIVATE (self)->ssid;
 }
 
 
@@ -1920,21 +1790,13 @@ out:
 static guint32
 nm_device_wifi_get_bitrate (NMDeviceWifi *self)
 {
-	int err = -1, fd;
-	struct iwreq wrq;
+	NMHwState hw;
 
 	g_return_val_if_fail (self != NULL, 0);
 
-	fd = socket (PF_INET, SOCK_DGRAM, 0);
-	if (fd < 0)
-		return 0;
-
-	memset (&wrq, 0, sizeof (wrq));
-	strncpy (wrq.ifr_name, nm_device_get_iface (NM_DEVICE (self)), IFNAMSIZ);
-	err = ioctl (fd, SIOCGIWRATE, &wrq);
-	close (fd);
-
-	return ((err == 0) ? wrq.u.bitrate.value / 1000 : 0);
+	nm_hw_control_refresh (nm_device_get_iface (NM_DEVICE (self)),
+	                       NM_HW_STATE_BITRATE, NULL, &hw);
+	return hw.bitrate;
 }
 
 /*
@@ -1947,26 +1809,14 @@ void
 nm_device_wifi_get_bssid (NMDeviceWifi *self,
                           struct ether_addr *bssid)
 {
-	int fd;
-	struct iwreq wrq;
+	NMHwState hw;
 
 	g_return_if_fail (self != NULL);
 	g_return_if_fail (bssid != NULL);
 
-	memset (bssid, 0, sizeof (struct ether_addr));
-
-	fd = socket (PF_INET, SOCK_DGRAM, 0);
-	if (fd < 0) {
-		nm_log_err (LOGD_WIFI, "failed to open control socket.");
-		return;
-	}
-
-	memset (&wrq, 0, sizeof (wrq));
-	strncpy (wrq.ifr_name, nm_device_get_iface (NM_DEVICE (self)), IFNAMSIZ);
-	if (ioctl (fd, SIOCGIWAP, &wrq) == 0)
-		memcpy (bssid->ether_addr_octet, &(wrq.u.ap_addr.sa_data), ETH_ALEN);
-
-	close (fd);
+	nm_hw_control_refresh (nm_device_get_iface (NM_DEVICE (self)),
+	                       NM_HW_STATE_BSSID, NULL, &hw);
+	memcpy (bssid, &hw.bssid, sizeof (struct ether_addr));
 }
 
 
@@ -2079,13 +1929,23 @@ request_wireless_scan (gpointer user_data)
 	gboolean backoff = FALSE;
 
 	if (check_scanning_allowed (self)) {
-		nm_log_dbg (LOGD_WIFI_SCAN, "(%s): scanning requested",
-		            nm_device_get_iface (NM_DEVICE (self)));
+		NMWifiScanType type;
+		GArray *freqs = NULL;
+		const GByteArray *ssid = NULL;
+
+		type = nm_wifi_scan_scheduler_next (priv->scan_sched, &freqs, &ssid);
+		nm_log_dbg (LOGD_WIFI_SCAN, "(%s): %s scan requested (%u channels)",
+		            nm_device_get_iface (NM_DEVICE (self)),
+		            nm_wifi_scan_type_to_string (type),
+		            freqs ? freqs->len : 0);
 
-		if (nm_supplicant_interface_request_scan (priv->supplicant.iface)) {
+		if (nm_supplicant_interface_request_scan (priv->supplicant.iface, ssid, freqs)) {
 			/* success */
 			backoff = TRUE;
 		}
+
+		if (freqs)
+			g_array_free (freqs, TRUE);
 	} else {
 		nm_log_dbg (LOGD_WIFI_SCAN, "(%s): scan requested but not allowed at this time",
 		            nm_device_get_iface (NM_DEVICE (self)));
@@ -2108,17 +1968,23 @@ schedule_scan (NMDeviceWifi *self, gboolean backoff)
 {
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 	GTimeVal now;
+	guint next_scan;
 
 	g_get_current_time (&now);
 
-	/* Cancel the pending scan if it would happen later than (now + the scan_interval) */
+	/* While associated the scheduler stretches (good link) or shortens
+	 * (roaming) the interval; otherwise it's the usual backoff.
+	 */
+	next_scan = nm_wifi_scan_scheduler_get_interval (priv->scan_sched, priv->scan_interval);
+
+	/* Cancel the pending scan if it would happen later than (now + next_scan) */
 	if (priv->pending_scan_id) {
-		if (now.tv_sec + priv->scan_interval < priv->scheduled_scan_time)
+		if (now.tv_sec + next_scan < priv->scheduled_scan_time)
 			cancel_pending_scan (self);
 	}
 
 	if (!priv->pending_scan_id) {
-		guint factor = 2, next_scan = priv->scan_interval;
+		guint factor = 2;
 
 		if (    nm_device_is_activating (NM_DEVICE (self))
 		    || (nm_device_get_state (NM_DEVICE (self)) == NM_DEVICE_STATE_ACTIVATED))
@@ -2128,7 +1994,7 @@ schedule_scan (NMDeviceWifi *self, gboolean backoff)
 		                                               request_wireless_scan,
 		                                               self);
 
-		priv->scheduled_scan_time = now.tv_sec + priv->scan_interval;
+		priv->scheduled_scan_time = now.tv_sec + next_scan;
 		if (backoff && (priv->scan_interval < (SCAN_INTERVAL_MAX / factor))) {
 				priv->scan_interval += (SCAN_INTERVAL_STEP / factor);
 				/* Ensure the scan interval will never be less than 20s... */
@@ -2308,19 +2174,8 @@ merge_scanned_ap (NMDeviceWifi *self,
 
 	found_ap = nm_ap_match_in_list (merge_ap, priv->ap_list, strict_match);
 	if (found_ap) {
-		nm_ap_set_flags (found_ap, nm_ap_get_flags (merge_ap));
-		nm_ap_set_wpa_flags (found_ap, nm_ap_get_wpa_flags (merge_ap));
-		nm_ap_set_rsn_flags (found_ap, nm_ap_get_rsn_flags (merge_ap));
-		nm_ap_set_strength (found_ap, nm_ap_get_strength (merge_ap));
-		nm_ap_set_last_seen (found_ap, nm_ap_get_last_seen (merge_ap));
-		nm_ap_set_broadcast (found_ap, nm_ap_get_broadcast (merge_ap));
-		nm_ap_set_freq (found_ap, nm_ap_get_freq (merge_ap));
-		nm_ap_set_max_bitrate (found_ap, nm_ap_get_max_bitrate (merge_ap));
-
-		/* If the AP is noticed in a scan, it's automatically no longer
-		 * fake, since it clearly exists somewhere.
-		 */
-		nm_ap_set_fake (found_ap, FALSE);
+		/* Usually nothing but last-seen and a bit of RSSI jitter changed */
+		nm_ap_update_from_scan (found_ap, merge_ap);
 	} else {
 		/* New entry in the list */
 		// FIXME: figure out if reference counts are correct here for AP objects
@@ -2331,6 +2186,19 @@ merge_scanned_ap (NMDeviceWifi *self,
 	}
 }
 
+static guint
+get_prune_interval (NMDeviceWifi *self)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	guint full_period_s;
+
+	/* Targeted scans don't refresh APs on other channels, so give them
+	 * until a full scan has had a chance to see them again.
+	 */
+	full_period_s = nm_wifi_scan_scheduler_get_full_period (priv->scan_sched, priv->scan_interval);
+	return MAX (SCAN_INTERVAL_MAX * 3, full_period_s + SCAN_INTERVAL_MAX);
+}
+
 static void
 cull_scan_list (NMDeviceWifi *self)
 {
@@ -2341,6 +2209,7 @@ cull_scan_list (NMDeviceWifi *self)
 	NMActRequest *req;
 	const char *cur_ap_path = NULL;
 	guint32 removed = 0, total = 0;
+	guint prune_interval_s;
 
 	g_return_if_fail (self != NULL);
 	priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
@@ -2354,6 +2223,8 @@ cull_scan_list (NMDeviceWifi *self)
 	nm_log_dbg (LOGD_WIFI_SCAN, "(%s): checking scan list for outdated APs",
 	            nm_device_get_iface (NM_DEVICE (self)));
 
+	prune_interval_s = get_prune_interval (self);
+
 	/* Walk the access point list and remove any access points older than
 	 * three times the inactive scan interval.
 	 */
@@ -2361,7 +2232,6 @@ cull_scan_list (NMDeviceWifi *self)
 		NMAccessPoint * ap = NM_AP (elt->data);
 		const glong     ap_time = nm_ap_get_last_seen (ap);
 		gboolean        keep = FALSE;
-		const guint     prune_interval_s = SCAN_INTERVAL_MAX * 3;
 
 		/* Don't ever prune the AP we're currently associated with */
 		if (cur_ap_path && !strcmp (cur_ap_path, nm_ap_get_dbus_path (ap)))
@@ -2402,6 +2272,43 @@ cull_scan_list (NMDeviceWifi *self)
 	            removed, total);
 }
 
+static guint
+restore_cached_aps (NMDeviceWifi *self)
+{
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
+	GSList *aps, *iter;
+	GTimeVal now;
+	glong expire;
+	guint count = 0;
+
+	aps = nm_wifi_bss_cache_get_aps (priv->bss_cache, NM_WIFI_BSS_CACHE_MAX_AGE);
+	if (!aps)
+		return 0;
+
+	/* Restored BSSes only stick around if a scan sees them again soon */
+	g_get_current_time (&now);
+	expire = now.tv_sec - get_prune_interval (self) + BSS_CACHE_RESTORE_GRACE;
+
+	for (iter = aps; iter; iter = g_slist_next (iter)) {
+		NMAccessPoint *ap = NM_AP (iter->data);
+
+		nm_ap_set_last_seen (ap, expire);
+		nm_wifi_scan_scheduler_bss_seen (priv->scan_sched,
+		                                 nm_ap_get_address (ap),
+		                                 nm_ap_get_ssid (ap),
+		                                 nm_ap_get_freq (ap));
+		merge_scanned_ap (self, ap);
+		g_object_unref (ap);
+		count++;
+	}
+	g_slist_free (aps);
+
+	nm_log_info (LOGD_WIFI_SCAN, "(%s): restored %u access points from the BSS cache",
+	             nm_device_get_iface (NM_DEVICE (self)), count);
+	nm_device_wifi_ap_list_print (self);
+	return count;
+}
+
 static void
 supplicant_iface_new_bss_cb (NMSupplicantInterface *iface,
                              GHashTable *properties,
@@ -2425,6 +2332,13 @@ supplicant_iface_new_bss_cb (NMSupplicantInterface *iface,
 
 		/* Add the AP to the device's AP list */
 		merge_scanned_ap (self, ap);
+
+		/* Remember which channel it's on for targeted scans */
+		nm_wifi_scan_scheduler_bss_seen (NM_DEVICE_WIFI_GET_PRIVATE (self)->scan_sched,
+		                                 nm_ap_get_address (ap),
+		                                 nm_ap_get_ssid (ap),
+		                                 nm_ap_get_freq (ap));
+		nm_wifi_bss_cache_update (NM_DEVICE_WIFI_GET_PRIVATE (self)->bss_cache, ap);
 		g_object_unref (ap);
 
 		/* Remove outdated access points */
@@ -2614,6 +2528,17 @@ supplicant_iface_state_cb (NMSupplicantInterface *iface,
 			                         NM_DEVICE_STATE_REASON_SUPPLICANT_AVAILABLE);
 		}
 
+		/* Offer recently seen BSSes as candidates right away and make the
+		 * first scan a quick one of their channels; otherwise start with a
+		 * full scan.
+		 */
+		if (   !priv->ap_list
+		    && nm_device_get_state (device) > NM_DEVICE_STATE_UNAVAILABLE
+		    && restore_cached_aps (self))
+			nm_wifi_scan_scheduler_start_from_history (priv->scan_sched);
+		else
+			nm_wifi_scan_scheduler_force_full (priv->scan_sched);
+
 		nm_log_dbg (LOGD_WIFI_SCAN,
 		            "(%s): supplicant ready, requesting initial scan",
 		            nm_device_get_iface (device));
@@ -2751,6 +2676,7 @@ supplicant_iface_notify_scanning_cb (NMSupplicantInterface *iface,
                                      GParamSpec *pspec,
                                      NMDeviceWifi *self)
 {
+	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
 	gboolean scanning;
 
 	scanning = nm_supplicant_interface_get_scanning (iface);
@@ -2759,6 +2685,16 @@ supplicant_iface_notify_scanning_cb (NMSupplicantInterface *iface,
 	            scanning ? "scanning" : "not scanning");
 
 	g_object_notify (G_OBJECT (self), "scanning");
+
+	/* Drop APs (including ones restored from the BSS cache) that the
+	 * finished scan didn't see, even if it found nothing new.
+	 */
+	if (!scanning)
+		cull_scan_list (self);
+
+	/* Without polling, catch up on link events skipped during the scan */
+	if (!scanning && priv->nl80211 && nm_wifi_nl80211_has_signal_events (priv->nl80211))
+		link_update (self);
 }
 
 static void
@@ -3032,11 +2968,9 @@ real_update_hw_address (NMDevice *dev)
 	struct ifreq req;
 	int fd;
 
-	fd = socket (PF_INET, SOCK_DGRAM, 0);
-	if (fd < 0) {
-		nm_log_err (LOGD_HW, "could not open control socket.");
+	fd = nm_hw_control_get_socket ();
+	if (fd < 0)
 		return;
-	}
 
 	memset (&req, 0, sizeof (struct ifreq));
 	strncpy (req.ifr_name, nm_device_get_iface (dev), IFNAMSIZ);
@@ -3046,8 +2980,6 @@ real_update_hw_address (NMDevice *dev)
 		            nm_device_get_iface (dev), errno);
 	} else
 		_update_hw_addr (self, (const guint8 *) &req.ifr_hwaddr.sa_data);
-
-	close (fd);
 }
 
 static void
@@ -3055,41 +2987,23 @@ real_update_permanent_hw_address (NMDevice *dev)
 {
 	NMDeviceWifi *self = NM_DEVICE_WIFI (dev);
 	NMDeviceWifiPrivate *priv = NM_DEVICE_WIFI_GET_PRIVATE (self);
-	struct ifreq req;
-	struct ethtool_perm_addr *epaddr = NULL;
-	int fd, ret;
-
-	fd = socket (PF_INET, SOCK_DGRAM, 0);
-	if (fd < 0) {
-		nm_log_err (LOGD_HW, "could not open control socket.");
-		return;
-	}
+	struct ether_addr addr;
 
 	/* Get permanent MAC address */
-	memset (&req, 0, sizeof (struct ifreq));
-	strncpy (req.ifr_name, nm_device_get_iface (dev), IFNAMSIZ);
-
-	epaddr = g_malloc0 (sizeof (struct ethtool_perm_addr) + ETH_ALEN);
-	epaddr->cmd = ETHTOOL_GPERMADDR;
-	epaddr->size = ETH_ALEN;
-	req.ifr_data = (void *) epaddr;
-
-	errno = 0;
-	ret = ioctl (fd, SIOCETHTOOL, &req);
-	if ((ret < 0) || !nm_ethernet_address_is_valid ((struct ether_addr *) epaddr->data)) {
+	if (   !nm_hw_control_get_permanent_address (nm_device_get_ifindex (dev),
+	                                             nm_device_get_iface (dev),
+	                                             &addr)
+	    || !nm_ethernet_address_is_valid (&addr)) {
 		nm_log_err (LOGD_HW | LOGD_ETHER, "(%s): unable to read permanent MAC address (error %d)",
 		            nm_device_get_iface (dev), errno);
 		/* Fall back to current address */
-		memcpy (epaddr->data, &priv->hw_addr, ETH_ALEN);
+		memcpy (&addr, &priv->hw_addr, ETH_ALEN);
 	}
 
-	if (memcmp (&priv->perm_hw_addr, epaddr->data, ETH_ALEN)) {
-		memcpy (&priv->perm_hw_addr, epaddr->data, ETH_ALEN);
+	if (memcmp (&priv->perm_hw_addr, &addr, ETH_ALEN)) {
+		memcpy (&priv->perm_hw_addr, &addr, ETH_ALEN);
 		g_object_notify (G_OBJECT (dev), NM_DEVICE_WIFI_PERMANENT_HW_ADDRESS);
 	}
-
-	g_free (epaddr);
-	close (fd);
 }
 
 static void
@@ -3468,7 +3382,7 @@ activation_success_handler (NMDevice *dev)
 	if (!nm_ap_get_max_bitrate (ap))
 		nm_ap_set_max_bitrate (ap, nm_device_wifi_get_bitrate (self));
 
-	tmp_ap = get_active_ap (self, ap, TRUE);
+	tmp_ap = get_active_ap (self, ap, TRUE, NULL);
 	if (tmp_ap) {
 		const GByteArray *ssid = nm_ap_get_ssid (tmp_ap);
 
@@ -3771,6 +3685,11 @@ dispose (GObject *object)
 		priv->periodic_source_id = 0;
 	}
 
+	if (priv->nl80211) {
+		nm_wifi_nl80211_free (priv->nl80211);
+		priv->nl80211 = NULL;
+	}
+
 	cleanup_association_attempt (self, TRUE);
 	supplicant_interface_release (self);
 
@@ -3787,6 +3706,21 @@ dispose (GObject *object)
 	set_current_ap (self, NULL);
 	remove_all_aps (self);
 
+	if (priv->scan_sched) {
+		nm_wifi_scan_scheduler_free (priv->scan_sched);
+		priv->scan_sched = NULL;
+	}
+
+	if (priv->bss_cache) {
+		nm_wifi_bss_cache_unref (priv->bss_cache);
+		priv->bss_cache = NULL;
+	}
+
+	if (priv->candidates) {
+		nm_wifi_candidate_index_free (priv->candidates);
+		priv->candidates = NULL;
+	}
+
 	g_free (priv->ipw_rfkill_path);
 	if (priv->ipw_rfkill_id) {
 		g_source_remove (priv->ipw_rfkill_id);
@@ -3879,7 +3813,8 @@ nm_device_wifi_class_init (NMDeviceWifiClass *klass)
 	parent_class->update_hw_address = real_update_hw_address;
 	parent_class->update_permanent_hw_address = real_update_permanent_hw_address;
 	parent_class->update_initial_hw_address = real_update_initial_hw_address;
-	parent_class->get_best_auto_connection = real_get_best_auto_connection;
+	parent_class->auto_candidate_changed = real_auto_candidate_changed;
+	parent_class->find_auto_candidate = real_find_auto_candidate;
 	parent_class->is_available = real_is_available;
 	parent_class->check_connection_compatible = real_check_connection_compatible;
 	parent_class->complete_connection = real_complete_connection;
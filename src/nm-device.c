@@ -49,6 +49,7 @@
 #include "nm-netlink-monitor.h"
 #include "nm-netlink-utils.h"
 #include "nm-netlink-compat.h"
+#include "nm-hw-control.h"
 #include "nm-setting-ip4-config.h"
 #include "nm-setting-ip6-config.h"
 #include "nm-setting-connection.h"
@@ -576,6 +577,49 @@ nm_device_get_best_auto_connection (NMDevice *dev,
 	return NM_DEVICE_GET_CLASS (dev)->get_best_auto_connection (dev, connections, specific_object);
 }
 
+gboolean
+nm_device_has_auto_candidates (NMDevice *dev)
+{
+	g_return_val_if_fail (NM_IS_DEVICE (dev), FALSE);
+
+	return NM_DEVICE_GET_CLASS (dev)->find_auto_candidate != NULL;
+}
+
+void
+nm_device_auto_candidate_changed (NMDevice *dev,
+                                  NMConnection *connection,
+                                  gboolean eligible)
+{
+	g_return_if_fail (NM_IS_DEVICE (dev));
+	g_return_if_fail (NM_IS_CONNECTION (connection));
+
+	if (NM_DEVICE_GET_CLASS (dev)->auto_candidate_changed)
+		NM_DEVICE_GET_CLASS (dev)->auto_candidate_changed (dev, connection, eligible);
+}
+
+NMConnection *
+nm_device_find_auto_candidate (NMDevice *dev,
+                               NMDeviceCandidateFunc filter,
+                               gpointer filter_data,
+                               char **specific_object)
+{
+	guint32 caps;
+
+	g_return_val_if_fail (NM_IS_DEVICE (dev), NULL);
+	g_return_val_if_fail (specific_object != NULL, NULL);
+	g_return_val_if_fail (*specific_object == NULL, NULL);
+
+	caps = nm_device_get_capabilities (dev);
+	/* Don't use devices that SUCK */
+	if (!(caps & NM_DEVICE_CAP_NM_SUPPORTED))
+		return NULL;
+
+	if (!NM_DEVICE_GET_CLASS (dev)->find_auto_candidate)
+		return NULL;
+
+	return NM_DEVICE_GET_CLASS (dev)->find_auto_candidate (dev, filter, filter_data, specific_object);
+}
+
 gboolean
 nm_device_complete_connection (NMDevice *self,
                                NMConnection *connection,
@@ -3096,11 +3140,9 @@ nm_device_update_ip4_address (NMDevice *self)
 	
 	g_return_if_fail (self  != NULL);
 
-	fd = socket (PF_INET, SOCK_DGRAM, 0);
-	if (fd < 0) {
-		nm_log_err (LOGD_IP4, "couldn't open control socket.");
+	fd = nm_hw_control_get_socket ();
+	if (fd < 0)
 		return;
-	}
 
 	memset (&req, 0, sizeof (struct ifreq));
 	strncpy (req.ifr_name, nm_device_get_ip_iface (self), IFNAMSIZ);
@@ -3109,7 +3151,6 @@ nm_device_update_ip4_address (NMDevice *self)
 		if (new_address != nm_device_get_ip4_address (self))
 			NM_DEVICE_GET_PRIVATE (self)->ip4_address = new_address;
 	}
-	close (fd);
 }
 
 static gboolean
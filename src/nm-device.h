@@ -56,6 +56,9 @@ typedef struct {
 	GObject parent;
 } NMDevice;
 
+/* Whether @connection may be auto-activated right now */
+typedef gboolean (*NMDeviceCandidateFunc) (NMConnection *connection, gpointer user_data);
+
 typedef struct {
 	GObjectClass parent;
 
@@ -84,6 +87,19 @@ typedef struct {
 	                                             GSList *connections,
 	                                             char **specific_object);
 
+	/* Devices that index their auto-activation candidates are told about
+	 * eligible connections as they change, instead of being handed all of
+	 * them on every pass.
+	 */
+	void           (* auto_candidate_changed)   (NMDevice *self,
+	                                             NMConnection *connection,
+	                                             gboolean eligible);
+
+	NMConnection * (* find_auto_candidate)      (NMDevice *self,
+	                                             NMDeviceCandidateFunc filter,
+	                                             gpointer filter_data,
+	                                             char **specific_object);
+
 	gboolean    (* check_connection_compatible) (NMDevice *self,
 	                                             NMConnection *connection,
 	                                             GError **error);
@@ -162,6 +178,17 @@ NMConnection * nm_device_get_best_auto_connection (NMDevice *dev,
                                                    GSList *connections,
                                                    char **specific_object);
 
+gboolean       nm_device_has_auto_candidates (NMDevice *dev);
+
+void           nm_device_auto_candidate_changed (NMDevice *dev,
+                                                 NMConnection *connection,
+                                                 gboolean eligible);
+
+NMConnection * nm_device_find_auto_candidate (NMDevice *dev,
+                                              NMDeviceCandidateFunc filter,
+                                              gpointer filter_data,
+                                              char **specific_object);
+
 gboolean nm_device_complete_connection (NMDevice *device,
                                         NMConnection *connection,
                                         const char *specific_object,
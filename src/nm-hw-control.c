@@ -0,0 +1,879 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2005 - 2011 Red Hat, Inc.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <math.h>
+#include <iwlib.h>
+#include <sys/ioctl.h>
+#include <linux/sockios.h>
+#include <linux/version.h>
+#include <linux/ethtool.h>
+#include <linux/rtnetlink.h>
+
+#define _LINUX_IF_H
+#include <linux/mii.h>
+#undef _LINUX_IF_H
+
+#include "nm-hw-control.h"
+#include "nm-netlink-monitor.h"
+#include "nm-netlink-compat.h"
+#include "nm-logging.h"
+#include "NetworkManager.h"
+
+/*
+ * Device hardware control
+ *
+ * All ioctl-based queries against network interfaces go through one
+ * long-lived control socket instead of opening and closing a fresh socket
+ * for every request.  Capability probes (ethtool, MII, WEXT scanning) don't
+ * change while the link exists, so their results are cached per ifindex and
+ * dropped when netlink reports the link was removed or brought up/down.
+ */
+
+typedef struct {
+	guint32 probed;  /* NMHwCapabilities that have been checked */
+	guint32 caps;    /* NMHwCapabilities that are supported */
+} CapsEntry;
+
+/* Probes run ahead of device creation by nm_hw_control_prefetch() */
+typedef struct {
+	int ifindex;
+	char *iface;
+	gboolean wireless;
+
+	guint32 probed;
+	guint32 caps;
+
+	gboolean range_tried;
+	gboolean range_ok;
+	struct iw_range range;
+	guint32 range_len;
+
+	gboolean perm_addr_tried;
+	gboolean perm_addr_ok;
+	int perm_addr_errno;
+	struct ether_addr perm_addr;
+} Prefetch;
+
+typedef struct {
+	NMHwPrefetchFunc callback;
+	gpointer user_data;
+} PrefetchWaiter;
+
+#define PREFETCH_MAX_THREADS 8
+
+static int control_fd = -1;
+static GHashTable *caps_cache = NULL;
+static NMNetlinkMonitor *monitor = NULL;
+
+static GThreadPool *prefetch_pool = NULL;
+static guint prefetch_pending = 0;
+static GSList *prefetch_waiters = NULL;
+static guint prefetch_waiters_id = 0;
+static GHashTable *prefetched = NULL;   /* ifindex -> Prefetch */
+
+static void
+netlink_notification (NMNetlinkMonitor *mon, struct nl_msg *msg, gpointer user_data)
+{
+	struct nlmsghdr *hdr = nlmsg_hdr (msg);
+	struct ifinfomsg *ifi;
+
+	if (hdr->nlmsg_type != RTM_NEWLINK && hdr->nlmsg_type != RTM_DELLINK)
+		return;
+
+	if (!nlmsg_valid_hdr (hdr, sizeof (*ifi)))
+		return;
+
+	ifi = nlmsg_data (hdr);
+
+	/* Drivers can report different capabilities depending on whether the
+	 * interface is up (MII in particular), so re-probe on IFF_UP changes.
+	 */
+	if (hdr->nlmsg_type == RTM_DELLINK || (ifi->ifi_change & IFF_UP))
+		nm_hw_control_invalidate (ifi->ifi_index);
+}
+
+static void
+ensure_caps_cache (void)
+{
+	if (caps_cache)
+		return;
+
+	caps_cache = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, g_free);
+
+	monitor = nm_netlink_monitor_get ();
+	g_signal_connect (monitor, "notification",
+	                  G_CALLBACK (netlink_notification), NULL);
+}
+
+/**
+ * nm_hw_control_get_socket:
+ *
+ * Returns: the shared control socket used for interface ioctls, or -1 if
+ * it could not be created.  The caller must not close the socket.
+ **/
+int
+nm_hw_control_get_socket (void)
+{
+	if (control_fd >= 0)
+		return control_fd;
+
+	control_fd = socket (PF_INET, SOCK_DGRAM, 0);
+	if (control_fd < 0) {
+		nm_log_err (LOGD_HW, "couldn't open control socket: %d", errno);
+		return -1;
+	}
+
+	/* Don't leak it into spawned children (dhclient, dnsmasq, pppd, etc) */
+	fcntl (control_fd, F_SETFD, FD_CLOEXEC);
+	return control_fd;
+}
+
+static gboolean
+probe_ethtool_link (int fd, const char *iface)
+{
+	struct ifreq ifr;
+	struct ethtool_value edata;
+
+	memset (&ifr, 0, sizeof (struct ifreq));
+	strncpy (ifr.ifr_name, iface, IFNAMSIZ);
+
+	memset (&edata, 0, sizeof (edata));
+	edata.cmd = ETHTOOL_GLINK;
+	ifr.ifr_data = (char *) &edata;
+
+	errno = 0;
+	if (ioctl (fd, SIOCETHTOOL, &ifr) < 0) {
+		nm_log_dbg (LOGD_HW, "(%s): SIOCETHTOOL failed: %d", iface, errno);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+static int
+mdio_read (int fd, struct ifreq *ifr, int location)
+{
+	struct mii_ioctl_data *mii;
+	int val = -1;
+
+	mii = (struct mii_ioctl_data *) &ifr->ifr_ifru;
+	mii->reg_num = location;
+
+	errno = 0;
+	if (ioctl (fd, SIOCGMIIREG, ifr) == 0) {
+		nm_log_dbg (LOGD_HW, "SIOCGMIIREG result 0x%X", mii->val_out);
+		val = mii->val_out;
+	} else
+		nm_log_dbg (LOGD_HW, "SIOCGMIIREG failed: %d", errno);
+
+	return val;
+}
+
+static gboolean
+probe_mii (int fd, const char *iface)
+{
+	struct ifreq ifr;
+
+	memset (&ifr, 0, sizeof (struct ifreq));
+	strncpy (ifr.ifr_name, iface, IFNAMSIZ);
+
+	errno = 0;
+	if (ioctl (fd, SIOCGMIIPHY, &ifr) < 0) {
+		nm_log_dbg (LOGD_HW, "(%s): SIOCGMIIPHY failed: %d", iface, errno);
+		return FALSE;
+	}
+
+	/* If we can read the BMSR register, we assume that the card supports MII link detection */
+	return mdio_read (fd, &ifr, MII_BMSR) != -1;
+}
+
+static gboolean
+probe_wext_scan (int fd, const char *iface)
+{
+	struct iwreq wrq;
+
+	/* Cards that don't scan aren't supported */
+	memset (&wrq, 0, sizeof (struct iwreq));
+	strncpy (wrq.ifr_name, iface, IFNAMSIZ);
+	if ((ioctl (fd, SIOCSIWSCAN, &wrq) < 0) && (errno == EOPNOTSUPP))
+		return FALSE;
+	return TRUE;
+}
+
+/**
+ * nm_hw_control_get_capabilities:
+ * @ifindex: interface index the result is cached under
+ * @iface: interface name
+ * @wanted: bitfield of #NMHwCapabilities the caller is interested in
+ *
+ * Probes any of the @wanted capabilities which haven't been probed for
+ * @ifindex yet; the rest come from the cache.  An @ifindex of 0 bypasses
+ * the cache.
+ *
+ * Returns: the subset of @wanted that the interface supports
+ **/
+guint32
+nm_hw_control_get_capabilities (int ifindex, const char *iface, guint32 wanted)
+{
+	CapsEntry uncached = { 0, 0 };
+	CapsEntry *entry = &uncached;
+	guint32 missing;
+	int fd;
+
+	g_return_val_if_fail (iface != NULL, NM_HW_CAP_NONE);
+
+	/* Interfaces without an index yet can't be cached; just probe them */
+	if (ifindex > 0) {
+		ensure_caps_cache ();
+
+		entry = g_hash_table_lookup (caps_cache, GINT_TO_POINTER (ifindex));
+		if (!entry) {
+			entry = g_malloc0 (sizeof (CapsEntry));
+			g_hash_table_insert (caps_cache, GINT_TO_POINTER (ifindex), entry);
+		}
+	}
+
+	missing = wanted & ~entry->probed;
+	if (missing) {
+		fd = nm_hw_control_get_socket ();
+		if (fd < 0)
+			return entry->caps & wanted;
+
+		if ((missing & NM_HW_CAP_ETHTOOL_LINK) && probe_ethtool_link (fd, iface))
+			entry->caps |= NM_HW_CAP_ETHTOOL_LINK;
+		if ((missing & NM_HW_CAP_MII) && probe_mii (fd, iface))
+			entry->caps |= NM_HW_CAP_MII;
+		if ((missing & NM_HW_CAP_WEXT_SCAN) && probe_wext_scan (fd, iface))
+			entry->caps |= NM_HW_CAP_WEXT_SCAN;
+
+		entry->probed |= missing;
+
+		nm_log_dbg (LOGD_HW, "(%s): probed capabilities 0x%X, supported 0x%X",
+		            iface, missing, entry->caps & missing);
+	}
+
+	return entry->caps & wanted;
+}
+
+/**
+ * nm_hw_control_invalidate:
+ * @ifindex: interface index
+ *
+ * Forget cached capability probes for @ifindex so they are re-run on
+ * the next request.
+ **/
+void
+nm_hw_control_invalidate (int ifindex)
+{
+	if (caps_cache && g_hash_table_remove (caps_cache, GINT_TO_POINTER (ifindex)))
+		nm_log_dbg (LOGD_HW, "(%d): hardware capability cache invalidated", ifindex);
+}
+
+static gboolean
+read_range (int fd, const char *iface, struct iw_range *range, guint32 *response_len)
+{
+	struct iwreq wrq;
+	int i = 26;
+	gboolean success = FALSE;
+
+	memset (&wrq, 0, sizeof (struct iwreq));
+	strncpy (wrq.ifr_name, iface, IFNAMSIZ);
+	wrq.u.data.pointer = (caddr_t) range;
+	wrq.u.data.length = sizeof (struct iw_range);
+
+	/* Need to give some drivers time to recover after suspend/resume
+	 * (ex ipw3945 takes a few seconds to talk to its regulatory daemon;
+	 * see rh bz#362421)
+	 */
+	while (i-- > 0) {
+		if (ioctl (fd, SIOCGIWRANGE, &wrq) == 0) {
+			if (response_len)
+				*response_len = wrq.u.data.length;
+			success = TRUE;
+			break;
+		} else if (errno != EAGAIN) {
+			nm_log_err (LOGD_HW | LOGD_WIFI,
+			            "(%s): couldn't get driver range information (%d).",
+			            iface, errno);
+			break;
+		}
+
+		g_usleep (G_USEC_PER_SEC / 4);
+	}
+
+	if (i <= 0) {
+		nm_log_warn (LOGD_HW | LOGD_WIFI,
+		             "(%s): driver took too long to respond to IWRANGE query.",
+		             iface);
+	}
+
+	return success;
+}
+
+static gboolean
+read_permanent_address (int fd, const char *iface, struct ether_addr *addr)
+{
+	struct ifreq req;
+	struct ethtool_perm_addr *epaddr;
+	int ret, saved_errno;
+
+	memset (&req, 0, sizeof (struct ifreq));
+	strncpy (req.ifr_name, iface, IFNAMSIZ);
+
+	epaddr = g_malloc0 (sizeof (struct ethtool_perm_addr) + ETH_ALEN);
+	epaddr->cmd = ETHTOOL_GPERMADDR;
+	epaddr->size = ETH_ALEN;
+	req.ifr_data = (void *) epaddr;
+
+	errno = 0;
+	ret = ioctl (fd, SIOCETHTOOL, &req);
+	saved_errno = errno;
+	if (ret == 0)
+		memcpy (addr, epaddr->data, ETH_ALEN);
+	g_free (epaddr);
+
+	errno = saved_errno;
+	return ret == 0;
+}
+
+/**
+ * nm_hw_control_get_range:
+ * @ifindex: interface index
+ * @iface: interface name
+ * @range: filled with the driver's WEXT range information
+ * @response_len: (allow-none): set to the length the driver returned
+ *
+ * Reads the driver's range information, retrying for a while if the driver
+ * is busy; during a prefetch the result probed in the background is used.
+ *
+ * Returns: %TRUE on success
+ **/
+gboolean
+nm_hw_control_get_range (int ifindex,
+                         const char *iface,
+                         struct iw_range *range,
+                         guint32 *response_len)
+{
+	Prefetch *pf = NULL;
+	int fd;
+
+	g_return_val_if_fail (iface != NULL, FALSE);
+	g_return_val_if_fail (range != NULL, FALSE);
+
+	if (prefetched && ifindex > 0)
+		pf = g_hash_table_lookup (prefetched, GINT_TO_POINTER (ifindex));
+	if (pf && pf->range_tried) {
+		if (pf->range_ok) {
+			memcpy (range, &pf->range, sizeof (struct iw_range));
+			if (response_len)
+				*response_len = pf->range_len;
+		}
+		return pf->range_ok;
+	}
+
+	fd = nm_hw_control_get_socket ();
+	if (fd < 0)
+		return FALSE;
+	return read_range (fd, iface, range, response_len);
+}
+
+/**
+ * nm_hw_control_get_permanent_address:
+ * @ifindex: interface index
+ * @iface: interface name
+ * @addr: filled with the permanent MAC address
+ *
+ * Reads the permanent MAC address with ethtool; during a prefetch the
+ * result probed in the background is used.  On failure errno is set.
+ *
+ * Returns: %TRUE on success
+ **/
+gboolean
+nm_hw_control_get_permanent_address (int ifindex,
+                                     const char *iface,
+                                     struct ether_addr *addr)
+{
+	Prefetch *pf = NULL;
+	int fd;
+
+	g_return_val_if_fail (iface != NULL, FALSE);
+	g_return_val_if_fail (addr != NULL, FALSE);
+
+	if (prefetched && ifindex > 0)
+		pf = g_hash_table_lookup (prefetched, GINT_TO_POINTER (ifindex));
+	if (pf && pf->perm_addr_tried) {
+		if (pf->perm_addr_ok)
+			memcpy (addr, &pf->perm_addr, ETH_ALEN);
+		errno = pf->perm_addr_errno;
+		return pf->perm_addr_ok;
+	}
+
+	fd = nm_hw_control_get_socket ();
+	if (fd < 0)
+		return FALSE;
+	return read_permanent_address (fd, iface, addr);
+}
+
+static void
+prefetch_free (Prefetch *pf)
+{
+	g_free (pf->iface);
+	g_slice_free (Prefetch, pf);
+}
+
+static gboolean
+prefetch_waiters_cb (gpointer user_data)
+{
+	GSList *waiters, *iter;
+
+	prefetch_waiters_id = 0;
+
+	/* Devices are created from the callbacks and pick up the results */
+	waiters = prefetch_waiters;
+	prefetch_waiters = NULL;
+	for (iter = waiters; iter; iter = g_slist_next (iter)) {
+		PrefetchWaiter *waiter = iter->data;
+
+		waiter->callback (waiter->user_data);
+		g_slice_free (PrefetchWaiter, waiter);
+	}
+	g_slist_free (waiters);
+
+	/* Anything not used by now would only go stale */
+	if (prefetched && prefetch_pending == 0)
+		g_hash_table_remove_all (prefetched);
+	return FALSE;
+}
+
+/* Runs on the main loop once a worker is done with an interface */
+static gboolean
+prefetch_done_cb (gpointer user_data)
+{
+	Prefetch *pf = user_data;
+
+	if (pf->probed) {
+		CapsEntry *entry;
+
+		ensure_caps_cache ();
+		entry = g_hash_table_lookup (caps_cache, GINT_TO_POINTER (pf->ifindex));
+		if (!entry) {
+			entry = g_malloc0 (sizeof (CapsEntry));
+			g_hash_table_insert (caps_cache, GINT_TO_POINTER (pf->ifindex), entry);
+		}
+		entry->caps = (entry->caps & ~pf->probed) | pf->caps;
+		entry->probed |= pf->probed;
+	}
+
+	if (!prefetched) {
+		prefetched = g_hash_table_new_full (g_direct_hash, g_direct_equal,
+		                                    NULL, (GDestroyNotify) prefetch_free);
+	}
+	g_hash_table_insert (prefetched, GINT_TO_POINTER (pf->ifindex), pf);
+
+	if (--prefetch_pending == 0 && prefetch_waiters)
+		prefetch_waiters_cb (NULL);
+	return FALSE;
+}
+
+static void
+prefetch_worker (gpointer data, gpointer user_data)
+{
+	Prefetch *pf = data;
+	int fd;
+
+	/* Workers use their own socket; the shared one belongs to the main loop */
+	fd = socket (PF_INET, SOCK_DGRAM, 0);
+	if (fd < 0)
+		goto done;
+
+	if (pf->wireless) {
+		pf->probed = NM_HW_CAP_WEXT_SCAN;
+		if (probe_wext_scan (fd, pf->iface))
+			pf->caps |= NM_HW_CAP_WEXT_SCAN;
+
+		pf->range_tried = TRUE;
+		pf->range_ok = read_range (fd, pf->iface, &pf->range, &pf->range_len);
+	} else {
+		pf->probed = NM_HW_CAP_ETHTOOL_LINK | NM_HW_CAP_MII;
+		if (probe_ethtool_link (fd, pf->iface))
+			pf->caps |= NM_HW_CAP_ETHTOOL_LINK;
+		if (probe_mii (fd, pf->iface))
+			pf->caps |= NM_HW_CAP_MII;
+	}
+
+	pf->perm_addr_tried = TRUE;
+	pf->perm_addr_ok = read_permanent_address (fd, pf->iface, &pf->perm_addr);
+	pf->perm_addr_errno = errno;
+
+	close (fd);
+
+done:
+	nm_log_dbg (LOGD_HW, "(%s): hardware probes done", pf->iface);
+	g_idle_add (prefetch_done_cb, pf);
+}
+
+/**
+ * nm_hw_control_prefetch:
+ * @ifindex: interface index
+ * @iface: interface name
+ * @wireless: whether @iface is a WEXT wireless interface
+ *
+ * Runs the slow probes a device does when it is created (capabilities,
+ * the wireless range, the permanent MAC address) for @iface on a worker
+ * thread, so that many interfaces can be probed at once.  The results are
+ * cached on the main loop and used by devices created from the callback
+ * of nm_hw_control_prefetch_wait().
+ **/
+void
+nm_hw_control_prefetch (int ifindex, const char *iface, gboolean wireless)
+{
+	Prefetch *pf;
+
+	g_return_if_fail (ifindex > 0);
+	g_return_if_fail (iface != NULL);
+
+	pf = g_slice_new0 (Prefetch);
+	pf->ifindex = ifindex;
+	pf->iface = g_strdup (iface);
+	pf->wireless = wireless;
+
+	prefetch_pending++;
+
+	if (!prefetch_pool) {
+		prefetch_pool = g_thread_pool_new (prefetch_worker, NULL,
+		                                   PREFETCH_MAX_THREADS, FALSE, NULL);
+	}
+	if (prefetch_pool)
+		g_thread_pool_push (prefetch_pool, pf, NULL);
+	else
+		prefetch_worker (pf, NULL);
+}
+
+/**
+ * nm_hw_control_prefetch_wait:
+ * @callback: called once all prefetches are done
+ * @user_data: user data for @callback
+ *
+ * Calls @callback from the main loop as soon as no nm_hw_control_prefetch()
+ * is outstanding anymore.  Prefetched results not used by the time the
+ * callbacks return are dropped.
+ **/
+void
+nm_hw_control_prefetch_wait (NMHwPrefetchFunc callback, gpointer user_data)
+{
+	PrefetchWaiter *waiter;
+
+	g_return_if_fail (callback != NULL);
+
+	waiter = g_slice_new0 (PrefetchWaiter);
+	waiter->callback = callback;
+	waiter->user_data = user_data;
+	prefetch_waiters = g_slist_append (prefetch_waiters, waiter);
+
+	if (prefetch_pending == 0 && !prefetch_waiters_id)
+		prefetch_waiters_id = g_idle_add (prefetch_waiters_cb, NULL);
+}
+
+/**
+ * nm_hw_control_freq_to_mhz:
+ * @freq: a WEXT frequency
+ *
+ * Returns: the frequency in MHz
+ **/
+guint32
+nm_hw_control_freq_to_mhz (const struct iw_freq *freq)
+{
+	if (freq->e == 0) {
+		/* Some drivers report channel not frequency.  Convert to a
+		 * frequency; but this assumes that the device is in b/g mode.
+		 */
+		if ((freq->m >= 1) && (freq->m <= 13))
+			return 2407 + (5 * freq->m);
+		else if (freq->m == 14)
+			return 2484;
+	}
+
+	return (guint32) (((double) freq->m) * pow (10, freq->e) / 1000000);
+}
+
+/**
+ * nm_hw_control_qual_to_percent:
+ * @qual: link quality from SIOCGIWSTATS
+ * @max_qual: maximum quality from the driver's range information
+ *
+ * Convert an iw_quality structure from SIOCGIWSTATS into a magical signal
+ * strength percentage.
+ *
+ * Returns: signal strength between 0 and 100
+ **/
+int
+nm_hw_control_qual_to_percent (const struct iw_quality *qual,
+                               const struct iw_quality *max_qual)
+{
+	int percent = -1;
+	int level_percent = -1;
+
+	g_return_val_if_fail (qual != NULL, -1);
+	g_return_val_if_fail (max_qual != NULL, -1);
+
+	nm_log_dbg (LOGD_WIFI,
+	            "QL: qual %d/%u/0x%X, level %d/%u/0x%X, noise %d/%u/0x%X, updated: 0x%X  ** MAX: qual %d/%u/0x%X, level %d/%u/0x%X, noise %d/%u/0x%X, updated: 0x%X",
+	            (__s8) qual->qual, qual->qual, qual->qual,
+	            (__s8) qual->level, qual->level, qual->level,
+	            (__s8) qual->noise, qual->noise, qual->noise,
+	            qual->updated,
+	            (__s8) max_qual->qual, max_qual->qual, max_qual->qual,
+	            (__s8) max_qual->level, max_qual->level, max_qual->level,
+	            (__s8) max_qual->noise, max_qual->noise, max_qual->noise,
+	            max_qual->updated);
+
+	/* Try using the card's idea of the signal quality first as long as it tells us what the max quality is.
+	 * Drivers that fill in quality values MUST treat them as percentages, ie the "Link Quality" MUST be
+	 * bounded by 0 and max_qual->qual, and MUST change in a linear fashion.  Within those bounds, drivers
+	 * are free to use whatever they want to calculate "Link Quality".
+	 */
+	if ((max_qual->qual != 0) && !(max_qual->updated & IW_QUAL_QUAL_INVALID) && !(qual->updated & IW_QUAL_QUAL_INVALID))
+		percent = (int)(100 * ((double)qual->qual / (double)max_qual->qual));
+
+	/* If the driver doesn't specify a complete and valid quality, we have two options:
+	 *
+	 * 1) dBm: driver must specify max_qual->level = 0, and have valid values for
+	 *        qual->level and (qual->noise OR max_qual->noise)
+	 * 2) raw RSSI: driver must specify max_qual->level > 0, and have valid values for
+	 *        qual->level and max_qual->level
+	 *
+	 * This is the WEXT spec.  If this interpretation is wrong, I'll fix it.  Otherwise,
+	 * If drivers don't conform to it, they are wrong and need to be fixed.
+	 */
+
+	if (    (max_qual->level == 0) && !(max_qual->updated & IW_QUAL_LEVEL_INVALID)          /* Valid max_qual->level == 0 */
+		&& !(qual->updated & IW_QUAL_LEVEL_INVALID)                                     /* Must have valid qual->level */
+		&& (    ((max_qual->noise > 0) && !(max_qual->updated & IW_QUAL_NOISE_INVALID)) /* Must have valid max_qual->noise */
+			|| ((qual->noise > 0) && !(qual->updated & IW_QUAL_NOISE_INVALID)))     /*    OR valid qual->noise */
+	   ) {
+		/* Absolute power values (dBm) */
+
+		/* Reasonable fallbacks for dumb drivers that don't specify either level. */
+		#define FALLBACK_NOISE_FLOOR_DBM  -90
+		#define FALLBACK_SIGNAL_MAX_DBM   -20
+		int max_level = FALLBACK_SIGNAL_MAX_DBM;
+		int noise = FALLBACK_NOISE_FLOOR_DBM;
+		int level = qual->level - 0x100;
+
+		level = CLAMP (level, FALLBACK_NOISE_FLOOR_DBM, FALLBACK_SIGNAL_MAX_DBM);
+
+		if ((qual->noise > 0) && !(qual->updated & IW_QUAL_NOISE_INVALID))
+			noise = qual->noise - 0x100;
+		else if ((max_qual->noise > 0) && !(max_qual->updated & IW_QUAL_NOISE_INVALID))
+			noise = max_qual->noise - 0x100;
+		noise = CLAMP (noise, FALLBACK_NOISE_FLOOR_DBM, FALLBACK_SIGNAL_MAX_DBM);
+
+		/* A sort of signal-to-noise ratio calculation */
+		level_percent = (int)(100 - 70 *(
+		                                ((double)max_level - (double)level) /
+		                                ((double)max_level - (double)noise)));
+		nm_log_dbg (LOGD_WIFI, "QL1: level_percent is %d.  max_level %d, level %d, noise_floor %d.",
+		            level_percent, max_level, level, noise);
+	} else if (   (max_qual->level != 0)
+	           && !(max_qual->updated & IW_QUAL_LEVEL_INVALID) /* Valid max_qual->level as upper bound */
+	           && !(qual->updated & IW_QUAL_LEVEL_INVALID)) {
+		/* Relative power values (RSSI) */
+
+		int level = qual->level;
+
+		/* Signal level is relavtive (0 -> max_qual->level) */
+		level = CLAMP (level, 0, max_qual->level);
+		level_percent = (int)(100 * ((double)level / (double)max_qual->level));
+		nm_log_dbg (LOGD_WIFI, "QL2: level_percent is %d.  max_level %d, level %d.",
+		            level_percent, max_qual->level, level);
+	} else if (percent == -1) {
+		nm_log_dbg (LOGD_WIFI, "QL: Could not get quality %% value from driver.  Driver is probably buggy.");
+	}
+
+	/* If the quality percent was 0 or doesn't exist, then try to use signal levels instead */
+	if ((percent < 1) && (level_percent >= 0))
+		percent = level_percent;
+
+	nm_log_dbg (LOGD_WIFI, "QL: Final quality percent is %d (%d).",
+	            percent, CLAMP (percent, 0, 100));
+	return (CLAMP (percent, 0, 100));
+}
+
+static gboolean
+refresh_speed (int fd, const char *iface, NMHwState *state)
+{
+	struct ifreq ifr;
+	struct ethtool_cmd edata = {
+		.cmd = ETHTOOL_GSET,
+	};
+	guint32 speed;
+
+	memset (&ifr, 0, sizeof (struct ifreq));
+	strncpy (ifr.ifr_name, iface, IFNAMSIZ);
+	ifr.ifr_data = (char *) &edata;
+
+	if (ioctl (fd, SIOCETHTOOL, &ifr) < 0)
+		return FALSE;
+
+#if LINUX_VERSION_CODE < KERNEL_VERSION(2,6,27)
+	speed = edata.speed;
+#else
+	speed = ethtool_cmd_speed (&edata);
+#endif
+
+	if (speed == G_MAXUINT16 || speed == G_MAXUINT32)
+		speed = 0;
+
+	state->speed = speed;
+	return TRUE;
+}
+
+/**
+ * nm_hw_control_refresh:
+ * @iface: interface name
+ * @what: bitfield of #NMHwStateFlags to read
+ * @max_qual: the driver's maximum link quality, required for
+ *   %NM_HW_STATE_STRENGTH
+ * @state: filled in with the hardware state
+ *
+ * Reads all of the requested hardware state of @iface in one pass over the
+ * shared control socket.  Pieces which could not be read are left out of
+ * @state->valid and zeroed.
+ *
+ * Returns: %TRUE if every piece of requested state was read
+ **/
+gboolean
+nm_hw_control_refresh (const char *iface,
+                       guint32 what,
+                       const struct iw_quality *max_qual,
+                       NMHwState *state)
+{
+	struct iwreq wrq;
+	int fd;
+
+	g_return_val_if_fail (iface != NULL, FALSE);
+	g_return_val_if_fail (state != NULL, FALSE);
+
+	memset (state, 0, sizeof (NMHwState));
+	state->strength = -1;
+	state->mode = NM_802_11_MODE_UNKNOWN;
+
+	fd = nm_hw_control_get_socket ();
+	if (fd < 0)
+		return FALSE;
+
+	if ((what & NM_HW_STATE_SPEED) && refresh_speed (fd, iface, state))
+		state->valid |= NM_HW_STATE_SPEED;
+
+	if (what & NM_HW_STATE_BSSID) {
+		memset (&wrq, 0, sizeof (wrq));
+		strncpy (wrq.ifr_name, iface, IFNAMSIZ);
+		if (ioctl (fd, SIOCGIWAP, &wrq) == 0) {
+			memcpy (state->bssid.ether_addr_octet, &(wrq.u.ap_addr.sa_data), ETH_ALEN);
+			state->valid |= NM_HW_STATE_BSSID;
+		}
+	}
+
+	if (what & NM_HW_STATE_SSID) {
+		char ssid[IW_ESSID_MAX_SIZE + 2];
+
+		memset (ssid, 0, sizeof (ssid));
+		memset (&wrq, 0, sizeof (wrq));
+		wrq.u.essid.pointer = (caddr_t) &ssid;
+		wrq.u.essid.length = sizeof (ssid);
+		wrq.u.essid.flags = 0;
+		strncpy (wrq.ifr_name, iface, IFNAMSIZ);
+
+		if (ioctl (fd, SIOCGIWESSID, &wrq) == 0) {
+			state->ssid_len = MIN (wrq.u.essid.length, NM_HW_SSID_MAX_LEN);
+			memcpy (state->ssid, ssid, state->ssid_len);
+			state->valid |= NM_HW_STATE_SSID;
+		} else {
+			nm_log_err (LOGD_HW | LOGD_WIFI, "(%s): couldn't get SSID: %d",
+			            iface, errno);
+		}
+	}
+
+	if (what & NM_HW_STATE_MODE) {
+		memset (&wrq, 0, sizeof (wrq));
+		strncpy (wrq.ifr_name, iface, IFNAMSIZ);
+		if (ioctl (fd, SIOCGIWMODE, &wrq) == 0) {
+			switch (wrq.u.mode) {
+			case IW_MODE_ADHOC:
+				state->mode = NM_802_11_MODE_ADHOC;
+				break;
+			case IW_MODE_INFRA:
+				state->mode = NM_802_11_MODE_INFRA;
+				break;
+			default:
+				state->mode = NM_802_11_MODE_UNKNOWN;
+				break;
+			}
+			state->valid |= NM_HW_STATE_MODE;
+		} else if (errno != ENODEV)
+			nm_log_warn (LOGD_HW | LOGD_WIFI, "(%s): error %d getting card mode", iface, errno);
+	}
+
+	if (what & NM_HW_STATE_FREQ) {
+		memset (&wrq, 0, sizeof (wrq));
+		strncpy (wrq.ifr_name, iface, IFNAMSIZ);
+		if (ioctl (fd, SIOCGIWFREQ, &wrq) == 0) {
+			state->freq = nm_hw_control_freq_to_mhz (&wrq.u.freq);
+			state->valid |= NM_HW_STATE_FREQ;
+		} else {
+			nm_log_warn (LOGD_HW | LOGD_WIFI,
+			             "(%s): error getting frequency: %s",
+			             iface, strerror (errno));
+		}
+	}
+
+	if (what & NM_HW_STATE_BITRATE) {
+		memset (&wrq, 0, sizeof (wrq));
+		strncpy (wrq.ifr_name, iface, IFNAMSIZ);
+		if (ioctl (fd, SIOCGIWRATE, &wrq) == 0) {
+			state->bitrate = wrq.u.bitrate.value / 1000;
+			state->valid |= NM_HW_STATE_BITRATE;
+		}
+	}
+
+	if ((what & NM_HW_STATE_STRENGTH) && max_qual) {
+		struct iw_statistics stats;
+
+		memset (&stats, 0, sizeof (stats));
+		memset (&wrq, 0, sizeof (wrq));
+		wrq.u.data.pointer = &stats;
+		wrq.u.data.length = sizeof (stats);
+		wrq.u.data.flags = 1;  /* Clear updated flag */
+		strncpy (wrq.ifr_name, iface, IFNAMSIZ);
+
+		if (ioctl (fd, SIOCGIWSTATS, &wrq) == 0) {
+			state->strength = nm_hw_control_qual_to_percent (&stats.qual, max_qual);
+			state->valid |= NM_HW_STATE_STRENGTH;
+		}
+	}
+
+	return (state->valid & what) == what;
+}
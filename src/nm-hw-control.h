@@ -0,0 +1,105 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ */
+
+#ifndef NM_HW_CONTROL_H
+#define NM_HW_CONTROL_H
+
+#include <glib.h>
+#include <net/ethernet.h>
+
+/* Forward declarations so users don't need the wireless extension headers */
+struct iw_freq;
+struct iw_quality;
+struct iw_range;
+
+/* Capabilities probed once per interface and cached until the link
+ * goes away or is brought up/down.
+ */
+typedef enum {
+	NM_HW_CAP_NONE         = 0x00000000,
+	NM_HW_CAP_ETHTOOL_LINK = 0x00000001,  /* ETHTOOL_GLINK works */
+	NM_HW_CAP_MII          = 0x00000002,  /* MII BMSR register readable */
+	NM_HW_CAP_WEXT_SCAN    = 0x00000004,  /* SIOCSIWSCAN not EOPNOTSUPP */
+} NMHwCapabilities;
+
+/* Pieces of hardware state nm_hw_control_refresh() can read */
+typedef enum {
+	NM_HW_STATE_NONE     = 0x00000000,
+	NM_HW_STATE_SPEED    = 0x00000001,  /* ethtool link speed */
+	NM_HW_STATE_BSSID    = 0x00000002,
+	NM_HW_STATE_SSID     = 0x00000004,
+	NM_HW_STATE_MODE     = 0x00000008,
+	NM_HW_STATE_FREQ     = 0x00000010,
+	NM_HW_STATE_BITRATE  = 0x00000020,
+	NM_HW_STATE_STRENGTH = 0x00000040,
+} NMHwStateFlags;
+
+#define NM_HW_SSID_MAX_LEN 32
+
+typedef struct {
+	guint32 valid;          /* NMHwStateFlags successfully read */
+
+	guint32 speed;          /* Mb/s */
+	struct ether_addr bssid;
+	guint8  ssid[NM_HW_SSID_MAX_LEN];
+	guint32 ssid_len;
+	int     mode;           /* NM80211Mode */
+	guint32 freq;           /* MHz */
+	guint32 bitrate;        /* Kb/s */
+	int     strength;       /* percent, or -1 if the driver didn't say */
+} NMHwState;
+
+int      nm_hw_control_get_socket       (void);
+
+guint32  nm_hw_control_get_capabilities (int ifindex,
+                                         const char *iface,
+                                         guint32 wanted);
+
+void     nm_hw_control_invalidate       (int ifindex);
+
+gboolean nm_hw_control_get_range        (int ifindex,
+                                         const char *iface,
+                                         struct iw_range *range,
+                                         guint32 *response_len);
+
+gboolean nm_hw_control_get_permanent_address (int ifindex,
+                                              const char *iface,
+                                              struct ether_addr *addr);
+
+typedef void (*NMHwPrefetchFunc) (gpointer user_data);
+
+void     nm_hw_control_prefetch         (int ifindex,
+                                         const char *iface,
+                                         gboolean wireless);
+
+void     nm_hw_control_prefetch_wait    (NMHwPrefetchFunc callback,
+                                         gpointer user_data);
+
+gboolean nm_hw_control_refresh          (const char *iface,
+                                         guint32 what,
+                                         const struct iw_quality *max_qual,
+                                         NMHwState *state);
+
+guint32  nm_hw_control_freq_to_mhz      (const struct iw_freq *freq);
+
+int      nm_hw_control_qual_to_percent  (const struct iw_quality *qual,
+                                         const struct iw_quality *max_qual);
+
+#endif /* NM_HW_CONTROL_H */
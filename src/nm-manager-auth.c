@@ -54,6 +54,7 @@ typedef struct {
 	char *permission;
 	guint idle_id;
 	gboolean disposed;
+	gpointer pending;  /* PkPending the call waits on, if any */
 } AuthCall;
 
 typedef struct {
@@ -298,11 +299,28 @@ auth_call_new (NMAuthChain *chain, const char *permission)
 	return call;
 }
 
+static void auth_call_free (AuthCall *call);
+#if WITH_POLKIT
+static void pk_pending_call_disposed (gpointer pending);
+#endif
+
 static void
 auth_call_cancel (AuthCall *call)
 {
+	/* Results scheduled for an idle (eg from the cache) would otherwise be
+	 * delivered to a chain that no longer exists.
+	 */
+	if (call->idle_id) {
+		auth_call_free (call);
+		return;
+	}
+
 	call->disposed = TRUE;
 	g_cancellable_cancel (call->cancellable);
+#if WITH_POLKIT
+	if (call->pending)
+		pk_pending_call_disposed (call->pending);
+#endif
 }
 
 static void
@@ -329,6 +347,11 @@ auth_call_complete (AuthCall *call)
 	g_return_val_if_fail (call != NULL, FALSE);
 
 	call->idle_id = 0;
+	if (call->disposed) {
+		auth_call_free (call);
+		return FALSE;
+	}
+
 	nm_auth_chain_remove_call (call->chain, call);
 	nm_auth_chain_check_done (call->chain);
 	auth_call_free (call);
@@ -345,32 +368,162 @@ auth_call_schedule_early_finish (AuthCall *call, GError *error)
 }
 
 #if WITH_POLKIT
+/* Authorization results are cached per D-Bus sender and action until
+ * PolicyKit reports a change, the session database changes, or the sender
+ * disconnects.  The sender's bus name is what PolicyKit evaluates, so
+ * keying on it (rather than on the uid) never hands one process's answer
+ * to another one that may be in a different session.  Only definite
+ * answers are cached; "auth" depends on the interaction flag, and grants
+ * based on a temporary authorization expire without notice.
+ *
+ * Identical checks that are still in flight are coalesced, so a burst of
+ * calls only causes a single CheckAuthorization round-trip.
+ */
+
+typedef struct {
+	char *key;         /* owner|action|interactive */
+	char *owner;
+	char *permission;
+	guint generation;  /* of pk_cache when the check was started */
+	GSList *calls;     /* AuthCalls waiting for the result */
+	GCancellable *cancellable;
+} PkPending;
+
+static GHashTable *pk_cache = NULL;    /* owner -> (action -> NMAuthCallResult) */
+static GHashTable *pk_pending = NULL;  /* key -> PkPending */
+static guint pk_generation = 0;
+
 static void
-pk_call_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+pk_cache_invalidate (void)
 {
-	AuthCall *call = user_data;
-	NMAuthChain *chain = call->chain;
-	PolkitAuthorizationResult *pk_result;
-	GError *error = NULL;
+	if (pk_cache)
+		g_hash_table_remove_all (pk_cache);
+	/* Results of checks in flight may already be stale */
+	pk_generation++;
+}
 
-	/* If the call is already disposed do nothing */
-	if (call->disposed) {
-		auth_call_free (call);
+static void
+pk_cache_session_changed_cb (NMSessionMonitor *monitor, gpointer user_data)
+{
+	pk_cache_invalidate ();
+}
+
+static void
+pk_cache_name_owner_changed_cb (NMDBusManager *dbus_mgr,
+                                const char *name,
+                                const char *old_owner,
+                                const char *new_owner,
+                                gpointer user_data)
+{
+	/* Forget about senders that left the bus */
+	if (!new_owner || !strlen (new_owner))
+		g_hash_table_remove (pk_cache, name);
+}
+
+static void pk_authority_watch (PolkitAuthority *authority);
+
+static void
+pk_cache_init (PolkitAuthority *authority)
+{
+	if (pk_cache)
 		return;
+
+	pk_authority_watch (authority);
+
+	pk_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+	                                  (GDestroyNotify) g_hash_table_destroy);
+	pk_pending = g_hash_table_new (g_str_hash, g_str_equal);
+
+	/* Both singletons are kept alive for the cache's lifetime */
+	g_signal_connect (nm_session_monitor_get (),
+	                  NM_SESSION_MONITOR_CHANGED,
+	                  G_CALLBACK (pk_cache_session_changed_cb),
+	                  NULL);
+	g_signal_connect (nm_dbus_manager_get (),
+	                  NM_DBUS_MANAGER_NAME_OWNER_CHANGED,
+	                  G_CALLBACK (pk_cache_name_owner_changed_cb),
+	                  NULL);
+}
+
+static NMAuthCallResult
+pk_cache_lookup (const char *owner, const char *permission)
+{
+	GHashTable *results;
+
+	results = g_hash_table_lookup (pk_cache, owner);
+	if (!results)
+		return NM_AUTH_CALL_RESULT_UNKNOWN;
+	return GPOINTER_TO_UINT (g_hash_table_lookup (results, permission));
+}
+
+static void
+pk_cache_add (const char *owner, const char *permission, NMAuthCallResult result)
+{
+	GHashTable *results;
+
+	results = g_hash_table_lookup (pk_cache, owner);
+	if (!results) {
+		results = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+		g_hash_table_insert (pk_cache, g_strdup (owner), results);
+	}
+	g_hash_table_insert (results, g_strdup (permission), GUINT_TO_POINTER (result));
+}
+
+/* PolicyKit doesn't emit Changed when a temporary authorization
+ * (auth_admin_keep, auth_self_keep) expires, so such grants must not be
+ * cached.  Same as polkit_authorization_result_get_temporary_authorization_id(),
+ * which needs a newer PolicyKit than we require.
+ */
+static gboolean
+pk_result_is_temporary (PolkitAuthorizationResult *pk_result)
+{
+	PolkitDetails *details;
+
+	details = polkit_authorization_result_get_details (pk_result);
+	return details && polkit_details_lookup (details, "polkit.temporary_authorization_id");
+}
+
+/* Once nobody waits for a check anymore, stop it, so that an interactive
+ * check doesn't keep prompting the user for nothing.
+ */
+static void
+pk_pending_call_disposed (gpointer data)
+{
+	PkPending *pending = data;
+	GSList *iter;
+
+	for (iter = pending->calls; iter; iter = g_slist_next (iter)) {
+		if (!((AuthCall *) iter->data)->disposed)
+			return;
 	}
 
-	pk_result = polkit_authority_check_authorization_finish (chain->authority, result, &error);
-	if (error) {
-		if (!chain->error)
-			chain->error = g_error_copy (error);
+	/* New identical checks mustn't piggy-back on a cancelled one */
+	if (g_hash_table_lookup (pk_pending, pending->key) == pending)
+		g_hash_table_remove (pk_pending, pending->key);
+	g_cancellable_cancel (pending->cancellable);
+}
+
+static void
+pk_call_cb (GObject *object, GAsyncResult *result, gpointer user_data)
+{
+	PkPending *pending = user_data;
+	PolkitAuthorizationResult *pk_result;
+	guint call_result = NM_AUTH_CALL_RESULT_UNKNOWN;
+	GError *error = NULL;
+	GSList *iter;
 
+	if (g_hash_table_lookup (pk_pending, pending->key) == pending)
+		g_hash_table_remove (pk_pending, pending->key);
+
+	pk_result = polkit_authority_check_authorization_finish (POLKIT_AUTHORITY (object), result, &error);
+	if (g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+		/* Every waiting call is gone already */
+	} else if (error) {
 		nm_log_warn (LOGD_CORE, "error requesting auth for %s: (%d) %s",
-		             call->permission,
+		             pending->permission,
 		             error ? error->code : -1,
 		             error && error->message ? error->message : "(unknown)");
 	} else {
-		guint call_result = NM_AUTH_CALL_RESULT_UNKNOWN;
-
 		if (polkit_authorization_result_get_is_authorized (pk_result)) {
 			/* Caller has the permission */
 			call_result = NM_AUTH_CALL_RESULT_YES;
@@ -380,14 +533,41 @@ pk_call_cb (GObject *object, GAsyncResult *result, gpointer user_data)
 		} else
 			call_result = NM_AUTH_CALL_RESULT_NO;
 
-		nm_auth_chain_set_data (chain, call->permission, GUINT_TO_POINTER (call_result), NULL);
+		if (   call_result != NM_AUTH_CALL_RESULT_AUTH
+		    && !pk_result_is_temporary (pk_result)
+		    && pending->generation == pk_generation)
+			pk_cache_add (pending->owner, pending->permission, call_result);
+	}
+
+	for (iter = pending->calls; iter; iter = g_slist_next (iter)) {
+		AuthCall *call = iter->data;
+		NMAuthChain *chain = call->chain;
+
+		/* If the call is already disposed do nothing */
+		if (call->disposed) {
+			auth_call_free (call);
+			continue;
+		}
+
+		if (error) {
+			if (!chain->error)
+				chain->error = g_error_copy (error);
+		} else
+			nm_auth_chain_set_data (chain, call->permission, GUINT_TO_POINTER (call_result), NULL);
+
+		auth_call_complete (call);
 	}
 
 	g_clear_error (&error);
 	if (pk_result)
 		g_object_unref (pk_result);
 
-	auth_call_complete (call);
+	g_slist_free (pending->calls);
+	g_object_unref (pending->cancellable);
+	g_free (pending->key);
+	g_free (pending->owner);
+	g_free (pending->permission);
+	g_slice_free (PkPending, pending);
 }
 #endif
 
@@ -401,35 +581,73 @@ nm_auth_chain_add_call (NMAuthChain *self,
 #if WITH_POLKIT
 	PolkitSubject *subject;
 	PolkitCheckAuthorizationFlags flags = POLKIT_CHECK_AUTHORIZATION_FLAGS_NONE;
+	NMAuthCallResult cached;
+	PkPending *pending;
+	char *key;
 
 	g_return_val_if_fail (self != NULL, FALSE);
 	g_return_val_if_fail (self->owner != NULL, FALSE);
 	g_return_val_if_fail (permission != NULL, FALSE);
 
-	subject = polkit_system_bus_name_new (self->owner);
-	if (!subject)
-		return FALSE;
-
 	call = auth_call_new (self, permission);
 
 	if (self->authority == NULL) {
 		/* No polkit, no authorization */
 		auth_call_schedule_early_finish (call, g_error_new_literal (0, 0, "PolicyKit unavailable"));
-		g_object_unref (subject);
 		return FALSE;
 	}
 
+	pk_cache_init (self->authority);
+
+	cached = pk_cache_lookup (self->owner, permission);
+	if (cached != NM_AUTH_CALL_RESULT_UNKNOWN) {
+		nm_auth_chain_set_data (self, permission, GUINT_TO_POINTER (cached), NULL);
+		auth_call_schedule_early_finish (call, NULL);
+		return TRUE;
+	}
+
+	/* Piggy-back on an identical check that is already running */
+	key = g_strdup_printf ("%s|%s|%d", self->owner, permission, !!allow_interaction);
+	pending = g_hash_table_lookup (pk_pending, key);
+	if (pending) {
+		call->pending = pending;
+		pending->calls = g_slist_append (pending->calls, call);
+		g_free (key);
+		return TRUE;
+	}
+
+	subject = polkit_system_bus_name_new (self->owner);
+	if (!subject) {
+		auth_call_schedule_early_finish (call, g_error_new_literal (0, 0, "Invalid D-Bus sender"));
+		g_free (key);
+		return FALSE;
+	}
+
+	pending = g_slice_new0 (PkPending);
+	pending->key = key;
+	pending->owner = g_strdup (self->owner);
+	pending->permission = g_strdup (permission);
+	pending->generation = pk_generation;
+	pending->calls = g_slist_append (NULL, call);
+	pending->cancellable = g_cancellable_new ();
+	call->pending = pending;
+	g_hash_table_insert (pk_pending, pending->key, pending);
+
 	if (allow_interaction)
 		flags = POLKIT_CHECK_AUTHORIZATION_FLAGS_ALLOW_USER_INTERACTION;
 
+	/* Shared between chains, so it isn't tied to any call's cancellable;
+	 * calls that go away meanwhile are dropped when it finishes, and it is
+	 * cancelled once all of them are gone.
+	 */
 	polkit_authority_check_authorization (self->authority,
 	                                      subject,
 	                                      permission,
 	                                      NULL,
 	                                      flags,
-	                                      call->cancellable,
+	                                      pending->cancellable,
 	                                      pk_call_cb,
-	                                      call);
+	                                      pending);
 	g_object_unref (subject);
 #else
 	/* -- NO POLKIT -- */
@@ -584,12 +802,29 @@ pk_authority_changed_cb (GObject *object, gpointer unused)
 {
 	GSList *iter;
 
+	/* Drop cached results before anyone re-checks */
+	pk_cache_invalidate ();
+
 	for (iter = funcs; iter; iter = g_slist_next (iter)) {
 		PkChangedInfo *info = iter->data;
 
 		info->changed_callback (info->changed_data);
 	}
 }
+
+static void
+pk_authority_watch (PolkitAuthority *authority)
+{
+	static guint32 changed_id = 0;
+
+	/* Hook up the changed signal the first time it's needed */
+	if (changed_id == 0) {
+		changed_id = g_signal_connect (authority,
+		                               "changed",
+		                               G_CALLBACK (pk_authority_changed_cb),
+		                               &funcs);
+	}
+}
 #endif
 
 void
@@ -597,7 +832,6 @@ nm_auth_changed_func_register (GDestroyNotify callback, gpointer callback_data)
 {
 #if WITH_POLKIT
 	PolkitAuthority *authority;
-	static guint32 changed_id = 0;
 #endif
 	PkChangedInfo *info;
 	GSList *iter;
@@ -608,13 +842,7 @@ nm_auth_changed_func_register (GDestroyNotify callback, gpointer callback_data)
 	if (!authority)
 		return;
 
-	/* Hook up the changed signal the first time a callback is registered */
-	if (changed_id == 0) {
-		changed_id = g_signal_connect (authority,
-		                               "changed",
-		                               G_CALLBACK (pk_authority_changed_cb),
-		                               &funcs);
-	}
+	pk_authority_watch (authority);
 #endif
 
 	/* No duplicates */
@@ -23,8 +23,10 @@
 #include <unistd.h>
 #include <errno.h>
 #include <netdb.h>
+#include <sys/socket.h>
 #include <ctype.h>
 #include <arpa/inet.h>
+#include <time.h>
 
 #include <glib.h>
 
@@ -33,165 +35,281 @@
 
 /************************************************************************/
 
-struct HostnameThread {
-	GThread *thread;
+/* Reverse lookups run on a small shared thread pool instead of a thread
+ * each, so an unreachable DNS server can't pile up blocked threads.
+ * Lookups of the same address share one getnameinfo() call and results
+ * are cached for a while; a lookup nobody is waiting for anymore is
+ * skipped if it hasn't started yet.
+ *
+ * Everything except the worker function runs in the main thread.
+ */
 
-	GMutex *lock;
-	gboolean dead;
-	int ret;
+#define HOSTNAME_POOL_MAX_THREADS 2
+#define HOSTNAME_CACHE_TTL        600  /* seconds, successful lookups */
+#define HOSTNAME_CACHE_NEG_TTL    30   /* seconds, failed lookups */
+#define HOSTNAME_CACHE_MAX        64
+
+typedef struct {
+	char *key;
+	struct sockaddr_storage addr;
+	socklen_t addr_size;
+	volatile gint cancelled;
 
-	struct sockaddr_in addr4;
-	struct sockaddr_in6 addr6;
-	struct sockaddr *addr;
-	size_t addr_size;
+	/* Written by the worker, read back in the main thread */
+	int ret;
 	char hostname[NI_MAXHOST + 1];
 
+	GSList *waiters;  /* HostnameThreads */
+} Lookup;
+
+typedef struct {
+	int ret;
+	char *hostname;
+	time_t expires;
+} CacheEntry;
+
+struct HostnameThread {
+	Lookup *lookup;   /* NULL once finished or when answered from cache */
+	gboolean dead;
+	int ret;
+	char *hostname;
 	HostnameThreadCallback callback;
 	gpointer user_data;
 };
 
-static gboolean
-hostname_thread_run_cb (gpointer user_data)
+static GThreadPool *pool = NULL;
+static GHashTable *inflight = NULL;  /* key -> Lookup */
+static GHashTable *cache = NULL;     /* key -> CacheEntry */
+
+static void
+cache_entry_free (CacheEntry *entry)
+{
+	g_free (entry->hostname);
+	g_slice_free (CacheEntry, entry);
+}
+
+static void
+lookup_free (Lookup *lookup)
+{
+	g_slist_free (lookup->waiters);
+	g_free (lookup->key);
+	g_slice_free (Lookup, lookup);
+}
+
+static void
+ht_deliver (HostnameThread *ht)
 {
-	HostnameThread *ht = (HostnameThread *) user_data;
 	const char *hostname = NULL;
 
-	if (strlen (ht->hostname) && strcmp (ht->hostname, "."))
+	if (ht->hostname && strlen (ht->hostname) && strcmp (ht->hostname, "."))
 		hostname = ht->hostname;
 
 	nm_log_dbg (LOGD_DNS, "(%p) calling address reverse-lookup result handler", ht);
 	(*ht->callback) (ht, ht->ret, hostname, ht->user_data);
+}
+
+static gboolean
+lookup_done_cb (gpointer user_data)
+{
+	Lookup *lookup = user_data;
+	gboolean cancelled = g_atomic_int_get (&lookup->cancelled);
+	GSList *iter;
+
+	/* A cancelled lookup was already dropped from the table */
+	if (!cancelled) {
+		CacheEntry *entry;
+
+		g_hash_table_remove (inflight, lookup->key);
+
+		if (g_hash_table_size (cache) >= HOSTNAME_CACHE_MAX)
+			g_hash_table_remove_all (cache);
+
+		entry = g_slice_new0 (CacheEntry);
+		entry->ret = lookup->ret;
+		entry->hostname = lookup->ret == 0 ? g_strdup (lookup->hostname) : NULL;
+		entry->expires = time (NULL) + (lookup->ret == 0 ? HOSTNAME_CACHE_TTL : HOSTNAME_CACHE_NEG_TTL);
+		g_hash_table_insert (cache, g_strdup (lookup->key), entry);
+	}
+
+	/* Callbacks free their HostnameThread */
+	for (iter = lookup->waiters; iter; iter = g_slist_next (iter)) {
+		HostnameThread *ht = iter->data;
+
+		ht->lookup = NULL;
+		ht->ret = lookup->ret;
+		ht->hostname = lookup->ret == 0 ? g_strdup (lookup->hostname) : NULL;
+		ht_deliver (ht);
+	}
+
+	lookup_free (lookup);
 	return FALSE;
 }
 
-static gpointer
-hostname_thread_worker (gpointer data)
+static void
+hostname_lookup_worker (gpointer data, gpointer user_data)
 {
-	HostnameThread *ht = (HostnameThread *) data;
+	Lookup *lookup = data;
 	int i;
 
-	nm_log_dbg (LOGD_DNS, "(%p) starting address reverse-lookup", ht);
-
-	g_mutex_lock (ht->lock);
-	if (ht->dead) {
-		g_mutex_unlock (ht->lock);
-		return (gpointer) NULL;
+	if (g_atomic_int_get (&lookup->cancelled)) {
+		nm_log_dbg (LOGD_DNS, "(%p) skipping cancelled address reverse-lookup", lookup);
+		lookup->ret = EAI_AGAIN;
+		goto done;
 	}
-	g_mutex_unlock (ht->lock);
 
-	ht->ret = getnameinfo (ht->addr, ht->addr_size, ht->hostname, NI_MAXHOST, NULL, 0, NI_NAMEREQD);
-	if (ht->ret == 0) {
+	nm_log_dbg (LOGD_DNS, "(%p) starting address reverse-lookup", lookup);
+
+	lookup->ret = getnameinfo ((struct sockaddr *) &lookup->addr, lookup->addr_size,
+	                           lookup->hostname, NI_MAXHOST, NULL, 0, NI_NAMEREQD);
+	if (lookup->ret == 0) {
 		nm_log_dbg (LOGD_DNS, "(%p) address reverse-lookup returned hostname '%s'",
-		            ht, ht->hostname);
-		for (i = 0; i < strlen (ht->hostname); i++)
-			ht->hostname[i] = tolower (ht->hostname[i]);
+		            lookup, lookup->hostname);
+		for (i = 0; i < strlen (lookup->hostname); i++)
+			lookup->hostname[i] = tolower (lookup->hostname[i]);
 	} else {
 		nm_log_dbg (LOGD_DNS, "(%p) address reverse-lookup failed: (%d) %s",
-		            ht, ht->ret, gai_strerror (ht->ret));
+		            lookup, lookup->ret, gai_strerror (lookup->ret));
 	}
 
-	/* Don't track the idle handler ID because by the time the g_idle_add()
-	 * returns the ID, the handler may already have run and freed the
-	 * HostnameThread.
-	 */
-	nm_log_dbg (LOGD_DNS, "(%p) scheduling address reverse-lookup result handler", ht);
-	g_idle_add (hostname_thread_run_cb, ht);
-	return (gpointer) TRUE;
+done:
+	nm_log_dbg (LOGD_DNS, "(%p) scheduling address reverse-lookup result handler", lookup);
+	g_idle_add (lookup_done_cb, lookup);
 }
 
-void
-hostname_thread_free (HostnameThread *ht)
+static gboolean
+cached_result_cb (gpointer user_data)
 {
-	g_return_if_fail (ht != NULL);
-
-	nm_log_dbg (LOGD_DNS, "(%p) freeing reverse-lookup thread", ht);
-
-	g_mutex_free (ht->lock);
-	memset (ht, 0, sizeof (HostnameThread));
-	g_free (ht);
+	ht_deliver ((HostnameThread *) user_data);
+	return FALSE;
 }
 
-HostnameThread *
-hostname4_thread_new (guint32 ip4_addr,
-                      HostnameThreadCallback callback,
-                      gpointer user_data)
+static HostnameThread *
+hostname_thread_new (int family,
+                     const void *addr,
+                     HostnameThreadCallback callback,
+                     gpointer user_data)
 {
 	HostnameThread *ht;
-	struct sockaddr_in addr4;
-	char buf[INET_ADDRSTRLEN + 1];
+	Lookup *lookup;
+	CacheEntry *entry;
+	char buf[INET6_ADDRSTRLEN + 1];
+	char *key;
 
-	ht = g_malloc0 (sizeof (HostnameThread));
-	g_assert (ht);
+	if (!inet_ntop (family, addr, buf, sizeof (buf)))
+		return NULL;
+
+	if (!pool) {
+		pool = g_thread_pool_new (hostname_lookup_worker, NULL,
+		                          HOSTNAME_POOL_MAX_THREADS, FALSE, NULL);
+		if (!pool)
+			return NULL;
+		inflight = g_hash_table_new (g_str_hash, g_str_equal);
+		cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+		                               (GDestroyNotify) cache_entry_free);
+	}
 
-	ht->lock = g_mutex_new ();
+	ht = g_malloc0 (sizeof (HostnameThread));
 	ht->callback = callback;
 	ht->user_data = user_data;
 
-	ht->addr4.sin_family = AF_INET;
-	ht->addr4.sin_addr.s_addr = ip4_addr;
-	ht->addr = (struct sockaddr *) &ht->addr4;
-	ht->addr_size = sizeof (ht->addr4);
+	key = g_strdup_printf ("%d/%s", family, buf);
+
+	entry = g_hash_table_lookup (cache, key);
+	if (entry && entry->expires > time (NULL)) {
+		/* Answer asynchronously, just like a real lookup */
+		ht->ret = entry->ret;
+		ht->hostname = g_strdup (entry->hostname);
+		g_idle_add (cached_result_cb, ht);
+		nm_log_dbg (LOGD_DNS, "(%p) using cached reverse-lookup result for address '%s'",
+		            ht, buf);
+		g_free (key);
+		return ht;
+	}
 
-	ht->thread = g_thread_create (hostname_thread_worker, ht, FALSE, NULL);
-	if (!ht->thread) {
-		hostname_thread_free (ht);
-		return NULL;
+	lookup = g_hash_table_lookup (inflight, key);
+	if (lookup) {
+		nm_log_dbg (LOGD_DNS, "(%p) joining in-progress reverse-lookup for address '%s'",
+		            ht, buf);
+		g_free (key);
+	} else {
+		lookup = g_slice_new0 (Lookup);
+		lookup->key = key;
+		if (family == AF_INET) {
+			struct sockaddr_in *sin = (struct sockaddr_in *) &lookup->addr;
+
+			sin->sin_family = AF_INET;
+			memcpy (&sin->sin_addr, addr, sizeof (sin->sin_addr));
+			lookup->addr_size = sizeof (*sin);
+		} else {
+			struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *) &lookup->addr;
+
+			sin6->sin6_family = AF_INET6;
+			memcpy (&sin6->sin6_addr, addr, sizeof (sin6->sin6_addr));
+			lookup->addr_size = sizeof (*sin6);
+		}
+		g_hash_table_insert (inflight, lookup->key, lookup);
+		g_thread_pool_push (pool, lookup, NULL);
+		nm_log_dbg (LOGD_DNS, "(%p) queued reverse-lookup for address '%s'",
+		            ht, buf);
 	}
 
-	if (!inet_ntop (AF_INET, &addr4.sin_addr, buf, sizeof (buf)))
-		strcpy (buf, "(unknown)");
+	ht->lookup = lookup;
+	lookup->waiters = g_slist_append (lookup->waiters, ht);
+	return ht;
+}
+
+void
+hostname_thread_free (HostnameThread *ht)
+{
+	g_return_if_fail (ht != NULL);
 
-	nm_log_dbg (LOGD_DNS, "(%p) started IPv4 reverse-lookup thread for address '%s'",
-	            ht, buf);
+	nm_log_dbg (LOGD_DNS, "(%p) freeing reverse-lookup request", ht);
 
-	return ht;
+	g_free (ht->hostname);
+	memset (ht, 0, sizeof (HostnameThread));
+	g_free (ht);
 }
 
 HostnameThread *
-hostname6_thread_new (const struct in6_addr *ip6_addr,
+hostname4_thread_new (guint32 ip4_addr,
                       HostnameThreadCallback callback,
                       gpointer user_data)
 {
-	HostnameThread *ht;
-	char buf[INET6_ADDRSTRLEN + 1];
-
-	ht = g_malloc0 (sizeof (HostnameThread));
-	g_assert (ht);
-
-	ht->lock = g_mutex_new ();
-	ht->callback = callback;
-	ht->user_data = user_data;
-
-	ht->addr6.sin6_family = AF_INET6;
-	ht->addr6.sin6_addr = *ip6_addr;
-	ht->addr = (struct sockaddr *) &ht->addr6;
-	ht->addr_size = sizeof (ht->addr6);
-
-	ht->thread = g_thread_create (hostname_thread_worker, ht, FALSE, NULL);
-	if (!ht->thread) {
-		hostname_thread_free (ht);
-		return NULL;
-	}
-
-	if (!inet_ntop (AF_INET, ip6_addr, buf, sizeof (buf)))
-		strcpy (buf, "(unknown)");
-
-	nm_log_dbg (LOGD_DNS, "(%p) started IPv6 reverse-lookup thread for address '%s'",
-	            ht, buf);
+	return hostname_thread_new (AF_INET, &ip4_addr, callback, user_data);
+}
 
-	return ht;
+HostnameThread *
+hostname6_thread_new (const struct in6_addr *ip6_addr,
+                      HostnameThreadCallback callback,
+                      gpointer user_data)
+{
+	return hostname_thread_new (AF_INET6, ip6_addr, callback, user_data);
 }
 
 void
 hostname_thread_kill (HostnameThread *ht)
 {
+	Lookup *lookup;
+	GSList *iter;
+
 	g_return_if_fail (ht != NULL);
 
-	nm_log_dbg (LOGD_DNS, "(%p) stopping reverse-lookup thread", ht);
+	nm_log_dbg (LOGD_DNS, "(%p) stopping reverse-lookup request", ht);
 
-	g_mutex_lock (ht->lock);
 	ht->dead = TRUE;
-	g_mutex_unlock (ht->lock);
+
+	/* Cancel the lookup if nobody else is waiting for it.  A later request
+	 * for the same address starts a fresh one.
+	 */
+	lookup = ht->lookup;
+	if (!lookup || g_atomic_int_get (&lookup->cancelled))
+		return;
+	for (iter = lookup->waiters; iter; iter = g_slist_next (iter)) {
+		if (!((HostnameThread *) iter->data)->dead)
+			return;
+	}
+	g_atomic_int_set (&lookup->cancelled, TRUE);
+	g_hash_table_remove (inflight, lookup->key);
 }
 
 gboolean
@@ -56,6 +56,8 @@ struct NMPolicy {
 	GSList *settings_ids;
 	GSList *dev_ids;
 
+	GHashTable *eligible;   /* NMDevice -> EligibleSet */
+
 	NMVPNManager *vpn_manager;
 	gulong vpn_activated_id;
 	gulong vpn_deactivated_id;
@@ -692,6 +694,125 @@ get_connection_auto_retries (NMConnection *connection)
 	return GPOINTER_TO_UINT (g_object_get_data (G_OBJECT (connection), RETRIES_TAG)) - 1;
 }
 
+/*****************************************************************************/
+
+/* Connections a device could ever auto-activate: autoconnect is set and
+ * the device accepts the connection's type and interface/MAC binding.
+ * These only change when the connection or the device hardware does, so
+ * the set is kept up to date from the settings signals and only the
+ * retry count, visibility and shared permission are checked per pass.
+ * Devices that index their candidates are told about every change.
+ */
+typedef struct {
+	GHashTable *connections;   /* NMSettingsConnection -> NMSettingsConnection */
+	gboolean valid;
+} EligibleSet;
+
+static void
+eligible_set_free (gpointer data)
+{
+	EligibleSet *set = data;
+
+	g_hash_table_destroy (set->connections);
+	g_slice_free (EligibleSet, set);
+}
+
+static gboolean
+connection_eligible (NMDevice *device, NMConnection *connection)
+{
+	NMSettingConnection *s_con;
+	GError *error = NULL;
+	gboolean compatible;
+
+	s_con = (NMSettingConnection *) nm_connection_get_setting (connection, NM_TYPE_SETTING_CONNECTION);
+	if (!s_con || !nm_setting_connection_get_autoconnect (s_con))
+		return FALSE;
+
+	compatible = nm_device_interface_check_connection_compatible (NM_DEVICE_INTERFACE (device), connection, &error);
+	g_clear_error (&error);
+	return compatible;
+}
+
+static void
+eligible_set_remove (EligibleSet *set, NMDevice *device, NMConnection *connection)
+{
+	/* Tell the device while the set still holds its reference */
+	if (g_hash_table_lookup (set->connections, connection)) {
+		nm_device_auto_candidate_changed (device, connection, FALSE);
+		g_hash_table_remove (set->connections, connection);
+	}
+}
+
+static void
+eligible_set_update (EligibleSet *set, NMDevice *device, NMConnection *connection)
+{
+	if (connection_eligible (device, connection)) {
+		g_hash_table_insert (set->connections, g_object_ref (connection), connection);
+		nm_device_auto_candidate_changed (device, connection, TRUE);
+	} else
+		eligible_set_remove (set, device, connection);
+}
+
+static EligibleSet *
+eligible_set_get (NMPolicy *policy, NMDevice *device)
+{
+	EligibleSet *set;
+	GSList *connections, *iter;
+
+	set = g_hash_table_lookup (policy->eligible, device);
+	if (!set) {
+		set = g_slice_new0 (EligibleSet);
+		set->connections = g_hash_table_new_full (g_direct_hash, g_direct_equal, g_object_unref, NULL);
+		g_hash_table_insert (policy->eligible, device, set);
+	}
+
+	if (!set->valid) {
+		GHashTableIter hash_iter;
+		gpointer connection;
+
+		g_hash_table_iter_init (&hash_iter, set->connections);
+		while (g_hash_table_iter_next (&hash_iter, &connection, NULL)) {
+			nm_device_auto_candidate_changed (device, connection, FALSE);
+			g_hash_table_iter_remove (&hash_iter);
+		}
+
+		connections = nm_settings_get_connections (policy->settings);
+		for (iter = connections; iter; iter = g_slist_next (iter))
+			eligible_set_update (set, device, NM_CONNECTION (iter->data));
+		g_slist_free (connections);
+		set->valid = TRUE;
+	}
+
+	return set;
+}
+
+static void
+eligible_update_all (NMPolicy *policy, NMConnection *connection, gboolean removed)
+{
+	GHashTableIter iter;
+	gpointer device, set;
+
+	g_hash_table_iter_init (&iter, policy->eligible);
+	while (g_hash_table_iter_next (&iter, &device, &set)) {
+		if (removed)
+			eligible_set_remove (set, NM_DEVICE (device), connection);
+		else if (((EligibleSet *) set)->valid)
+			eligible_set_update (set, NM_DEVICE (device), connection);
+	}
+}
+
+static void
+eligible_invalidate (NMPolicy *policy, NMDevice *device)
+{
+	EligibleSet *set;
+
+	set = g_hash_table_lookup (policy->eligible, device);
+	if (set)
+		set->valid = FALSE;
+}
+
+/*****************************************************************************/
+
 typedef struct {
 	NMPolicy *policy;
 	NMDevice *device;
@@ -708,14 +829,37 @@ activate_data_free (ActivateData *data)
 	g_free (data);
 }
 
+/* Ignore connections that were tried too many times or are not visible
+ * to any logged-in users.  Also ignore shared wifi connections for
+ * which no user has the shared wifi permission.
+ */
+static gboolean
+auto_activate_allowed (NMConnection *connection, gpointer user_data)
+{
+	NMSettingsConnection *candidate = NM_SETTINGS_CONNECTION (connection);
+	const char *permission;
+
+	if (   get_connection_auto_retries (connection) == 0
+	    || nm_settings_connection_is_visible (candidate) == FALSE)
+		return FALSE;
+
+	permission = nm_utils_get_shared_wifi_permission (connection);
+	if (permission) {
+		if (nm_settings_connection_check_permission (candidate, permission) == FALSE)
+			return FALSE;
+	}
+
+	return TRUE;
+}
+
 static gboolean
 auto_activate_device (gpointer user_data)
 {
 	ActivateData *data = (ActivateData *) user_data;
 	NMPolicy *policy;
-	NMConnection *best_connection;
+	NMConnection *best_connection = NULL;
 	char *specific_object = NULL;
-	GSList *connections, *iter;
+	EligibleSet *set;
 
 	g_assert (data);
 	policy = data->policy;
@@ -730,37 +874,31 @@ auto_activate_device (gpointer user_data)
 	if (nm_device_get_act_request (data->device))
 		goto out;
 
-	iter = connections = nm_settings_get_connections (policy->settings);
-
-	/* Remove connections that shouldn't be auto-activated */
-	while (iter) {
-		NMSettingsConnection *candidate = NM_SETTINGS_CONNECTION (iter->data);
-		gboolean remove_it = FALSE;
-		const char *permission;
+	set = eligible_set_get (policy, data->device);
 
-		/* Grab next item before we possibly delete the current item */
-		iter = g_slist_next (iter);
-
-		/* Ignore connections that were tried too many times or are not visible
-		 * to any logged-in users.  Also ignore shared wifi connections for
-		 * which no user has the shared wifi permission.
-		 */
-		if (   get_connection_auto_retries (NM_CONNECTION (candidate)) == 0
-		    || nm_settings_connection_is_visible (candidate) == FALSE)
-			remove_it = TRUE;
-		else {
-			permission = nm_utils_get_shared_wifi_permission (NM_CONNECTION (candidate));
-			if (permission) {
-				if (nm_settings_connection_check_permission (candidate, permission) == FALSE)
-					remove_it = TRUE;
-			}
+	if (nm_device_has_auto_candidates (data->device)) {
+		/* The device already knows the eligible set */
+		best_connection = nm_device_find_auto_candidate (data->device,
+		                                                 auto_activate_allowed,
+		                                                 policy,
+		                                                 &specific_object);
+	} else {
+		GSList *connections = NULL;
+		GHashTableIter iter;
+		gpointer candidate;
+
+		/* Collect the connections that may be auto-activated right now */
+		g_hash_table_iter_init (&iter, set->connections);
+		while (g_hash_table_iter_next (&iter, &candidate, NULL)) {
+			if (auto_activate_allowed (candidate, policy))
+				connections = g_slist_prepend (connections, candidate);
 		}
+		connections = nm_settings_sort_connections (connections);
 
-		if (remove_it)
-			connections = g_slist_remove (connections, candidate);
+		best_connection = nm_device_get_best_auto_connection (data->device, connections, &specific_object);
+		g_slist_free (connections);
 	}
 
-	best_connection = nm_device_get_best_auto_connection (data->device, connections, &specific_object);
 	if (best_connection) {
 		GError *error = NULL;
 
@@ -778,8 +916,6 @@ auto_activate_device (gpointer user_data)
 		}
 	}
 
-	g_slist_free (connections);
-
  out:
 	activate_data_free (data);
 	return FALSE;
@@ -971,6 +1107,12 @@ device_state_changed (NMDevice *device,
 	if (connection)
 		g_object_set_data (G_OBJECT (connection), FAILURE_REASON_TAG, GUINT_TO_POINTER (0));
 
+	/* The device's permanent address or capabilities may change while it
+	 * is unavailable; recheck which connections it accepts.
+	 */
+	if (new_state <= NM_DEVICE_STATE_UNAVAILABLE)
+		eligible_invalidate (policy, device);
+
 	switch (new_state) {
 	case NM_DEVICE_STATE_FAILED:
 		/* Mark the connection invalid if it failed during activation so that
@@ -979,6 +1121,10 @@ device_state_changed (NMDevice *device,
 		if (connection && IS_ACTIVATING_STATE (old_state)) {
 			guint32 tries = get_connection_auto_retries (connection);
 
+			/* Don't reuse cached agent secrets that may have caused the failure */
+			if (NM_IS_SETTINGS_CONNECTION (connection))
+				nm_settings_connection_clear_secrets_cache (NM_SETTINGS_CONNECTION (connection));
+
 			if (reason == NM_DEVICE_STATE_REASON_NO_SECRETS) {
 				/* If the connection couldn't get the secrets it needed (ex because
 				 * the user canceled, or no secrets exist), there's no point in
@@ -1115,6 +1261,8 @@ device_removed (NMManager *manager, NMDevice *device, gpointer user_data)
 	ActivateData *tmp;
 	GSList *iter;
 
+	g_hash_table_remove (policy->eligible, device);
+
 	/* Clear any idle callbacks for this device */
 	tmp = find_pending_activation (policy->pending_activation_checks, device);
 	if (tmp) {
@@ -1154,8 +1302,11 @@ connection_added (NMSettings *settings,
                   NMConnection *connection,
                   gpointer user_data)
 {
+	NMPolicy *policy = user_data;
+
 	set_connection_auto_retries (connection, RETRIES_DEFAULT);
-	schedule_activate_all ((NMPolicy *) user_data);
+	eligible_update_all (policy, connection, FALSE);
+	schedule_activate_all (policy);
 }
 
 static void
@@ -1176,10 +1327,13 @@ connection_updated (NMSettings *settings,
                     NMConnection *connection,
                     gpointer user_data)
 {
+	NMPolicy *policy = user_data;
+
 	/* Reset auto retries back to default since connection was updated */
 	set_connection_auto_retries (connection, RETRIES_DEFAULT);
 
-	schedule_activate_all ((NMPolicy *) user_data);
+	eligible_update_all (policy, connection, FALSE);
+	schedule_activate_all (policy);
 }
 
 static void
@@ -1213,6 +1367,7 @@ connection_removed (NMSettings *settings,
 {
 	NMPolicy *policy = user_data;
 
+	eligible_update_all (policy, connection, TRUE);
 	_deactivate_if_active (policy->manager, connection);
 }
 
@@ -1277,6 +1432,7 @@ nm_policy_new (NMManager *manager,
 	policy->manager = g_object_ref (manager);
 	policy->settings = g_object_ref (settings);
 	policy->update_state_id = 0;
+	policy->eligible = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, eligible_set_free);
 
 	/* Grab hostname on startup and use that if nothing provides one */
 	memset (hostname, 0, sizeof (hostname));
@@ -1360,6 +1516,8 @@ nm_policy_destroy (NMPolicy *policy)
 	if (policy->reset_retries_id)
 		g_source_remove (policy->reset_retries_id);
 
+	g_hash_table_destroy (policy->eligible);
+
 	g_free (policy->orig_hostname);
 	g_free (policy->cur_hostname);
 
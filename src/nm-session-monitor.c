@@ -26,6 +26,7 @@
 #include <sys/stat.h>
 #include <gio/gio.h>
 #include "nm-logging.h"
+#include "nm-marshal.h"
 
 #include "nm-session-monitor.h"
 
@@ -53,11 +54,13 @@ struct _NMSessionMonitorClass {
 	GObjectClass parent_class;
 
 	void (*changed) (NMSessionMonitor *monitor);
+	void (*user_changed) (NMSessionMonitor *monitor, const char *user, gboolean has_session);
 };
 
 
 enum {
 	CHANGED,
+	USER_CHANGED,
 	LAST_SIGNAL,
 };
 static guint signals[LAST_SIGNAL] = {0};
@@ -293,6 +296,12 @@ ensure_database (NMSessionMonitor *self, GError **error)
 	return TRUE;
 #endif
 
+	/* While the file monitor works it reloads the database on every
+	 * change, so there's no need to check the timestamp on each query.
+	 */
+	if (self->database != NULL && self->database_monitor != NULL)
+		return TRUE;
+
 	if (self->database != NULL) {
 		struct stat statbuf;
 
@@ -326,9 +335,55 @@ on_file_monitor_changed (GFileMonitor *    file_monitor,
                          gpointer          user_data)
 {
 	NMSessionMonitor *self = NM_SESSION_MONITOR (user_data);
+	GHashTable *old_users;
+	GHashTableIter iter;
+	gpointer key;
+	GSList *logged_in = NULL, *logged_out = NULL, *liter;
+	GError *error = NULL;
 
-	/* throw away cache */
-	free_database (self);
+	/* A write shows up as CHANGED events followed by CHANGES_DONE_HINT;
+	 * only read the database once it is complete.
+	 */
+	switch (event_type) {
+	case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+	case G_FILE_MONITOR_EVENT_CREATED:
+	case G_FILE_MONITOR_EVENT_DELETED:
+		break;
+	default:
+		return;
+	}
+
+	/* Remember who had a session before re-reading the database */
+	old_users = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	g_hash_table_iter_init (&iter, self->sessions_by_user);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+		g_hash_table_insert (old_users, g_strdup (key), NULL);
+
+	if (!reload_database (self, &error)) {
+		if (!g_error_matches (error, NM_SESSION_MONITOR_ERROR, NM_SESSION_MONITOR_ERROR_NO_DATABASE))
+			nm_log_warn (LOGD_CORE, "Error reloading " CKDB_PATH ": %s", error->message);
+		g_clear_error (&error);
+	}
+
+	g_hash_table_iter_init (&iter, self->sessions_by_user);
+	while (g_hash_table_iter_next (&iter, &key, NULL)) {
+		if (!g_hash_table_remove (old_users, key))
+			logged_in = g_slist_prepend (logged_in, g_strdup (key));
+	}
+	g_hash_table_iter_init (&iter, old_users);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+		logged_out = g_slist_prepend (logged_out, g_strdup (key));
+	g_hash_table_destroy (old_users);
+
+	for (liter = logged_out; liter; liter = g_slist_next (liter))
+		g_signal_emit (self, signals[USER_CHANGED], 0, liter->data, FALSE);
+	for (liter = logged_in; liter; liter = g_slist_next (liter))
+		g_signal_emit (self, signals[USER_CHANGED], 0, liter->data, TRUE);
+
+	g_slist_foreach (logged_out, (GFunc) g_free, NULL);
+	g_slist_free (logged_out);
+	g_slist_foreach (logged_in, (GFunc) g_free, NULL);
+	g_slist_free (logged_in);
 
 	g_signal_emit (self, signals[CHANGED], 0);
 }
@@ -412,6 +467,25 @@ nm_session_monitor_class_init (NMSessionMonitorClass *klass)
 	                                 NULL,                   /* accumulator data */
 	                                 g_cclosure_marshal_VOID__VOID,
 	                                 G_TYPE_NONE, 0);
+
+	/**
+	 * NMSessionMonitor::user-changed:
+	 * @monitor: A #NMSessionMonitor
+	 * @user: the username
+	 * @has_session: whether @user is now logged into any session
+	 *
+	 * Emitted for each user that logged into their first session or out of
+	 * their last one, before #NMSessionMonitor::changed.
+	 */
+	signals[USER_CHANGED] = g_signal_new (NM_SESSION_MONITOR_USER_CHANGED,
+	                                      NM_TYPE_SESSION_MONITOR,
+	                                      G_SIGNAL_RUN_LAST,
+	                                      G_STRUCT_OFFSET (NMSessionMonitorClass, user_changed),
+	                                      NULL,                   /* accumulator      */
+	                                      NULL,                   /* accumulator data */
+	                                      _nm_marshal_VOID__STRING_BOOLEAN,
+	                                      G_TYPE_NONE, 2,
+	                                      G_TYPE_STRING, G_TYPE_BOOLEAN);
 }
 
 NMSessionMonitor *
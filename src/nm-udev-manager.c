@@ -34,6 +34,7 @@
 #include "nm-udev-manager.h"
 #include "nm-marshal.h"
 #include "nm-logging.h"
+#include "nm-hw-control.h"
 #include "NetworkManagerUtils.h"
 #include "nm-device-wifi.h"
 #include "nm-device-olpc-mesh.h"
@@ -49,6 +50,10 @@ typedef struct {
 	RfKillState rfkill_states[RFKILL_TYPE_MAX];
 	GSList *killswitches;
 
+	/* Devices found at startup, waiting for their hardware probes */
+	GSList *probing;
+	gboolean probe_queued;
+
 	gboolean disposed;
 } NMUdevManagerPrivate;
 
@@ -491,20 +496,20 @@ out:
 	return device;
 }
 
-static void
-net_add (NMUdevManager *self, GUdevDevice *device)
+static gboolean
+net_should_add (NMUdevManager *self, GUdevDevice *device)
 {
 	gint etype;
 	const char *iface;
 	const char *tmp;
 	gboolean is_ctc;
 
-	g_return_if_fail (device != NULL);
+	g_return_val_if_fail (device != NULL, FALSE);
 
 	iface = g_udev_device_get_name (device);
 	if (!iface) {
 		nm_log_dbg (LOGD_HW, "failed to get device's interface");
-		return;
+		return FALSE;
 	}
 
 	etype = g_udev_device_get_sysfs_attr_as_int (device, "type");
@@ -540,19 +545,66 @@ net_add (NMUdevManager *self, GUdevDevice *device)
 		tmp = g_udev_device_get_property (device, "ID_MODEL");
 		if (tmp && (strstr (tmp, "PC-Suite") || strstr (tmp, "PC Suite"))) {
 			nm_log_dbg (LOGD_HW, "ignoring Nokia PC-Suite ethernet interface");
-			return;
+			return FALSE;
 		}
 	}
 
-	g_signal_emit (self, signals[DEVICE_ADDED], 0, device, device_creator);
+	return TRUE;
+}
+
+static void
+net_add (NMUdevManager *self, GUdevDevice *device)
+{
+	if (net_should_add (self, device))
+		g_signal_emit (self, signals[DEVICE_ADDED], 0, device, device_creator);
 }
 
 static void
 net_remove (NMUdevManager *self, GUdevDevice *device)
 {
+	NMUdevManagerPrivate *priv = NM_UDEV_MANAGER_GET_PRIVATE (self);
+	GSList *iter;
+
+	/* Don't create a device that went away while it was being probed */
+	for (iter = priv->probing; iter; iter = g_slist_next (iter)) {
+		GUdevDevice *candidate = iter->data;
+
+		if (!g_strcmp0 (g_udev_device_get_name (candidate), g_udev_device_get_name (device))) {
+			priv->probing = g_slist_delete_link (priv->probing, iter);
+			g_object_unref (candidate);
+			break;
+		}
+	}
+
 	g_signal_emit (self, signals[DEVICE_REMOVED], 0, device);
 }
 
+static void
+query_devices_probed (gpointer user_data)
+{
+	NMUdevManager *self = NM_UDEV_MANAGER (user_data);
+	NMUdevManagerPrivate *priv = NM_UDEV_MANAGER_GET_PRIVATE (self);
+	GSList *devices, *iter;
+
+	priv->probe_queued = FALSE;
+
+	/* All devices are created and exported in one go */
+	devices = priv->probing;
+	priv->probing = NULL;
+	for (iter = devices; iter; iter = g_slist_next (iter)) {
+		g_signal_emit (self, signals[DEVICE_ADDED], 0, iter->data, device_creator);
+		g_object_unref (iter->data);
+	}
+	g_slist_free (devices);
+
+	g_object_unref (self);
+}
+
+/* Probing the hardware of a device blocks on driver ioctls, which can take
+ * long for some drivers and adds up with many interfaces.  At startup
+ * the probes for all interfaces run in parallel on worker threads first;
+ * the devices are then created from the cached results.
+ */
 void
 nm_udev_manager_query_devices (NMUdevManager *self)
 {
@@ -564,10 +616,30 @@ nm_udev_manager_query_devices (NMUdevManager *self)
 
 	devices = g_udev_client_query_by_subsystem (priv->client, "net");
 	for (iter = devices; iter; iter = g_list_next (iter)) {
-		net_add (self, G_UDEV_DEVICE (iter->data));
-		g_object_unref (G_UDEV_DEVICE (iter->data));
+		GUdevDevice *device = G_UDEV_DEVICE (iter->data);
+		gint ifindex;
+
+		if (net_should_add (self, device)) {
+			/* Devices with an invalid ifindex are not probed; they are
+			 * still queued so device_creator() warns about them.
+			 */
+			ifindex = g_udev_device_get_sysfs_attr_as_int (device, "ifindex");
+			if (ifindex > 0 && !is_olpc_mesh (device)) {
+				nm_hw_control_prefetch (ifindex,
+				                        g_udev_device_get_name (device),
+				                        is_wireless (device));
+			}
+			priv->probing = g_slist_prepend (priv->probing, g_object_ref (device));
+		}
+		g_object_unref (device);
 	}
 	g_list_free (devices);
+
+	priv->probing = g_slist_reverse (priv->probing);
+	if (priv->probing && !priv->probe_queued) {
+		priv->probe_queued = TRUE;
+		nm_hw_control_prefetch_wait (query_devices_probed, g_object_ref (self));
+	}
 }
 
 static void
@@ -646,6 +718,10 @@ dispose (GObject *object)
 	g_slist_foreach (priv->killswitches, (GFunc) killswitch_destroy, NULL);
 	g_slist_free (priv->killswitches);
 
+	g_slist_foreach (priv->probing, (GFunc) g_object_unref, NULL);
+	g_slist_free (priv->probing);
+	priv->probing = NULL;
+
 	G_OBJECT_CLASS (nm_udev_manager_parent_class)->dispose (object);	
 }
 
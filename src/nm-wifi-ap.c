@@ -936,13 +936,9 @@ void nm_ap_set_address (NMAccessPoint *ap, const struct ether_addr * addr)
  */
 NM80211Mode nm_ap_get_mode (NMAccessPoint *ap)
 {
-	NM80211Mode mode;
-
 	g_return_val_if_fail (NM_IS_AP (ap), -1);
 
-	g_object_get (ap, NM_AP_MODE, &mode, NULL);
-
-	return mode;
+	return NM_AP_GET_PRIVATE (ap)->mode;
 }
 
 void nm_ap_set_mode (NMAccessPoint *ap, const NM80211Mode mode)
@@ -969,13 +965,9 @@ void nm_ap_set_mode (NMAccessPoint *ap, const NM80211Mode mode)
  */
 gint8 nm_ap_get_strength (NMAccessPoint *ap)
 {
-	gint8 strength;
-
 	g_return_val_if_fail (NM_IS_AP (ap), 0);
 
-	g_object_get (ap, NM_AP_STRENGTH, &strength, NULL);
-
-	return strength;
+	return NM_AP_GET_PRIVATE (ap)->strength;
 }
 
 void nm_ap_set_strength (NMAccessPoint *ap, const gint8 strength)
@@ -1000,13 +992,9 @@ void nm_ap_set_strength (NMAccessPoint *ap, const gint8 strength)
 guint32
 nm_ap_get_freq (NMAccessPoint *ap)
 {
-	guint32 freq;
-
 	g_return_val_if_fail (NM_IS_AP (ap), 0);
 
-	g_object_get (ap, NM_AP_FREQUENCY, &freq, NULL);
-
-	return freq;
+	return NM_AP_GET_PRIVATE (ap)->freq;
 }
 
 void
@@ -1032,13 +1020,9 @@ nm_ap_set_freq (NMAccessPoint *ap,
  */
 guint32 nm_ap_get_max_bitrate (NMAccessPoint *ap)
 {
-	guint32 rate;
-
 	g_return_val_if_fail (NM_IS_AP (ap), 0);
 
-	g_object_get (ap, NM_AP_MAX_BITRATE, &rate, NULL);
-
-	return rate;
+	return NM_AP_GET_PRIVATE (ap)->max_bitrate;
 }
 
 void
@@ -1113,6 +1097,72 @@ void nm_ap_set_last_seen (NMAccessPoint *ap, const glong last_seen)
 	NM_AP_GET_PRIVATE (ap)->last_seen = last_seen;
 }
 
+static gboolean
+ssid_is_hidden (const GByteArray *ssid)
+{
+	return !ssid || nm_utils_is_empty_ssid (ssid->data, ssid->len);
+}
+
+/**
+ * nm_ap_update_from_scan:
+ * @ap: an access point already in the scan list
+ * @scanned: a new scan result for the same BSS
+ *
+ * Copies the scanned attributes of @scanned into @ap, and its SSID if
+ * that of @ap was hidden.  Strength changes smaller than
+ * NM_AP_STRENGTH_HYSTERESIS are ignored so ordinary RSSI jitter doesn't
+ * cause property change notifications; when nothing else changed either,
+ * only the last-seen time is updated and no notification is emitted at
+ * all.
+ *
+ * Returns: %TRUE if any exported property of @ap changed
+ */
+gboolean
+nm_ap_update_from_scan (NMAccessPoint *ap, NMAccessPoint *scanned)
+{
+	NMAccessPointPrivate *priv, *new;
+	gboolean strength_changed, ssid_found;
+
+	g_return_val_if_fail (NM_IS_AP (ap), FALSE);
+	g_return_val_if_fail (NM_IS_AP (scanned), FALSE);
+
+	priv = NM_AP_GET_PRIVATE (ap);
+	new = NM_AP_GET_PRIVATE (scanned);
+
+	/* If the AP is noticed in a scan, it's automatically no longer
+	 * fake, since it clearly exists somewhere.
+	 */
+	priv->fake = FALSE;
+	priv->last_seen = new->last_seen;
+	priv->broadcast = new->broadcast;
+
+	strength_changed = ABS (priv->strength - new->strength) >= NM_AP_STRENGTH_HYSTERESIS;
+	ssid_found = ssid_is_hidden (priv->ssid) && !ssid_is_hidden (new->ssid);
+
+	if (   priv->flags == new->flags
+	    && priv->wpa_flags == new->wpa_flags
+	    && priv->rsn_flags == new->rsn_flags
+	    && priv->freq == new->freq
+	    && priv->max_bitrate == new->max_bitrate
+	    && !strength_changed
+	    && !ssid_found)
+		return FALSE;
+
+	g_object_freeze_notify (G_OBJECT (ap));
+	if (ssid_found)
+		nm_ap_set_ssid (ap, new->ssid);
+	nm_ap_set_flags (ap, new->flags);
+	nm_ap_set_wpa_flags (ap, new->wpa_flags);
+	nm_ap_set_rsn_flags (ap, new->rsn_flags);
+	nm_ap_set_freq (ap, new->freq);
+	nm_ap_set_max_bitrate (ap, new->max_bitrate);
+	if (strength_changed)
+		nm_ap_set_strength (ap, new->strength);
+	g_object_thaw_notify (G_OBJECT (ap));
+
+	return TRUE;
+}
+
 gboolean
 nm_ap_check_compatible (NMAccessPoint *self,
                         NMConnection *connection)
@@ -1239,11 +1289,18 @@ nm_ap_match_in_list (NMAccessPoint *find_ap,
 		const struct ether_addr * find_addr = nm_ap_get_address (find_ap);
 
 		/* SSID match; if both APs are hiding their SSIDs,
-		 * let matching continue on BSSID and other properties
+		 * let matching continue on BSSID and other properties.  A hidden
+		 * AP whose SSID has become known only matches the same BSSID.
 		 */
-		if (   (!list_ssid && find_ssid)
-		    || (list_ssid && !find_ssid)
-		    || !nm_utils_same_ssid (list_ssid, find_ssid, TRUE))
+		if (ssid_is_hidden (list_ssid) && !ssid_is_hidden (find_ssid)) {
+			if (   !nm_ethernet_address_is_valid (list_addr)
+			    || memcmp (list_addr->ether_addr_octet,
+			               find_addr->ether_addr_octet,
+			               ETH_ALEN) != 0)
+				continue;
+		} else if (   (!list_ssid && find_ssid)
+		           || (list_ssid && !find_ssid)
+		           || !nm_utils_same_ssid (list_ssid, find_ssid, TRUE))
 			continue;
 
 		/* BSSID match */
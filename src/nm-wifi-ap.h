@@ -100,6 +100,11 @@ void				nm_ap_set_broadcast		(NMAccessPoint *ap, gboolean broadcast);
 glong			nm_ap_get_last_seen		(const NMAccessPoint *ap);
 void				nm_ap_set_last_seen		(NMAccessPoint *ap, const glong last_seen);
 
+/* Scanned strength changes smaller than this (percent) aren't reported */
+#define NM_AP_STRENGTH_HYSTERESIS 5
+
+gboolean			nm_ap_update_from_scan (NMAccessPoint *ap, NMAccessPoint *scanned);
+
 gboolean			nm_ap_check_compatible (NMAccessPoint *self,
                                             NMConnection *connection);
 
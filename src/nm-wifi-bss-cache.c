@@ -0,0 +1,447 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <net/ethernet.h>
+#include <netinet/ether.h>
+
+#include "nm-wifi-bss-cache.h"
+#include "nm-logging.h"
+#include "nm-utils.h"
+#include "NetworkManagerUtils.h"
+
+#define BSS_CACHE_FILE LOCALSTATEDIR"/lib/NetworkManager/bss-cache"
+
+/* Most BSSes kept; the least recently seen one is dropped beyond this */
+#define MAX_ENTRIES 256
+
+/* Seconds to batch up scan results before writing the file */
+#define SAVE_DELAY 60
+
+typedef struct {
+	struct ether_addr bssid;
+	GByteArray *ssid;
+	NM80211Mode mode;
+	guint32 flags;
+	guint32 wpa_flags;
+	guint32 rsn_flags;
+	guint32 freq;
+	guint32 max_bitrate;
+	gint8 strength;
+	glong last_seen;
+} CacheEntry;
+
+struct _NMWifiBssCache {
+	guint refcount;
+	GHashTable *entries;    /* struct ether_addr -> CacheEntry */
+	gboolean dirty;
+	guint save_id;
+};
+
+static NMWifiBssCache *singleton = NULL;
+
+static guint
+mac_hash (gconstpointer v)
+{
+	const guint8 *p = v;
+	guint32 i, h = 5381;
+
+	for (i = 0; i < ETH_ALEN; i++)
+		h = (h << 5) + h + p[i];
+	return h;
+}
+
+static gboolean
+mac_equal (gconstpointer a, gconstpointer b)
+{
+	return memcmp (a, b, ETH_ALEN) == 0;
+}
+
+static void
+cache_entry_free (gpointer data)
+{
+	CacheEntry *entry = data;
+
+	if (entry->ssid)
+		g_byte_array_free (entry->ssid, TRUE);
+	g_slice_free (CacheEntry, entry);
+}
+
+static glong
+now_seconds (void)
+{
+	GTimeVal now;
+
+	g_get_current_time (&now);
+	return now.tv_sec;
+}
+
+static void
+load (NMWifiBssCache *cache)
+{
+	GKeyFile *key_file;
+	char **groups;
+	gsize num = 0, i;
+
+	key_file = g_key_file_new ();
+	if (!g_key_file_load_from_file (key_file, BSS_CACHE_FILE, G_KEY_FILE_NONE, NULL)) {
+		g_key_file_free (key_file);
+		return;
+	}
+
+	/* Files from older versions were world-readable */
+	chmod (BSS_CACHE_FILE, S_IRUSR | S_IWUSR);
+
+	groups = g_key_file_get_groups (key_file, &num);
+	for (i = 0; i < num; i++) {
+		struct ether_addr bssid;
+		CacheEntry *entry;
+		gint *ssid;
+		gsize ssid_len = 0, j;
+		char *tmp;
+
+		if (!ether_aton_r (groups[i], &bssid))
+			continue;
+
+		ssid = g_key_file_get_integer_list (key_file, groups[i], "ssid", &ssid_len, NULL);
+		if (!ssid || !ssid_len || ssid_len > 32) {
+			g_free (ssid);
+			continue;
+		}
+
+		entry = g_slice_new0 (CacheEntry);
+		memcpy (&entry->bssid, &bssid, sizeof (bssid));
+		entry->ssid = g_byte_array_sized_new (ssid_len);
+		for (j = 0; j < ssid_len; j++) {
+			guint8 c = (guint8) CLAMP (ssid[j], 0, 255);
+
+			g_byte_array_append (entry->ssid, &c, 1);
+		}
+		g_free (ssid);
+
+		entry->mode = g_key_file_get_integer (key_file, groups[i], "mode", NULL);
+		entry->flags = g_key_file_get_integer (key_file, groups[i], "flags", NULL);
+		entry->wpa_flags = g_key_file_get_integer (key_file, groups[i], "wpa-flags", NULL);
+		entry->rsn_flags = g_key_file_get_integer (key_file, groups[i], "rsn-flags", NULL);
+		entry->freq = g_key_file_get_integer (key_file, groups[i], "frequency", NULL);
+		entry->max_bitrate = g_key_file_get_integer (key_file, groups[i], "max-bitrate", NULL);
+		entry->strength = CLAMP (g_key_file_get_integer (key_file, groups[i], "strength", NULL), 0, 100);
+
+		tmp = g_key_file_get_value (key_file, groups[i], "last-seen", NULL);
+		if (tmp)
+			entry->last_seen = (glong) g_ascii_strtoull (tmp, NULL, 10);
+		g_free (tmp);
+
+		if (!entry->freq || !entry->last_seen) {
+			cache_entry_free (entry);
+			continue;
+		}
+
+		g_hash_table_insert (cache->entries, &entry->bssid, entry);
+	}
+	g_strfreev (groups);
+	g_key_file_free (key_file);
+
+	nm_log_dbg (LOGD_WIFI_SCAN, "loaded %d cached BSSes from " BSS_CACHE_FILE,
+	            g_hash_table_size (cache->entries));
+}
+
+/* The cache is a location history, so only root may read it.  Written to
+ * a private temporary file that replaces the old one, which also fixes the
+ * mode of files written by older versions.
+ */
+static gboolean
+write_private (const char *data, gsize len, GError **error)
+{
+	char *tmp_path;
+	int fd, errsv = 0;
+	gssize written;
+
+	tmp_path = g_strdup (BSS_CACHE_FILE ".XXXXXX");
+	fd = g_mkstemp_full (tmp_path, O_RDWR, S_IRUSR | S_IWUSR);
+	if (fd < 0) {
+		errsv = errno;
+		g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errsv),
+		             "failed to create temporary file: %s", g_strerror (errsv));
+		g_free (tmp_path);
+		return FALSE;
+	}
+
+	while (len > 0) {
+		written = write (fd, data, len);
+		if (written < 0) {
+			if (errno == EINTR)
+				continue;
+			errsv = errno;
+			break;
+		}
+		data += written;
+		len -= written;
+	}
+
+	if (close (fd) < 0 && !errsv)
+		errsv = errno;
+	if (!errsv && rename (tmp_path, BSS_CACHE_FILE) < 0)
+		errsv = errno;
+
+	if (errsv) {
+		g_set_error (error, G_FILE_ERROR, g_file_error_from_errno (errsv),
+		             "failed to write file: %s", g_strerror (errsv));
+		unlink (tmp_path);
+	}
+	g_free (tmp_path);
+	return errsv == 0;
+}
+
+static void
+save (NMWifiBssCache *cache)
+{
+	GKeyFile *key_file;
+	GHashTableIter iter;
+	CacheEntry *entry;
+	glong now = now_seconds ();
+	char *data;
+	gsize len = 0;
+	GError *error = NULL;
+
+	key_file = g_key_file_new ();
+
+	g_hash_table_iter_init (&iter, cache->entries);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &entry)) {
+		char *group, *tmp;
+		gint ssid[32];
+		guint i;
+
+		/* Too old to ever be offered again */
+		if (entry->last_seen + NM_WIFI_BSS_CACHE_MAX_AGE < now)
+			continue;
+
+		for (i = 0; i < entry->ssid->len; i++)
+			ssid[i] = entry->ssid->data[i];
+
+		group = nm_ether_ntop (&entry->bssid);
+		g_key_file_set_integer_list (key_file, group, "ssid", ssid, entry->ssid->len);
+		g_key_file_set_integer (key_file, group, "mode", entry->mode);
+		g_key_file_set_integer (key_file, group, "flags", entry->flags);
+		g_key_file_set_integer (key_file, group, "wpa-flags", entry->wpa_flags);
+		g_key_file_set_integer (key_file, group, "rsn-flags", entry->rsn_flags);
+		g_key_file_set_integer (key_file, group, "frequency", entry->freq);
+		g_key_file_set_integer (key_file, group, "max-bitrate", entry->max_bitrate);
+		g_key_file_set_integer (key_file, group, "strength", entry->strength);
+
+		tmp = g_strdup_printf ("%ld", entry->last_seen);
+		g_key_file_set_value (key_file, group, "last-seen", tmp);
+		g_free (tmp);
+		g_free (group);
+	}
+
+	data = g_key_file_to_data (key_file, &len, &error);
+	if (data) {
+		write_private (data, len, &error);
+		g_free (data);
+	}
+	if (error) {
+		nm_log_warn (LOGD_WIFI_SCAN, "error saving BSS cache file '%s': %s",
+		             BSS_CACHE_FILE, error->message);
+		g_error_free (error);
+	}
+	g_key_file_free (key_file);
+
+	cache->dirty = FALSE;
+}
+
+static gboolean
+save_cb (gpointer user_data)
+{
+	NMWifiBssCache *cache = user_data;
+
+	cache->save_id = 0;
+	save (cache);
+	return FALSE;
+}
+
+/**
+ * nm_wifi_bss_cache_get:
+ *
+ * Returns: a reference to the BSS cache shared by all Wi-Fi devices,
+ * loaded from disk the first time; release with nm_wifi_bss_cache_unref()
+ */
+NMWifiBssCache *
+nm_wifi_bss_cache_get (void)
+{
+	if (!singleton) {
+		singleton = g_slice_new0 (NMWifiBssCache);
+		singleton->entries = g_hash_table_new_full (mac_hash, mac_equal, NULL, cache_entry_free);
+		load (singleton);
+	}
+
+	singleton->refcount++;
+	return singleton;
+}
+
+void
+nm_wifi_bss_cache_unref (NMWifiBssCache *cache)
+{
+	g_return_if_fail (cache != NULL);
+	g_return_if_fail (cache == singleton);
+	g_return_if_fail (cache->refcount > 0);
+
+	if (--cache->refcount)
+		return;
+
+	nm_wifi_bss_cache_flush (cache);
+	g_hash_table_destroy (cache->entries);
+	g_slice_free (NMWifiBssCache, cache);
+	singleton = NULL;
+}
+
+static void
+drop_oldest (NMWifiBssCache *cache)
+{
+	GHashTableIter iter;
+	CacheEntry *entry, *oldest = NULL;
+
+	g_hash_table_iter_init (&iter, cache->entries);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &entry)) {
+		if (!oldest || entry->last_seen < oldest->last_seen)
+			oldest = entry;
+	}
+
+	if (oldest)
+		g_hash_table_remove (cache->entries, &oldest->bssid);
+}
+
+/**
+ * nm_wifi_bss_cache_update:
+ * @cache: the BSS cache
+ * @ap: a freshly scanned access point
+ *
+ * Records @ap in the cache; the file is rewritten a little later so a
+ * burst of scan results costs a single write.
+ */
+void
+nm_wifi_bss_cache_update (NMWifiBssCache *cache, NMAccessPoint *ap)
+{
+	const GByteArray *ssid;
+	CacheEntry *entry;
+
+	g_return_if_fail (cache != NULL);
+	g_return_if_fail (NM_IS_AP (ap));
+
+	/* Only real infrastructure BSSes with a known SSID are worth offering
+	 * before they show up in a scan; IBSS BSSIDs are transient anyway.
+	 */
+	ssid = nm_ap_get_ssid (ap);
+	if (   !ssid
+	    || nm_utils_is_empty_ssid (ssid->data, ssid->len)
+	    || ssid->len > 32
+	    || !nm_ap_get_freq (ap)
+	    || nm_ap_get_fake (ap)
+	    || nm_ap_get_mode (ap) != NM_802_11_MODE_INFRA)
+		return;
+
+	entry = g_hash_table_lookup (cache->entries, nm_ap_get_address (ap));
+	if (!entry) {
+		if (g_hash_table_size (cache->entries) >= MAX_ENTRIES)
+			drop_oldest (cache);
+
+		entry = g_slice_new0 (CacheEntry);
+		memcpy (&entry->bssid, nm_ap_get_address (ap), sizeof (struct ether_addr));
+		g_hash_table_insert (cache->entries, &entry->bssid, entry);
+	}
+
+	if (entry->ssid)
+		g_byte_array_free (entry->ssid, TRUE);
+	entry->ssid = g_byte_array_sized_new (ssid->len);
+	g_byte_array_append (entry->ssid, ssid->data, ssid->len);
+
+	entry->mode = nm_ap_get_mode (ap);
+	entry->flags = nm_ap_get_flags (ap);
+	entry->wpa_flags = nm_ap_get_wpa_flags (ap);
+	entry->rsn_flags = nm_ap_get_rsn_flags (ap);
+	entry->freq = nm_ap_get_freq (ap);
+	entry->max_bitrate = nm_ap_get_max_bitrate (ap);
+	entry->strength = nm_ap_get_strength (ap);
+	entry->last_seen = nm_ap_get_last_seen (ap);
+
+	cache->dirty = TRUE;
+	if (!cache->save_id)
+		cache->save_id = g_timeout_add_seconds (SAVE_DELAY, save_cb, cache);
+}
+
+/**
+ * nm_wifi_bss_cache_get_aps:
+ * @cache: the BSS cache
+ * @max_age: only return BSSes seen at most this many seconds ago
+ *
+ * Returns: a list of new #NMAccessPoint objects for the cached BSSes;
+ * the caller owns the list and the references
+ */
+GSList *
+nm_wifi_bss_cache_get_aps (NMWifiBssCache *cache, glong max_age)
+{
+	GHashTableIter iter;
+	CacheEntry *entry;
+	GSList *aps = NULL;
+	glong now = now_seconds ();
+
+	g_return_val_if_fail (cache != NULL, NULL);
+
+	g_hash_table_iter_init (&iter, cache->entries);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &entry)) {
+		NMAccessPoint *ap;
+
+		if (entry->last_seen + max_age < now)
+			continue;
+
+		ap = nm_ap_new ();
+		nm_ap_set_address (ap, &entry->bssid);
+		nm_ap_set_ssid (ap, entry->ssid);
+		nm_ap_set_mode (ap, entry->mode);
+		nm_ap_set_flags (ap, entry->flags);
+		nm_ap_set_wpa_flags (ap, entry->wpa_flags);
+		nm_ap_set_rsn_flags (ap, entry->rsn_flags);
+		nm_ap_set_freq (ap, entry->freq);
+		nm_ap_set_max_bitrate (ap, entry->max_bitrate);
+		nm_ap_set_strength (ap, entry->strength);
+		nm_ap_set_last_seen (ap, entry->last_seen);
+		aps = g_slist_prepend (aps, ap);
+	}
+
+	return aps;
+}
+
+void
+nm_wifi_bss_cache_flush (NMWifiBssCache *cache)
+{
+	g_return_if_fail (cache != NULL);
+
+	if (cache->save_id) {
+		g_source_remove (cache->save_id);
+		cache->save_id = 0;
+	}
+
+	if (cache->dirty)
+		save (cache);
+}
@@ -0,0 +1,45 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ */
+
+#ifndef NM_WIFI_BSS_CACHE_H
+#define NM_WIFI_BSS_CACHE_H
+
+#include <glib.h>
+
+#include "nm-wifi-ap.h"
+
+/* Cached BSSes older than this (seconds) aren't offered as candidates */
+#define NM_WIFI_BSS_CACHE_MAX_AGE (24 * 60 * 60)
+
+typedef struct _NMWifiBssCache NMWifiBssCache;
+
+NMWifiBssCache *nm_wifi_bss_cache_get     (void);
+
+void            nm_wifi_bss_cache_unref   (NMWifiBssCache *cache);
+
+void            nm_wifi_bss_cache_update  (NMWifiBssCache *cache,
+                                           NMAccessPoint *ap);
+
+GSList *        nm_wifi_bss_cache_get_aps (NMWifiBssCache *cache,
+                                           glong max_age);
+
+void            nm_wifi_bss_cache_flush   (NMWifiBssCache *cache);
+
+#endif /* NM_WIFI_BSS_CACHE_H */
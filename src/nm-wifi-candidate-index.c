@@ -0,0 +1,489 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ */
+
+#include <string.h>
+#include <netinet/ether.h>
+
+#include "nm-wifi-candidate-index.h"
+#include "nm-setting-connection.h"
+#include "nm-setting-wireless.h"
+#include "nm-setting-ip4-config.h"
+#include "nm-settings-connection.h"
+
+/* Everything auto-activation needs to know about an eligible connection,
+ * parsed when the connection is added or updated.
+ */
+typedef struct {
+	NMWifiCandidateIndex *index;
+	NMConnection *connection;
+
+	gboolean usable;     /* Wi-Fi, autoconnect, allowed on this device */
+	gboolean shared;
+	GByteArray *ssid;    /* without trailing NUL; NULL unless usable by SSID */
+
+	/* For targeted scans, of any connection with a wireless setting */
+	GByteArray *known_ssid;
+	GArray *known_bssids;  /* struct ether_addr */
+
+	/* Per-lookup filter result */
+	guint generation;
+	gboolean allowed;
+} Candidate;
+
+struct _NMWifiCandidateIndex {
+	GHashTable *by_connection;   /* NMConnection -> Candidate */
+	GHashTable *by_ssid;         /* GByteArray -> GSList of Candidate */
+	GSList *shared;              /* usable shared Candidates */
+	guint8 perm_hw_addr[ETH_ALEN];
+	guint generation;
+
+	gboolean known_changed;
+};
+
+static guint
+ssid_hash (gconstpointer v)
+{
+	const GByteArray *ssid = v;
+	guint32 i, h = 5381;
+
+	for (i = 0; i < ssid->len; i++)
+		h = (h << 5) + h + ssid->data[i];
+	return h;
+}
+
+static gboolean
+ssid_equal (gconstpointer a, gconstpointer b)
+{
+	const GByteArray *ssid_a = a, *ssid_b = b;
+
+	return    ssid_a->len == ssid_b->len
+	       && memcmp (ssid_a->data, ssid_b->data, ssid_a->len) == 0;
+}
+
+static void
+ssid_free (gpointer data)
+{
+	g_byte_array_free ((GByteArray *) data, TRUE);
+}
+
+/* Same normalization as nm_utils_same_ssid (..., TRUE) */
+static guint
+ssid_key_len (const GByteArray *ssid)
+{
+	if (ssid->len && ssid->data[ssid->len - 1] == '\0')
+		return ssid->len - 1;
+	return ssid->len;
+}
+
+static void
+candidate_unlink_ssid (NMWifiCandidateIndex *index, Candidate *c)
+{
+	gpointer key = NULL, list = NULL;
+	GSList *new_list;
+
+	if (!c->ssid)
+		return;
+	if (!g_hash_table_lookup_extended (index->by_ssid, c->ssid, &key, &list))
+		return;
+
+	new_list = g_slist_remove (list, c);
+	if (new_list == list)
+		return;
+
+	/* The old head is gone already; don't let the table free it again */
+	g_hash_table_steal (index->by_ssid, key);
+	if (new_list)
+		g_hash_table_insert (index->by_ssid, key, new_list);
+	else
+		ssid_free (key);
+}
+
+/* Undoes candidate_parse() */
+static void
+candidate_reset (NMWifiCandidateIndex *index, Candidate *c)
+{
+	candidate_unlink_ssid (index, c);
+	if (c->shared)
+		index->shared = g_slist_remove (index->shared, c);
+	if (c->ssid)
+		g_byte_array_free (c->ssid, TRUE);
+	if (c->known_ssid)
+		g_byte_array_free (c->known_ssid, TRUE);
+	if (c->known_bssids)
+		g_array_free (c->known_bssids, TRUE);
+
+	c->usable = FALSE;
+	c->shared = FALSE;
+	c->ssid = NULL;
+	c->known_ssid = NULL;
+	c->known_bssids = NULL;
+}
+
+static void
+candidate_free (gpointer data)
+{
+	Candidate *c = data;
+
+	candidate_reset (c->index, c);
+	g_object_unref (c->connection);
+	g_slice_free (Candidate, c);
+}
+
+static void
+candidate_parse (NMWifiCandidateIndex *index, Candidate *c)
+{
+	NMConnection *connection = c->connection;
+	NMSettingConnection *s_con;
+	NMSettingWireless *s_wireless;
+	NMSettingIP4Config *s_ip4;
+	const GByteArray *mac, *ssid;
+	const GSList *iter;
+	GSList *list;
+
+	s_con = (NMSettingConnection *) nm_connection_get_setting (connection, NM_TYPE_SETTING_CONNECTION);
+	s_wireless = (NMSettingWireless *) nm_connection_get_setting (connection, NM_TYPE_SETTING_WIRELESS);
+
+	if (s_wireless) {
+		guint32 i;
+
+		ssid = nm_setting_wireless_get_ssid (s_wireless);
+		if (ssid) {
+			c->known_ssid = g_byte_array_sized_new (ssid->len);
+			g_byte_array_append (c->known_ssid, ssid->data, ssid->len);
+		}
+		c->known_bssids = g_array_new (FALSE, FALSE, sizeof (struct ether_addr));
+		for (i = 0; i < nm_setting_wireless_get_num_seen_bssids (s_wireless); i++) {
+			struct ether_addr addr;
+
+			if (ether_aton_r (nm_setting_wireless_get_seen_bssid (s_wireless, i), &addr))
+				g_array_append_val (c->known_bssids, addr);
+		}
+	}
+
+	if (!s_con || !s_wireless)
+		return;
+	if (strcmp (nm_setting_connection_get_connection_type (s_con), NM_SETTING_WIRELESS_SETTING_NAME))
+		return;
+	if (!nm_setting_connection_get_autoconnect (s_con))
+		return;
+
+	mac = nm_setting_wireless_get_mac_address (s_wireless);
+	if (mac && memcmp (mac->data, index->perm_hw_addr, ETH_ALEN))
+		return;
+
+	/* Found device MAC address in the blacklist - do not use this connection */
+	for (iter = nm_setting_wireless_get_mac_address_blacklist (s_wireless); iter; iter = g_slist_next (iter)) {
+		struct ether_addr addr;
+
+		if (!ether_aton_r (iter->data, &addr)) {
+			g_warn_if_reached ();
+			continue;
+		}
+		if (memcmp (&addr, index->perm_hw_addr, ETH_ALEN) == 0)
+			return;
+	}
+
+	s_ip4 = (NMSettingIP4Config *) nm_connection_get_setting (connection, NM_TYPE_SETTING_IP4_CONFIG);
+	if (s_ip4 && !strcmp (nm_setting_ip4_config_get_method (s_ip4), NM_SETTING_IP4_CONFIG_METHOD_SHARED))
+		c->shared = TRUE;
+
+	c->usable = TRUE;
+
+	/* Shared connections don't need a matching AP, so only the others
+	 * are reachable by SSID.
+	 */
+	if (c->shared) {
+		index->shared = g_slist_prepend (index->shared, c);
+		return;
+	}
+
+	ssid = nm_setting_wireless_get_ssid (s_wireless);
+	if (!ssid)
+		return;
+
+	c->ssid = g_byte_array_sized_new (ssid->len);
+	g_byte_array_append (c->ssid, ssid->data, ssid_key_len (ssid));
+
+	list = g_hash_table_lookup (index->by_ssid, c->ssid);
+	if (list)
+		list->next = g_slist_prepend (list->next, c);
+	else {
+		g_hash_table_insert (index->by_ssid,
+		                     g_byte_array_append (g_byte_array_sized_new (c->ssid->len),
+		                                          c->ssid->data, c->ssid->len),
+		                     g_slist_prepend (NULL, c));
+	}
+}
+
+NMWifiCandidateIndex *
+nm_wifi_candidate_index_new (void)
+{
+	NMWifiCandidateIndex *index;
+
+	index = g_slice_new0 (NMWifiCandidateIndex);
+	index->by_connection = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, candidate_free);
+	index->by_ssid = g_hash_table_new_full (ssid_hash, ssid_equal, ssid_free, (GDestroyNotify) g_slist_free);
+	return index;
+}
+
+void
+nm_wifi_candidate_index_clear (NMWifiCandidateIndex *index)
+{
+	g_return_if_fail (index != NULL);
+
+	/* Drop the SSID lists first so candidate_free() has nothing to unlink */
+	g_hash_table_remove_all (index->by_ssid);
+	g_slist_free (index->shared);
+	index->shared = NULL;
+	g_hash_table_remove_all (index->by_connection);
+	index->known_changed = TRUE;
+}
+
+void
+nm_wifi_candidate_index_free (NMWifiCandidateIndex *index)
+{
+	g_return_if_fail (index != NULL);
+
+	nm_wifi_candidate_index_clear (index);
+	g_hash_table_destroy (index->by_connection);
+	g_hash_table_destroy (index->by_ssid);
+	g_slice_free (NMWifiCandidateIndex, index);
+}
+
+/**
+ * nm_wifi_candidate_index_add:
+ * @index: the index
+ * @connection: a connection eligible for auto-activation
+ *
+ * Adds @connection to the index, or re-parses it if it was added before
+ * and has been updated since.
+ */
+void
+nm_wifi_candidate_index_add (NMWifiCandidateIndex *index, NMConnection *connection)
+{
+	Candidate *c;
+
+	g_return_if_fail (index != NULL);
+	g_return_if_fail (NM_IS_CONNECTION (connection));
+
+	c = g_hash_table_lookup (index->by_connection, connection);
+	if (c)
+		candidate_reset (index, c);
+	else {
+		c = g_slice_new0 (Candidate);
+		c->index = index;
+		c->connection = g_object_ref (connection);
+		g_hash_table_insert (index->by_connection, connection, c);
+	}
+
+	candidate_parse (index, c);
+	index->known_changed = TRUE;
+}
+
+/**
+ * nm_wifi_candidate_index_remove:
+ * @index: the index
+ * @connection: a connection no longer eligible for auto-activation
+ *
+ * Drops @connection and the reference the index holds on it.
+ */
+void
+nm_wifi_candidate_index_remove (NMWifiCandidateIndex *index, NMConnection *connection)
+{
+	g_return_if_fail (index != NULL);
+
+	if (g_hash_table_remove (index->by_connection, connection))
+		index->known_changed = TRUE;
+}
+
+static void
+set_perm_hw_addr (NMWifiCandidateIndex *index, const guint8 *perm_hw_addr)
+{
+	GHashTableIter iter;
+	Candidate *c;
+
+	if (memcmp (index->perm_hw_addr, perm_hw_addr, ETH_ALEN) == 0)
+		return;
+	memcpy (index->perm_hw_addr, perm_hw_addr, ETH_ALEN);
+
+	/* MAC filters were resolved against the old address */
+	g_hash_table_iter_init (&iter, index->by_connection);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &c)) {
+		candidate_reset (index, c);
+		candidate_parse (index, c);
+	}
+	index->known_changed = TRUE;
+}
+
+static gboolean
+candidate_allowed (NMWifiCandidateIndex *index,
+                   Candidate *c,
+                   NMWifiCandidateFilterFunc filter,
+                   gpointer filter_data)
+{
+	if (c->generation != index->generation) {
+		c->generation = index->generation;
+		c->allowed = filter ? filter (c->connection, filter_data) : TRUE;
+	}
+	return c->allowed;
+}
+
+static guint64
+candidate_timestamp (Candidate *c)
+{
+	if (NM_IS_SETTINGS_CONNECTION (c->connection))
+		return nm_settings_connection_get_timestamp (NM_SETTINGS_CONNECTION (c->connection));
+	return 0;
+}
+
+/**
+ * nm_wifi_candidate_index_find:
+ * @index: the index
+ * @perm_hw_addr: the device's permanent MAC address
+ * @ap_list: the device's current scan list
+ * @filter: (allow-none): called once per lookup for each candidate that
+ *   could be used, to check whether it may be auto-activated right now
+ * @filter_data: user data for @filter
+ * @out_ap: on return, the AP to use for the returned connection, or %NULL
+ *   for shared connections
+ *
+ * Picks the most recently used connection that passes @filter and is
+ * either shared or compatible with some AP in @ap_list; the same choice
+ * nm_settings_sort_connections() order would give.  Only the connections
+ * for the SSIDs in @ap_list and the shared ones are looked at.
+ *
+ * Returns: the connection to auto-activate, or %NULL
+ */
+NMConnection *
+nm_wifi_candidate_index_find (NMWifiCandidateIndex *index,
+                              const guint8 *perm_hw_addr,
+                              GSList *ap_list,
+                              NMWifiCandidateFilterFunc filter,
+                              gpointer filter_data,
+                              NMAccessPoint **out_ap)
+{
+	Candidate *best = NULL;
+	NMAccessPoint *best_ap = NULL;
+	guint64 best_ts = 0;
+	GSList *iter;
+
+	g_return_val_if_fail (index != NULL, NULL);
+	g_return_val_if_fail (perm_hw_addr != NULL, NULL);
+	g_return_val_if_fail (out_ap != NULL, NULL);
+
+	set_perm_hw_addr (index, perm_hw_addr);
+
+	/* Filter results are only good for this lookup */
+	index->generation++;
+
+	for (iter = index->shared; iter; iter = g_slist_next (iter)) {
+		Candidate *c = iter->data;
+		guint64 ts = candidate_timestamp (c);
+
+		if (best && ts <= best_ts)
+			continue;
+		if (candidate_allowed (index, c, filter, filter_data)) {
+			best = c;
+			best_ts = ts;
+		}
+	}
+
+	/* Each candidate keeps the first compatible AP in scan list order */
+	for (iter = ap_list; iter; iter = g_slist_next (iter)) {
+		NMAccessPoint *ap = NM_AP (iter->data);
+		const GByteArray *ssid = nm_ap_get_ssid (ap);
+		GByteArray key;
+		GSList *c_iter;
+
+		if (!ssid || !ssid->len)
+			continue;
+
+		key.data = ssid->data;
+		key.len = ssid_key_len (ssid);
+
+		for (c_iter = g_hash_table_lookup (index->by_ssid, &key); c_iter; c_iter = g_slist_next (c_iter)) {
+			Candidate *c = c_iter->data;
+			guint64 ts = candidate_timestamp (c);
+
+			if (best && ts <= best_ts)
+				continue;
+			if (!candidate_allowed (index, c, filter, filter_data))
+				continue;
+			if (nm_ap_check_compatible (ap, c->connection)) {
+				best = c;
+				best_ts = ts;
+				best_ap = ap;
+			}
+		}
+	}
+
+	*out_ap = (best && !best->shared) ? best_ap : NULL;
+	return best ? best->connection : NULL;
+}
+
+/**
+ * nm_wifi_candidate_index_known_changed:
+ * @index: the index
+ *
+ * Returns: %TRUE if connections were added, updated or removed since the
+ * last call; resets the flag
+ */
+gboolean
+nm_wifi_candidate_index_known_changed (NMWifiCandidateIndex *index)
+{
+	gboolean changed;
+
+	g_return_val_if_fail (index != NULL, FALSE);
+
+	changed = index->known_changed;
+	index->known_changed = FALSE;
+	return changed;
+}
+
+/**
+ * nm_wifi_candidate_index_foreach_known:
+ * @index: the index
+ * @func: called for every indexed wireless connection
+ * @user_data: user data for @func
+ *
+ * Reports the SSIDs and seen BSSIDs of the indexed connections, as parsed
+ * when the connection was added or last updated.
+ */
+void
+nm_wifi_candidate_index_foreach_known (NMWifiCandidateIndex *index,
+                                       NMWifiKnownNetworkFunc func,
+                                       gpointer user_data)
+{
+	GHashTableIter iter;
+	Candidate *c;
+
+	g_return_if_fail (index != NULL);
+	g_return_if_fail (func != NULL);
+
+	g_hash_table_iter_init (&iter, index->by_connection);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &c)) {
+		if (!c->known_bssids)
+			continue;
+		func (c->known_ssid,
+		      (const struct ether_addr *) c->known_bssids->data,
+		      c->known_bssids->len,
+		      user_data);
+	}
+}
@@ -0,0 +1,65 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ */
+
+#ifndef NM_WIFI_CANDIDATE_INDEX_H
+#define NM_WIFI_CANDIDATE_INDEX_H
+
+#include <glib.h>
+#include <net/ethernet.h>
+
+#include "nm-connection.h"
+#include "nm-wifi-ap.h"
+
+typedef struct _NMWifiCandidateIndex NMWifiCandidateIndex;
+
+NMWifiCandidateIndex *nm_wifi_candidate_index_new   (void);
+
+void                  nm_wifi_candidate_index_free  (NMWifiCandidateIndex *index);
+
+void                  nm_wifi_candidate_index_clear (NMWifiCandidateIndex *index);
+
+void                  nm_wifi_candidate_index_add    (NMWifiCandidateIndex *index,
+                                                      NMConnection *connection);
+
+void                  nm_wifi_candidate_index_remove (NMWifiCandidateIndex *index,
+                                                      NMConnection *connection);
+
+typedef gboolean (*NMWifiCandidateFilterFunc) (NMConnection *connection,
+                                               gpointer user_data);
+
+NMConnection *        nm_wifi_candidate_index_find  (NMWifiCandidateIndex *index,
+                                                     const guint8 *perm_hw_addr,
+                                                     GSList *ap_list,
+                                                     NMWifiCandidateFilterFunc filter,
+                                                     gpointer filter_data,
+                                                     NMAccessPoint **out_ap);
+
+typedef void (*NMWifiKnownNetworkFunc) (const GByteArray *ssid,
+                                        const struct ether_addr *bssids,
+                                        guint num_bssids,
+                                        gpointer user_data);
+
+gboolean              nm_wifi_candidate_index_known_changed (NMWifiCandidateIndex *index);
+
+void                  nm_wifi_candidate_index_foreach_known (NMWifiCandidateIndex *index,
+                                                             NMWifiKnownNetworkFunc func,
+                                                             gpointer user_data);
+
+#endif /* NM_WIFI_CANDIDATE_INDEX_H */
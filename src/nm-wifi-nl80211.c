@@ -0,0 +1,663 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <errno.h>
+#include <net/ethernet.h>
+#include <linux/nl80211.h>
+#include <netlink/netlink.h>
+#include <netlink/msg.h>
+#include <netlink/attr.h>
+#include <netlink/genl/genl.h>
+#include <netlink/genl/ctrl.h>
+#include <netlink/genl/family.h>
+
+#include <glib.h>
+
+#include "nm-wifi-nl80211.h"
+#include "nm-wifi-ap-utils.h"
+#include "nm-netlink-compat.h"
+#include "nm-logging.h"
+#include "NetworkManager.h"
+
+/* IE element ID of the SSID in a BSS's information elements */
+#define WLAN_EID_SSID 0
+
+struct _NMWifiNl80211 {
+	char *iface;
+	int ifindex;
+	int id;                   /* nl80211 generic netlink family */
+
+	/* Sync/blocking request/response connection */
+	struct nl_sock *nl_sock;
+
+	/* Async event listener connection */
+	struct nl_sock *nl_event;
+	GIOChannel *io_channel;
+	guint event_id;
+
+	gboolean has_cqm;
+
+	/* BSSID, SSID, mode and frequency of the current BSS, from the last
+	 * BSS dump; only refreshed when the link changes.
+	 */
+	NMHwState bss;
+	gboolean bss_valid;
+
+	NMWifiNl80211EventFunc callback;
+	gpointer user_data;
+};
+
+/*****************************************************************/
+
+static int
+error_handler (struct sockaddr_nl *nla, struct nlmsgerr *err, void *arg)
+{
+	int *ret = arg;
+
+	*ret = err->error;
+	return NL_STOP;
+}
+
+static int
+finish_handler (struct nl_msg *msg, void *arg)
+{
+	int *ret = arg;
+
+	*ret = 0;
+	return NL_SKIP;
+}
+
+static int
+ack_handler (struct nl_msg *msg, void *arg)
+{
+	int *ret = arg;
+
+	*ret = 0;
+	return NL_STOP;
+}
+
+/* Sends @msg and processes replies (including all parts of multipart
+ * dumps) with @valid_handler until the kernel acks or errors.  Consumes @msg.
+ */
+static int
+send_and_recv (struct nl_sock *sk,
+               struct nl_msg *msg,
+               int (*valid_handler) (struct nl_msg *, void *),
+               void *valid_data)
+{
+	struct nl_cb *cb;
+	int err;
+
+	cb = nl_cb_alloc (NL_CB_DEFAULT);
+	if (!cb) {
+		nlmsg_free (msg);
+		return -ENOMEM;
+	}
+
+	err = nl_send_auto_complete (sk, msg);
+	if (err < 0)
+		goto out;
+
+	err = 1;
+	nl_cb_err (cb, NL_CB_CUSTOM, error_handler, &err);
+	nl_cb_set (cb, NL_CB_FINISH, NL_CB_CUSTOM, finish_handler, &err);
+	nl_cb_set (cb, NL_CB_ACK, NL_CB_CUSTOM, ack_handler, &err);
+	if (valid_handler)
+		nl_cb_set (cb, NL_CB_VALID, NL_CB_CUSTOM, valid_handler, valid_data);
+
+	while (err > 0) {
+		if (nl_recvmsgs (sk, cb) < 0)
+			break;
+	}
+
+out:
+	nl_cb_put (cb);
+	nlmsg_free (msg);
+	return err;
+}
+
+static struct nl_msg *
+nl80211_msg_new (NMWifiNl80211 *nl, int cmd, int flags)
+{
+	struct nl_msg *msg;
+
+	msg = nlmsg_alloc ();
+	if (!msg)
+		return NULL;
+
+	genlmsg_put (msg, 0, 0, nl->id, 0, flags, cmd, 0);
+	if (nla_put_u32 (msg, NL80211_ATTR_IFINDEX, nl->ifindex) < 0) {
+		nlmsg_free (msg);
+		return NULL;
+	}
+	return msg;
+}
+
+/*****************************************************************/
+
+typedef struct {
+	const char *group;
+	int id;
+} McastGroupInfo;
+
+static int
+family_handler (struct nl_msg *msg, void *arg)
+{
+	McastGroupInfo *info = arg;
+	struct genlmsghdr *gnlh = nlmsg_data (nlmsg_hdr (msg));
+	struct nlattr *tb[CTRL_ATTR_MAX + 1];
+	struct nlattr *mcgrp;
+	int rem;
+
+	nla_parse (tb, CTRL_ATTR_MAX, genlmsg_attrdata (gnlh, 0),
+	           genlmsg_attrlen (gnlh, 0), NULL);
+
+	if (!tb[CTRL_ATTR_MCAST_GROUPS])
+		return NL_SKIP;
+
+	nla_for_each_nested (mcgrp, tb[CTRL_ATTR_MCAST_GROUPS], rem) {
+		struct nlattr *tb_mcgrp[CTRL_ATTR_MCAST_GRP_MAX + 1];
+		struct nlattr *name;
+
+		nla_parse (tb_mcgrp, CTRL_ATTR_MCAST_GRP_MAX, nla_data (mcgrp),
+		           nla_len (mcgrp), NULL);
+
+		name = tb_mcgrp[CTRL_ATTR_MCAST_GRP_NAME];
+		if (!name || !tb_mcgrp[CTRL_ATTR_MCAST_GRP_ID])
+			continue;
+		if (strncmp (nla_data (name), info->group, nla_len (name)))
+			continue;
+
+		info->id = nla_get_u32 (tb_mcgrp[CTRL_ATTR_MCAST_GRP_ID]);
+		break;
+	}
+
+	return NL_SKIP;
+}
+
+static int
+get_multicast_id (struct nl_sock *sk, const char *family, const char *group)
+{
+	McastGroupInfo info = { group, -ENOENT };
+	struct nl_msg *msg;
+	int err;
+
+	msg = nlmsg_alloc ();
+	if (!msg)
+		return -ENOMEM;
+
+	genlmsg_put (msg, 0, 0, GENL_ID_CTRL, 0, 0, CTRL_CMD_GETFAMILY, 0);
+	if (nla_put_string (msg, CTRL_ATTR_FAMILY_NAME, family) < 0) {
+		nlmsg_free (msg);
+		return -ENOMEM;
+	}
+
+	err = send_and_recv (sk, msg, family_handler, &info);
+	return (err == 0) ? info.id : err;
+}
+
+/*****************************************************************/
+
+static int
+event_handler (struct nl_msg *msg, void *arg)
+{
+	NMWifiNl80211 *nl = arg;
+	struct genlmsghdr *gnlh = nlmsg_data (nlmsg_hdr (msg));
+	struct nlattr *tb[NL80211_ATTR_MAX + 1];
+	struct nlattr *cqm[NL80211_ATTR_CQM_MAX + 1];
+	int signal_dbm = 0;
+
+	nla_parse (tb, NL80211_ATTR_MAX, genlmsg_attrdata (gnlh, 0),
+	           genlmsg_attrlen (gnlh, 0), NULL);
+
+	/* The mlme group carries events for every wireless interface */
+	if (!tb[NL80211_ATTR_IFINDEX] || (nla_get_u32 (tb[NL80211_ATTR_IFINDEX]) != nl->ifindex))
+		return NL_SKIP;
+
+	switch (gnlh->cmd) {
+	case NL80211_CMD_CONNECT:
+	case NL80211_CMD_ROAM:
+	case NL80211_CMD_DISCONNECT:
+	case NL80211_CMD_JOIN_IBSS:
+		nm_log_dbg (LOGD_WIFI, "(%s): nl80211 link event %d", nl->iface, gnlh->cmd);
+		nl->bss_valid = FALSE;
+		nl->callback (nl, NM_WIFI_NL80211_EVENT_LINK, 0, nl->user_data);
+		break;
+	case NL80211_CMD_NOTIFY_CQM:
+		if (!tb[NL80211_ATTR_CQM])
+			break;
+		if (nla_parse_nested (cqm, NL80211_ATTR_CQM_MAX, tb[NL80211_ATTR_CQM], NULL) < 0)
+			break;
+		if (!cqm[NL80211_ATTR_CQM_RSSI_THRESHOLD_EVENT])
+			break;
+
+		switch (nla_get_u32 (cqm[NL80211_ATTR_CQM_RSSI_THRESHOLD_EVENT])) {
+		case NL80211_CQM_RSSI_THRESHOLD_EVENT_LOW:
+			signal_dbm = NM_WIFI_NL80211_CQM_RSSI_THRESHOLD - NM_WIFI_NL80211_CQM_RSSI_HYSTERESIS;
+			break;
+		case NL80211_CQM_RSSI_THRESHOLD_EVENT_HIGH:
+			signal_dbm = NM_WIFI_NL80211_CQM_RSSI_THRESHOLD + NM_WIFI_NL80211_CQM_RSSI_HYSTERESIS;
+			break;
+		default:
+			/* Unknown event; nothing to tell about the signal */
+			return NL_SKIP;
+		}
+
+		nm_log_dbg (LOGD_WIFI, "(%s): nl80211 signal now %s threshold",
+		            nl->iface,
+		            signal_dbm < NM_WIFI_NL80211_CQM_RSSI_THRESHOLD ? "below" : "above");
+		nl->callback (nl, NM_WIFI_NL80211_EVENT_SIGNAL, signal_dbm, nl->user_data);
+		break;
+	default:
+		break;
+	}
+
+	return NL_SKIP;
+}
+
+static gboolean
+event_io_cb (GIOChannel *channel, GIOCondition condition, gpointer user_data)
+{
+	NMWifiNl80211 *nl = user_data;
+	int err;
+
+	if (condition & (G_IO_ERR | G_IO_HUP | G_IO_NVAL)) {
+		nm_log_warn (LOGD_WIFI, "(%s): nl80211 event socket closed", nl->iface);
+		nl->event_id = 0;
+		return FALSE;
+	}
+
+	err = nl_recvmsgs_default (nl->nl_event);
+	if (err < 0) {
+		nm_log_dbg (LOGD_WIFI, "(%s): error processing nl80211 events: %s",
+		            nl->iface, nl_geterror (err));
+	}
+
+	return TRUE;
+}
+
+static gboolean
+setup_events (NMWifiNl80211 *nl)
+{
+	int mlme_id;
+
+	mlme_id = get_multicast_id (nl->nl_sock, "nl80211", "mlme");
+	if (mlme_id < 0) {
+		nm_log_dbg (LOGD_WIFI, "(%s): nl80211 mlme multicast group not found (%d)",
+		            nl->iface, mlme_id);
+		return FALSE;
+	}
+
+	nl->nl_event = nl_socket_alloc ();
+	if (!nl->nl_event)
+		return FALSE;
+
+	if (genl_connect (nl->nl_event) < 0)
+		return FALSE;
+
+	nl_socket_disable_seq_check (nl->nl_event);
+	nl_socket_modify_cb (nl->nl_event, NL_CB_VALID, NL_CB_CUSTOM, event_handler, nl);
+
+	if (nl_socket_add_membership (nl->nl_event, mlme_id) < 0)
+		return FALSE;
+
+	nl->io_channel = g_io_channel_unix_new (nl_socket_get_fd (nl->nl_event));
+	g_io_channel_set_encoding (nl->io_channel, NULL, NULL);
+	g_io_channel_set_flags (nl->io_channel,
+	                        g_io_channel_get_flags (nl->io_channel) | G_IO_FLAG_NONBLOCK,
+	                        NULL);
+	nl->event_id = g_io_add_watch (nl->io_channel,
+	                               G_IO_IN | G_IO_PRI | G_IO_ERR | G_IO_HUP | G_IO_NVAL,
+	                               event_io_cb,
+	                               nl);
+	return TRUE;
+}
+
+/* Ask the driver to tell us when the signal crosses a threshold so the
+ * connection doesn't need to be polled to notice a weakening link.
+ */
+static gboolean
+setup_cqm (NMWifiNl80211 *nl)
+{
+	struct nl_msg *msg;
+	struct nlattr *cqm;
+	int err;
+
+	msg = nl80211_msg_new (nl, NL80211_CMD_SET_CQM, 0);
+	if (!msg)
+		return FALSE;
+
+	cqm = nla_nest_start (msg, NL80211_ATTR_CQM);
+	if (   !cqm
+	    || nla_put_u32 (msg, NL80211_ATTR_CQM_RSSI_THOLD, (guint32) NM_WIFI_NL80211_CQM_RSSI_THRESHOLD) < 0
+	    || nla_put_u32 (msg, NL80211_ATTR_CQM_RSSI_HYST, NM_WIFI_NL80211_CQM_RSSI_HYSTERESIS) < 0) {
+		nlmsg_free (msg);
+		return FALSE;
+	}
+	nla_nest_end (msg, cqm);
+
+	err = send_and_recv (nl->nl_sock, msg, NULL, NULL);
+	if (err < 0) {
+		nm_log_dbg (LOGD_WIFI, "(%s): driver doesn't support nl80211 signal monitoring (%d)",
+		            nl->iface, err);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * nm_wifi_nl80211_new:
+ * @iface: wireless interface name
+ * @ifindex: wireless interface index
+ * @callback: called when nl80211 reports a link or signal event for @ifindex
+ * @user_data: data for @callback
+ *
+ * Returns: a new nl80211 link sampler, or %NULL if the kernel or driver
+ * don't support nl80211 and the caller should fall back to WEXT.
+ **/
+NMWifiNl80211 *
+nm_wifi_nl80211_new (const char *iface,
+                     int ifindex,
+                     NMWifiNl80211EventFunc callback,
+                     gpointer user_data)
+{
+	NMWifiNl80211 *nl;
+
+	g_return_val_if_fail (iface != NULL, NULL);
+	g_return_val_if_fail (ifindex > 0, NULL);
+	g_return_val_if_fail (callback != NULL, NULL);
+
+	nl = g_malloc0 (sizeof (NMWifiNl80211));
+	nl->iface = g_strdup (iface);
+	nl->ifindex = ifindex;
+	nl->callback = callback;
+	nl->user_data = user_data;
+
+	nl->nl_sock = nl_socket_alloc ();
+	if (!nl->nl_sock)
+		goto error;
+
+	if (genl_connect (nl->nl_sock) < 0)
+		goto error;
+
+	nl->id = genl_ctrl_resolve (nl->nl_sock, "nl80211");
+	if (nl->id < 0) {
+		nm_log_dbg (LOGD_WIFI, "(%s): nl80211 not found", iface);
+		goto error;
+	}
+
+	if (!setup_events (nl))
+		goto error;
+
+	nl->has_cqm = setup_cqm (nl);
+
+	nm_log_info (LOGD_HW | LOGD_WIFI, "(%s): using nl80211 link events%s",
+	             iface, nl->has_cqm ? " and signal monitoring" : "");
+	return nl;
+
+error:
+	nm_wifi_nl80211_free (nl);
+	return NULL;
+}
+
+void
+nm_wifi_nl80211_free (NMWifiNl80211 *nl)
+{
+	g_return_if_fail (nl != NULL);
+
+	if (nl->event_id)
+		g_source_remove (nl->event_id);
+	if (nl->io_channel)
+		g_io_channel_unref (nl->io_channel);
+	if (nl->nl_event)
+		nl_socket_free (nl->nl_event);
+	if (nl->nl_sock)
+		nl_socket_free (nl->nl_sock);
+	g_free (nl->iface);
+	memset (nl, 0, sizeof (NMWifiNl80211));
+	g_free (nl);
+}
+
+/**
+ * nm_wifi_nl80211_has_signal_events:
+ * @nl: the nl80211 link sampler
+ *
+ * Returns: %TRUE if the driver reports signal threshold crossings, in which
+ * case the link doesn't need polling.
+ **/
+gboolean
+nm_wifi_nl80211_has_signal_events (NMWifiNl80211 *nl)
+{
+	g_return_val_if_fail (nl != NULL, FALSE);
+
+	return nl->has_cqm;
+}
+
+/*****************************************************************/
+
+static void
+parse_ssid_ie (const guint8 *ie, int len, NMHwState *state)
+{
+	while (len >= 2 && len >= ie[1] + 2) {
+		if (ie[0] == WLAN_EID_SSID) {
+			state->ssid_len = MIN (ie[1], NM_HW_SSID_MAX_LEN);
+			memcpy (state->ssid, ie + 2, state->ssid_len);
+			return;
+		}
+		len -= ie[1] + 2;
+		ie += ie[1] + 2;
+	}
+}
+
+static int
+bss_dump_handler (struct nl_msg *msg, void *arg)
+{
+	NMHwState *state = arg;
+	struct genlmsghdr *gnlh = nlmsg_data (nlmsg_hdr (msg));
+	struct nlattr *tb[NL80211_ATTR_MAX + 1];
+	struct nlattr *bss[NL80211_BSS_MAX + 1];
+	static struct nla_policy bss_policy[NL80211_BSS_MAX + 1] = {
+		[NL80211_BSS_FREQUENCY]  = { .type = NLA_U32 },
+		[NL80211_BSS_BSSID]      = { },
+		[NL80211_BSS_SIGNAL_MBM] = { .type = NLA_U32 },
+		[NL80211_BSS_STATUS]     = { .type = NLA_U32 },
+	};
+	guint32 status;
+
+	nla_parse (tb, NL80211_ATTR_MAX, genlmsg_attrdata (gnlh, 0),
+	           genlmsg_attrlen (gnlh, 0), NULL);
+
+	if (!tb[NL80211_ATTR_BSS])
+		return NL_SKIP;
+	if (nla_parse_nested (bss, NL80211_BSS_MAX, tb[NL80211_ATTR_BSS], bss_policy) < 0)
+		return NL_SKIP;
+
+	/* Only the BSS we're associated with or have joined is interesting */
+	if (!bss[NL80211_BSS_STATUS] || !bss[NL80211_BSS_BSSID])
+		return NL_SKIP;
+
+	status = nla_get_u32 (bss[NL80211_BSS_STATUS]);
+	if (status == NL80211_BSS_STATUS_ASSOCIATED)
+		state->mode = NM_802_11_MODE_INFRA;
+	else if (status == NL80211_BSS_STATUS_IBSS_JOINED)
+		state->mode = NM_802_11_MODE_ADHOC;
+	else
+		return NL_SKIP;
+
+	memcpy (state->bssid.ether_addr_octet, nla_data (bss[NL80211_BSS_BSSID]), ETH_ALEN);
+
+	if (bss[NL80211_BSS_FREQUENCY])
+		state->freq = nla_get_u32 (bss[NL80211_BSS_FREQUENCY]);
+
+	if (bss[NL80211_BSS_SIGNAL_MBM]) {
+		int mbm = (int) nla_get_u32 (bss[NL80211_BSS_SIGNAL_MBM]);
+
+		state->strength = nm_ap_utils_level_to_quality (mbm / 100);
+		state->valid |= NM_HW_STATE_STRENGTH;
+	}
+
+	if (bss[NL80211_BSS_INFORMATION_ELEMENTS]) {
+		parse_ssid_ie (nla_data (bss[NL80211_BSS_INFORMATION_ELEMENTS]),
+		               nla_len (bss[NL80211_BSS_INFORMATION_ELEMENTS]),
+		               state);
+	}
+
+	return NL_SKIP;
+}
+
+static int
+station_handler (struct nl_msg *msg, void *arg)
+{
+	NMHwState *state = arg;
+	struct genlmsghdr *gnlh = nlmsg_data (nlmsg_hdr (msg));
+	struct nlattr *tb[NL80211_ATTR_MAX + 1];
+	struct nlattr *sinfo[NL80211_STA_INFO_MAX + 1];
+	struct nlattr *rinfo[NL80211_RATE_INFO_MAX + 1];
+	static struct nla_policy stats_policy[NL80211_STA_INFO_MAX + 1] = {
+		[NL80211_STA_INFO_SIGNAL]      = { .type = NLA_U8 },
+		[NL80211_STA_INFO_TX_BITRATE]  = { .type = NLA_NESTED },
+	};
+	static struct nla_policy rate_policy[NL80211_RATE_INFO_MAX + 1] = {
+		[NL80211_RATE_INFO_BITRATE]    = { .type = NLA_U16 },
+	};
+
+	nla_parse (tb, NL80211_ATTR_MAX, genlmsg_attrdata (gnlh, 0),
+	           genlmsg_attrlen (gnlh, 0), NULL);
+
+	if (!tb[NL80211_ATTR_STA_INFO])
+		return NL_SKIP;
+	if (nla_parse_nested (sinfo, NL80211_STA_INFO_MAX, tb[NL80211_ATTR_STA_INFO], stats_policy) < 0)
+		return NL_SKIP;
+
+	/* The station's own signal average is better than the last beacon's */
+	if (sinfo[NL80211_STA_INFO_SIGNAL]) {
+		state->strength = nm_ap_utils_level_to_quality ((gint8) nla_get_u8 (sinfo[NL80211_STA_INFO_SIGNAL]));
+		state->valid |= NM_HW_STATE_STRENGTH;
+	}
+
+	if (   sinfo[NL80211_STA_INFO_TX_BITRATE]
+	    && nla_parse_nested (rinfo, NL80211_RATE_INFO_MAX,
+	                         sinfo[NL80211_STA_INFO_TX_BITRATE], rate_policy) == 0
+	    && rinfo[NL80211_RATE_INFO_BITRATE]) {
+		/* nl80211 reports units of 100 Kb/s */
+		state->bitrate = nla_get_u16 (rinfo[NL80211_RATE_INFO_BITRATE]) * 100;
+		state->valid |= NM_HW_STATE_BITRATE;
+	}
+
+	return NL_SKIP;
+}
+
+/* Finds the associated or joined BSS in a full BSS dump */
+static gboolean
+get_bss (NMWifiNl80211 *nl)
+{
+	struct nl_msg *msg;
+	int err;
+
+	memset (&nl->bss, 0, sizeof (NMHwState));
+	nl->bss.strength = -1;
+	nl->bss.mode = NM_802_11_MODE_UNKNOWN;
+
+	msg = nl80211_msg_new (nl, NL80211_CMD_GET_SCAN, NLM_F_DUMP);
+	if (!msg)
+		return FALSE;
+
+	err = send_and_recv (nl->nl_sock, msg, bss_dump_handler, &nl->bss);
+	if (err < 0) {
+		nm_log_dbg (LOGD_WIFI, "(%s): nl80211 BSS dump failed (%d)", nl->iface, err);
+		return FALSE;
+	}
+
+	/* No BSS means not associated; that's still a valid answer */
+	nl->bss.valid |= NM_HW_STATE_BSSID | NM_HW_STATE_SSID | NM_HW_STATE_MODE | NM_HW_STATE_FREQ;
+	nl->bss_valid = TRUE;
+	return TRUE;
+}
+
+static gboolean
+get_station (NMWifiNl80211 *nl, NMHwState *state)
+{
+	struct nl_msg *msg;
+	int err;
+
+	msg = nl80211_msg_new (nl, NL80211_CMD_GET_STATION, 0);
+	if (!msg)
+		return FALSE;
+
+	if (nla_put (msg, NL80211_ATTR_MAC, ETH_ALEN, state->bssid.ether_addr_octet) < 0) {
+		nlmsg_free (msg);
+		return FALSE;
+	}
+
+	err = send_and_recv (nl->nl_sock, msg, station_handler, state);
+	if (err < 0) {
+		nm_log_dbg (LOGD_WIFI, "(%s): nl80211 station query failed (%d)", nl->iface, err);
+		return FALSE;
+	}
+	return TRUE;
+}
+
+/**
+ * nm_wifi_nl80211_get_link:
+ * @nl: the nl80211 link sampler
+ * @state: filled in with the current link parameters
+ *
+ * Reads signal and TX bitrate of the associated BSS from its station entry.
+ * BSSID, SSID, mode and frequency come from a BSS dump, which is only
+ * repeated after a link event or when the station has gone away.
+ *
+ * Returns: %TRUE on success, %FALSE if the caller should fall back to WEXT
+ **/
+gboolean
+nm_wifi_nl80211_get_link (NMWifiNl80211 *nl, NMHwState *state)
+{
+	g_return_val_if_fail (nl != NULL, FALSE);
+	g_return_val_if_fail (state != NULL, FALSE);
+
+	/* IBSS has no station entry for the BSS and its BSSID may change
+	 * through coalescing, so it always takes the dump.
+	 */
+	if (!nl->bss_valid || nl->bss.mode != NM_802_11_MODE_INFRA) {
+		if (!get_bss (nl))
+			return FALSE;
+	}
+
+	*state = nl->bss;
+	if (state->mode != NM_802_11_MODE_INFRA)
+		return TRUE;
+
+	/* The signal of the cached dump is stale; the station's is current */
+	state->strength = -1;
+	state->valid &= ~NM_HW_STATE_STRENGTH;
+
+	if (!get_station (nl, state)) {
+		/* Roamed or disassociated without us seeing the event */
+		if (!get_bss (nl))
+			return FALSE;
+		*state = nl->bss;
+		if (state->mode == NM_802_11_MODE_INFRA)
+			get_station (nl, state);
+	}
+
+	return TRUE;
+}
@@ -0,0 +1,56 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ */
+
+#ifndef NM_WIFI_NL80211_H
+#define NM_WIFI_NL80211_H
+
+#include <glib.h>
+
+#include "nm-hw-control.h"
+
+typedef enum {
+	NM_WIFI_NL80211_EVENT_LINK   = 0x00000001,  /* connect, disconnect, roam, IBSS join */
+	NM_WIFI_NL80211_EVENT_SIGNAL = 0x00000002,  /* signal crossed the CQM RSSI threshold */
+} NMWifiNl80211Event;
+
+/* Signal quality monitoring threshold for NM_WIFI_NL80211_EVENT_SIGNAL */
+#define NM_WIFI_NL80211_CQM_RSSI_THRESHOLD  -70  /* dBm */
+#define NM_WIFI_NL80211_CQM_RSSI_HYSTERESIS   4  /* dB */
+
+typedef struct _NMWifiNl80211 NMWifiNl80211;
+
+typedef void (*NMWifiNl80211EventFunc) (NMWifiNl80211 *nl,
+                                        NMWifiNl80211Event event,
+                                        int signal_dbm,
+                                        gpointer user_data);
+
+NMWifiNl80211 *nm_wifi_nl80211_new               (const char *iface,
+                                                  int ifindex,
+                                                  NMWifiNl80211EventFunc callback,
+                                                  gpointer user_data);
+
+void           nm_wifi_nl80211_free              (NMWifiNl80211 *nl);
+
+gboolean       nm_wifi_nl80211_has_signal_events (NMWifiNl80211 *nl);
+
+gboolean       nm_wifi_nl80211_get_link          (NMWifiNl80211 *nl,
+                                                  NMHwState *state);
+
+#endif /* NM_WIFI_NL80211_H */
@@ -0,0 +1,488 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ */
+
+#include <string.h>
+
+#include "nm-wifi-scan-scheduler.h"
+
+/* Upper bound on the BSS channel history; the least recently seen
+ * entry is dropped when it fills up.
+ */
+#define MAX_BSS_HISTORY 128
+
+typedef struct {
+	struct ether_addr bssid;
+	GByteArray *ssid;
+	guint32 freq;
+	guint32 stamp;
+} BssEntry;
+
+struct _NMWifiScanScheduler {
+	GHashTable *bss;            /* struct ether_addr -> BssEntry */
+	guint32 stamp;
+
+	GHashTable *known_ssids;    /* GByteArray -> GByteArray */
+	GHashTable *known_bssids;   /* struct ether_addr -> struct ether_addr */
+
+	GByteArray *link_ssid;      /* NULL when not associated */
+	guint32 link_freq;
+	gboolean weak;
+	guint roam_interval;
+
+	guint scans_since_full;
+	gboolean history_first;
+};
+
+static guint
+mac_hash (gconstpointer v)
+{
+	const guint8 *p = v;
+	guint32 i, h = 5381;
+
+	for (i = 0; i < ETH_ALEN; i++)
+		h = (h << 5) + h + p[i];
+	return h;
+}
+
+static gboolean
+mac_equal (gconstpointer a, gconstpointer b)
+{
+	return memcmp (a, b, ETH_ALEN) == 0;
+}
+
+static guint
+ssid_hash (gconstpointer v)
+{
+	const GByteArray *ssid = v;
+	guint32 i, h = 5381;
+
+	for (i = 0; i < ssid->len; i++)
+		h = (h << 5) + h + ssid->data[i];
+	return h;
+}
+
+static gboolean
+ssid_equal (gconstpointer a, gconstpointer b)
+{
+	const GByteArray *ssid_a = a, *ssid_b = b;
+
+	return    ssid_a->len == ssid_b->len
+	       && memcmp (ssid_a->data, ssid_b->data, ssid_a->len) == 0;
+}
+
+static GByteArray *
+ssid_dup (const GByteArray *ssid)
+{
+	GByteArray *dup;
+
+	dup = g_byte_array_sized_new (ssid->len);
+	g_byte_array_append (dup, ssid->data, ssid->len);
+	return dup;
+}
+
+static void
+ssid_free (gpointer data)
+{
+	g_byte_array_free ((GByteArray *) data, TRUE);
+}
+
+static void
+bss_entry_free (gpointer data)
+{
+	BssEntry *entry = data;
+
+	if (entry->ssid)
+		g_byte_array_free (entry->ssid, TRUE);
+	g_slice_free (BssEntry, entry);
+}
+
+NMWifiScanScheduler *
+nm_wifi_scan_scheduler_new (void)
+{
+	NMWifiScanScheduler *sched;
+
+	sched = g_slice_new0 (NMWifiScanScheduler);
+	sched->bss = g_hash_table_new_full (mac_hash, mac_equal, NULL, bss_entry_free);
+	sched->known_ssids = g_hash_table_new_full (ssid_hash, ssid_equal, ssid_free, NULL);
+	sched->known_bssids = g_hash_table_new_full (mac_hash, mac_equal, g_free, NULL);
+	sched->roam_interval = NM_WIFI_SCAN_INTERVAL_ROAM_MIN;
+
+	/* First scan should always see everything */
+	sched->scans_since_full = NM_WIFI_SCAN_FULL_EVERY;
+	return sched;
+}
+
+void
+nm_wifi_scan_scheduler_free (NMWifiScanScheduler *sched)
+{
+	g_return_if_fail (sched != NULL);
+
+	g_hash_table_destroy (sched->bss);
+	g_hash_table_destroy (sched->known_ssids);
+	g_hash_table_destroy (sched->known_bssids);
+	if (sched->link_ssid)
+		g_byte_array_free (sched->link_ssid, TRUE);
+	g_slice_free (NMWifiScanScheduler, sched);
+}
+
+void
+nm_wifi_scan_scheduler_clear_known (NMWifiScanScheduler *sched)
+{
+	g_return_if_fail (sched != NULL);
+
+	g_hash_table_remove_all (sched->known_ssids);
+	g_hash_table_remove_all (sched->known_bssids);
+}
+
+void
+nm_wifi_scan_scheduler_add_known_ssid (NMWifiScanScheduler *sched,
+                                       const GByteArray *ssid)
+{
+	GByteArray *dup;
+
+	g_return_if_fail (sched != NULL);
+
+	if (!ssid || !ssid->len || g_hash_table_lookup (sched->known_ssids, ssid))
+		return;
+
+	dup = ssid_dup (ssid);
+	g_hash_table_insert (sched->known_ssids, dup, dup);
+}
+
+void
+nm_wifi_scan_scheduler_add_known_bssid (NMWifiScanScheduler *sched,
+                                        const struct ether_addr *bssid)
+{
+	struct ether_addr *dup;
+
+	g_return_if_fail (sched != NULL);
+	g_return_if_fail (bssid != NULL);
+
+	if (g_hash_table_lookup (sched->known_bssids, bssid))
+		return;
+
+	dup = g_memdup (bssid, sizeof (struct ether_addr));
+	g_hash_table_insert (sched->known_bssids, dup, dup);
+}
+
+static void
+drop_oldest_bss (NMWifiScanScheduler *sched)
+{
+	GHashTableIter iter;
+	BssEntry *entry, *oldest = NULL;
+
+	g_hash_table_iter_init (&iter, sched->bss);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &entry)) {
+		if (!oldest || entry->stamp < oldest->stamp)
+			oldest = entry;
+	}
+
+	if (oldest)
+		g_hash_table_remove (sched->bss, &oldest->bssid);
+}
+
+void
+nm_wifi_scan_scheduler_bss_seen (NMWifiScanScheduler *sched,
+                                 const struct ether_addr *bssid,
+                                 const GByteArray *ssid,
+                                 guint32 freq)
+{
+	BssEntry *entry;
+
+	g_return_if_fail (sched != NULL);
+	g_return_if_fail (bssid != NULL);
+
+	if (!freq)
+		return;
+
+	entry = g_hash_table_lookup (sched->bss, bssid);
+	if (!entry) {
+		if (g_hash_table_size (sched->bss) >= MAX_BSS_HISTORY)
+			drop_oldest_bss (sched);
+
+		entry = g_slice_new0 (BssEntry);
+		memcpy (&entry->bssid, bssid, sizeof (struct ether_addr));
+		g_hash_table_insert (sched->bss, &entry->bssid, entry);
+	}
+
+	/* Hidden APs report an empty SSID; keep whatever we learned before */
+	if (ssid && ssid->len && (!entry->ssid || !ssid_equal (entry->ssid, ssid))) {
+		if (entry->ssid)
+			g_byte_array_free (entry->ssid, TRUE);
+		entry->ssid = ssid_dup (ssid);
+	}
+
+	entry->freq = freq;
+	entry->stamp = ++sched->stamp;
+}
+
+void
+nm_wifi_scan_scheduler_set_link (NMWifiScanScheduler *sched,
+                                 const GByteArray *ssid,
+                                 guint32 freq)
+{
+	g_return_if_fail (sched != NULL);
+
+	if (sched->link_ssid) {
+		g_byte_array_free (sched->link_ssid, TRUE);
+		sched->link_ssid = NULL;
+	}
+
+	if (ssid && ssid->len)
+		sched->link_ssid = ssid_dup (ssid);
+	sched->link_freq = freq;
+
+	/* A new association starts out assumed good */
+	sched->weak = FALSE;
+	sched->roam_interval = NM_WIFI_SCAN_INTERVAL_ROAM_MIN;
+}
+
+/**
+ * nm_wifi_scan_scheduler_update_strength:
+ * @sched: the scheduler
+ * @strength: current link strength in percent, or -1 if unknown
+ *
+ * Returns: %TRUE if the link just became weak and the caller should
+ * reschedule scanning so a roaming scan happens soon.
+ */
+gboolean
+nm_wifi_scan_scheduler_update_strength (NMWifiScanScheduler *sched,
+                                        int strength)
+{
+	g_return_val_if_fail (sched != NULL, FALSE);
+
+	if (!sched->link_ssid || strength < 0)
+		return FALSE;
+
+	if (!sched->weak && strength < NM_WIFI_SCAN_WEAK_STRENGTH) {
+		sched->weak = TRUE;
+		sched->roam_interval = NM_WIFI_SCAN_INTERVAL_ROAM_MIN;
+		return TRUE;
+	}
+
+	if (sched->weak && strength > NM_WIFI_SCAN_GOOD_STRENGTH)
+		sched->weak = FALSE;
+
+	return FALSE;
+}
+
+void
+nm_wifi_scan_scheduler_force_full (NMWifiScanScheduler *sched)
+{
+	g_return_if_fail (sched != NULL);
+
+	sched->scans_since_full = NM_WIFI_SCAN_FULL_EVERY;
+	sched->history_first = FALSE;
+}
+
+/**
+ * nm_wifi_scan_scheduler_start_from_history:
+ * @sched: the scheduler
+ *
+ * Makes the next scan a quick one of the channels in the BSS history
+ * (e.g. restored from the BSS cache after resume), followed right away by
+ * a full scan.
+ */
+void
+nm_wifi_scan_scheduler_start_from_history (NMWifiScanScheduler *sched)
+{
+	g_return_if_fail (sched != NULL);
+
+	sched->scans_since_full = NM_WIFI_SCAN_FULL_EVERY;
+	sched->history_first = (g_hash_table_size (sched->bss) > 0);
+}
+
+static void
+add_freq (GArray *freqs, guint32 freq)
+{
+	guint i;
+
+	for (i = 0; i < freqs->len; i++) {
+		if (g_array_index (freqs, guint32, i) == freq)
+			return;
+	}
+	g_array_append_val (freqs, freq);
+}
+
+static GArray *
+collect_ess_freqs (NMWifiScanScheduler *sched)
+{
+	GArray *freqs;
+	GHashTableIter iter;
+	BssEntry *entry;
+
+	freqs = g_array_new (FALSE, FALSE, sizeof (guint32));
+	if (sched->link_freq)
+		add_freq (freqs, sched->link_freq);
+
+	g_hash_table_iter_init (&iter, sched->bss);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &entry)) {
+		if (entry->ssid && ssid_equal (entry->ssid, sched->link_ssid))
+			add_freq (freqs, entry->freq);
+	}
+	return freqs;
+}
+
+static GArray *
+collect_known_freqs (NMWifiScanScheduler *sched, gboolean all)
+{
+	GArray *freqs;
+	GHashTableIter iter;
+	BssEntry *entry;
+
+	freqs = g_array_new (FALSE, FALSE, sizeof (guint32));
+
+	g_hash_table_iter_init (&iter, sched->bss);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &entry)) {
+		if (   all
+		    || g_hash_table_lookup (sched->known_bssids, &entry->bssid)
+		    || (entry->ssid && g_hash_table_lookup (sched->known_ssids, entry->ssid)))
+			add_freq (freqs, entry->freq);
+	}
+	return freqs;
+}
+
+/**
+ * nm_wifi_scan_scheduler_next:
+ * @sched: the scheduler
+ * @out_freqs: on return, the channels (MHz) to scan, or %NULL for all
+ *  channels; free with g_array_free()
+ * @out_ssid: on return, the SSID to probe for, or %NULL for a wildcard
+ *  probe; owned by the scheduler
+ *
+ * Picks the kind of scan to run next based on the link state and the
+ * channel history, and accounts for it.
+ *
+ * Returns: the type of scan to request
+ */
+NMWifiScanType
+nm_wifi_scan_scheduler_next (NMWifiScanScheduler *sched,
+                             GArray **out_freqs,
+                             const GByteArray **out_ssid)
+{
+	NMWifiScanType type = NM_WIFI_SCAN_TYPE_FULL;
+	GArray *freqs = NULL;
+
+	g_return_val_if_fail (sched != NULL, NM_WIFI_SCAN_TYPE_FULL);
+	g_return_val_if_fail (out_freqs != NULL, NM_WIFI_SCAN_TYPE_FULL);
+	g_return_val_if_fail (out_ssid != NULL, NM_WIFI_SCAN_TYPE_FULL);
+
+	*out_freqs = NULL;
+	*out_ssid = NULL;
+
+	if (sched->history_first) {
+		/* Known networks' channels if we know any yet, otherwise all the
+		 * channels anything was seen on last time.
+		 */
+		sched->history_first = FALSE;
+		freqs = collect_known_freqs (sched, FALSE);
+		if (!freqs->len) {
+			g_array_free (freqs, TRUE);
+			freqs = collect_known_freqs (sched, TRUE);
+		}
+		type = NM_WIFI_SCAN_TYPE_TARGETED;
+	} else if (sched->link_ssid && sched->weak) {
+		/* Looking for a better AP in the same ESS; never pay for a full
+		 * scan here since throughput and latency already suffer.
+		 */
+		freqs = collect_ess_freqs (sched);
+		type = NM_WIFI_SCAN_TYPE_ROAM;
+		*out_ssid = sched->link_ssid;
+
+		sched->roam_interval = MIN (sched->roam_interval * 2, NM_WIFI_SCAN_INTERVAL_ROAM_MAX);
+	} else if (sched->scans_since_full < NM_WIFI_SCAN_FULL_EVERY) {
+		if (sched->link_ssid)
+			freqs = collect_ess_freqs (sched);
+		else
+			freqs = collect_known_freqs (sched, FALSE);
+		type = NM_WIFI_SCAN_TYPE_TARGETED;
+	}
+
+	if (freqs && !freqs->len) {
+		/* Nothing known yet; only a full scan can help */
+		g_array_free (freqs, TRUE);
+		freqs = NULL;
+		type = NM_WIFI_SCAN_TYPE_FULL;
+		*out_ssid = NULL;
+	}
+
+	if (type == NM_WIFI_SCAN_TYPE_FULL)
+		sched->scans_since_full = 0;
+	else if (type == NM_WIFI_SCAN_TYPE_TARGETED)
+		sched->scans_since_full++;
+
+	*out_freqs = freqs;
+	return type;
+}
+
+/**
+ * nm_wifi_scan_scheduler_get_interval:
+ * @sched: the scheduler
+ * @backoff_interval: the device's current disconnected-scan backoff
+ *
+ * Returns: how many seconds to wait before the next scan
+ */
+guint
+nm_wifi_scan_scheduler_get_interval (NMWifiScanScheduler *sched,
+                                     guint backoff_interval)
+{
+	g_return_val_if_fail (sched != NULL, backoff_interval);
+
+	if (!sched->link_ssid)
+		return backoff_interval;
+	if (sched->weak)
+		return sched->roam_interval;
+	return MAX (backoff_interval, NM_WIFI_SCAN_INTERVAL_ASSOCIATED);
+}
+
+/**
+ * nm_wifi_scan_scheduler_get_full_period:
+ * @sched: the scheduler
+ * @backoff_interval: the device's current disconnected-scan backoff
+ *
+ * Returns: roughly how many seconds pass between full scans, i.e. how
+ * long an AP outside the targeted channels can go without being seen
+ */
+guint
+nm_wifi_scan_scheduler_get_full_period (NMWifiScanScheduler *sched,
+                                        guint backoff_interval)
+{
+	g_return_val_if_fail (sched != NULL, backoff_interval);
+
+	if (!sched->link_ssid)
+		return backoff_interval * (NM_WIFI_SCAN_FULL_EVERY + 1);
+	return MAX (backoff_interval, NM_WIFI_SCAN_INTERVAL_ASSOCIATED) * (NM_WIFI_SCAN_FULL_EVERY + 1);
+}
+
+const char *
+nm_wifi_scan_type_to_string (NMWifiScanType type)
+{
+	switch (type) {
+	case NM_WIFI_SCAN_TYPE_FULL:
+		return "full";
+	case NM_WIFI_SCAN_TYPE_TARGETED:
+		return "targeted";
+	case NM_WIFI_SCAN_TYPE_ROAM:
+		return "roaming";
+	default:
+		break;
+	}
+	return "unknown";
+}
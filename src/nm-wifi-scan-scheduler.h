@@ -0,0 +1,90 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ */
+
+#ifndef NM_WIFI_SCAN_SCHEDULER_H
+#define NM_WIFI_SCAN_SCHEDULER_H
+
+#include <glib.h>
+#include <net/ethernet.h>
+
+typedef enum {
+	NM_WIFI_SCAN_TYPE_FULL = 0,   /* all channels, wildcard SSID */
+	NM_WIFI_SCAN_TYPE_TARGETED,   /* channels known networks were seen on */
+	NM_WIFI_SCAN_TYPE_ROAM,       /* channels of the current ESS, its SSID only */
+} NMWifiScanType;
+
+/* Link strength (percent) below which the link is considered weak and
+ * roaming scans start; matches the nl80211 CQM threshold of -70 dBm.
+ * The link is good again once it climbs above NM_WIFI_SCAN_GOOD_STRENGTH.
+ */
+#define NM_WIFI_SCAN_WEAK_STRENGTH  50
+#define NM_WIFI_SCAN_GOOD_STRENGTH  57
+
+/* All of these are in seconds */
+#define NM_WIFI_SCAN_INTERVAL_ASSOCIATED 240
+#define NM_WIFI_SCAN_INTERVAL_ROAM_MIN   5
+#define NM_WIFI_SCAN_INTERVAL_ROAM_MAX   60
+
+/* A full scan follows every N targeted scans so new networks still show up */
+#define NM_WIFI_SCAN_FULL_EVERY 3
+
+typedef struct _NMWifiScanScheduler NMWifiScanScheduler;
+
+NMWifiScanScheduler *nm_wifi_scan_scheduler_new             (void);
+
+void                 nm_wifi_scan_scheduler_free            (NMWifiScanScheduler *sched);
+
+void                 nm_wifi_scan_scheduler_clear_known     (NMWifiScanScheduler *sched);
+
+void                 nm_wifi_scan_scheduler_add_known_ssid  (NMWifiScanScheduler *sched,
+                                                             const GByteArray *ssid);
+
+void                 nm_wifi_scan_scheduler_add_known_bssid (NMWifiScanScheduler *sched,
+                                                             const struct ether_addr *bssid);
+
+void                 nm_wifi_scan_scheduler_bss_seen        (NMWifiScanScheduler *sched,
+                                                             const struct ether_addr *bssid,
+                                                             const GByteArray *ssid,
+                                                             guint32 freq);
+
+void                 nm_wifi_scan_scheduler_set_link        (NMWifiScanScheduler *sched,
+                                                             const GByteArray *ssid,
+                                                             guint32 freq);
+
+gboolean             nm_wifi_scan_scheduler_update_strength (NMWifiScanScheduler *sched,
+                                                             int strength);
+
+void                 nm_wifi_scan_scheduler_force_full      (NMWifiScanScheduler *sched);
+
+void                 nm_wifi_scan_scheduler_start_from_history (NMWifiScanScheduler *sched);
+
+NMWifiScanType       nm_wifi_scan_scheduler_next            (NMWifiScanScheduler *sched,
+                                                             GArray **out_freqs,
+                                                             const GByteArray **out_ssid);
+
+guint                nm_wifi_scan_scheduler_get_interval    (NMWifiScanScheduler *sched,
+                                                             guint backoff_interval);
+
+guint                nm_wifi_scan_scheduler_get_full_period (NMWifiScanScheduler *sched,
+                                                             guint backoff_interval);
+
+const char *         nm_wifi_scan_type_to_string            (NMWifiScanType type);
+
+#endif /* NM_WIFI_SCAN_SCHEDULER_H */
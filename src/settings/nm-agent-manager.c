@@ -58,6 +58,9 @@ typedef struct {
 	GHashTable *agents;
 
 	GHashTable *requests;
+
+	/* Ask all agents at once for non-interactive secrets requests */
+	gboolean parallel_requests;
 } NMAgentManagerPrivate;
 
 enum {
@@ -417,6 +420,13 @@ struct _Request {
 	/* Stores the sorted list of NMSecretAgents which will be asked for secrets */
 	GSList *pending;
 
+	/* In parallel mode, the outstanding AgentCalls; the first agent to
+	 * return secrets wins and the others are cancelled.
+	 */
+	gboolean parallel;
+	gboolean parallel_started;
+	GSList *calls;
+
 	/* Stores the list of NMSecretAgent hashes that we've already
 	 * asked for secrets, so that we don't ask the same agent twice
 	 * if it quits and re-registers during this secrets request.
@@ -577,6 +587,35 @@ agent_compare_func (NMSecretAgent *a, NMSecretAgent *b, gpointer user_data)
 	return 0;
 }
 
+typedef struct {
+	NMSecretAgent *agent;
+	gconstpointer call_id;
+} AgentCall;
+
+/* Cancels and forgets the outstanding parallel call to @agent, or all of
+ * them if @agent is NULL.  Returns TRUE if any call was cancelled.
+ */
+static gboolean
+request_cancel_calls (Request *req, NMSecretAgent *agent)
+{
+	GSList *iter, *next;
+	gboolean found = FALSE;
+
+	for (iter = req->calls; iter; iter = next) {
+		AgentCall *call = iter->data;
+
+		next = g_slist_next (iter);
+		if (agent && call->agent != agent)
+			continue;
+
+		nm_secret_agent_cancel_secrets (call->agent, call->call_id);
+		req->calls = g_slist_delete_link (req->calls, iter);
+		g_slice_free (AgentCall, call);
+		found = TRUE;
+	}
+	return found;
+}
+
 static void
 request_add_agent (Request *req,
                    NMSecretAgent *agent,
@@ -623,6 +662,10 @@ request_add_agent (Request *req,
 	                                                agent,
 	                                                (GCompareDataFunc) agent_compare_func,
 	                                                session_monitor);
+
+	/* Parallel requests still waiting for answers ask new agents right away */
+	if (req->parallel && req->parallel_started && req->calls)
+		req->next_callback (req);
 }
 
 static void
@@ -654,6 +697,9 @@ request_remove_agent (Request *req, NMSecretAgent *agent)
 		req->current_call_id = NULL;
 		try_next = TRUE;
 		detail = " current";
+	} else if (req->parallel && request_cancel_calls (req, agent)) {
+		try_next = TRUE;
+		detail = " current";
 	}
 
 	nm_log_dbg (LOGD_AGENTS, "(%s)%s agent removed from secrets request %p/%s",
@@ -670,6 +716,14 @@ request_remove_agent (Request *req, NMSecretAgent *agent)
 	}
 }
 
+/* Remembers @agent so it isn't asked again should it re-register */
+static void
+request_mark_asked (Request *req, NMSecretAgent *agent)
+{
+	req->asked = g_slist_prepend (req->asked,
+	                              GUINT_TO_POINTER (nm_secret_agent_get_hash (agent)));
+}
+
 static gboolean
 next_generic (Request *req, const char *detail)
 {
@@ -688,6 +742,7 @@ next_generic (Request *req, const char *detail)
 		req->current_has_modify = FALSE;
 		req->current = req->pending->data;
 		req->pending = g_slist_remove (req->pending, req->current);
+		request_mark_asked (req, req->current);
 
 		nm_log_dbg (LOGD_AGENTS, "(%s) agent %s secrets for request %p/%s",
 					nm_secret_agent_get_description (req->current),
@@ -711,6 +766,20 @@ start_generic (gpointer user_data)
 
 /*************************************************************/
 
+static char *
+agent_get_username (NMSecretAgent *agent)
+{
+	struct passwd *pw;
+
+	pw = getpwuid (nm_secret_agent_get_owner_uid (agent));
+	if (pw && strlen (pw->pw_name)) {
+		/* Needs to be UTF-8 valid since it may be pushed through D-Bus */
+		if (g_utf8_validate (pw->pw_name, -1, NULL))
+			return g_strdup (pw->pw_name);
+	}
+	return NULL;
+}
+
 static void
 get_done_cb (NMSecretAgent *agent,
              gconstpointer call_id,
@@ -722,8 +791,7 @@ get_done_cb (NMSecretAgent *agent,
 	GHashTable *setting_secrets;
 	const char *agent_dbus_owner;
 	gboolean agent_has_modify;
-	struct passwd *pw;
-	char *agent_uname = NULL;
+	char *agent_uname;
 
 	g_return_if_fail (call_id == req->current_call_id);
 
@@ -760,14 +828,7 @@ get_done_cb (NMSecretAgent *agent,
 	            nm_secret_agent_get_description (agent),
 	            req, req->setting_name);
 
-	/* Get the agent's username */
-	pw = getpwuid (nm_secret_agent_get_owner_uid (agent));
-	if (pw && strlen (pw->pw_name)) {
-		/* Needs to be UTF-8 valid since it may be pushed through D-Bus */
-		if (g_utf8_validate (pw->pw_name, -1, NULL))
-			agent_uname = g_strdup (pw->pw_name);
-	}
-
+	agent_uname = agent_get_username (agent);
 	agent_dbus_owner = nm_secret_agent_get_dbus_owner (agent);
 	req_complete_success (req, secrets, agent_dbus_owner, agent_uname, agent_has_modify);
 	g_free (agent_uname);
@@ -814,8 +875,9 @@ set_secrets_not_required (NMConnection *connection, GHashTable *hash)
 	}
 }
 
-static void
-get_agent_request_secrets (Request *req, gboolean include_system_secrets)
+/* Returns a copy of the connection to send to an agent */
+static NMConnection *
+get_agent_connection (Request *req, gboolean include_system_secrets)
 {
 	NMConnection *tmp;
 
@@ -832,7 +894,15 @@ get_agent_request_secrets (Request *req, gboolean include_system_secrets)
 		if (req->existing_secrets)
 			set_secrets_not_required (tmp, req->existing_secrets);
 	}
+	return tmp;
+}
 
+static void
+get_agent_request_secrets (Request *req, gboolean include_system_secrets)
+{
+	NMConnection *tmp;
+
+	tmp = get_agent_connection (req, include_system_secrets);
 	req->current_call_id = nm_secret_agent_get_secrets (NM_SECRET_AGENT (req->current),
 	                                                    tmp,
 	                                                    req->setting_name,
@@ -979,6 +1049,125 @@ get_next_cb (Request *req)
 	}
 }
 
+static void
+get_parallel_done_cb (NMSecretAgent *agent,
+                      gconstpointer call_id,
+                      GHashTable *secrets,
+                      GError *error,
+                      gpointer user_data)
+{
+	Request *req = user_data;
+	AgentCall *call = NULL;
+	GHashTable *setting_secrets = NULL;
+	GSList *iter;
+	char *agent_uname;
+
+	for (iter = req->calls; iter; iter = g_slist_next (iter)) {
+		if (((AgentCall *) iter->data)->call_id == call_id) {
+			call = iter->data;
+			break;
+		}
+	}
+	g_return_if_fail (call != NULL);
+
+	req->calls = g_slist_remove (req->calls, call);
+	g_slice_free (AgentCall, call);
+
+	if (error) {
+		nm_log_dbg (LOGD_AGENTS, "(%s) agent failed secrets request %p/%s: (%d) %s",
+		            nm_secret_agent_get_description (agent),
+		            req, req->setting_name,
+		            error->code,
+		            error->message ? error->message : "(unknown)");
+	} else {
+		/* Ensure the setting we wanted secrets for got returned and has something in it */
+		setting_secrets = g_hash_table_lookup (secrets, req->setting_name);
+		if (!setting_secrets || !g_hash_table_size (setting_secrets)) {
+			nm_log_dbg (LOGD_AGENTS, "(%s) agent returned no secrets for request %p/%s",
+			            nm_secret_agent_get_description (agent),
+			            req, req->setting_name);
+			setting_secrets = NULL;
+		}
+	}
+
+	if (!setting_secrets) {
+		/* Fail the request once no other agent is left to answer */
+		if (!req->calls)
+			req->next_callback (req);
+		return;
+	}
+
+	nm_log_dbg (LOGD_AGENTS, "(%s) agent returned secrets for request %p/%s",
+	            nm_secret_agent_get_description (agent),
+	            req, req->setting_name);
+
+	/* First agent with secrets wins; the others aren't needed anymore */
+	request_cancel_calls (req, NULL);
+
+	agent_uname = agent_get_username (agent);
+	req_complete_success (req, secrets, nm_secret_agent_get_dbus_owner (agent), agent_uname, FALSE);
+	g_free (agent_uname);
+}
+
+/* Asks every pending agent at once.  Only used for requests that don't
+ * allow interaction, so no system secrets are ever sent to the agents and
+ * no MODIFY permission check is needed.
+ */
+static void
+get_next_parallel_cb (Request *req)
+{
+	NMConnection *tmp = NULL;
+	GError *error;
+
+	req->parallel_started = TRUE;
+
+	while (req->pending) {
+		NMSecretAgent *agent = req->pending->data;
+		gconstpointer call_id;
+		AgentCall *call;
+
+		req->pending = g_slist_delete_link (req->pending, req->pending);
+		request_mark_asked (req, agent);
+
+		if (!tmp)
+			tmp = get_agent_connection (req, FALSE);
+
+		nm_log_dbg (LOGD_AGENTS, "(%s) agent getting secrets for request %p/%s (parallel)",
+		            nm_secret_agent_get_description (agent),
+		            req, req->setting_name);
+
+		call_id = nm_secret_agent_get_secrets (agent,
+		                                       tmp,
+		                                       req->setting_name,
+		                                       req->hint,
+		                                       req->flags,
+		                                       get_parallel_done_cb,
+		                                       req);
+		if (call_id == NULL) {
+			/* Shouldn't hit this, but handle it anyway */
+			g_warn_if_fail (call_id != NULL);
+			continue;
+		}
+
+		call = g_slice_new (AgentCall);
+		call->agent = agent;
+		call->call_id = call_id;
+		req->calls = g_slist_prepend (req->calls, call);
+	}
+
+	if (tmp)
+		g_object_unref (tmp);
+
+	if (req->calls == NULL) {
+		/* No more secret agents are available to fulfill this secrets request */
+		error = g_error_new_literal (NM_AGENT_MANAGER_ERROR,
+		                             NM_AGENT_MANAGER_ERROR_NO_SECRETS,
+		                             "No agents were available for this request.");
+		req_complete_error (req, error);
+		g_error_free (error);
+	}
+}
+
 static gboolean
 get_start (gpointer user_data)
 {
@@ -1072,6 +1261,12 @@ get_cancel_cb (Request *req)
 		nm_secret_agent_cancel_secrets (req->current, req->current_call_id);
 }
 
+static void
+get_cancel_parallel_cb (Request *req)
+{
+	request_cancel_calls (req, NULL);
+}
+
 guint32
 nm_agent_manager_get_secrets (NMAgentManager *self,
                               NMConnection *connection,
@@ -1088,6 +1283,7 @@ nm_agent_manager_get_secrets (NMAgentManager *self,
 {
 	NMAgentManagerPrivate *priv = NM_AGENT_MANAGER_GET_PRIVATE (self);
 	Request *req;
+	gboolean parallel;
 
 	g_return_val_if_fail (self != NULL, 0);
 	g_return_val_if_fail (connection != NULL, 0);
@@ -1105,6 +1301,12 @@ nm_agent_manager_get_secrets (NMAgentManager *self,
 	 * both returning NULL if they didn't hash anything.
 	 */
 
+	/* Interactive requests still go to one agent at a time in priority
+	 * order, so the user only gets asked once and system secrets are only
+	 * sent after the agent's MODIFY permission has been checked.
+	 */
+	parallel = priv->parallel_requests && (flags == NM_SETTINGS_GET_SECRETS_FLAG_NONE);
+
 	req = request_new_get (connection,
 	                       filter_by_uid,
 	                       uid_filter,
@@ -1118,8 +1320,9 @@ nm_agent_manager_get_secrets (NMAgentManager *self,
 	                       other_data3,
 	                       get_complete_cb,
 	                       self,
-	                       get_next_cb,
-	                       get_cancel_cb);
+	                       parallel ? get_next_parallel_cb : get_next_cb,
+	                       parallel ? get_cancel_parallel_cb : get_cancel_cb);
+	req->parallel = parallel;
 	g_hash_table_insert (priv->requests, GUINT_TO_POINTER (req->reqid), req);
 
 	/* Kick off the request */
@@ -1442,6 +1645,24 @@ authority_changed_cb (gpointer user_data)
 
 /*************************************************************/
 
+/**
+ * nm_agent_manager_set_parallel_requests:
+ * @self: the #NMAgentManager
+ * @parallel: whether to ask all agents at once
+ *
+ * When @parallel is %TRUE, secrets requests that don't allow user
+ * interaction are sent to all eligible agents at the same time; the first
+ * agent to return secrets wins and the other requests are cancelled.
+ * Interactive requests always ask one agent at a time.
+ **/
+void
+nm_agent_manager_set_parallel_requests (NMAgentManager *self, gboolean parallel)
+{
+	g_return_if_fail (NM_IS_AGENT_MANAGER (self));
+
+	NM_AGENT_MANAGER_GET_PRIVATE (self)->parallel_requests = parallel;
+}
+
 NMAgentManager *
 nm_agent_manager_get (void)
 {
@@ -92,4 +92,7 @@ guint32 nm_agent_manager_delete_secrets (NMAgentManager *manager,
 NMSecretAgent *nm_agent_manager_get_agent_by_user (NMAgentManager *manager,
                                                    const char *username);
 
+void nm_agent_manager_set_parallel_requests (NMAgentManager *manager,
+                                             gboolean parallel);
+
 #endif /* NM_AGENT_MANAGER_H */
@@ -0,0 +1,193 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ */
+
+#include <config.h>
+#include <string.h>
+
+#include "nm-settings-change-queue.h"
+
+/* Editors and configuration management tools usually cause several
+ * monitor events per saved file (temporary file, rename, attribute
+ * changes).  Plugins feed those events in here and get called back once
+ * per path after it has been quiet for a while.  A digest of the file
+ * contents is kept for every path so plugins can skip reparsing files
+ * whose bytes did not change.
+ */
+
+struct _NMSettingsChangeQueue {
+	NMSettingsChangeFunc func;
+	gpointer user_data;
+
+	/* path -> generation its last event arrived in */
+	GHashTable *pending;
+	guint generation;
+	guint timeout_id;
+
+	GHashTable *digests;  /* path -> checksum of its contents */
+};
+
+static gboolean
+tick_cb (gpointer user_data)
+{
+	NMSettingsChangeQueue *queue = user_data;
+	GHashTableIter iter;
+	gpointer key, value;
+	GSList *ready = NULL, *liter;
+	gboolean again = TRUE;
+
+	/* Paths that saw no new event during the last interval are ready;
+	 * the others get another interval to settle.
+	 */
+	g_hash_table_iter_init (&iter, queue->pending);
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		if (GPOINTER_TO_UINT (value) != queue->generation) {
+			ready = g_slist_prepend (ready, key);
+			g_hash_table_iter_steal (&iter);
+		}
+	}
+	queue->generation++;
+
+	if (g_hash_table_size (queue->pending) == 0) {
+		queue->timeout_id = 0;
+		again = FALSE;
+	}
+
+	/* Callbacks may add paths again; those are handled on a later tick */
+	for (liter = ready; liter; liter = g_slist_next (liter)) {
+		const char *path = liter->data;
+
+		queue->func (path, g_file_test (path, G_FILE_TEST_EXISTS), queue->user_data);
+	}
+	g_slist_foreach (ready, (GFunc) g_free, NULL);
+	g_slist_free (ready);
+
+	return again;
+}
+
+/**************************************************************/
+
+NMSettingsChangeQueue *
+nm_settings_change_queue_new (NMSettingsChangeFunc func, gpointer user_data)
+{
+	NMSettingsChangeQueue *queue;
+
+	g_return_val_if_fail (func != NULL, NULL);
+
+	queue = g_slice_new0 (NMSettingsChangeQueue);
+	queue->func = func;
+	queue->user_data = user_data;
+	queue->pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	queue->digests = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	return queue;
+}
+
+void
+nm_settings_change_queue_free (NMSettingsChangeQueue *queue)
+{
+	g_return_if_fail (queue != NULL);
+
+	if (queue->timeout_id)
+		g_source_remove (queue->timeout_id);
+	g_hash_table_destroy (queue->pending);
+	g_hash_table_destroy (queue->digests);
+	g_slice_free (NMSettingsChangeQueue, queue);
+}
+
+/**
+ * nm_settings_change_queue_add:
+ * @queue: the #NMSettingsChangeQueue
+ * @path: the file an event was received for
+ *
+ * Schedules @path to be handled once its events have settled.
+ **/
+void
+nm_settings_change_queue_add (NMSettingsChangeQueue *queue, const char *path)
+{
+	g_return_if_fail (queue != NULL);
+	g_return_if_fail (path != NULL);
+
+	g_hash_table_insert (queue->pending, g_strdup (path), GUINT_TO_POINTER (queue->generation));
+
+	if (!queue->timeout_id)
+		queue->timeout_id = g_timeout_add (NM_SETTINGS_CHANGE_QUEUE_DELAY_MS, tick_cb, queue);
+}
+
+/**
+ * nm_settings_change_queue_contents_changed:
+ * @queue: the #NMSettingsChangeQueue
+ * @path: the path the digest is recorded for
+ * @files: (allow-none): %NULL-terminated list of files that make up @path,
+ *   or %NULL if it is just @path itself
+ *
+ * Checksums the contents of @files and remembers the result for @path.
+ *
+ * Returns: %TRUE if the contents differ from the last call for @path or
+ * there was no previous call.
+ **/
+gboolean
+nm_settings_change_queue_contents_changed (NMSettingsChangeQueue *queue,
+                                           const char *path,
+                                           const char **files)
+{
+	const char *single[2] = { path, NULL };
+	GChecksum *sum;
+	const char *old;
+	char *digest;
+	gboolean changed;
+
+	g_return_val_if_fail (queue != NULL, TRUE);
+	g_return_val_if_fail (path != NULL, TRUE);
+
+	if (!files)
+		files = single;
+
+	sum = g_checksum_new (G_CHECKSUM_SHA256);
+	for (; *files; files++) {
+		char *contents = NULL;
+		gsize len = 0;
+
+		/* Include the name so a file moving between slots counts too */
+		g_checksum_update (sum, (const guchar *) *files, strlen (*files) + 1);
+		if (g_file_get_contents (*files, &contents, &len, NULL)) {
+			g_checksum_update (sum, (const guchar *) "+", 1);
+			g_checksum_update (sum, (const guchar *) contents, len);
+			g_free (contents);
+		} else
+			g_checksum_update (sum, (const guchar *) "-", 1);
+	}
+	digest = g_strdup (g_checksum_get_string (sum));
+	g_checksum_free (sum);
+
+	old = g_hash_table_lookup (queue->digests, path);
+	changed = !old || strcmp (old, digest);
+	g_hash_table_insert (queue->digests, g_strdup (path), digest);
+	return changed;
+}
+
+/* Drops the recorded digest, e.g. because @path was removed */
+void
+nm_settings_change_queue_forget (NMSettingsChangeQueue *queue, const char *path)
+{
+	g_return_if_fail (queue != NULL);
+	g_return_if_fail (path != NULL);
+
+	g_hash_table_remove (queue->pending, path);
+	g_hash_table_remove (queue->digests, path);
+}
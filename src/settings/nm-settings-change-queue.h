@@ -0,0 +1,55 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ */
+
+#ifndef NM_SETTINGS_CHANGE_QUEUE_H
+#define NM_SETTINGS_CHANGE_QUEUE_H
+
+#include <glib.h>
+
+/* A path has to be quiet for between one and two of these before its
+ * changes are handled.
+ */
+#define NM_SETTINGS_CHANGE_QUEUE_DELAY_MS 200
+
+typedef struct _NMSettingsChangeQueue NMSettingsChangeQueue;
+
+/* Called once per changed path after its events have settled; 'exists'
+ * tells whether the file is still there.
+ */
+typedef void (*NMSettingsChangeFunc) (const char *path,
+                                      gboolean exists,
+                                      gpointer user_data);
+
+NMSettingsChangeQueue *nm_settings_change_queue_new  (NMSettingsChangeFunc func,
+                                                      gpointer user_data);
+
+void     nm_settings_change_queue_free               (NMSettingsChangeQueue *queue);
+
+void     nm_settings_change_queue_add                (NMSettingsChangeQueue *queue,
+                                                      const char *path);
+
+gboolean nm_settings_change_queue_contents_changed   (NMSettingsChangeQueue *queue,
+                                                      const char *path,
+                                                      const char **files);
+
+void     nm_settings_change_queue_forget             (NMSettingsChangeQueue *queue,
+                                                      const char *path);
+
+#endif /* NM_SETTINGS_CHANGE_QUEUE_H */
@@ -22,6 +22,7 @@
 #include "config.h"
 
 #include <string.h>
+#include <time.h>
 #include <netinet/ether.h>
 
 #include <NetworkManager.h>
@@ -40,6 +41,7 @@
 #include "nm-marshal.h"
 #include "nm-agent-manager.h"
 #include "NetworkManagerUtils.h"
+#include "nm-settings-reply-cache.h"
 
 #define SETTINGS_TIMESTAMPS_FILE  LOCALSTATEDIR"/lib/NetworkManager/timestamps"
 #define SETTINGS_SEEN_BSSIDS_FILE LOCALSTATEDIR"/lib/NetworkManager/seen-bssids"
@@ -85,7 +87,7 @@ typedef struct {
 	NMDBusManager *dbus_mgr;
 	NMAgentManager *agent_mgr;
 	NMSessionMonitor *session_monitor;
-	guint session_changed_id;
+	GSList *acl_users;  /* users this connection is indexed under */
 
 	GSList *pending_auths; /* List of pending authentication requests */
 	gboolean visible; /* Is this connection is visible by some session? */
@@ -106,8 +108,20 @@ typedef struct {
 	 */
 	NMConnection *agent_secrets;
 
+	/* Agent-owned secrets kept across activations when the secrets cache is
+	 * enabled, hashed by setting name; unlike 'agent_secrets' they survive
+	 * nm_connection_clear_secrets() until they expire.
+	 */
+	GHashTable *secrets_cache;
+
 	guint64 timestamp;   /* Up-to-date timestamp of connection use */
 	GHashTable *seen_bssids; /* Up-to-date BSSIDs that's been seen for the connection */
+
+	/* Marshalled GetSettings reply; 'watched_settings' are the settings it
+	 * was built from, whose changes drop it again.
+	 */
+	NMSettingsReplyCache *reply_cache;
+	GSList *watched_settings;
 } NMSettingsConnectionPrivate;
 
 /**************************************************************/
@@ -209,6 +223,84 @@ nm_settings_connection_is_visible (NMSettingsConnection *self)
 	return NM_SETTINGS_CONNECTION_GET_PRIVATE (self)->visible;
 }
 
+/* Username -> set of connections whose ACL lists that user.  When a user
+ * logs in or out only their connections need their visibility rechecked.
+ */
+static GHashTable *acl_index = NULL;
+
+static void
+acl_index_remove (NMSettingsConnection *self)
+{
+	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
+	GSList *iter;
+
+	for (iter = priv->acl_users; iter; iter = g_slist_next (iter)) {
+		GHashTable *connections = g_hash_table_lookup (acl_index, iter->data);
+
+		if (connections) {
+			g_hash_table_remove (connections, self);
+			if (g_hash_table_size (connections) == 0)
+				g_hash_table_remove (acl_index, iter->data);
+		}
+		g_free (iter->data);
+	}
+	g_slist_free (priv->acl_users);
+	priv->acl_users = NULL;
+}
+
+static void
+acl_index_add (NMSettingsConnection *self, NMSettingConnection *s_con)
+{
+	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
+	guint32 num, i;
+
+	num = nm_setting_connection_get_num_permissions (s_con);
+	for (i = 0; i < num; i++) {
+		const char *puser;
+		GHashTable *connections;
+
+		if (!nm_setting_connection_get_permission (s_con, i, NULL, &puser, NULL))
+			continue;
+
+		connections = g_hash_table_lookup (acl_index, puser);
+		if (!connections) {
+			connections = g_hash_table_new (g_direct_hash, g_direct_equal);
+			g_hash_table_insert (acl_index, g_strdup (puser), connections);
+		} else if (g_hash_table_lookup (connections, self))
+			continue;
+
+		g_hash_table_insert (connections, self, self);
+		priv->acl_users = g_slist_prepend (priv->acl_users, g_strdup (puser));
+	}
+}
+
+static void
+acl_user_changed_cb (NMSessionMonitor *monitor,
+                     const char *user,
+                     gboolean has_session,
+                     gpointer unused)
+{
+	GHashTable *connections;
+	GHashTableIter iter;
+	gpointer key;
+	GSList *affected = NULL, *liter;
+
+	connections = g_hash_table_lookup (acl_index, user);
+	if (!connections)
+		return;
+
+	/* Rechecking re-indexes the connection, so work on a copy */
+	g_hash_table_iter_init (&iter, connections);
+	while (g_hash_table_iter_next (&iter, &key, NULL))
+		affected = g_slist_prepend (affected, g_object_ref (key));
+
+	for (liter = affected; liter; liter = g_slist_next (liter)) {
+		nm_settings_connection_recheck_visibility (liter->data);
+		g_object_unref (liter->data);
+	}
+	g_slist_free (affected);
+}
+
 void
 nm_settings_connection_recheck_visibility (NMSettingsConnection *self)
 {
@@ -224,6 +316,10 @@ nm_settings_connection_recheck_visibility (NMSettingsConnection *self)
 	s_con = (NMSettingConnection *) nm_connection_get_setting (NM_CONNECTION (self), NM_TYPE_SETTING_CONNECTION);
 	g_assert (s_con);
 
+	/* The ACL may have changed since the last check */
+	acl_index_remove (self);
+	acl_index_add (self, s_con);
+
 	/* Check every user in the ACL for a session */
 	num = nm_setting_connection_get_num_permissions (s_con);
 	if (num == 0) {
@@ -246,12 +342,6 @@ nm_settings_connection_recheck_visibility (NMSettingsConnection *self)
 	set_visible (self, FALSE);
 }
 
-static void
-session_changed_cb (NMSessionMonitor *self, gpointer user_data)
-{
-	nm_settings_connection_recheck_visibility (NM_SETTINGS_CONNECTION (user_data));
-}
-
 /**************************************************************/
 
 /* Return TRUE if any active user in the connection's ACL has the given
@@ -369,6 +459,317 @@ secrets_cleared_cb (NMSettingsConnection *self)
 	priv->agent_secrets = NULL;
 }
 
+/**************************************************************/
+
+/* Lifetime of cached agent-owned secrets in seconds; 0 disables the cache */
+static guint32 secrets_cache_ttl = 0;
+
+typedef struct {
+	GHashTable *secrets;  /* a{sv} of one setting's agent-owned secrets */
+	time_t expires;
+} CachedSecrets;
+
+static void
+wipe_secret_string (gpointer key, gpointer value, gpointer user_data)
+{
+	if (value)
+		memset (value, 0, strlen (value));
+}
+
+/* Destroy function for secret values; doesn't leave them lying around in
+ * freed memory.
+ */
+static void
+secret_value_free (gpointer data)
+{
+	GValue *val = data;
+
+	if (G_VALUE_HOLDS_STRING (val))
+		wipe_secret_string (NULL, (gpointer) g_value_get_string (val), NULL);
+	else if (G_VALUE_HOLDS (val, DBUS_TYPE_G_MAP_OF_STRING)) {
+		/* VPN secrets */
+		g_hash_table_foreach (g_value_get_boxed (val), wipe_secret_string, NULL);
+	} else if (G_VALUE_HOLDS (val, DBUS_TYPE_G_UCHAR_ARRAY)) {
+		GByteArray *array = g_value_get_boxed (val);
+
+		if (array)
+			memset (array->data, 0, array->len);
+	}
+
+	g_value_unset (val);
+	g_slice_free (GValue, val);
+}
+
+static GHashTable *
+secrets_setting_hash_new (void)
+{
+	return g_hash_table_new_full (g_str_hash, g_str_equal, g_free, secret_value_free);
+}
+
+/* Moves everything from @src, as returned by nm_setting_to_hash(), into
+ * @dst, whose values are wiped when freed; destroys @src.
+ */
+static void
+secrets_setting_hash_take (GHashTable *dst, GHashTable *src)
+{
+	GHashTableIter iter;
+	gpointer key, value;
+
+	g_hash_table_iter_init (&iter, src);
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		g_hash_table_iter_steal (&iter);
+		g_hash_table_insert (dst, key, value);
+	}
+	g_hash_table_destroy (src);
+}
+
+static void
+cached_secrets_free (CachedSecrets *cached)
+{
+	g_hash_table_destroy (cached->secrets);
+	g_slice_free (CachedSecrets, cached);
+}
+
+/**
+ * nm_settings_connection_set_secrets_cache_ttl:
+ * @ttl: how long agent-owned secrets are cached, in seconds
+ *
+ * Enables caching of agent-owned secrets across activations for all
+ * connections, so that non-interactive secrets requests (like automatic
+ * reconnects) don't have to wait for the secret agent.  A @ttl of 0
+ * disables the cache.
+ **/
+void
+nm_settings_connection_set_secrets_cache_ttl (guint32 ttl)
+{
+	secrets_cache_ttl = ttl;
+}
+
+static gboolean
+secret_is_cacheable (NMSetting *setting, const char *secret)
+{
+	NMSettingSecretFlags flags = NM_SETTING_SECRET_FLAG_NONE;
+
+	/* Only saved agent-owned secrets are cached, not-saved ones need user
+	 * interaction by definition.
+	 */
+	if (!nm_setting_get_secret_flags (setting, secret, &flags, NULL))
+		return FALSE;
+	return    (flags & NM_SETTING_SECRET_FLAG_AGENT_OWNED)
+	       && !(flags & NM_SETTING_SECRET_FLAG_NOT_SAVED);
+}
+
+static void
+secrets_cache_add (NMSettingsConnection *self, const char *setting_name)
+{
+	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
+	NMSetting *setting;
+	GHashTable *hash, *secrets;
+	GHashTableIter iter;
+	gpointer key, value;
+	CachedSecrets *cached;
+
+	if (!secrets_cache_ttl)
+		return;
+
+	/* Pick the secrets straight from the setting rather than from a copy of
+	 * the whole connection, so every copy made here gets wiped.
+	 */
+	setting = nm_connection_get_setting_by_name (NM_CONNECTION (self), setting_name);
+	hash = setting ? nm_setting_to_hash (setting, NM_SETTING_HASH_FLAG_ONLY_SECRETS) : NULL;
+	if (!hash) {
+		g_hash_table_remove (priv->secrets_cache, setting_name);
+		return;
+	}
+
+	secrets = secrets_setting_hash_new ();
+	g_hash_table_iter_init (&iter, hash);
+	while (g_hash_table_iter_next (&iter, &key, &value)) {
+		GValue *val = value;
+
+		g_hash_table_iter_steal (&iter);
+
+		if (G_VALUE_HOLDS (val, DBUS_TYPE_G_MAP_OF_STRING)) {
+			GHashTableIter vpn_iter;
+			gpointer vpn_key, vpn_value;
+
+			/* VPN secrets carry their flags one by one */
+			g_hash_table_iter_init (&vpn_iter, g_value_get_boxed (val));
+			while (g_hash_table_iter_next (&vpn_iter, &vpn_key, &vpn_value)) {
+				if (!secret_is_cacheable (setting, vpn_key)) {
+					wipe_secret_string (NULL, vpn_value, NULL);
+					g_hash_table_iter_remove (&vpn_iter);
+				}
+			}
+			if (g_hash_table_size (g_value_get_boxed (val))) {
+				g_hash_table_insert (secrets, key, val);
+				continue;
+			}
+		} else if (secret_is_cacheable (setting, key)) {
+			g_hash_table_insert (secrets, key, val);
+			continue;
+		}
+
+		secret_value_free (val);
+		g_free (key);
+	}
+	g_hash_table_destroy (hash);
+
+	if (!g_hash_table_size (secrets)) {
+		g_hash_table_destroy (secrets);
+		g_hash_table_remove (priv->secrets_cache, setting_name);
+		return;
+	}
+
+	cached = g_slice_new (CachedSecrets);
+	cached->secrets = secrets;
+	cached->expires = time (NULL) + secrets_cache_ttl;
+	g_hash_table_insert (priv->secrets_cache, g_strdup (setting_name), cached);
+
+	nm_log_dbg (LOGD_SETTINGS, "(%s/%s) cached agent secrets for %u seconds",
+	            nm_connection_get_uuid (NM_CONNECTION (self)),
+	            setting_name,
+	            secrets_cache_ttl);
+}
+
+static void
+copy_secret_value (gpointer key, gpointer value, gpointer user_data)
+{
+	GValue *copy;
+
+	copy = g_slice_new0 (GValue);
+	g_value_init (copy, G_VALUE_TYPE (value));
+	g_value_copy (value, copy);
+	g_hash_table_insert ((GHashTable *) user_data, g_strdup (key), copy);
+}
+
+/* Returns the system secrets plus the cached agent-owned secrets for
+ * @setting_name, or NULL.  Whether that's all the connection needs is
+ * left to the agent manager, which asks an agent for anything missing.
+ * The returned secrets are wiped once the last reference is dropped.
+ */
+static GHashTable *
+secrets_cache_lookup (NMSettingsConnection *self, const char *setting_name)
+{
+	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
+	CachedSecrets *cached;
+	GHashTable *hash, *system, *setting_hash;
+	GHashTableIter iter;
+	gpointer key, value;
+
+	cached = g_hash_table_lookup (priv->secrets_cache, setting_name);
+	if (!cached)
+		return NULL;
+
+	if (cached->expires <= time (NULL)) {
+		g_hash_table_remove (priv->secrets_cache, setting_name);
+		return NULL;
+	}
+
+	hash = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+	                              (GDestroyNotify) g_hash_table_destroy);
+
+	system = nm_connection_to_hash (priv->system_secrets, NM_SETTING_HASH_FLAG_ONLY_SECRETS);
+	if (system) {
+		g_hash_table_iter_init (&iter, system);
+		while (g_hash_table_iter_next (&iter, &key, &value)) {
+			g_hash_table_iter_steal (&iter);
+			setting_hash = secrets_setting_hash_new ();
+			secrets_setting_hash_take (setting_hash, value);
+			g_hash_table_insert (hash, key, setting_hash);
+		}
+		g_hash_table_destroy (system);
+	}
+
+	setting_hash = g_hash_table_lookup (hash, setting_name);
+	if (!setting_hash) {
+		setting_hash = secrets_setting_hash_new ();
+		g_hash_table_insert (hash, g_strdup (setting_name), setting_hash);
+	}
+	g_hash_table_foreach (cached->secrets, copy_secret_value, setting_hash);
+
+	nm_log_dbg (LOGD_SETTINGS, "(%s/%s) using cached agent secrets",
+	            nm_connection_get_uuid (NM_CONNECTION (self)),
+	            setting_name);
+	return hash;
+}
+
+/**
+ * nm_settings_connection_clear_secrets_cache:
+ * @self: the #NMSettingsConnection
+ *
+ * Forgets any cached agent-owned secrets of the connection, eg because
+ * they were found to be wrong.
+ **/
+void
+nm_settings_connection_clear_secrets_cache (NMSettingsConnection *self)
+{
+	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (self));
+
+	g_hash_table_remove_all (NM_SETTINGS_CONNECTION_GET_PRIVATE (self)->secrets_cache);
+}
+
+/**************************************************************/
+
+static void setting_changed_cb (GObject *setting, GParamSpec *pspec, gpointer user_data);
+
+static void
+reply_cache_invalidate (NMSettingsConnection *self)
+{
+	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
+	GSList *iter;
+
+	if (priv->reply_cache)
+		nm_settings_reply_cache_clear (priv->reply_cache);
+
+	for (iter = priv->watched_settings; iter; iter = g_slist_next (iter)) {
+		g_signal_handlers_disconnect_by_func (iter->data, G_CALLBACK (setting_changed_cb), self);
+		g_object_unref (iter->data);
+	}
+	g_slist_free (priv->watched_settings);
+	priv->watched_settings = NULL;
+}
+
+static void
+setting_changed_cb (GObject *setting, GParamSpec *pspec, gpointer user_data)
+{
+	/* Secrets are never part of the cached reply */
+	if (pspec->flags & NM_SETTING_PARAM_SECRET)
+		return;
+
+	reply_cache_invalidate (NM_SETTINGS_CONNECTION (user_data));
+}
+
+static void
+watch_setting_cb (NMSetting *setting,
+                  const char *key,
+                  const GValue *value,
+                  GParamFlags flags,
+                  gpointer user_data)
+{
+	NMSettingsConnection *self = NM_SETTINGS_CONNECTION (user_data);
+	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
+
+	if (g_slist_find (priv->watched_settings, setting))
+		return;
+
+	g_signal_connect (setting, "notify", G_CALLBACK (setting_changed_cb), self);
+	priv->watched_settings = g_slist_prepend (priv->watched_settings, g_object_ref (setting));
+}
+
+static void
+updated_cb (NMSettingsConnection *self)
+{
+	reply_cache_invalidate (self);
+}
+
+static void
+changed_cb (NMSettingsConnection *self)
+{
+	/* A setting was added or removed; the watched ones don't tell */
+	reply_cache_invalidate (self);
+}
+
 /* Update the settings of this connection to match that of 'new', taking care to
  * make a private copy of secrets.
  */
@@ -388,6 +789,9 @@ nm_settings_connection_replace_settings (NMSettingsConnection *self,
 
 	priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
 
+	reply_cache_invalidate (self);
+	g_hash_table_remove_all (priv->secrets_cache);
+
 	new_settings = nm_connection_to_hash (new, NM_SETTING_HASH_FLAG_ALL);
 	g_assert (new_settings);
 	if (nm_connection_replace_settings (NM_CONNECTION (self), new_settings, error)) {
@@ -747,6 +1151,8 @@ agent_secrets_done_cb (NMAgentManager *manager,
 			 */
 			update_system_secrets_cache (self);
 			update_agent_secrets_cache (self, NULL);
+			if (agent_dbus_owner)
+				secrets_cache_add (self, setting_name);
 
 			/* Only save secrets to backing storage if the agent returned any
 			 * new system secrets.  If it didn't, then the secrets are agent-
@@ -840,7 +1246,18 @@ nm_settings_connection_get_secrets (NMSettingsConnection *self,
 		return 0;
 	}
 
-	existing_secrets = nm_connection_to_hash (priv->system_secrets, NM_SETTING_HASH_FLAG_ONLY_SECRETS);
+	/* Requests for new secrets mean the previous ones didn't work.  Otherwise
+	 * requests that can't involve the user may be answered from the cache;
+	 * the agent manager then finds the existing secrets sufficient.
+	 */
+	existing_secrets = NULL;
+	if (flags & NM_SETTINGS_GET_SECRETS_FLAG_REQUEST_NEW)
+		g_hash_table_remove (priv->secrets_cache, setting_name);
+	else if (flags == NM_SETTINGS_GET_SECRETS_FLAG_NONE && !filter_by_uid)
+		existing_secrets = secrets_cache_lookup (self, setting_name);
+
+	if (!existing_secrets)
+		existing_secrets = nm_connection_to_hash (priv->system_secrets, NM_SETTING_HASH_FLAG_ONLY_SECRETS);
 	call_id = nm_agent_manager_get_secrets (priv->agent_mgr,
 	                                        NM_CONNECTION (self),
 	                                        filter_by_uid,
@@ -1055,40 +1472,54 @@ get_settings_auth_cb (NMSettingsConnection *self,
                       GError *error,
                       gpointer data)
 {
-	if (error)
+	NMSettingsConnectionPrivate *priv = NM_SETTINGS_CONNECTION_GET_PRIVATE (self);
+	GHashTable *settings;
+	NMConnection *dupl_con;
+	NMSettingConnection *s_con;
+	guint64 timestamp;
+
+	if (error) {
 		dbus_g_method_return_error (context, error);
-	else {
-		GHashTable *settings;
-		NMConnection *dupl_con;
-		NMSettingConnection *s_con;
-		guint64 timestamp;
-
-		dupl_con = nm_connection_duplicate (NM_CONNECTION (self));
-		g_assert (dupl_con);
-
-		/* Timestamp is not updated in connection's 'timestamp' property,
-		 * because it would force updating the connection and in turn
-		 * writing to /etc periodically, which we want to avoid. Rather real
-		 * timestamps are kept track of in a private variable. So, substitute
-		 * timestamp property with the real one here before returning the settings.
-		 */
-		timestamp = nm_settings_connection_get_timestamp (self);
-		if (timestamp) {
-			s_con = nm_connection_get_setting_connection (NM_CONNECTION (dupl_con));
-			g_assert (s_con);
-			g_object_set (s_con, NM_SETTING_CONNECTION_TIMESTAMP, timestamp, NULL);
-		}
+		return;
+	}
 
-		/* Secrets should *never* be returned by the GetSettings method, they
-		 * get returned by the GetSecrets method which can be better
-		 * protected against leakage of secrets to unprivileged callers.
-		 */
-		settings = nm_connection_to_hash (NM_CONNECTION (dupl_con), NM_SETTING_HASH_FLAG_NO_SECRETS);
-		g_assert (settings);
-		dbus_g_method_return (context, settings);
-		g_hash_table_destroy (settings);
-		g_object_unref (dupl_con);
+	if (nm_settings_reply_cache_send (priv->reply_cache, NM_SETTING_HASH_FLAG_NO_SECRETS, context))
+		return;
+
+	dupl_con = nm_connection_duplicate (NM_CONNECTION (self));
+	g_assert (dupl_con);
+
+	/* Timestamp is not updated in connection's 'timestamp' property,
+	 * because it would force updating the connection and in turn
+	 * writing to /etc periodically, which we want to avoid. Rather real
+	 * timestamps are kept track of in a private variable. So, substitute
+	 * timestamp property with the real one here before returning the settings.
+	 */
+	timestamp = nm_settings_connection_get_timestamp (self);
+	if (timestamp) {
+		s_con = nm_connection_get_setting_connection (NM_CONNECTION (dupl_con));
+		g_assert (s_con);
+		g_object_set (s_con, NM_SETTING_CONNECTION_TIMESTAMP, timestamp, NULL);
 	}
+
+	/* Secrets should *never* be returned by the GetSettings method, they
+	 * get returned by the GetSecrets method which can be better
+	 * protected against leakage of secrets to unprivileged callers.
+	 */
+	settings = nm_connection_to_hash (NM_CONNECTION (dupl_con), NM_SETTING_HASH_FLAG_NO_SECRETS);
+	g_assert (settings);
+
+	/* Keep the marshalled reply around until the connection changes */
+	reply_cache_invalidate (self);
+	if (nm_settings_reply_cache_add (priv->reply_cache, NM_SETTING_HASH_FLAG_NO_SECRETS, settings)) {
+		nm_connection_for_each_setting_value (NM_CONNECTION (self), watch_setting_cb, self);
+		if (!nm_settings_reply_cache_send (priv->reply_cache, NM_SETTING_HASH_FLAG_NO_SECRETS, context))
+			dbus_g_method_return (context, settings);
+	} else
+		dbus_g_method_return (context, settings);
+
+	g_hash_table_destroy (settings);
+	g_object_unref (dupl_con);
 }
 
 static void
@@ -1437,6 +1868,7 @@ nm_settings_connection_update_timestamp (NMSettingsConnection *connection, guint
 
 	/* Update timestamp in private storage */
 	priv->timestamp = timestamp;
+	reply_cache_invalidate (connection);
 
 	/* Save timestamp to timestamps database file */
 	timestamps_file = g_key_file_new ();
@@ -1693,16 +2125,28 @@ nm_settings_connection_init (NMSettingsConnection *self)
 	priv->visible = FALSE;
 
 	priv->session_monitor = nm_session_monitor_get ();
-	priv->session_changed_id = g_signal_connect (priv->session_monitor,
-	                                             NM_SESSION_MONITOR_CHANGED,
-	                                             G_CALLBACK (session_changed_cb),
-	                                             self);
+	if (!acl_index) {
+		/* The index holds its own reference on the singleton monitor */
+		acl_index = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+		                                   (GDestroyNotify) g_hash_table_destroy);
+		g_signal_connect (nm_session_monitor_get (),
+		                  NM_SESSION_MONITOR_USER_CHANGED,
+		                  G_CALLBACK (acl_user_changed_cb),
+		                  NULL);
+	}
 
 	priv->agent_mgr = nm_agent_manager_get ();
 
 	priv->seen_bssids = g_hash_table_new_full (mac_hash, mac_equal, g_free, g_free);
 
+	priv->reply_cache = nm_settings_reply_cache_new ();
+
+	priv->secrets_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+	                                             (GDestroyNotify) cached_secrets_free);
+
 	g_signal_connect (self, "secrets-cleared", G_CALLBACK (secrets_cleared_cb), NULL);
+	g_signal_connect (self, NM_SETTINGS_CONNECTION_UPDATED, G_CALLBACK (updated_cb), NULL);
+	g_signal_connect (self, "changed", G_CALLBACK (changed_cb), NULL);
 }
 
 static void
@@ -1720,6 +2164,7 @@ dispose (GObject *object)
 		g_object_unref (priv->system_secrets);
 	if (priv->agent_secrets)
 		g_object_unref (priv->agent_secrets);
+	g_hash_table_destroy (priv->secrets_cache);
 
 	/* Cancel PolicyKit requests */
 	for (iter = priv->pending_auths; iter; iter = g_slist_next (iter))
@@ -1734,10 +2179,13 @@ dispose (GObject *object)
 
 	g_hash_table_destroy (priv->seen_bssids);
 
+	reply_cache_invalidate (self);
+	nm_settings_reply_cache_free (priv->reply_cache);
+	priv->reply_cache = NULL;
+
 	set_visible (self, FALSE);
 
-	if (priv->session_changed_id)
-		g_signal_handler_disconnect (priv->session_monitor, priv->session_changed_id);
+	acl_index_remove (self);
 	g_object_unref (priv->session_monitor);
 	g_object_unref (priv->agent_mgr);
 	g_object_unref (priv->dbus_mgr);
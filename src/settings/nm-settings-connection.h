@@ -113,6 +113,10 @@ guint32 nm_settings_connection_get_secrets (NMSettingsConnection *connection,
 void nm_settings_connection_cancel_secrets (NMSettingsConnection *connection,
                                             guint32 call_id);
 
+void nm_settings_connection_set_secrets_cache_ttl (guint32 ttl);
+
+void nm_settings_connection_clear_secrets_cache (NMSettingsConnection *connection);
+
 gboolean nm_settings_connection_is_visible (NMSettingsConnection *self);
 
 void nm_settings_connection_recheck_visibility (NMSettingsConnection *self);
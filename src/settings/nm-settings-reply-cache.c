@@ -0,0 +1,486 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ */
+
+#include <config.h>
+#include <string.h>
+
+#include <dbus/dbus-glib-lowlevel.h>
+
+#include "nm-settings-reply-cache.h"
+#include "nm-dbus-glib-types.h"
+#include "nm-logging.h"
+
+/* One slot per NMSettingHashFlags value */
+#define N_VARIANTS (NM_SETTING_HASH_FLAG_ONLY_SECRETS + 1)
+
+struct _NMSettingsReplyCache {
+	/* Method-return templates without serial or destination */
+	DBusMessage *replies[N_VARIANTS];
+};
+
+/**************************************************************/
+
+/* Builds the D-Bus signature dbus-glib would use for 'type'; returns FALSE
+ * for anything we don't know how to marshal so the caller can fall back
+ * to dbus-glib itself.
+ */
+static gboolean
+type_signature (GType type, GString *sig)
+{
+	if (type == G_TYPE_STRING)
+		g_string_append_c (sig, DBUS_TYPE_STRING);
+	else if (type == G_TYPE_BOOLEAN)
+		g_string_append_c (sig, DBUS_TYPE_BOOLEAN);
+	else if (type == G_TYPE_INT)
+		g_string_append_c (sig, DBUS_TYPE_INT32);
+	else if (type == G_TYPE_UINT)
+		g_string_append_c (sig, DBUS_TYPE_UINT32);
+	else if (type == G_TYPE_INT64)
+		g_string_append_c (sig, DBUS_TYPE_INT64);
+	else if (type == G_TYPE_UINT64)
+		g_string_append_c (sig, DBUS_TYPE_UINT64);
+	else if (type == G_TYPE_UCHAR)
+		g_string_append_c (sig, DBUS_TYPE_BYTE);
+	else if (type == G_TYPE_DOUBLE)
+		g_string_append_c (sig, DBUS_TYPE_DOUBLE);
+	else if (type == DBUS_TYPE_G_OBJECT_PATH)
+		g_string_append_c (sig, DBUS_TYPE_OBJECT_PATH);
+	else if (type == G_TYPE_STRV)
+		g_string_append (sig, "as");
+	else if (type == G_TYPE_VALUE)
+		g_string_append_c (sig, DBUS_TYPE_VARIANT);
+	else if (dbus_g_type_is_collection (type)) {
+		g_string_append_c (sig, DBUS_TYPE_ARRAY);
+		return type_signature (dbus_g_type_get_collection_specialization (type), sig);
+	} else if (dbus_g_type_is_map (type)) {
+		g_string_append (sig, "a{");
+		if (!type_signature (dbus_g_type_get_map_key_specialization (type), sig))
+			return FALSE;
+		if (!type_signature (dbus_g_type_get_map_value_specialization (type), sig))
+			return FALSE;
+		g_string_append_c (sig, '}');
+	} else if (dbus_g_type_is_struct (type)) {
+		guint i, size = dbus_g_type_get_struct_size (type);
+
+		g_string_append_c (sig, '(');
+		for (i = 0; i < size; i++) {
+			if (!type_signature (dbus_g_type_get_struct_member_type (type, i), sig))
+				return FALSE;
+		}
+		g_string_append_c (sig, ')');
+	} else
+		return FALSE;
+
+	return TRUE;
+}
+
+static gboolean append_value (DBusMessageIter *iter, const GValue *value);
+
+static gboolean
+append_variant (DBusMessageIter *iter, const GValue *value)
+{
+	DBusMessageIter sub;
+	GString *sig;
+	gboolean success;
+
+	sig = g_string_sized_new (8);
+	success = type_signature (G_VALUE_TYPE (value), sig);
+	if (success) {
+		success = dbus_message_iter_open_container (iter, DBUS_TYPE_VARIANT, sig->str, &sub);
+		if (success) {
+			success = append_value (&sub, value);
+			success = dbus_message_iter_close_container (iter, &sub) && success;
+		}
+	}
+	g_string_free (sig, TRUE);
+	return success;
+}
+
+typedef struct {
+	DBusMessageIter *iter;
+	gboolean success;
+} AppendInfo;
+
+static void
+collection_append_cb (const GValue *value, gpointer user_data)
+{
+	AppendInfo *info = user_data;
+
+	if (info->success)
+		info->success = append_value (info->iter, value);
+}
+
+static void
+map_append_cb (const GValue *key, const GValue *value, gpointer user_data)
+{
+	AppendInfo *info = user_data;
+	DBusMessageIter entry;
+
+	if (!info->success)
+		return;
+
+	info->success = dbus_message_iter_open_container (info->iter, DBUS_TYPE_DICT_ENTRY, NULL, &entry);
+	if (info->success) {
+		info->success = append_value (&entry, key) && append_value (&entry, value);
+		info->success = dbus_message_iter_close_container (info->iter, &entry) && info->success;
+	}
+}
+
+static gboolean
+append_fixed_array (DBusMessageIter *iter, int element_type, GArray *array)
+{
+	DBusMessageIter sub;
+	char sig[2] = { element_type, '\0' };
+	gboolean success;
+
+	if (!dbus_message_iter_open_container (iter, DBUS_TYPE_ARRAY, sig, &sub))
+		return FALSE;
+	success = dbus_message_iter_append_fixed_array (&sub, element_type, &array->data, array->len);
+	return dbus_message_iter_close_container (iter, &sub) && success;
+}
+
+static gboolean
+append_container (DBusMessageIter *iter, const GValue *value)
+{
+	GType type = G_VALUE_TYPE (value);
+	DBusMessageIter sub;
+	AppendInfo info;
+	GString *sig;
+	gboolean success;
+
+	/* The byte and uint arrays are the bulk of most connections (SSIDs,
+	 * certificates, IPv4 addresses); copy those in one go.
+	 */
+	if (type == DBUS_TYPE_G_UCHAR_ARRAY)
+		return append_fixed_array (iter, DBUS_TYPE_BYTE, g_value_get_boxed (value));
+	if (type == DBUS_TYPE_G_ARRAY_OF_UINT)
+		return append_fixed_array (iter, DBUS_TYPE_UINT32, g_value_get_boxed (value));
+
+	sig = g_string_sized_new (8);
+	if (dbus_g_type_is_collection (type))
+		success = type_signature (dbus_g_type_get_collection_specialization (type), sig);
+	else {
+		g_string_append_c (sig, DBUS_DICT_ENTRY_BEGIN_CHAR);
+		success =    type_signature (dbus_g_type_get_map_key_specialization (type), sig)
+		          && type_signature (dbus_g_type_get_map_value_specialization (type), sig);
+		g_string_append_c (sig, DBUS_DICT_ENTRY_END_CHAR);
+	}
+
+	if (success)
+		success = dbus_message_iter_open_container (iter, DBUS_TYPE_ARRAY, sig->str, &sub);
+	g_string_free (sig, TRUE);
+	if (!success)
+		return FALSE;
+
+	info.iter = &sub;
+	info.success = TRUE;
+	if (dbus_g_type_is_collection (type))
+		dbus_g_type_collection_value_iterate (value, collection_append_cb, &info);
+	else
+		dbus_g_type_map_value_iterate (value, map_append_cb, &info);
+
+	return dbus_message_iter_close_container (iter, &sub) && info.success;
+}
+
+static gboolean
+append_struct (DBusMessageIter *iter, const GValue *value)
+{
+	GType type = G_VALUE_TYPE (value);
+	DBusMessageIter sub;
+	guint i, size;
+	gboolean success = TRUE;
+
+	if (!dbus_message_iter_open_container (iter, DBUS_TYPE_STRUCT, NULL, &sub))
+		return FALSE;
+
+	size = dbus_g_type_get_struct_size (type);
+	for (i = 0; success && i < size; i++) {
+		GValue member = { 0, };
+
+		g_value_init (&member, dbus_g_type_get_struct_member_type (type, i));
+		success =    dbus_g_type_struct_get_member (value, i, &member)
+		          && append_value (&sub, &member);
+		g_value_unset (&member);
+	}
+
+	return dbus_message_iter_close_container (iter, &sub) && success;
+}
+
+static gboolean
+append_value (DBusMessageIter *iter, const GValue *value)
+{
+	GType type = G_VALUE_TYPE (value);
+
+	if (type == G_TYPE_STRING) {
+		const char *str = g_value_get_string (value);
+
+		if (!str)
+			str = "";
+		return dbus_message_iter_append_basic (iter, DBUS_TYPE_STRING, &str);
+	} else if (type == G_TYPE_BOOLEAN) {
+		dbus_bool_t b = g_value_get_boolean (value);
+
+		return dbus_message_iter_append_basic (iter, DBUS_TYPE_BOOLEAN, &b);
+	} else if (type == G_TYPE_INT) {
+		dbus_int32_t i = g_value_get_int (value);
+
+		return dbus_message_iter_append_basic (iter, DBUS_TYPE_INT32, &i);
+	} else if (type == G_TYPE_UINT) {
+		dbus_uint32_t u = g_value_get_uint (value);
+
+		return dbus_message_iter_append_basic (iter, DBUS_TYPE_UINT32, &u);
+	} else if (type == G_TYPE_INT64) {
+		dbus_int64_t i = g_value_get_int64 (value);
+
+		return dbus_message_iter_append_basic (iter, DBUS_TYPE_INT64, &i);
+	} else if (type == G_TYPE_UINT64) {
+		dbus_uint64_t u = g_value_get_uint64 (value);
+
+		return dbus_message_iter_append_basic (iter, DBUS_TYPE_UINT64, &u);
+	} else if (type == G_TYPE_UCHAR) {
+		unsigned char c = g_value_get_uchar (value);
+
+		return dbus_message_iter_append_basic (iter, DBUS_TYPE_BYTE, &c);
+	} else if (type == G_TYPE_DOUBLE) {
+		double d = g_value_get_double (value);
+
+		return dbus_message_iter_append_basic (iter, DBUS_TYPE_DOUBLE, &d);
+	} else if (type == DBUS_TYPE_G_OBJECT_PATH) {
+		const char *path = g_value_get_boxed (value);
+
+		if (!path)
+			path = "/";
+		return dbus_message_iter_append_basic (iter, DBUS_TYPE_OBJECT_PATH, &path);
+	} else if (type == G_TYPE_STRV) {
+		char **strv = g_value_get_boxed (value);
+		DBusMessageIter sub;
+		gboolean success = TRUE;
+
+		if (!dbus_message_iter_open_container (iter, DBUS_TYPE_ARRAY, "s", &sub))
+			return FALSE;
+		while (success && strv && *strv)
+			success = dbus_message_iter_append_basic (&sub, DBUS_TYPE_STRING, strv++);
+		return dbus_message_iter_close_container (iter, &sub) && success;
+	} else if (type == G_TYPE_VALUE)
+		return append_variant (iter, g_value_get_boxed (value));
+	else if (dbus_g_type_is_collection (type) || dbus_g_type_is_map (type))
+		return append_container (iter, value);
+	else if (dbus_g_type_is_struct (type))
+		return append_struct (iter, value);
+
+	return FALSE;
+}
+
+/* Catch anything we can't marshal before starting to write the message,
+ * so a half-written container never has to be unwound.
+ */
+static gboolean
+settings_marshallable (GHashTable *settings)
+{
+	GHashTableIter iter, prop_iter;
+	GHashTable *props;
+	GValue *value;
+	GString *sig;
+	gboolean success = TRUE;
+
+	sig = g_string_sized_new (16);
+	g_hash_table_iter_init (&iter, settings);
+	while (success && g_hash_table_iter_next (&iter, NULL, (gpointer) &props)) {
+		g_hash_table_iter_init (&prop_iter, props);
+		while (success && g_hash_table_iter_next (&prop_iter, NULL, (gpointer) &value)) {
+			g_string_truncate (sig, 0);
+			success = type_signature (G_VALUE_TYPE (value), sig);
+		}
+	}
+	g_string_free (sig, TRUE);
+	return success;
+}
+
+static gboolean
+append_settings (DBusMessage *message, GHashTable *settings)
+{
+	DBusMessageIter iter, settings_iter;
+	GHashTableIter setting_iter;
+	const char *setting_name;
+	GHashTable *props;
+	gboolean success = TRUE;
+
+	dbus_message_iter_init_append (message, &iter);
+	if (!dbus_message_iter_open_container (&iter, DBUS_TYPE_ARRAY, "{sa{sv}}", &settings_iter))
+		return FALSE;
+
+	g_hash_table_iter_init (&setting_iter, settings);
+	while (success && g_hash_table_iter_next (&setting_iter, (gpointer) &setting_name, (gpointer) &props)) {
+		DBusMessageIter setting_entry, props_iter;
+		GHashTableIter prop_iter;
+		const char *prop_name;
+		GValue *value;
+
+		if (!dbus_message_iter_open_container (&settings_iter, DBUS_TYPE_DICT_ENTRY, NULL, &setting_entry))
+			return FALSE;
+		success = dbus_message_iter_append_basic (&setting_entry, DBUS_TYPE_STRING, &setting_name);
+		if (success)
+			success = dbus_message_iter_open_container (&setting_entry, DBUS_TYPE_ARRAY, "{sv}", &props_iter);
+		if (success) {
+			g_hash_table_iter_init (&prop_iter, props);
+			while (success && g_hash_table_iter_next (&prop_iter, (gpointer) &prop_name, (gpointer) &value)) {
+				DBusMessageIter prop_entry;
+
+				if (!dbus_message_iter_open_container (&props_iter, DBUS_TYPE_DICT_ENTRY, NULL, &prop_entry)) {
+					success = FALSE;
+					break;
+				}
+				success =    dbus_message_iter_append_basic (&prop_entry, DBUS_TYPE_STRING, &prop_name)
+				          && append_variant (&prop_entry, value);
+				success = dbus_message_iter_close_container (&props_iter, &prop_entry) && success;
+			}
+			success = dbus_message_iter_close_container (&setting_entry, &props_iter) && success;
+		}
+		success = dbus_message_iter_close_container (&settings_iter, &setting_entry) && success;
+	}
+
+	return dbus_message_iter_close_container (&iter, &settings_iter) && success;
+}
+
+/**************************************************************/
+
+NMSettingsReplyCache *
+nm_settings_reply_cache_new (void)
+{
+	return g_slice_new0 (NMSettingsReplyCache);
+}
+
+void
+nm_settings_reply_cache_clear (NMSettingsReplyCache *cache)
+{
+	guint i;
+
+	g_return_if_fail (cache != NULL);
+
+	for (i = 0; i < N_VARIANTS; i++) {
+		if (cache->replies[i]) {
+			dbus_message_unref (cache->replies[i]);
+			cache->replies[i] = NULL;
+		}
+	}
+}
+
+void
+nm_settings_reply_cache_free (NMSettingsReplyCache *cache)
+{
+	g_return_if_fail (cache != NULL);
+
+	nm_settings_reply_cache_clear (cache);
+	g_slice_free (NMSettingsReplyCache, cache);
+}
+
+/**
+ * nm_settings_reply_cache_add:
+ * @cache: the #NMSettingsReplyCache
+ * @flags: the filter @settings was built with
+ * @settings: connection hash as returned by nm_connection_to_hash()
+ *
+ * Marshals @settings into a method-return template and stores it in the
+ * slot for @flags, replacing whatever was there.
+ *
+ * Returns: %TRUE if the settings could be marshalled
+ **/
+gboolean
+nm_settings_reply_cache_add (NMSettingsReplyCache *cache,
+                             NMSettingHashFlags flags,
+                             GHashTable *settings)
+{
+	DBusMessage *reply;
+
+	g_return_val_if_fail (cache != NULL, FALSE);
+	g_return_val_if_fail (flags < N_VARIANTS, FALSE);
+	g_return_val_if_fail (settings != NULL, FALSE);
+
+	if (!settings_marshallable (settings))
+		return FALSE;
+
+	reply = dbus_message_new (DBUS_MESSAGE_TYPE_METHOD_RETURN);
+	if (!reply)
+		return FALSE;
+
+	if (!append_settings (reply, settings)) {
+		nm_log_warn (LOGD_SETTINGS, "failed to marshal connection settings reply");
+		dbus_message_unref (reply);
+		return FALSE;
+	}
+
+	if (cache->replies[flags])
+		dbus_message_unref (cache->replies[flags]);
+	cache->replies[flags] = reply;
+	return TRUE;
+}
+
+/**
+ * nm_settings_reply_cache_send:
+ * @cache: the #NMSettingsReplyCache
+ * @flags: which cached variant to send
+ * @context: the method invocation to reply to
+ *
+ * Replies to @context with a copy of the cached message for @flags.  The
+ * copy shares nothing with the template, so the template can be dropped
+ * while the reply is still queued.
+ *
+ * Returns: %TRUE if a reply was sent, %FALSE if nothing is cached for
+ * @flags and the caller still has to reply itself
+ **/
+gboolean
+nm_settings_reply_cache_send (NMSettingsReplyCache *cache,
+                              NMSettingHashFlags flags,
+                              DBusGMethodInvocation *context)
+{
+	DBusMessage *call_reply, *reply;
+	const char *destination;
+
+	g_return_val_if_fail (cache != NULL, FALSE);
+	g_return_val_if_fail (flags < N_VARIANTS, FALSE);
+	g_return_val_if_fail (context != NULL, FALSE);
+
+	if (!cache->replies[flags])
+		return FALSE;
+
+	/* Borrow the serial and destination dbus-glib would have used */
+	call_reply = dbus_g_method_get_reply (context);
+	if (!call_reply)
+		return FALSE;
+
+	reply = dbus_message_copy (cache->replies[flags]);
+	if (!reply) {
+		dbus_message_unref (call_reply);
+		return FALSE;
+	}
+
+	destination = dbus_message_get_destination (call_reply);
+	if (   !dbus_message_set_reply_serial (reply, dbus_message_get_reply_serial (call_reply))
+	    || (destination && !dbus_message_set_destination (reply, destination))) {
+		dbus_message_unref (reply);
+		dbus_message_unref (call_reply);
+		return FALSE;
+	}
+	dbus_message_unref (call_reply);
+
+	/* Takes ownership of 'reply' and frees 'context' */
+	dbus_g_method_send_reply (context, reply);
+	return TRUE;
+}
@@ -0,0 +1,49 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ */
+
+#ifndef NM_SETTINGS_REPLY_CACHE_H
+#define NM_SETTINGS_REPLY_CACHE_H
+
+#include <glib.h>
+#include <dbus/dbus-glib.h>
+#include <nm-setting.h>
+
+/* Holds already-marshalled a{sa{sv}} method replies for a connection, one
+ * per NMSettingHashFlags filter, so repeated GetSettings calls only copy
+ * the cached message body instead of rebuilding and re-marshalling the
+ * settings hash.
+ */
+typedef struct _NMSettingsReplyCache NMSettingsReplyCache;
+
+NMSettingsReplyCache *nm_settings_reply_cache_new   (void);
+
+void                  nm_settings_reply_cache_free  (NMSettingsReplyCache *cache);
+
+void                  nm_settings_reply_cache_clear (NMSettingsReplyCache *cache);
+
+gboolean              nm_settings_reply_cache_add   (NMSettingsReplyCache *cache,
+                                                     NMSettingHashFlags flags,
+                                                     GHashTable *settings);
+
+gboolean              nm_settings_reply_cache_send  (NMSettingsReplyCache *cache,
+                                                     NMSettingHashFlags flags,
+                                                     DBusGMethodInvocation *context);
+
+#endif /* NM_SETTINGS_REPLY_CACHE_H */
@@ -0,0 +1,398 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ */
+
+#include <config.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "nm-settings-write-queue.h"
+#include "nm-settings-error.h"
+#include "nm-logging.h"
+
+/* Plugins hand their commits to the queue instead of writing right away.
+ * All commits that arrive within NM_SETTINGS_WRITE_QUEUE_DELAY_MS are
+ * flushed together: each connection is written at most once, every
+ * directory that was written to is fsync()ed once, and the identity of
+ * every file written is remembered so the plugins can tell the change
+ * notifications caused by their own writes from real external edits.
+ */
+
+typedef struct {
+	NMSettingsConnectionCommitFunc callback;
+	gpointer user_data;
+} Commit;
+
+typedef struct {
+	NMSettingsConnection *connection;
+	NMSettingsWriteFunc write_func;
+	NMSettingsWriteChainFunc chain_func;
+	GSList *commits;  /* list of Commit, oldest first */
+	gboolean success;
+	GError *error;
+} Entry;
+
+typedef struct {
+	dev_t dev;
+	ino_t ino;
+	off_t size;
+	time_t mtime;
+	long mtime_nsec;
+	time_t ctime;
+	long ctime_nsec;
+} FileId;
+
+struct _NMSettingsWriteQueue {
+	GHashTable *pending;    /* NMSettingsConnection -> Entry */
+	guint flush_id;
+	gboolean flushing;
+
+	GSList *written;        /* paths written during the current flush */
+	GHashTable *own_writes; /* path -> FileId as we left it */
+};
+
+/**************************************************************/
+
+static void
+entry_free (Entry *entry)
+{
+	g_slist_foreach (entry->commits, (GFunc) g_free, NULL);
+	g_slist_free (entry->commits);
+	g_clear_error (&entry->error);
+	g_object_unref (entry->connection);
+	g_slice_free (Entry, entry);
+}
+
+static void
+entry_complete (NMSettingsConnection *connection, GError *error, gpointer user_data)
+{
+	Entry *entry = user_data;
+	GSList *iter;
+
+	for (iter = entry->commits; iter; iter = g_slist_next (iter)) {
+		Commit *commit = iter->data;
+
+		commit->callback (connection, error, commit->user_data);
+	}
+}
+
+static void
+file_id_fill (FileId *id, const struct stat *st)
+{
+	id->dev = st->st_dev;
+	id->ino = st->st_ino;
+	id->size = st->st_size;
+	id->mtime = st->st_mtime;
+	id->mtime_nsec = st->st_mtim.tv_nsec;
+	id->ctime = st->st_ctime;
+	id->ctime_nsec = st->st_ctim.tv_nsec;
+}
+
+static gboolean
+file_id_matches (const FileId *id, const struct stat *st)
+{
+	return    id->dev == st->st_dev
+	       && id->ino == st->st_ino
+	       && id->size == st->st_size
+	       && id->mtime == st->st_mtime
+	       && id->mtime_nsec == st->st_mtim.tv_nsec
+	       && id->ctime == st->st_ctime
+	       && id->ctime_nsec == st->st_ctim.tv_nsec;
+}
+
+static void
+sync_path (const char *path)
+{
+	int fd;
+
+	/* Removed files have nothing left to sync but their directory */
+	fd = open (path, O_RDONLY);
+	if (fd < 0)
+		return;
+	if (fsync (fd) < 0)
+		nm_log_warn (LOGD_SETTINGS, "failed to sync '%s': %d", path, errno);
+	close (fd);
+}
+
+/* fsync() each written file, then each directory written to once, and
+ * remember what the written files look like now.
+ */
+static void
+sync_written (NMSettingsWriteQueue *queue)
+{
+	GHashTable *dirs;
+	GHashTableIter iter;
+	const char *dir;
+	GSList *liter;
+
+	if (!queue->written)
+		return;
+
+	/* File data first, so the directory entries never point at data that
+	 * isn't on disk yet.
+	 */
+	dirs = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	for (liter = queue->written; liter; liter = g_slist_next (liter)) {
+		sync_path (liter->data);
+		g_hash_table_insert (dirs, g_path_get_dirname (liter->data), NULL);
+	}
+
+	g_hash_table_iter_init (&iter, dirs);
+	while (g_hash_table_iter_next (&iter, (gpointer) &dir, NULL))
+		sync_path (dir);
+	g_hash_table_destroy (dirs);
+
+	for (liter = queue->written; liter; liter = g_slist_next (liter)) {
+		char *path = liter->data;
+		struct stat st;
+
+		if (stat (path, &st) == 0) {
+			FileId *id = g_new (FileId, 1);
+
+			file_id_fill (id, &st);
+			g_hash_table_insert (queue->own_writes, path, id);
+		} else {
+			g_hash_table_remove (queue->own_writes, path);
+			g_free (path);
+		}
+	}
+	g_slist_free (queue->written);
+	queue->written = NULL;
+}
+
+static gboolean
+flush_cb (gpointer user_data)
+{
+	NMSettingsWriteQueue *queue = user_data;
+	GHashTable *pending;
+	GHashTableIter iter;
+	GSList *entries = NULL, *liter;
+	Entry *entry;
+
+	queue->flush_id = 0;
+
+	/* Commits made from the callbacks below go into the next batch */
+	pending = queue->pending;
+	queue->pending = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+	g_hash_table_iter_init (&iter, pending);
+	while (g_hash_table_iter_next (&iter, NULL, (gpointer) &entry))
+		entries = g_slist_prepend (entries, entry);
+	g_hash_table_destroy (pending);
+
+	queue->flushing = TRUE;
+	for (liter = entries; liter; liter = g_slist_next (liter)) {
+		entry = liter->data;
+		entry->success = entry->write_func (entry->connection, &entry->error);
+	}
+	sync_written (queue);
+	queue->flushing = FALSE;
+
+	for (liter = entries; liter; liter = g_slist_next (liter)) {
+		entry = liter->data;
+
+		if (entry->success)
+			entry->chain_func (entry->connection, entry_complete, entry);
+		else {
+			if (!entry->error) {
+				entry->error = g_error_new_literal (NM_SETTINGS_ERROR,
+				                                    NM_SETTINGS_ERROR_INTERNAL_ERROR,
+				                                    "Failed to write connection");
+			}
+			entry_complete (entry->connection, entry->error, entry);
+		}
+		entry_free (entry);
+	}
+	g_slist_free (entries);
+
+	return FALSE;
+}
+
+/**************************************************************/
+
+NMSettingsWriteQueue *
+nm_settings_write_queue_get (void)
+{
+	static NMSettingsWriteQueue *singleton = NULL;
+
+	if (!singleton) {
+		singleton = g_slice_new0 (NMSettingsWriteQueue);
+		singleton->pending = g_hash_table_new (g_direct_hash, g_direct_equal);
+		singleton->own_writes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, g_free);
+	}
+	return singleton;
+}
+
+/**
+ * nm_settings_write_queue_commit:
+ * @queue: the #NMSettingsWriteQueue
+ * @connection: the connection to write out
+ * @write_func: writes @connection when the batch is flushed
+ * @chain_func: chains up to the parent commit_changes() after a
+ *   successful write
+ * @callback: called once @connection has been written, or failed to be
+ * @user_data: user data for @callback
+ *
+ * Queues @connection to be written with the next batch.  If it is already
+ * queued the write is shared and @callback is just added to it.
+ **/
+void
+nm_settings_write_queue_commit (NMSettingsWriteQueue *queue,
+                                NMSettingsConnection *connection,
+                                NMSettingsWriteFunc write_func,
+                                NMSettingsWriteChainFunc chain_func,
+                                NMSettingsConnectionCommitFunc callback,
+                                gpointer user_data)
+{
+	Entry *entry;
+	Commit *commit;
+
+	g_return_if_fail (queue != NULL);
+	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (connection));
+	g_return_if_fail (write_func != NULL);
+	g_return_if_fail (chain_func != NULL);
+	g_return_if_fail (callback != NULL);
+
+	entry = g_hash_table_lookup (queue->pending, connection);
+	if (!entry) {
+		entry = g_slice_new0 (Entry);
+		entry->connection = g_object_ref (connection);
+		g_hash_table_insert (queue->pending, connection, entry);
+	}
+	entry->write_func = write_func;
+	entry->chain_func = chain_func;
+
+	commit = g_new0 (Commit, 1);
+	commit->callback = callback;
+	commit->user_data = user_data;
+	entry->commits = g_slist_append (entry->commits, commit);
+
+	if (!queue->flush_id)
+		queue->flush_id = g_timeout_add (NM_SETTINGS_WRITE_QUEUE_DELAY_MS, flush_cb, queue);
+}
+
+/* Drops queued writes for a connection that is going away */
+void
+nm_settings_write_queue_cancel (NMSettingsWriteQueue *queue,
+                                NMSettingsConnection *connection)
+{
+	Entry *entry;
+	GError *error;
+
+	g_return_if_fail (queue != NULL);
+	g_return_if_fail (NM_IS_SETTINGS_CONNECTION (connection));
+
+	entry = g_hash_table_lookup (queue->pending, connection);
+	if (!entry)
+		return;
+
+	g_hash_table_remove (queue->pending, connection);
+
+	error = g_error_new_literal (NM_SETTINGS_ERROR,
+	                             NM_SETTINGS_ERROR_INTERNAL_ERROR,
+	                             "Connection was removed before it was written");
+	entry_complete (connection, error, entry);
+	g_error_free (error);
+	entry_free (entry);
+}
+
+/**
+ * nm_settings_write_queue_add_written:
+ * @queue: the #NMSettingsWriteQueue
+ * @path: a file the caller just wrote
+ *
+ * Records @path as written by us; called from an #NMSettingsWriteFunc it
+ * is synced with the rest of the batch, otherwise right away.
+ **/
+void
+nm_settings_write_queue_add_written (NMSettingsWriteQueue *queue,
+                                     const char *path)
+{
+	g_return_if_fail (queue != NULL);
+	g_return_if_fail (path != NULL);
+
+	queue->written = g_slist_prepend (queue->written, g_strdup (path));
+	if (!queue->flushing)
+		sync_written (queue);
+}
+
+/**
+ * nm_settings_write_queue_is_own_write:
+ * @queue: the #NMSettingsWriteQueue
+ * @path: a file a change notification was received for
+ *
+ * Returns: %TRUE if @path is still exactly as we last wrote it, in which
+ * case the notification was caused by our own write and the file does not
+ * need to be read again.
+ **/
+gboolean
+nm_settings_write_queue_is_own_write (NMSettingsWriteQueue *queue,
+                                      const char *path)
+{
+	FileId *id;
+	struct stat st;
+
+	g_return_val_if_fail (queue != NULL, FALSE);
+	g_return_val_if_fail (path != NULL, FALSE);
+
+	id = g_hash_table_lookup (queue->own_writes, path);
+	if (!id)
+		return FALSE;
+
+	/* Keep the entry while it matches; one write causes several events */
+	if (stat (path, &st) == 0 && file_id_matches (id, &st))
+		return TRUE;
+
+	g_hash_table_remove (queue->own_writes, path);
+	return FALSE;
+}
+
+/**
+ * nm_settings_write_queue_needs_write:
+ * @connection: the in-memory connection
+ * @on_disk: (allow-none): the connection as it was last read or written
+ *
+ * Returns: %TRUE unless @connection differs from @on_disk only in secrets
+ * that are never written to disk.
+ **/
+gboolean
+nm_settings_write_queue_needs_write (NMConnection *connection,
+                                     NMConnection *on_disk)
+{
+	GHashTable *diffs = NULL;
+	gboolean same;
+
+	g_return_val_if_fail (NM_IS_CONNECTION (connection), TRUE);
+
+	if (!on_disk)
+		return TRUE;
+
+	same = nm_connection_diff (connection,
+	                           on_disk,
+	                           NM_SETTING_COMPARE_FLAG_IGNORE_AGENT_OWNED_SECRETS |
+	                             NM_SETTING_COMPARE_FLAG_IGNORE_NOT_SAVED_SECRETS,
+	                           &diffs);
+	if (diffs)
+		g_hash_table_destroy (diffs);
+	return !same;
+}
@@ -0,0 +1,66 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/* NetworkManager -- Network link manager
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ */
+
+#ifndef NM_SETTINGS_WRITE_QUEUE_H
+#define NM_SETTINGS_WRITE_QUEUE_H
+
+#include <glib.h>
+#include <nm-connection.h>
+
+#include "nm-settings-connection.h"
+
+/* Commits made to the same connection within this window are written once */
+#define NM_SETTINGS_WRITE_QUEUE_DELAY_MS 100
+
+typedef struct _NMSettingsWriteQueue NMSettingsWriteQueue;
+
+/* Writes 'connection' to disk if needed; plugins report the files they
+ * touched with nm_settings_write_queue_add_written().
+ */
+typedef gboolean (*NMSettingsWriteFunc) (NMSettingsConnection *connection,
+                                         GError **error);
+
+/* Chains up to the parent class' commit_changes() once the write is done */
+typedef void (*NMSettingsWriteChainFunc) (NMSettingsConnection *connection,
+                                          NMSettingsConnectionCommitFunc callback,
+                                          gpointer user_data);
+
+NMSettingsWriteQueue *nm_settings_write_queue_get (void);
+
+void     nm_settings_write_queue_commit        (NMSettingsWriteQueue *queue,
+                                                NMSettingsConnection *connection,
+                                                NMSettingsWriteFunc write_func,
+                                                NMSettingsWriteChainFunc chain_func,
+                                                NMSettingsConnectionCommitFunc callback,
+                                                gpointer user_data);
+
+void     nm_settings_write_queue_cancel        (NMSettingsWriteQueue *queue,
+                                                NMSettingsConnection *connection);
+
+void     nm_settings_write_queue_add_written   (NMSettingsWriteQueue *queue,
+                                                const char *path);
+
+gboolean nm_settings_write_queue_is_own_write  (NMSettingsWriteQueue *queue,
+                                                const char *path);
+
+gboolean nm_settings_write_queue_needs_write   (NMConnection *connection,
+                                                NMConnection *on_disk);
+
+#endif /* NM_SETTINGS_WRITE_QUEUE_H */
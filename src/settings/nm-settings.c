@@ -51,6 +51,7 @@
 #include <nm-setting-wired.h>
 #include <nm-setting-wireless.h>
 #include <nm-setting-wireless-security.h>
+#include <nm-utils.h>
 
 #include "../nm-device-ethernet.h"
 #include "nm-dbus-glib-types.h"
@@ -67,6 +68,9 @@
 #include "nm-settings-utils.h"
 
 #define CONFIG_KEY_NO_AUTO_DEFAULT "no-auto-default"
+#define CONFIG_GROUP_AGENTS "agents"
+#define CONFIG_KEY_PARALLEL_REQUESTS "parallel-requests"
+#define CONFIG_KEY_SECRETS_CACHE_TTL "secrets-cache-ttl"
 
 /* LINKER CRACKROCK */
 #define EXPORT(sym) void * __export_##sym = &sym;
@@ -151,32 +155,200 @@ enum {
 	LAST_PROP
 };
 
+typedef struct {
+	guint plugin;
+	NMConnection *connection;
+} BindingOwner;
+
+/* Returns a key for the device (and network) a connection is tied to, or
+ * NULL if it isn't tied to anything in particular.  @out_has_mac tells
+ * whether the key names a specific device.
+ */
+static char *
+connection_binding_key (NMConnection *connection, gboolean *out_has_mac)
+{
+	NMSettingWired *s_wired;
+	NMSettingWireless *s_wireless;
+	const GByteArray *mac, *ssid;
+	GString *key;
+	guint i;
+
+	*out_has_mac = FALSE;
+
+	s_wired = nm_connection_get_setting_wired (connection);
+	if (s_wired) {
+		mac = nm_setting_wired_get_mac_address (s_wired);
+		if (!mac || mac->len != ETH_ALEN)
+			return NULL;
+		*out_has_mac = TRUE;
+		return g_strdup_printf ("%s/%s", NM_SETTING_WIRED_SETTING_NAME,
+		                        ether_ntoa ((struct ether_addr *) mac->data));
+	}
+
+	s_wireless = nm_connection_get_setting_wireless (connection);
+	if (s_wireless) {
+		ssid = nm_setting_wireless_get_ssid (s_wireless);
+		if (!ssid)
+			return NULL;
+
+		key = g_string_new (NM_SETTING_WIRELESS_SETTING_NAME "/");
+		mac = nm_setting_wireless_get_mac_address (s_wireless);
+		if (mac && mac->len == ETH_ALEN) {
+			g_string_append (key, ether_ntoa ((struct ether_addr *) mac->data));
+			*out_has_mac = TRUE;
+		}
+
+		/* SSIDs are arbitrary bytes; two that differ must not share a key */
+		g_string_append_c (key, '/');
+		for (i = 0; i < ssid->len; i++)
+			g_string_append_printf (key, "%02x", ssid->data[i]);
+		return g_string_free (key, FALSE);
+	}
+
+	return NULL;
+}
+
+/* Returns the owner @connection conflicts with, if any.  A connection bound
+ * to a device conflicts with any other plugin's connection for the same
+ * device; one that only names a network conflicts only with a connection
+ * describing the same thing.
+ */
+static BindingOwner *
+binding_find_conflict (GSList *owners,
+                       guint plugin,
+                       NMConnection *connection,
+                       gboolean has_mac)
+{
+	GSList *iter;
+
+	for (iter = owners; iter; iter = g_slist_next (iter)) {
+		BindingOwner *owner = iter->data;
+
+		if (owner->plugin == plugin)
+			continue;
+		if (   has_mac
+		    || nm_connection_compare (connection, owner->connection, NM_SETTING_COMPARE_FLAG_FUZZY))
+			return owner;
+	}
+	return NULL;
+}
+
+static void
+binding_owners_free (gpointer data)
+{
+	GSList *owners = data, *iter;
+
+	for (iter = owners; iter; iter = g_slist_next (iter))
+		g_slice_free (BindingOwner, iter->data);
+	g_slist_free (owners);
+}
+
+static char *
+plugin_name (NMSystemConfigInterface *plugin)
+{
+	char *name = NULL;
+
+	g_object_get (G_OBJECT (plugin), NM_SYSTEM_CONFIG_INTERFACE_NAME, &name, NULL);
+	return name;
+}
+
 static void
 load_connections (NMSettings *self)
 {
 	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
-	GSList *iter;
+	GHashTable *uuids, *bindings;
+	GPtrArray *names;
+	GSList *winners = NULL, *iter;
+	guint idx;
 
 	if (priv->connections_loaded)
 		return;
 
-	for (iter = priv->plugins; iter; iter = g_slist_next (iter)) {
+	/* Plugins are listed in priority order.  Index every connection by UUID
+	 * and by the device/network it is bound to; a connection conflicting
+	 * with one from an earlier plugin is rejected, so only one of them gets
+	 * exported.  Connections from the same plugin only conflict by UUID.
+	 * This is only done once: a rejected connection is not exported when
+	 * the one it lost to is removed, and connections that plugins add
+	 * later are not checked.
+	 */
+	uuids = g_hash_table_new (g_str_hash, g_str_equal);
+	bindings = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, binding_owners_free);
+	names = g_ptr_array_new_with_free_func (g_free);
+
+	for (iter = priv->plugins, idx = 0; iter; iter = g_slist_next (iter), idx++) {
 		NMSystemConfigInterface *plugin = NM_SYSTEM_CONFIG_INTERFACE (iter->data);
 		GSList *plugin_connections;
 		GSList *elt;
 
+		g_ptr_array_add (names, plugin_name (plugin));
 		plugin_connections = nm_system_config_interface_get_connections (plugin);
 
-		// FIXME: ensure connections from plugins loaded with a lower priority
-		// get rejected when they conflict with connections from a higher
-		// priority plugin.
+		for (elt = plugin_connections; elt; elt = g_slist_next (elt)) {
+			NMConnection *connection = NM_CONNECTION (elt->data);
+			const char *uuid = nm_connection_get_uuid (connection);
+			char *binding;
+			gboolean has_mac;
+			gpointer owner;
+
+			if (uuid && g_hash_table_lookup_extended (uuids, uuid, NULL, &owner)) {
+				nm_log_warn (LOGD_SETTINGS, "ignoring connection '%s' from plugin %s: "
+				             "UUID %s is already provided by plugin %s",
+				             nm_connection_get_id (connection),
+				             (char *) g_ptr_array_index (names, idx), uuid,
+				             (char *) g_ptr_array_index (names, GPOINTER_TO_UINT (owner)));
+				continue;
+			}
 
-		for (elt = plugin_connections; elt; elt = g_slist_next (elt))
-			claim_connection (self, NM_SETTINGS_CONNECTION (elt->data), TRUE);
+			binding = connection_binding_key (connection, &has_mac);
+			if (binding) {
+				gpointer old_key = NULL, owners = NULL;
+				BindingOwner *conflict, *entry;
+
+				g_hash_table_lookup_extended (bindings, binding, &old_key, &owners);
+
+				conflict = binding_find_conflict (owners, idx, connection, has_mac);
+				if (conflict) {
+					nm_log_warn (LOGD_SETTINGS, "ignoring connection '%s' from plugin %s: "
+					             "plugin %s already provides connection '%s' for the same %s",
+					             nm_connection_get_id (connection),
+					             (char *) g_ptr_array_index (names, idx),
+					             (char *) g_ptr_array_index (names, conflict->plugin),
+					             nm_connection_get_id (conflict->connection),
+					             has_mac ? "device" : "network");
+					g_free (binding);
+					continue;
+				}
+
+				entry = g_slice_new (BindingOwner);
+				entry->plugin = idx;
+				entry->connection = connection;
+
+				/* Take the list out so replacing it doesn't free the owners */
+				if (old_key) {
+					g_hash_table_steal (bindings, old_key);
+					g_free (old_key);
+				}
+				g_hash_table_insert (bindings, binding, g_slist_prepend (owners, entry));
+			}
+
+			if (uuid)
+				g_hash_table_insert (uuids, (gpointer) uuid, GUINT_TO_POINTER (idx));
+			winners = g_slist_prepend (winners, connection);
+		}
 
 		g_slist_free (plugin_connections);
 	}
 
+	g_hash_table_destroy (uuids);
+	g_hash_table_destroy (bindings);
+	g_ptr_array_free (names, TRUE);
+
+	winners = g_slist_reverse (winners);
+	for (iter = winners; iter; iter = g_slist_next (iter))
+		claim_connection (self, NM_SETTINGS_CONNECTION (iter->data), TRUE);
+	g_slist_free (winners);
+
 	priv->connections_loaded = TRUE;
 
 	/* FIXME: Bad hack */
@@ -300,8 +472,17 @@ nm_settings_get_connections (NMSettings *self)
 
 	g_hash_table_iter_init (&iter, NM_SETTINGS_GET_PRIVATE (self)->connections);
 	while (g_hash_table_iter_next (&iter, NULL, &data))
-		list = g_slist_insert_sorted (list, data, connection_sort);
-	return list;
+		list = g_slist_prepend (list, data);
+	return g_slist_sort (list, connection_sort);
+}
+
+/* Sorts a list of NMSettingsConnections into the order returned by
+ * nm_settings_get_connections(); returns the new list head.
+ */
+GSList *
+nm_settings_sort_connections (GSList *connections)
+{
+	return g_slist_sort (connections, connection_sort);
 }
 
 NMSettingsConnection *
@@ -1492,6 +1673,34 @@ nm_settings_device_removed (NMSettings *self, NMDevice *device)
 
 /***************************************************************/
 
+static void
+read_agents_config (NMSettings *self)
+{
+	NMSettingsPrivate *priv = NM_SETTINGS_GET_PRIVATE (self);
+	GKeyFile *config;
+	gboolean parallel;
+	int ttl;
+
+	if (!priv->config_file)
+		return;
+
+	config = g_key_file_new ();
+	if (!config) {
+		nm_log_warn (LOGD_SETTINGS, "not enough memory to load config file.");
+		return;
+	}
+
+	if (g_key_file_load_from_file (config, priv->config_file, G_KEY_FILE_NONE, NULL)) {
+		parallel = g_key_file_get_boolean (config, CONFIG_GROUP_AGENTS, CONFIG_KEY_PARALLEL_REQUESTS, NULL);
+		nm_agent_manager_set_parallel_requests (priv->agent_mgr, parallel);
+
+		ttl = g_key_file_get_integer (config, CONFIG_GROUP_AGENTS, CONFIG_KEY_SECRETS_CACHE_TTL, NULL);
+		nm_settings_connection_set_secrets_cache_ttl (MAX (ttl, 0));
+	}
+
+	g_key_file_free (config);
+}
+
 NMSettings *
 nm_settings_new (const char *config_file,
                  const char *plugins,
@@ -1511,6 +1720,8 @@ nm_settings_new (const char *config_file,
 	priv->dbus_mgr = nm_dbus_manager_get ();
 	priv->bus = nm_dbus_manager_get_connection (priv->dbus_mgr);
 
+	read_agents_config (self);
+
 	if (plugins) {
 		/* Load the plugins; fail if a plugin is not found. */
 		if (!load_plugins (self, plugins, error)) {
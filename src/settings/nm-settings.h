@@ -105,6 +105,8 @@ void nm_settings_add_connection (NMSettings *self,
  */
 GSList *nm_settings_get_connections (NMSettings *settings);
 
+GSList *nm_settings_sort_connections (GSList *connections);
+
 NMSettingsConnection *nm_settings_get_connection_by_path (NMSettings *settings,
                                                           const char *path);
 
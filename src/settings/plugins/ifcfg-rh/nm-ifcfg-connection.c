@@ -38,7 +38,9 @@
 #include "nm-ifcfg-connection.h"
 #include "reader.h"
 #include "writer.h"
+#include "utils.h"
 #include "nm-inotify-helper.h"
+#include "nm-settings-write-queue.h"
 
 G_DEFINE_TYPE (NMIfcfgConnection, nm_ifcfg_connection, NM_TYPE_SETTINGS_CONNECTION)
 
@@ -60,6 +62,9 @@ typedef struct {
 	int route6file_wd;
 
 	char *unmanaged;
+
+	/* The connection as last read from or written to disk */
+	NMConnection *on_disk;
 } NMIfcfgConnectionPrivate;
 
 enum {
@@ -84,11 +89,21 @@ files_changed_cb (NMInotifyHelper *ih,
 {
 	NMIfcfgConnection *self = NM_IFCFG_CONNECTION (user_data);
 	NMIfcfgConnectionPrivate *priv = NM_IFCFG_CONNECTION_GET_PRIVATE (self);
+	const char *changed;
+
+	if (evt->wd == priv->file_wd)
+		changed = priv->path;
+	else if (evt->wd == priv->keyfile_wd)
+		changed = priv->keyfile;
+	else if (evt->wd == priv->routefile_wd)
+		changed = priv->routefile;
+	else if (evt->wd == priv->route6file_wd)
+		changed = priv->route6file;
+	else
+		return;
 
-	if (   (evt->wd != priv->file_wd)
-	    && (evt->wd != priv->keyfile_wd)
-	    && (evt->wd != priv->routefile_wd)
-	    && (evt->wd != priv->route6file_wd))
+	/* Ignore the notification for our own write */
+	if (changed && nm_settings_write_queue_is_own_write (nm_settings_write_queue_get (), changed))
 		return;
 
 	/* push the event up to the plugin */
@@ -142,6 +157,7 @@ nm_ifcfg_connection_new (const char *full_path,
 
 	priv = NM_IFCFG_CONNECTION_GET_PRIVATE (object);
 	priv->path = g_strdup (full_path);
+	priv->on_disk = nm_connection_duplicate (tmp);
 
 	ih = nm_inotify_helper_get ();
 	priv->ih_event_id = g_signal_connect (ih, "event", G_CALLBACK (files_changed_cb), object);
@@ -178,56 +194,87 @@ nm_ifcfg_connection_get_unmanaged_spec (NMIfcfgConnection *self)
 	return NM_IFCFG_CONNECTION_GET_PRIVATE (self)->unmanaged;
 }
 
+void
+nm_ifcfg_connection_set_on_disk (NMIfcfgConnection *self, NMConnection *on_disk)
+{
+	NMIfcfgConnectionPrivate *priv;
+
+	g_return_if_fail (NM_IS_IFCFG_CONNECTION (self));
+	g_return_if_fail (NM_IS_CONNECTION (on_disk));
+
+	priv = NM_IFCFG_CONNECTION_GET_PRIVATE (self);
+	if (priv->on_disk)
+		g_object_unref (priv->on_disk);
+	priv->on_disk = nm_connection_duplicate (on_disk);
+}
+
 static void
-commit_changes (NMSettingsConnection *connection,
-                NMSettingsConnectionCommitFunc callback,
-                gpointer user_data)
+add_written (const char *path)
+{
+	NMSettingsWriteQueue *queue = nm_settings_write_queue_get ();
+
+	if (path && g_file_test (path, G_FILE_TEST_EXISTS))
+		nm_settings_write_queue_add_written (queue, path);
+}
+
+static gboolean
+write_connection (NMSettingsConnection *connection, GError **error)
 {
 	NMIfcfgConnectionPrivate *priv = NM_IFCFG_CONNECTION_GET_PRIVATE (connection);
-	GError *error = NULL;
-	NMConnection *reread;
-	char *unmanaged = NULL, *keyfile = NULL, *routefile = NULL, *route6file = NULL;
-	gboolean same = FALSE;
-
-	/* To ensure we don't rewrite files that are only changed from other
-	 * processes on-disk, read the existing connection back in and only rewrite
-	 * it if it's really changed.
+	char *extra;
+
+	/* Compare against what we last read or wrote instead of reading the
+	 * files back in; external edits are picked up through inotify and update
+	 * the snapshot.  Nothing is written if only unsaved secrets changed.
 	 */
-	reread = connection_from_file (priv->path, NULL, NULL, NULL,
-	                               &unmanaged, &keyfile, &routefile, &route6file,
-	                               NULL, NULL);
-	g_free (unmanaged);
-	g_free (keyfile);
-	g_free (routefile);
-	g_free (route6file);
-
-	if (reread) {
-		same = nm_connection_compare (NM_CONNECTION (connection),
-		                              reread,
-		                              NM_SETTING_COMPARE_FLAG_IGNORE_AGENT_OWNED_SECRETS |
-		                                NM_SETTING_COMPARE_FLAG_IGNORE_NOT_SAVED_SECRETS);
-		g_object_unref (reread);
-
-		/* Don't bother writing anything out if in-memory and on-disk data are the same */
-		if (same) {
-			/* But chain up to parent to handle success - emits updated signal */
-			NM_SETTINGS_CONNECTION_CLASS (nm_ifcfg_connection_parent_class)->commit_changes (connection, callback, user_data);
-			return;
-		}
-	}
+	if (!nm_settings_write_queue_needs_write (NM_CONNECTION (connection), priv->on_disk))
+		return TRUE;
 
-	if (writer_update_connection (NM_CONNECTION (connection),
-	                              IFCFG_DIR,
-	                              priv->path,
-	                              priv->keyfile,
-	                              &error)) {
-		/* Chain up to parent to handle success */
-		NM_SETTINGS_CONNECTION_CLASS (nm_ifcfg_connection_parent_class)->commit_changes (connection, callback, user_data);
-	} else {
-		/* Otherwise immediate error */
-		callback (connection, error, user_data);
-		g_error_free (error);
-	}
+	if (!writer_update_connection (NM_CONNECTION (connection),
+	                               IFCFG_DIR,
+	                               priv->path,
+	                               priv->keyfile,
+	                               error))
+		return FALSE;
+
+	add_written (priv->path);
+
+	extra = utils_get_keys_path (priv->path);
+	add_written (extra);
+	g_free (extra);
+
+	extra = utils_get_route_path (priv->path);
+	add_written (extra);
+	g_free (extra);
+
+	extra = utils_get_route6_path (priv->path);
+	add_written (extra);
+	g_free (extra);
+
+	nm_ifcfg_connection_set_on_disk (NM_IFCFG_CONNECTION (connection), NM_CONNECTION (connection));
+	return TRUE;
+}
+
+static void
+chain_commit_changes (NMSettingsConnection *connection,
+                      NMSettingsConnectionCommitFunc callback,
+                      gpointer user_data)
+{
+	/* Chain up to parent to handle success - emits updated signal */
+	NM_SETTINGS_CONNECTION_CLASS (nm_ifcfg_connection_parent_class)->commit_changes (connection, callback, user_data);
+}
+
+static void
+commit_changes (NMSettingsConnection *connection,
+                NMSettingsConnectionCommitFunc callback,
+                gpointer user_data)
+{
+	nm_settings_write_queue_commit (nm_settings_write_queue_get (),
+	                                connection,
+	                                write_connection,
+	                                chain_commit_changes,
+	                                callback,
+	                                user_data);
 }
 
 static void
@@ -237,6 +284,8 @@ do_delete (NMSettingsConnection *connection,
 {
 	NMIfcfgConnectionPrivate *priv = NM_IFCFG_CONNECTION_GET_PRIVATE (connection);
 
+	nm_settings_write_queue_cancel (nm_settings_write_queue_get (), connection);
+
 	g_unlink (priv->path);
 	if (priv->keyfile)
 		g_unlink (priv->keyfile);
@@ -285,6 +334,9 @@ finalize (GObject *object)
 	if (priv->route6file_wd >= 0)
 		nm_inotify_helper_remove_watch (ih, priv->route6file_wd);
 
+	if (priv->on_disk)
+		g_object_unref (priv->on_disk);
+
 	G_OBJECT_CLASS (nm_ifcfg_connection_parent_class)->finalize (object);
 }
 
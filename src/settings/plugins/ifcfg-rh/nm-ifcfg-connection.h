@@ -54,6 +54,8 @@ const char *nm_ifcfg_connection_get_path (NMIfcfgConnection *self);
 
 const char *nm_ifcfg_connection_get_unmanaged_spec (NMIfcfgConnection *self);
 
+void nm_ifcfg_connection_set_on_disk (NMIfcfgConnection *self, NMConnection *on_disk);
+
 gboolean nm_ifcfg_connection_update (NMIfcfgConnection *self,
                                      GHashTable *new_settings,
                                      GError **error);
@@ -44,6 +44,8 @@
 #include "plugin.h"
 #include "nm-system-config-interface.h"
 #include "nm-settings-error.h"
+#include "nm-settings-write-queue.h"
+#include "nm-settings-change-queue.h"
 
 #include "nm-ifcfg-connection.h"
 #include "nm-inotify-helper.h"
@@ -66,6 +68,8 @@ static void connection_new_or_changed (SCPluginIfcfg *plugin,
                                        const char *path,
                                        NMIfcfgConnection *existing);
 
+static gboolean contents_changed (SCPluginIfcfg *self, const char *path);
+
 static void system_config_interface_init (NMSystemConfigInterface *system_config_interface_class);
 
 G_DEFINE_TYPE_EXTENDED (SCPluginIfcfg, sc_plugin_ifcfg, G_TYPE_OBJECT, 0,
@@ -76,7 +80,8 @@ G_DEFINE_TYPE_EXTENDED (SCPluginIfcfg, sc_plugin_ifcfg, G_TYPE_OBJECT, 0,
 
 
 typedef struct {
-	GHashTable *connections;
+	GHashTable *connections;  /* ifcfg path -> NMIfcfgConnection */
+	NMSettingsChangeQueue *changes;
 
 	gulong ih_event_id;
 	int sc_network_wd;
@@ -106,7 +111,7 @@ connection_ifcfg_changed (NMIfcfgConnection *connection, gpointer user_data)
 	path = nm_ifcfg_connection_get_path (connection);
 	g_return_if_fail (path != NULL);
 
-	connection_new_or_changed (plugin, path, connection);
+	nm_settings_change_queue_add (SC_PLUGIN_IFCFG_GET_PRIVATE (plugin)->changes, path);
 }
 
 static NMIfcfgConnection *
@@ -178,8 +183,9 @@ read_connections (SCPluginIfcfg *plugin)
 				continue;
 
 			full_path = g_build_filename (IFCFG_DIR, item, NULL);
-			if (utils_get_ifcfg_name (full_path, TRUE))
-				_internal_new_connection (plugin, full_path, NULL, NULL);
+			if (   utils_get_ifcfg_name (full_path, TRUE)
+			    && _internal_new_connection (plugin, full_path, NULL, NULL))
+				contents_changed (plugin, full_path);
 			g_free (full_path);
 		}
 
@@ -192,6 +198,36 @@ read_connections (SCPluginIfcfg *plugin)
 
 /* Monitoring */
 
+/* Checks whether any of the files making up the connection at 'path'
+ * changed since they were last looked at.
+ */
+static gboolean
+contents_changed (SCPluginIfcfg *self, const char *path)
+{
+	SCPluginIfcfgPrivate *priv = SC_PLUGIN_IFCFG_GET_PRIVATE (self);
+	char *extra[3];
+	const char *files[5];
+	gboolean changed;
+	guint i, n = 0;
+
+	extra[0] = utils_get_keys_path (path);
+	extra[1] = utils_get_route_path (path);
+	extra[2] = utils_get_route6_path (path);
+
+	files[n++] = path;
+	for (i = 0; i < G_N_ELEMENTS (extra); i++) {
+		if (extra[i])
+			files[n++] = extra[i];
+	}
+	files[n] = NULL;
+
+	changed = nm_settings_change_queue_contents_changed (priv->changes, path, files);
+
+	for (i = 0; i < G_N_ELEMENTS (extra); i++)
+		g_free (extra[i]);
+	return changed;
+}
+
 /* Callback for nm_settings_connection_replace_and_commit. Report any errors
  * encountered when commiting connection settings updates. */
 static void
@@ -313,6 +349,8 @@ connection_new_or_changed (SCPluginIfcfg *self,
 			g_signal_emit_by_name (self, NM_SYSTEM_CONFIG_INTERFACE_CONNECTION_ADDED, existing);
 		}
 
+		/* The files already hold these settings; the commit has nothing to write */
+		nm_ifcfg_connection_set_on_disk (existing, NM_CONNECTION (new));
 		nm_settings_connection_replace_and_commit (NM_SETTINGS_CONNECTION (existing),
 		                                           NM_CONNECTION (new),
 		                                           commit_cb, NULL);
@@ -324,6 +362,33 @@ connection_new_or_changed (SCPluginIfcfg *self,
 	g_object_unref (new);
 }
 
+/* Called by the change queue once events for 'name' have settled */
+static void
+path_changed (const char *name, gboolean exists, gpointer user_data)
+{
+	SCPluginIfcfg *plugin = SC_PLUGIN_IFCFG (user_data);
+	SCPluginIfcfgPrivate *priv = SC_PLUGIN_IFCFG_GET_PRIVATE (plugin);
+	NMIfcfgConnection *connection;
+
+	connection = g_hash_table_lookup (priv->connections, name);
+
+	if (!exists) {
+		nm_settings_change_queue_forget (priv->changes, name);
+		if (connection) {
+			PLUGIN_PRINT (IFCFG_PLUGIN_NAME, "removed %s.", name);
+			remove_connection (plugin, connection);
+		}
+		return;
+	}
+
+	/* Don't reparse if none of the connection's files changed */
+	if (!contents_changed (plugin, name) && connection)
+		return;
+
+	/* Update or new */
+	connection_new_or_changed (plugin, name, connection);
+}
+
 static void
 dir_changed (GFileMonitor *monitor,
 		   GFile *file,
@@ -334,7 +399,15 @@ dir_changed (GFileMonitor *monitor,
 	SCPluginIfcfg *plugin = SC_PLUGIN_IFCFG (user_data);
 	SCPluginIfcfgPrivate *priv = SC_PLUGIN_IFCFG_GET_PRIVATE (plugin);
 	char *path, *name;
-	NMIfcfgConnection *connection;
+
+	switch (event_type) {
+	case G_FILE_MONITOR_EVENT_DELETED:
+	case G_FILE_MONITOR_EVENT_CREATED:
+	case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
+		break;
+	default:
+		return;
+	}
 
 	path = g_file_get_path (file);
 	if (utils_should_ignore_file (path, FALSE)) {
@@ -344,25 +417,18 @@ dir_changed (GFileMonitor *monitor,
 
 	/* Given any ifcfg, keys, or routes file, get the ifcfg file path */
 	name = utils_get_ifcfg_path (path);
-	g_free (path);
 	if (name) {
-		connection = g_hash_table_lookup (priv->connections, name);
-		switch (event_type) {
-		case G_FILE_MONITOR_EVENT_DELETED:
-			PLUGIN_PRINT (IFCFG_PLUGIN_NAME, "removed %s.", name);
-			if (connection)
-				remove_connection (plugin, connection);
-			break;
-		case G_FILE_MONITOR_EVENT_CREATED:
-		case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
-			/* Update or new */
-			connection_new_or_changed (plugin, name, connection);
-			break;
-		default:
-			break;
-		}
+		/* Nothing to re-read if the file is still exactly as we wrote it,
+		 * but the recorded contents are stale now.
+		 */
+		if (   event_type != G_FILE_MONITOR_EVENT_DELETED
+		    && nm_settings_write_queue_is_own_write (nm_settings_write_queue_get (), path))
+			nm_settings_change_queue_forget (priv->changes, name);
+		else
+			nm_settings_change_queue_add (priv->changes, name);
 		g_free (name);
 	}
+	g_free (path);
 }
 
 static void
@@ -373,6 +439,7 @@ setup_ifcfg_monitoring (SCPluginIfcfg *plugin)
 	GFileMonitor *monitor;
 
 	priv->connections = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
+	priv->changes = nm_settings_change_queue_new (path_changed, plugin);
 
 	file = g_file_new_for_path (IFCFG_DIR "/");
 	monitor = g_file_monitor_directory (file, G_FILE_MONITOR_NONE, NULL, NULL);
@@ -457,6 +524,7 @@ add_connection (NMSystemConfigInterface *config,
 
 	/* Write it out first, then add the connection to our internal list */
 	if (writer_new_connection (connection, IFCFG_DIR, &path, error)) {
+		nm_settings_write_queue_add_written (nm_settings_write_queue_get (), path);
 		added = _internal_new_connection (self, path, connection, error);
 		g_free (path);
 	}
@@ -683,6 +751,11 @@ dispose (GObject *object)
 
 	g_free (priv->hostname);
 
+	if (priv->changes) {
+		nm_settings_change_queue_free (priv->changes);
+		priv->changes = NULL;
+	}
+
 	if (priv->connections)
 		g_hash_table_destroy (priv->connections);
 
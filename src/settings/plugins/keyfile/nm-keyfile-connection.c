@@ -28,6 +28,7 @@
 #include "nm-system-config-interface.h"
 #include "nm-dbus-glib-types.h"
 #include "nm-keyfile-connection.h"
+#include "nm-settings-write-queue.h"
 #include "reader.h"
 #include "writer.h"
 #include "common.h"
@@ -38,6 +39,9 @@ G_DEFINE_TYPE (NMKeyfileConnection, nm_keyfile_connection, NM_TYPE_SETTINGS_CONN
 
 typedef struct {
 	char *path;
+
+	/* The connection as last read from or written to 'path' */
+	NMConnection *on_disk;
 } NMKeyfileConnectionPrivate;
 
 NMKeyfileConnection *
@@ -81,8 +85,11 @@ nm_keyfile_connection_new (const char *full_path,
 		             "Connection in file %s had no UUID", full_path);
 		g_object_unref (object);
 		object = NULL;
+		goto out;
 	}
 
+	priv->on_disk = nm_connection_duplicate (tmp);
+
 out:
 	g_object_unref (tmp);
 	return (NMKeyfileConnection *) object;
@@ -96,23 +103,52 @@ nm_keyfile_connection_get_path (NMKeyfileConnection *self)
 	return NM_KEYFILE_CONNECTION_GET_PRIVATE (self)->path;
 }
 
-static void
-commit_changes (NMSettingsConnection *connection,
-                NMSettingsConnectionCommitFunc callback,
-                gpointer user_data)
+/**
+ * nm_keyfile_connection_set_on_disk:
+ * @self: the #NMKeyfileConnection
+ * @path: the file @on_disk was read from
+ * @on_disk: the connection as just read back from the keyfile
+ *
+ * Tells @self what is on disk after an external change or rename, so the
+ * commit following the update doesn't write the same data back.
+ **/
+void
+nm_keyfile_connection_set_on_disk (NMKeyfileConnection *self,
+                                   const char *path,
+                                   NMConnection *on_disk)
+{
+	NMKeyfileConnectionPrivate *priv;
+
+	g_return_if_fail (NM_IS_KEYFILE_CONNECTION (self));
+	g_return_if_fail (path != NULL);
+	g_return_if_fail (NM_IS_CONNECTION (on_disk));
+
+	priv = NM_KEYFILE_CONNECTION_GET_PRIVATE (self);
+	if (g_strcmp0 (priv->path, path)) {
+		g_free (priv->path);
+		priv->path = g_strdup (path);
+	}
+
+	if (priv->on_disk)
+		g_object_unref (priv->on_disk);
+	priv->on_disk = nm_connection_duplicate (on_disk);
+}
+
+static gboolean
+write_connection (NMSettingsConnection *connection, GError **error)
 {
 	NMKeyfileConnectionPrivate *priv = NM_KEYFILE_CONNECTION_GET_PRIVATE (connection);
 	char *path = NULL;
-	GError *error = NULL;
+
+	/* Don't rewrite the file for changes that never hit the disk */
+	if (!nm_settings_write_queue_needs_write (NM_CONNECTION (connection), priv->on_disk))
+		return TRUE;
 
 	if (!nm_keyfile_plugin_write_connection (NM_CONNECTION (connection),
 	                                         priv->path,
 	                                         &path,
-	                                         &error)) {
-		callback (connection, error, user_data);
-		g_clear_error (&error);
-		return;
-	}
+	                                         error))
+		return FALSE;
 
 	/* Update the filename if it changed */
 	if (path) {
@@ -120,11 +156,37 @@ commit_changes (NMSettingsConnection *connection,
 		priv->path = path;
 	}
 
+	nm_settings_write_queue_add_written (nm_settings_write_queue_get (), priv->path);
+
+	if (priv->on_disk)
+		g_object_unref (priv->on_disk);
+	priv->on_disk = nm_connection_duplicate (NM_CONNECTION (connection));
+	return TRUE;
+}
+
+static void
+chain_commit_changes (NMSettingsConnection *connection,
+                      NMSettingsConnectionCommitFunc callback,
+                      gpointer user_data)
+{
 	NM_SETTINGS_CONNECTION_CLASS (nm_keyfile_connection_parent_class)->commit_changes (connection,
 	                                                                                   callback,
 	                                                                                   user_data);
 }
 
+static void
+commit_changes (NMSettingsConnection *connection,
+                NMSettingsConnectionCommitFunc callback,
+                gpointer user_data)
+{
+	nm_settings_write_queue_commit (nm_settings_write_queue_get (),
+	                                connection,
+	                                write_connection,
+	                                chain_commit_changes,
+	                                callback,
+	                                user_data);
+}
+
 static void 
 do_delete (NMSettingsConnection *connection,
            NMSettingsConnectionDeleteFunc callback,
@@ -132,6 +194,7 @@ do_delete (NMSettingsConnection *connection,
 {
 	NMKeyfileConnectionPrivate *priv = NM_KEYFILE_CONNECTION_GET_PRIVATE (connection);
 
+	nm_settings_write_queue_cancel (nm_settings_write_queue_get (), connection);
 	g_unlink (priv->path);
 
 	NM_SETTINGS_CONNECTION_CLASS (nm_keyfile_connection_parent_class)->delete (connection,
@@ -154,6 +217,8 @@ finalize (GObject *object)
 	nm_connection_clear_secrets (NM_CONNECTION (object));
 
 	g_free (priv->path);
+	if (priv->on_disk)
+		g_object_unref (priv->on_disk);
 
 	G_OBJECT_CLASS (nm_keyfile_connection_parent_class)->finalize (object);
 }
@@ -49,6 +49,10 @@ NMKeyfileConnection *nm_keyfile_connection_new (const char *filename,
 
 const char *nm_keyfile_connection_get_path (NMKeyfileConnection *self);
 
+void nm_keyfile_connection_set_on_disk (NMKeyfileConnection *self,
+                                        const char *path,
+                                        NMConnection *on_disk);
+
 G_END_DECLS
 
 #endif /* NM_KEYFILE_CONNECTION_H */
@@ -38,6 +38,8 @@
 #include "plugin.h"
 #include "nm-system-config-interface.h"
 #include "nm-keyfile-connection.h"
+#include "nm-settings-write-queue.h"
+#include "nm-settings-change-queue.h"
 #include "writer.h"
 #include "common.h"
 #include "utils.h"
@@ -55,10 +57,12 @@ G_DEFINE_TYPE_EXTENDED (SCPluginKeyfile, sc_plugin_keyfile, G_TYPE_OBJECT, 0,
 #define SC_PLUGIN_KEYFILE_GET_PRIVATE(o) (G_TYPE_INSTANCE_GET_PRIVATE ((o), SC_TYPE_PLUGIN_KEYFILE, SCPluginKeyfilePrivate))
 
 typedef struct {
-	GHashTable *hash;
+	GHashTable *hash;   /* path -> NMKeyfileConnection */
+	GHashTable *uuids;  /* UUID -> NMKeyfileConnection */
 
 	GFileMonitor *monitor;
 	guint monitor_id;
+	NMSettingsChangeQueue *changes;
 
 	const char *conf_file;
 	GFileMonitor *conf_file_monitor;
@@ -69,6 +73,26 @@ typedef struct {
 	gboolean disposed;
 } SCPluginKeyfilePrivate;
 
+static void
+index_connection (SCPluginKeyfile *self, NMKeyfileConnection *connection)
+{
+	SCPluginKeyfilePrivate *priv = SC_PLUGIN_KEYFILE_GET_PRIVATE (self);
+	const char *uuid = nm_connection_get_uuid (NM_CONNECTION (connection));
+
+	if (uuid)
+		g_hash_table_insert (priv->uuids, g_strdup (uuid), connection);
+}
+
+static void
+unindex_connection (SCPluginKeyfile *self, NMKeyfileConnection *connection)
+{
+	SCPluginKeyfilePrivate *priv = SC_PLUGIN_KEYFILE_GET_PRIVATE (self);
+	const char *uuid = nm_connection_get_uuid (NM_CONNECTION (connection));
+
+	if (uuid && g_hash_table_lookup (priv->uuids, uuid) == connection)
+		g_hash_table_remove (priv->uuids, uuid);
+}
+
 static NMSettingsConnection *
 _internal_new_connection (SCPluginKeyfile *self,
                           const char *full_path,
@@ -85,6 +109,7 @@ _internal_new_connection (SCPluginKeyfile *self,
 		g_hash_table_insert (priv->hash,
 		                     (gpointer) nm_keyfile_connection_get_path (connection),
 		                     connection);
+		index_connection (self, connection);
 	}
 
 	return (NMSettingsConnection *) connection;
@@ -122,6 +147,9 @@ read_connections (NMSystemConfigInterface *config)
 		if (connection) {
 			PLUGIN_PRINT (KEYFILE_PLUGIN_NAME, "    read connection '%s'",
 			              nm_connection_get_id (NM_CONNECTION (connection)));
+			/* Remember the contents so touching the file doesn't cause a reparse */
+			nm_settings_change_queue_contents_changed (SC_PLUGIN_KEYFILE_GET_PRIVATE (self)->changes,
+			                                           full_path, NULL);
 		} else {
 			PLUGIN_PRINT (KEYFILE_PLUGIN_NAME, "    error: %s",
 				          (error && error->message) ? error->message : "(unknown)");
@@ -168,6 +196,7 @@ remove_connection (SCPluginKeyfile *self,
 
 	/* Removing from the hash table should drop the last reference */
 	g_object_ref (connection);
+	unindex_connection (self, connection);
 	g_hash_table_remove (SC_PLUGIN_KEYFILE_GET_PRIVATE (self)->hash, name);
 	nm_settings_connection_signal_remove (NM_SETTINGS_CONNECTION (connection));
 	g_object_unref (connection);
@@ -177,125 +206,152 @@ static NMKeyfileConnection *
 find_by_uuid (SCPluginKeyfile *self, const char *uuid)
 {
 	SCPluginKeyfilePrivate *priv = SC_PLUGIN_KEYFILE_GET_PRIVATE (self);
-	GHashTableIter iter;
-	gpointer data = NULL;
+	NMKeyfileConnection *found;
 
 	g_return_val_if_fail (uuid != NULL, NULL);
 
-	g_hash_table_iter_init (&iter, priv->hash);
-	while (g_hash_table_iter_next (&iter, NULL, &data)) {
-		NMConnection *candidate = NM_CONNECTION (data);
-
-		if (strcmp (uuid, nm_connection_get_uuid (candidate)) == 0)
-			return NM_KEYFILE_CONNECTION (candidate);
-	}
-	return NULL;
+	found = g_hash_table_lookup (priv->uuids, uuid);
+	if (found && g_strcmp0 (uuid, nm_connection_get_uuid (NM_CONNECTION (found))))
+		return NULL;
+	return found;
 }
 
+/* Called by the change queue once events for 'full_path' have settled */
 static void
-dir_changed (GFileMonitor *monitor,
-             GFile *file,
-             GFile *other_file,
-             GFileMonitorEvent event_type,
-             gpointer user_data)
+path_changed (const char *full_path, gboolean exists, gpointer user_data)
 {
 	NMSystemConfigInterface *config = NM_SYSTEM_CONFIG_INTERFACE (user_data);
 	SCPluginKeyfile *self = SC_PLUGIN_KEYFILE (config);
 	SCPluginKeyfilePrivate *priv = SC_PLUGIN_KEYFILE_GET_PRIVATE (self);
-	char *full_path;
 	NMKeyfileConnection *connection;
 	GError *error = NULL;
 
-	full_path = g_file_get_path (file);
-	if (nm_keyfile_plugin_utils_should_ignore_file (full_path)) {
-		g_free (full_path);
-		return;
-	}
-
 	connection = g_hash_table_lookup (priv->hash, full_path);
 
-	switch (event_type) {
-	case G_FILE_MONITOR_EVENT_DELETED:
+	if (!exists) {
+		nm_settings_change_queue_forget (priv->changes, full_path);
 		if (connection) {
 			PLUGIN_PRINT (KEYFILE_PLUGIN_NAME, "removed %s.", full_path);
-			remove_connection (SC_PLUGIN_KEYFILE (config), connection, full_path);
+			remove_connection (self, connection, full_path);
 		}
-		break;
-	case G_FILE_MONITOR_EVENT_CREATED:
-	case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
-		if (connection) {
-			/* Update */
-			NMKeyfileConnection *tmp;
-
-			tmp = nm_keyfile_connection_new (full_path, NULL, &error);
-			if (tmp) {
-				if (!nm_connection_compare (NM_CONNECTION (connection),
-				                            NM_CONNECTION (tmp),
-				                            NM_SETTING_COMPARE_FLAG_IGNORE_AGENT_OWNED_SECRETS |
-				                              NM_SETTING_COMPARE_FLAG_IGNORE_NOT_SAVED_SECRETS)) {
-					PLUGIN_PRINT (KEYFILE_PLUGIN_NAME, "updating %s", full_path);
-					update_connection_settings (connection, tmp);
-				}
-				g_object_unref (tmp);
-			} else {
-				/* Error; remove the connection */
-				PLUGIN_PRINT (KEYFILE_PLUGIN_NAME, "    error: %s",
-						      (error && error->message) ? error->message : "(unknown)");
-				g_clear_error (&error);
-				remove_connection (SC_PLUGIN_KEYFILE (config), connection, full_path);
+		return;
+	}
+
+	/* Don't reparse files whose contents are the same as last time */
+	if (   !nm_settings_change_queue_contents_changed (priv->changes, full_path, NULL)
+	    && connection)
+		return;
+
+	if (connection) {
+		/* Update */
+		NMKeyfileConnection *tmp;
+
+		tmp = nm_keyfile_connection_new (full_path, NULL, &error);
+		if (tmp) {
+			if (!nm_connection_compare (NM_CONNECTION (connection),
+			                            NM_CONNECTION (tmp),
+			                            NM_SETTING_COMPARE_FLAG_IGNORE_AGENT_OWNED_SECRETS |
+			                              NM_SETTING_COMPARE_FLAG_IGNORE_NOT_SAVED_SECRETS)) {
+				PLUGIN_PRINT (KEYFILE_PLUGIN_NAME, "updating %s", full_path);
+				unindex_connection (self, connection);
+				nm_keyfile_connection_set_on_disk (connection, full_path, NM_CONNECTION (tmp));
+				update_connection_settings (connection, tmp);
+				index_connection (self, connection);
 			}
+			g_object_unref (tmp);
 		} else {
-			PLUGIN_PRINT (KEYFILE_PLUGIN_NAME, "updating %s", full_path);
+			/* Error; remove the connection */
+			PLUGIN_PRINT (KEYFILE_PLUGIN_NAME, "    error: %s",
+					      (error && error->message) ? error->message : "(unknown)");
+			g_clear_error (&error);
+			remove_connection (self, connection, full_path);
+		}
+	} else {
+		PLUGIN_PRINT (KEYFILE_PLUGIN_NAME, "updating %s", full_path);
 
-			/* New */
-			connection = nm_keyfile_connection_new (full_path, NULL, &error);
-			if (connection) {
-				NMKeyfileConnection *found = NULL;
+		/* New */
+		connection = nm_keyfile_connection_new (full_path, NULL, &error);
+		if (connection) {
+			NMKeyfileConnection *found = NULL;
+
+			/* Connection renames will show up as different files but with
+			 * the same UUID.  Try to find the original connection.
+			 * A connection rename is treated just like an update except
+			 * there's a bit more housekeeping with the hash table.
+			 */
+			found = find_by_uuid (self, nm_connection_get_uuid (NM_CONNECTION (connection)));
+			if (found) {
+				const char *old_path = nm_keyfile_connection_get_path (found);
+
+				/* Removing from the hash table should drop the last reference,
+				 * but of course we want to keep the connection around.
+				 */
+				g_object_ref (found);
+				nm_settings_change_queue_forget (priv->changes, old_path);
+				g_hash_table_remove (priv->hash, old_path);
 
-				/* Connection renames will show up as different files but with
-				 * the same UUID.  Try to find the original connection.
-				 * A connection rename is treated just like an update except
-				 * there's a bit more housekeeping with the hash table.
+				/* Point the connection at its new file; the update then
+				 * has nothing left to write.
 				 */
-				found = find_by_uuid (self, nm_connection_get_uuid (NM_CONNECTION (connection)));
-				if (found) {
-					const char *old_path = nm_keyfile_connection_get_path (connection);
-
-					/* Removing from the hash table should drop the last reference,
-					 * but of course we want to keep the connection around.
-					 */
-					g_object_ref (found);
-					g_hash_table_remove (priv->hash, old_path);
-
-					/* Updating settings should update the NMKeyfileConnection's
-					 * filename property too.
-					 */
-					update_connection_settings (found, connection);
-
-					/* Re-insert the connection back into the hash with the new filename */
-					g_hash_table_insert (priv->hash,
-					                     (gpointer) nm_keyfile_connection_get_path (found),
-					                     found);
-
-					/* Get rid of the temporary connection */
-					g_object_unref (connection);
-				} else {
-					g_hash_table_insert (priv->hash,
-					                     (gpointer) nm_keyfile_connection_get_path (connection),
-					                     connection);
-					g_signal_emit_by_name (config, NM_SYSTEM_CONFIG_INTERFACE_CONNECTION_ADDED, connection);
-				}
+				nm_keyfile_connection_set_on_disk (found, full_path, NM_CONNECTION (connection));
+				update_connection_settings (found, connection);
+
+				/* Re-insert the connection back into the hash with the new filename */
+				g_hash_table_insert (priv->hash,
+				                     (gpointer) nm_keyfile_connection_get_path (found),
+				                     found);
+
+				/* Get rid of the temporary connection */
+				g_object_unref (connection);
 			} else {
-				PLUGIN_PRINT (KEYFILE_PLUGIN_NAME, "    error: %s",
-						      (error && error->message) ? error->message : "(unknown)");
-				g_clear_error (&error);
+				g_hash_table_insert (priv->hash,
+				                     (gpointer) nm_keyfile_connection_get_path (connection),
+				                     connection);
+				index_connection (self, connection);
+				g_signal_emit_by_name (config, NM_SYSTEM_CONFIG_INTERFACE_CONNECTION_ADDED, connection);
 			}
+		} else {
+			PLUGIN_PRINT (KEYFILE_PLUGIN_NAME, "    error: %s",
+					      (error && error->message) ? error->message : "(unknown)");
+			g_clear_error (&error);
 		}
+	}
+}
+
+static void
+dir_changed (GFileMonitor *monitor,
+             GFile *file,
+             GFile *other_file,
+             GFileMonitorEvent event_type,
+             gpointer user_data)
+{
+	SCPluginKeyfilePrivate *priv = SC_PLUGIN_KEYFILE_GET_PRIVATE (user_data);
+	char *full_path;
+
+	switch (event_type) {
+	case G_FILE_MONITOR_EVENT_DELETED:
+	case G_FILE_MONITOR_EVENT_CREATED:
+	case G_FILE_MONITOR_EVENT_CHANGES_DONE_HINT:
 		break;
 	default:
-		break;
+		return;
 	}
 
+	full_path = g_file_get_path (file);
+	if (nm_keyfile_plugin_utils_should_ignore_file (full_path)) {
+		g_free (full_path);
+		return;
+	}
+
+	/* Nothing to re-read if the file is still exactly as we wrote it, but
+	 * its recorded contents are stale now.
+	 */
+	if (   event_type != G_FILE_MONITOR_EVENT_DELETED
+	    && nm_settings_write_queue_is_own_write (nm_settings_write_queue_get (), full_path))
+		nm_settings_change_queue_forget (priv->changes, full_path);
+	else
+		nm_settings_change_queue_add (priv->changes, full_path);
+
 	g_free (full_path);
 }
 
@@ -344,6 +400,8 @@ setup_monitoring (NMSystemConfigInterface *config)
 	GFileMonitor *monitor;
 
 	priv->hash = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, g_object_unref);
+	priv->uuids = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+	priv->changes = nm_settings_change_queue_new (path_changed, config);
 
 	file = g_file_new_for_path (KEYFILE_DIR);
 	monitor = g_file_monitor_directory (file, G_FILE_MONITOR_NONE, NULL, NULL);
@@ -396,6 +454,7 @@ add_connection (NMSystemConfigInterface *config,
 
 	/* Write it out first, then add the connection to our internal list */
 	if (nm_keyfile_plugin_write_connection (connection, NULL, &path, error)) {
+		nm_settings_write_queue_add_written (nm_settings_write_queue_get (), path);
 		added = _internal_new_connection (self, path, connection, error);
 		g_free (path);
 	}
@@ -598,6 +657,12 @@ dispose (GObject *object)
 
 	g_free (priv->hostname);
 
+	if (priv->changes)
+		nm_settings_change_queue_free (priv->changes);
+
+	if (priv->uuids)
+		g_hash_table_destroy (priv->uuids);
+
 	if (priv->hash)
 		g_hash_table_destroy (priv->hash);
 
@@ -911,8 +911,70 @@ string_to_gvalue (const char *str)
 	return val;
 }
 
+static GValue *
+ssid_to_gvalue (const GByteArray *ssid)
+{
+	GValue *val = g_slice_new0 (GValue);
+	GPtrArray *ssids;
+
+	ssids = g_ptr_array_sized_new (1);
+	g_ptr_array_add (ssids, (gpointer) ssid);
+
+	g_value_init (val, DBUS_TYPE_G_ARRAY_OF_ARRAY_OF_UCHAR);
+	g_value_set_boxed (val, ssids);
+	g_ptr_array_free (ssids, TRUE);
+	return val;
+}
+
+#define DBUS_TYPE_G_FREQ_RANGE          (dbus_g_type_get_struct ("GValueArray", G_TYPE_UINT, G_TYPE_UINT, G_TYPE_INVALID))
+#define DBUS_TYPE_G_ARRAY_OF_FREQ_RANGE (dbus_g_type_get_collection ("GPtrArray", DBUS_TYPE_G_FREQ_RANGE))
+
+static GValue *
+freqs_to_gvalue (const GArray *freqs)
+{
+	GValue *val = g_slice_new0 (GValue);
+	GPtrArray *channels;
+	guint i;
+
+	/* wpa_supplicant wants (center frequency, width) pairs in MHz */
+	channels = g_ptr_array_sized_new (freqs->len);
+	for (i = 0; i < freqs->len; i++) {
+		GValueArray *channel = g_value_array_new (2);
+		GValue item = { 0, };
+
+		g_value_init (&item, G_TYPE_UINT);
+		g_value_set_uint (&item, g_array_index (freqs, guint32, i));
+		g_value_array_append (channel, &item);
+		g_value_set_uint (&item, 20);
+		g_value_array_append (channel, &item);
+		g_value_unset (&item);
+
+		g_ptr_array_add (channels, channel);
+	}
+
+	g_value_init (val, DBUS_TYPE_G_ARRAY_OF_FREQ_RANGE);
+	g_value_set_boxed (val, channels);
+
+	g_ptr_array_foreach (channels, (GFunc) g_value_array_free, NULL);
+	g_ptr_array_free (channels, TRUE);
+	return val;
+}
+
+/**
+ * nm_supplicant_interface_request_scan:
+ * @self: the supplicant interface
+ * @ssid: if not %NULL, probe only for this SSID
+ * @freqs: if not %NULL, scan only these frequencies (MHz, as guint32)
+ *
+ * Asks the supplicant for an active scan; with neither @ssid nor @freqs
+ * this is a wildcard scan of every supported channel.
+ *
+ * Returns: %TRUE if the request was sent
+ */
 gboolean
-nm_supplicant_interface_request_scan (NMSupplicantInterface * self)
+nm_supplicant_interface_request_scan (NMSupplicantInterface * self,
+                                      const GByteArray *ssid,
+                                      const GArray *freqs)
 {
 	NMSupplicantInterfacePrivate *priv;
 	NMSupplicantInfo *info;
@@ -926,6 +988,10 @@ nm_supplicant_interface_request_scan (NMSupplicantInterface * self)
 	/* Scan parameters */
 	hash = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, destroy_gvalue);
 	g_hash_table_insert (hash, "Type", string_to_gvalue ("active"));
+	if (ssid && ssid->len)
+		g_hash_table_insert (hash, "SSIDs", ssid_to_gvalue (ssid));
+	if (freqs && freqs->len)
+		g_hash_table_insert (hash, "Channels", freqs_to_gvalue (freqs));
 
 	info = nm_supplicant_info_new (self, priv->iface_proxy, priv->other_pcalls);
 	call = dbus_g_proxy_begin_call (priv->iface_proxy, "Scan",
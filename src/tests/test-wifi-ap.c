@@ -0,0 +1,189 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ *
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <netinet/ether.h>
+
+#include "nm-wifi-ap.h"
+#include "NetworkManagerUtils.h"
+
+/* nm-wifi-ap.c only needs this from NetworkManagerUtils.c, which would
+ * pull in most of the daemon.
+ */
+gboolean
+nm_ethernet_address_is_valid (const struct ether_addr *test_addr)
+{
+	static const guint8 zero[ETH_ALEN] = { 0 };
+
+	return memcmp (test_addr->ether_addr_octet, zero, ETH_ALEN) != 0;
+}
+
+/*******************************************/
+
+#define TEST_BSSID "00:11:22:33:44:55"
+#define TEST_SSID  "blahblah"
+
+static NMAccessPoint *
+make_ap (const char *ssid, gint8 strength, glong last_seen)
+{
+	NMAccessPoint *ap;
+
+	ap = nm_ap_new ();
+	if (ssid) {
+		GByteArray *array;
+
+		array = g_byte_array_sized_new (strlen (ssid));
+		g_byte_array_append (array, (const guint8 *) ssid, strlen (ssid));
+		nm_ap_set_ssid (ap, array);
+		g_byte_array_free (array, TRUE);
+	}
+	nm_ap_set_address (ap, ether_aton (TEST_BSSID));
+	nm_ap_set_mode (ap, NM_802_11_MODE_INFRA);
+	nm_ap_set_flags (ap, NM_802_11_AP_FLAGS_PRIVACY);
+	nm_ap_set_rsn_flags (ap, NM_802_11_AP_SEC_PAIR_CCMP | NM_802_11_AP_SEC_GROUP_CCMP | NM_802_11_AP_SEC_KEY_MGMT_PSK);
+	nm_ap_set_freq (ap, 2412);
+	nm_ap_set_max_bitrate (ap, 54000);
+	nm_ap_set_strength (ap, strength);
+	nm_ap_set_last_seen (ap, last_seen);
+	return ap;
+}
+
+static void
+notify_cb (GObject *object, GParamSpec *pspec, gpointer user_data)
+{
+	GString *notified = user_data;
+
+	g_string_append_printf (notified, "%s%s", notified->len ? "," : "", pspec->name);
+}
+
+/*******************************************/
+
+static void
+test_update_unchanged (void)
+{
+	NMAccessPoint *ap, *scanned;
+	GString *notified = g_string_new (NULL);
+	GSList *list;
+
+	ap = make_ap (TEST_SSID, 50, 100);
+	scanned = make_ap (TEST_SSID, 50, 120);
+	g_signal_connect (ap, "notify", G_CALLBACK (notify_cb), notified);
+
+	list = g_slist_prepend (NULL, ap);
+	g_assert (nm_ap_match_in_list (scanned, list, TRUE) == ap);
+	g_slist_free (list);
+
+	g_assert (nm_ap_update_from_scan (ap, scanned) == FALSE);
+	g_assert_cmpstr (notified->str, ==, "");
+	g_assert_cmpint (nm_ap_get_last_seen (ap), ==, 120);
+
+	/* Jitter below the hysteresis doesn't count as a change either */
+	nm_ap_set_strength (scanned, 50 + NM_AP_STRENGTH_HYSTERESIS - 1);
+	g_assert (nm_ap_update_from_scan (ap, scanned) == FALSE);
+	g_assert_cmpstr (notified->str, ==, "");
+	g_assert_cmpint (nm_ap_get_strength (ap), ==, 50);
+
+	g_object_unref (scanned);
+	g_object_unref (ap);
+	g_string_free (notified, TRUE);
+}
+
+static void
+test_update_strength (void)
+{
+	NMAccessPoint *ap, *scanned;
+	GString *notified = g_string_new (NULL);
+
+	ap = make_ap (TEST_SSID, 50, 100);
+	scanned = make_ap (TEST_SSID, 50 - NM_AP_STRENGTH_HYSTERESIS, 120);
+	g_signal_connect (ap, "notify", G_CALLBACK (notify_cb), notified);
+
+	g_assert (nm_ap_update_from_scan (ap, scanned) == TRUE);
+	g_assert_cmpstr (notified->str, ==, NM_AP_STRENGTH);
+	g_assert_cmpint (nm_ap_get_strength (ap), ==, 50 - NM_AP_STRENGTH_HYSTERESIS);
+	g_assert_cmpint (nm_ap_get_last_seen (ap), ==, 120);
+
+	g_object_unref (scanned);
+	g_object_unref (ap);
+	g_string_free (notified, TRUE);
+}
+
+static void
+test_update_hidden_ssid (void)
+{
+	NMAccessPoint *ap, *scanned;
+	GString *notified = g_string_new (NULL);
+	GSList *list;
+	const GByteArray *ssid;
+
+	ap = make_ap (NULL, 50, 100);
+	scanned = make_ap (TEST_SSID, 50, 120);
+	g_signal_connect (ap, "notify", G_CALLBACK (notify_cb), notified);
+
+	/* The scan result for the same BSS now carries the SSID */
+	list = g_slist_prepend (NULL, ap);
+	g_assert (nm_ap_match_in_list (scanned, list, TRUE) == ap);
+	g_slist_free (list);
+
+	g_assert (nm_ap_update_from_scan (ap, scanned) == TRUE);
+	g_assert_cmpstr (notified->str, ==, NM_AP_SSID);
+
+	ssid = nm_ap_get_ssid (ap);
+	g_assert (ssid != NULL);
+	g_assert_cmpint (ssid->len, ==, strlen (TEST_SSID));
+	g_assert (memcmp (ssid->data, TEST_SSID, ssid->len) == 0);
+
+	/* Once known, the SSID isn't changed by a later scan */
+	g_string_truncate (notified, 0);
+	g_assert (nm_ap_update_from_scan (ap, scanned) == FALSE);
+	g_assert_cmpstr (notified->str, ==, "");
+
+	g_object_unref (scanned);
+	g_object_unref (ap);
+	g_string_free (notified, TRUE);
+}
+
+/*******************************************/
+
+#if GLIB_CHECK_VERSION(2,25,12)
+typedef GTestFixtureFunc TCFunc;
+#else
+typedef void (*TCFunc)(void);
+#endif
+
+#define TESTCASE(t, d) g_test_create_case (#t, 0, (gconstpointer) d, NULL, (TCFunc) t, NULL)
+
+int main (int argc, char **argv)
+{
+	GTestSuite *suite;
+
+	g_type_init ();
+	g_test_init (&argc, &argv, NULL);
+
+	suite = g_test_get_root ();
+
+	g_test_suite_add (suite, TESTCASE (test_update_unchanged, NULL));
+	g_test_suite_add (suite, TESTCASE (test_update_strength, NULL));
+	g_test_suite_add (suite, TESTCASE (test_update_hidden_ssid, NULL));
+
+	return g_test_run ();
+}
+
@@ -0,0 +1,283 @@
+/* -*- Mode: C; tab-width: 4; indent-tabs-mode: t; c-basic-offset: 4 -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ *
+ * Copyright (C) 2011 Red Hat, Inc.
+ *
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "nm-wifi-scan-scheduler.h"
+
+static const struct ether_addr bssid_home1 = { { 0x00, 0x11, 0x22, 0x33, 0x44, 0x01 } };
+static const struct ether_addr bssid_home2 = { { 0x00, 0x11, 0x22, 0x33, 0x44, 0x02 } };
+static const struct ether_addr bssid_cafe  = { { 0x00, 0x11, 0x22, 0x33, 0x44, 0x03 } };
+static const struct ether_addr bssid_other = { { 0x00, 0x11, 0x22, 0x33, 0x44, 0x04 } };
+
+static GByteArray *
+make_ssid (const char *str)
+{
+	GByteArray *ssid;
+
+	ssid = g_byte_array_sized_new (strlen (str));
+	g_byte_array_append (ssid, (const guint8 *) str, strlen (str));
+	return ssid;
+}
+
+static gboolean
+has_freq (GArray *freqs, guint32 freq)
+{
+	guint i;
+
+	for (i = 0; i < freqs->len; i++) {
+		if (g_array_index (freqs, guint32, i) == freq)
+			return TRUE;
+	}
+	return FALSE;
+}
+
+static NMWifiScanScheduler *
+setup (GByteArray *home, GByteArray *cafe, GByteArray *other)
+{
+	NMWifiScanScheduler *sched;
+
+	sched = nm_wifi_scan_scheduler_new ();
+	nm_wifi_scan_scheduler_bss_seen (sched, &bssid_home1, home, 2412);
+	nm_wifi_scan_scheduler_bss_seen (sched, &bssid_home2, home, 5180);
+	nm_wifi_scan_scheduler_bss_seen (sched, &bssid_cafe, cafe, 2437);
+	nm_wifi_scan_scheduler_bss_seen (sched, &bssid_other, other, 2462);
+	return sched;
+}
+
+/*******************************************/
+
+static void
+test_disconnected (void)
+{
+	NMWifiScanScheduler *sched;
+	GByteArray *home = make_ssid ("home");
+	GByteArray *cafe = make_ssid ("cafe");
+	GByteArray *other = make_ssid ("other");
+	const GByteArray *ssid = NULL;
+	GArray *freqs = NULL;
+	NMWifiScanType type;
+	int i;
+
+	sched = setup (home, cafe, other);
+
+	/* Nothing known; every scan is full */
+	for (i = 0; i < 5; i++) {
+		type = nm_wifi_scan_scheduler_next (sched, &freqs, &ssid);
+		g_assert_cmpint (type, ==, NM_WIFI_SCAN_TYPE_FULL);
+		g_assert (freqs == NULL);
+		g_assert (ssid == NULL);
+	}
+
+	/* Known by SSID and by seen BSSID */
+	nm_wifi_scan_scheduler_add_known_ssid (sched, home);
+	nm_wifi_scan_scheduler_add_known_bssid (sched, &bssid_cafe);
+
+	for (i = 0; i < NM_WIFI_SCAN_FULL_EVERY; i++) {
+		type = nm_wifi_scan_scheduler_next (sched, &freqs, &ssid);
+		g_assert_cmpint (type, ==, NM_WIFI_SCAN_TYPE_TARGETED);
+		g_assert (ssid == NULL);
+		g_assert (freqs != NULL);
+		g_assert_cmpint (freqs->len, ==, 3);
+		g_assert (has_freq (freqs, 2412));
+		g_assert (has_freq (freqs, 5180));
+		g_assert (has_freq (freqs, 2437));
+		g_array_free (freqs, TRUE);
+	}
+
+	/* Periodic full scan to find new networks */
+	type = nm_wifi_scan_scheduler_next (sched, &freqs, &ssid);
+	g_assert_cmpint (type, ==, NM_WIFI_SCAN_TYPE_FULL);
+	g_assert (freqs == NULL);
+
+	g_assert_cmpint (nm_wifi_scan_scheduler_get_interval (sched, 20), ==, 20);
+
+	nm_wifi_scan_scheduler_free (sched);
+	g_byte_array_free (home, TRUE);
+	g_byte_array_free (cafe, TRUE);
+	g_byte_array_free (other, TRUE);
+}
+
+static void
+test_associated_roaming (void)
+{
+	NMWifiScanScheduler *sched;
+	GByteArray *home = make_ssid ("home");
+	GByteArray *cafe = make_ssid ("cafe");
+	GByteArray *other = make_ssid ("other");
+	const GByteArray *ssid = NULL;
+	GArray *freqs = NULL;
+	NMWifiScanType type;
+	guint interval;
+
+	sched = setup (home, cafe, other);
+	nm_wifi_scan_scheduler_set_link (sched, home, 2412);
+	nm_wifi_scan_scheduler_next (sched, &freqs, &ssid);  /* initial full scan */
+
+	/* Good link: long interval, only the current ESS's channels */
+	g_assert (nm_wifi_scan_scheduler_update_strength (sched, 80) == FALSE);
+	g_assert_cmpint (nm_wifi_scan_scheduler_get_interval (sched, 20), ==, NM_WIFI_SCAN_INTERVAL_ASSOCIATED);
+
+	type = nm_wifi_scan_scheduler_next (sched, &freqs, &ssid);
+	g_assert_cmpint (type, ==, NM_WIFI_SCAN_TYPE_TARGETED);
+	g_assert (ssid == NULL);
+	g_assert_cmpint (freqs->len, ==, 2);
+	g_assert (has_freq (freqs, 2412));
+	g_assert (has_freq (freqs, 5180));
+	g_array_free (freqs, TRUE);
+
+	/* Weak link: short roaming scans for the current SSID, backing off */
+	g_assert (nm_wifi_scan_scheduler_update_strength (sched, NM_WIFI_SCAN_WEAK_STRENGTH - 1) == TRUE);
+	g_assert (nm_wifi_scan_scheduler_update_strength (sched, NM_WIFI_SCAN_WEAK_STRENGTH - 5) == FALSE);
+	g_assert_cmpint (nm_wifi_scan_scheduler_get_interval (sched, 20), ==, NM_WIFI_SCAN_INTERVAL_ROAM_MIN);
+
+	type = nm_wifi_scan_scheduler_next (sched, &freqs, &ssid);
+	g_assert_cmpint (type, ==, NM_WIFI_SCAN_TYPE_ROAM);
+	g_assert (ssid != NULL);
+	g_assert_cmpint (ssid->len, ==, home->len);
+	g_assert_cmpint (freqs->len, ==, 2);
+	g_array_free (freqs, TRUE);
+
+	interval = nm_wifi_scan_scheduler_get_interval (sched, 20);
+	g_assert_cmpint (interval, >, NM_WIFI_SCAN_INTERVAL_ROAM_MIN);
+	g_assert_cmpint (interval, <=, NM_WIFI_SCAN_INTERVAL_ROAM_MAX);
+
+	/* Hysteresis: just above the weak threshold is still weak */
+	nm_wifi_scan_scheduler_update_strength (sched, NM_WIFI_SCAN_WEAK_STRENGTH + 1);
+	type = nm_wifi_scan_scheduler_next (sched, &freqs, &ssid);
+	g_assert_cmpint (type, ==, NM_WIFI_SCAN_TYPE_ROAM);
+	g_array_free (freqs, TRUE);
+
+	nm_wifi_scan_scheduler_update_strength (sched, NM_WIFI_SCAN_GOOD_STRENGTH + 1);
+	g_assert_cmpint (nm_wifi_scan_scheduler_get_interval (sched, 20), ==, NM_WIFI_SCAN_INTERVAL_ASSOCIATED);
+
+	/* Disconnecting returns to the plain backoff */
+	nm_wifi_scan_scheduler_set_link (sched, NULL, 0);
+	g_assert_cmpint (nm_wifi_scan_scheduler_get_interval (sched, 20), ==, 20);
+	g_assert (nm_wifi_scan_scheduler_update_strength (sched, 10) == FALSE);
+
+	nm_wifi_scan_scheduler_free (sched);
+	g_byte_array_free (home, TRUE);
+	g_byte_array_free (cafe, TRUE);
+	g_byte_array_free (other, TRUE);
+}
+
+static void
+test_history_limit (void)
+{
+	NMWifiScanScheduler *sched;
+	GByteArray *home = make_ssid ("home");
+	struct ether_addr addr = { { 0x02, 0, 0, 0, 0, 0 } };
+	const GByteArray *ssid = NULL;
+	GArray *freqs = NULL;
+	NMWifiScanType type;
+	guint i;
+
+	sched = nm_wifi_scan_scheduler_new ();
+	nm_wifi_scan_scheduler_add_known_ssid (sched, home);
+	nm_wifi_scan_scheduler_bss_seen (sched, &bssid_home1, home, 2412);
+	nm_wifi_scan_scheduler_next (sched, &freqs, &ssid);  /* initial full scan */
+
+	/* Enough unrelated BSSes to push the oldest entry out */
+	for (i = 0; i < 1000; i++) {
+		addr.ether_addr_octet[4] = i >> 8;
+		addr.ether_addr_octet[5] = i & 0xFF;
+		nm_wifi_scan_scheduler_bss_seen (sched, &addr, NULL, 2462);
+	}
+
+	type = nm_wifi_scan_scheduler_next (sched, &freqs, &ssid);
+	g_assert_cmpint (type, ==, NM_WIFI_SCAN_TYPE_FULL);
+	g_assert (freqs == NULL);
+
+	nm_wifi_scan_scheduler_free (sched);
+	g_byte_array_free (home, TRUE);
+}
+
+static void
+test_start_from_history (void)
+{
+	NMWifiScanScheduler *sched;
+	GByteArray *home = make_ssid ("home");
+	GByteArray *cafe = make_ssid ("cafe");
+	GByteArray *other = make_ssid ("other");
+	const GByteArray *ssid = NULL;
+	GArray *freqs = NULL;
+	NMWifiScanType type;
+
+	sched = setup (home, cafe, other);
+
+	/* Nothing known yet: every remembered channel, then a full scan */
+	nm_wifi_scan_scheduler_start_from_history (sched);
+	type = nm_wifi_scan_scheduler_next (sched, &freqs, &ssid);
+	g_assert_cmpint (type, ==, NM_WIFI_SCAN_TYPE_TARGETED);
+	g_assert_cmpint (freqs->len, ==, 4);
+	g_array_free (freqs, TRUE);
+
+	type = nm_wifi_scan_scheduler_next (sched, &freqs, &ssid);
+	g_assert_cmpint (type, ==, NM_WIFI_SCAN_TYPE_FULL);
+
+	/* Known networks narrow it down */
+	nm_wifi_scan_scheduler_add_known_ssid (sched, cafe);
+	nm_wifi_scan_scheduler_start_from_history (sched);
+	type = nm_wifi_scan_scheduler_next (sched, &freqs, &ssid);
+	g_assert_cmpint (type, ==, NM_WIFI_SCAN_TYPE_TARGETED);
+	g_assert_cmpint (freqs->len, ==, 1);
+	g_assert (has_freq (freqs, 2437));
+	g_array_free (freqs, TRUE);
+
+	/* An empty history means a plain full scan */
+	nm_wifi_scan_scheduler_free (sched);
+	sched = nm_wifi_scan_scheduler_new ();
+	nm_wifi_scan_scheduler_start_from_history (sched);
+	type = nm_wifi_scan_scheduler_next (sched, &freqs, &ssid);
+	g_assert_cmpint (type, ==, NM_WIFI_SCAN_TYPE_FULL);
+
+	nm_wifi_scan_scheduler_free (sched);
+	g_byte_array_free (home, TRUE);
+	g_byte_array_free (cafe, TRUE);
+	g_byte_array_free (other, TRUE);
+}
+
+/*******************************************/
+
+#if GLIB_CHECK_VERSION(2,25,12)
+typedef GTestFixtureFunc TCFunc;
+#else
+typedef void (*TCFunc)(void);
+#endif
+
+#define TESTCASE(t, d) g_test_create_case (#t, 0, (gconstpointer) d, NULL, (TCFunc) t, NULL)
+
+int main (int argc, char **argv)
+{
+	GTestSuite *suite;
+
+	g_test_init (&argc, &argv, NULL);
+
+	suite = g_test_get_root ();
+
+	g_test_suite_add (suite, TESTCASE (test_disconnected, NULL));
+	g_test_suite_add (suite, TESTCASE (test_associated_roaming, NULL));
+	g_test_suite_add (suite, TESTCASE (test_history_limit, NULL));
+	g_test_suite_add (suite, TESTCASE (test_start_from_history, NULL));
+
+	return g_test_run ();
+}